@@ -1,101 +1,764 @@
-#include "ADC_Config.h"
-#include "SystemClock.h"
-
-/**
-  * @brief Initialisation de l'ADC
-  *        Configure l'ADC1 pour effectuer des conversions analogiques-numriques sur les canaux slectionns.
-  */
-void ADC_Init (void)
-{
-	/************** TAPES  SUIVRE *****************
-	1. Activer les horloges ADC et GPIO
-	2. Configurer le diviseur d'horloge dans le registre CCR
-	3. Rgler le mode SCAN et la rsolution dans CR1
-	4. Configurer le mode de conversion continue, EOC et alignement des donnes dans CR2
-	5. Rgler le temps d'chantillonnage pour les canaux dans ADC_SMPRx
-	6. Dfinir la longueur de la squence des canaux dans ADC_SQR1
-	7. Configurer les broches GPIO correspondantes en mode analogique
-	************************************************/
-
-	// 1. Activer les horloges ADC et GPIO
-	RCC->APB2ENR |= (1<<8);  // Activer l'horloge ADC1
-	RCC->AHB1ENR |= (1<<0);  // Activer l'horloge GPIOA
-
-	// 2. Configurer le diviseur d'horloge dans CCR
-	ADC->CCR |= 1<<16; // Diviseur de PCLK2 par 4
-
-	// 3. Configurer le mode SCAN et la rsolution dans CR1
-	ADC1->CR1 = (1<<8);    // Mode SCAN activ
-	ADC1->CR1 &= ~(1<<24); // Rsolution 12 bits
-
-	// 4. Configurer le mode de conversion continue, EOC et alignement des donnes dans CR2
-	ADC1->CR2 |= (1<<1);   // Conversion continue active
-	ADC1->CR2 |= (1<<10);  // EOC aprs chaque conversion
-	ADC1->CR2 &= ~(1<<11); // Alignement des donnes  droite
-
-	// 5. Configurer le temps d'chantillonnage
-	ADC1->SMPR2 &= ~((1<<3) | (1<<12));  // Temps d'chantillonnage de 3 cycles pour les canaux 1 et 4
-
-	// 6. Dfinir la longueur de la squence des canaux
-	ADC1->SQR1 |= (1<<20); // Longueur de la squence : 2 conversions
-
-	// 7. Configurer les broches GPIO en mode analogique
-	GPIOA->MODER |= (3<<2);  // Mode analogique pour PA1 (canal 1)
-	GPIOA->MODER |= (3<<8);  // Mode analogique pour PA4 (canal 4)
-}
-
-/**
-  * @brief Activer l'ADC
-  *        Initialise l'ADC en rglant le bit ADON dans CR2 et attend la stabilisation.
-  */
-void ADC_Enable (void)
-{
-	ADC1->CR2 |= 1<<0;  // Activer l'ADC (ADON = 1)
-
-	uint32_t delay = 10000;
-	while (delay--); // Attendre environ 10 s pour la stabilisation
-}
-
-/**
-  * @brief Dmarrer une conversion sur un canal spcifique
-  * @param channel : Numro du canal  convertir
-  */
-void ADC_Start (int channel)
-{
-	/************** TAPES  SUIVRE *****************
-	1. Rgler le canal dans le registre de squence SQR3
-	2. Effacer le registre de statut
-	3. Dmarrer la conversion en rglant le bit SWSTART dans CR2
-	************************************************/
-	ADC1->SQR3 = 0;                 // Rinitialiser la squence
-	ADC1->SQR3 |= (channel<<0);     // Configurer le canal pour la conversion
-	ADC1->SR = 0;                   // Effacer le registre de statut
-	ADC1->CR2 |= (1<<30);           // Lancer la conversion
-}
-
-/**
-  * @brief Attendre la fin de la conversion
-  */
-void ADC_WaitForConv (void)
-{
-	// Attendre que le drapeau EOC soit activ (fin de conversion)
-	while (!(ADC1->SR & (1<<1)));
-}
-
-/**
-  * @brief Obtenir la valeur convertie de l'ADC
-  * @retval Valeur 12 bits de la conversion
-  */
-uint16_t ADC_GetVal (void)
-{
-	return ADC1->DR; // Lire le registre de donnes
-}
-
-/**
-  * @brief Dsactiver l'ADC
-  *        Rinitialise l'ADC en dsactivant le bit ADON dans CR2.
-  */
-void ADC_Disable (void)
-{
-	ADC1->CR2 &= ~(1<<0); // Dsactiver l'ADC (ADON = 0)
-}
+#include "ADC_Config.h"
+#include "SystemClock.h"
+#include "DWT_Config.h"
+#include "IsrTime.h"
+#include "Trace.h"
+#include <stdio.h>
+
+// Durée d'échantillonnage en cycles ADC pour chaque code SMPx
+static const uint16_t smp_cycles[8] = { 3, 15, 28, 56, 84, 112, 144, 480 };
+
+// Temps de stabilisation de l'ADC après ADON (tSTAB, 3 µs max selon la fiche technique)
+#define ADC_TSTAB_US 3
+
+// Bits de ADC_SR (effacés en écrivant 0)
+#define SR_EOC   (1U<<1)
+#define SR_STRT  (1U<<4)
+#define SR_OVR   (1U<<5)
+
+// Drapeaux du flux 0 dans DMA2->LISR / LIFCR
+#define DMA_FEIF  (1U<<0)
+#define DMA_DMEIF (1U<<2)
+#define DMA_TEIF  (1U<<3)
+#define DMA_HTIF  (1U<<4)
+#define DMA_TCIF  (1U<<5)
+
+static volatile ADC_Errors errors;
+static volatile uint32_t block_ovr;          // Débordements pendant ADC_ReadBlock()
+
+// Flux continu ADC1 -> DMA2 flux 0 (canal 0), anneau circulaire
+static struct {
+	uint8_t           active;
+	uint16_t         *ring;
+	uint32_t          size;                  // Puissance de 2
+	uint32_t          sqr1;                  // Séquence d'origine
+	uint32_t          dt_q8;                 // Intervalle entre conversions (cycles CPU, Q8)
+	volatile uint32_t halves;                // Demi-anneaux remplis depuis le redémarrage
+	volatile uint32_t epoch;                 // Incrémenté à chaque (re)démarrage
+	volatile uint32_t epoch_t0;              // Date du premier échantillon de l'époque
+	uint32_t          rd_epoch;
+	uint32_t          rd;                    // Échantillons lus depuis le début de l'époque
+} stream;
+
+// Acquisition déclenchée par front externe (EXTI11 / PB11), fronts datés par TIM2
+static struct {
+	volatile uint8_t active;
+	uint32_t         tick_hz;                // Horloge de TIM2
+	uint32_t         sqr1, cr2;              // Configuration d'origine
+	Trigger          t;
+} trig;
+
+/**
+  * @brief Choisir le diviseur ADC le plus faible respectant ADCCLK <= 36 MHz
+  *        Fonction pure : ne dépend que de PCLK2, issu de SysClock_GetTree().
+  * @param pclk2 : Horloge APB2 (Hz)
+  * @retval Valeur du champ ADCPRE de ADC_CCR (0 = /2, 1 = /4, 2 = /6, 3 = /8)
+  */
+uint32_t ADC_ComputePrescaler (uint32_t pclk2)
+{
+	uint32_t pre;
+
+	for (pre = 0; pre < 3; pre++) {
+		if (pclk2 / (2 * (pre + 1)) <= ADC_CLK_MAX_HZ)
+			break;
+	}
+	return pre;
+}
+
+/**
+  * @brief Fréquence de l'horloge ADC active
+  * @retval ADCCLK (Hz)
+  */
+uint32_t ADC_GetClock (void)
+{
+	return SysClock_GetTree()->pclk2 / (2 * (((ADC->CCR >> 16) & 3) + 1));
+}
+
+/**
+  * @brief Initialisation de l'ADC
+  *        Configure l'ADC1 pour effectuer des conversions analogiques-numériques sur les canaux sélectionnés.
+  */
+void ADC_Init (void)
+{
+	/************** ÉTAPES À SUIVRE *****************
+	1. Activer les horloges ADC et GPIO
+	2. (Le diviseur d'horloge CCR est réglé par ADC_Enable(), une fois l'horloge système fixée)
+	3. Régler le mode SCAN et la résolution dans CR1
+	4. Configurer le mode de conversion continue, EOC et alignement des données dans CR2
+	5. Régler le temps d'échantillonnage pour les canaux dans ADC_SMPRx
+	6. Définir la longueur de la séquence des canaux dans ADC_SQR1
+	7. Configurer les broches GPIO correspondantes en mode analogique
+	************************************************/
+
+	// 1. Activer les horloges ADC et GPIO
+	RCC->APB2ENR |= (1<<8);  // Activer l'horloge ADC1
+	RCC->AHB1ENR |= (1<<0);  // Activer l'horloge GPIOA
+
+	// 3. Configurer le mode SCAN et la résolution dans CR1
+	ADC1->CR1 = (1<<8);    // Mode SCAN activé
+	ADC1->CR1 &= ~(1<<24); // Résolution 12 bits
+
+	// 4. Configurer le mode de conversion continue, EOC et alignement des données dans CR2
+	ADC1->CR2 |= (1<<1);   // Conversion continue activée
+	ADC1->CR2 |= (1<<10);  // EOC après chaque conversion
+	ADC1->CR2 &= ~(1<<11); // Alignement des données à droite
+
+	// 5. Configurer le temps d'échantillonnage
+	ADC1->SMPR2 &= ~((1<<3) | (1<<12));  // Temps d'échantillonnage de 3 cycles pour les canaux 1 et 4
+
+	// 6. Définir la longueur de la séquence des canaux
+	ADC1->SQR1 |= (1<<20); // Longueur de la séquence : 2 conversions
+
+	// 7. Configurer les broches GPIO en mode analogique
+	GPIOA->MODER |= (3<<2);  // Mode analogique pour PA1 (canal 1)
+	GPIOA->MODER |= (3<<8);  // Mode analogique pour PA4 (canal 4)
+
+	// Débordement (OVR) signalé par interruption, pendant les acquisitions seulement (ovr_irq)
+	NVIC_EnableIRQ(ADC_IRQn);
+}
+
+/**
+  * @brief Activer l'ADC
+  *        Initialise l'ADC en réglant le bit ADON dans CR2 et attend la stabilisation.
+  *        L'attente est calibrée sur le compteur de cycles : exactement tSTAB quelle que soit
+  *        la fréquence du coeur, au lieu d'une boucle vide dépendante du compilateur.
+  *        Le compteur doit tourner (SystemInit, BootTime_Start) : il n'est jamais touché ici,
+  *        pour ne pas fausser les étapes de BootTime.
+  */
+void ADC_Enable (void)
+{
+	// Diviseur d'horloge dérivé de PCLK2 actif (ADCCLK <= 36 MHz)
+	ADC->CCR = (ADC->CCR & ~(3<<16)) | (ADC_ComputePrescaler(SysClock_GetTree()->pclk2) << 16);
+
+	ADC1->CR2 |= 1<<0;  // Activer l'ADC (ADON = 1)
+
+	DWT_Delay_us(ADC_TSTAB_US); // Attendre tSTAB pour la stabilisation
+}
+
+/**
+  * @brief Démarrer une conversion sur un canal spécifique
+  * @param channel : Numéro du canal à convertir
+  */
+void ADC_Start (int channel)
+{
+	/************** ÉTAPES À SUIVRE *****************
+	1. Régler le canal dans le registre de séquence SQR3
+	2. Effacer le registre de statut
+	3. Démarrer la conversion en réglant le bit SWSTART dans CR2
+	************************************************/
+	ADC1->SQR3 = 0;                 // Réinitialiser la séquence
+	ADC1->SQR3 |= (channel<<0);     // Configurer le canal pour la conversion
+	ADC1->SR = ~(SR_EOC | SR_STRT); // Effacer EOC et STRT ; OVR reste visible pour l'interruption
+	ADC1->CR2 |= (1<<30);           // Lancer la conversion
+}
+
+/**
+  * @brief Attendre la fin de la conversion
+  */
+void ADC_WaitForConv (void)
+{
+	// Attendre que le drapeau EOC soit activé (fin de conversion)
+	while (!(ADC1->SR & (1<<1)));
+}
+
+/**
+  * @brief Obtenir la valeur convertie de l'ADC
+  * @retval Valeur 12 bits de la conversion
+  */
+uint16_t ADC_GetVal (void)
+{
+	return ADC1->DR; // Lire le registre de données
+}
+
+/**
+  * @brief Désactiver l'ADC
+  *        Réinitialise l'ADC en désactivant le bit ADON dans CR2.
+  */
+void ADC_Disable (void)
+{
+	ADC1->CR2 &= ~(1<<0); // Désactiver l'ADC (ADON = 0)
+}
+
+/**
+  * @brief Nombre de bits d'une résolution
+  */
+uint32_t ADC_ResolutionBits (ADC_Resolution res)
+{
+	return 12 - 2 * (uint32_t)res;
+}
+
+/**
+  * @brief Durée totale d'une conversion en cycles ADC
+  *        Temps d'échantillonnage + un cycle par bit de résolution (15 cycles en 12 bits / 3 cycles,
+  *        9 cycles en 6 bits / 3 cycles).
+  */
+uint32_t ADC_ConvCycles (ADC_Resolution res, ADC_SampleTime smp)
+{
+	return smp_cycles[smp] + ADC_ResolutionBits(res);
+}
+
+/**
+  * @brief Changer la résolution
+  *        L'ADC est arrêté pendant la modification puis réactivé (avec tSTAB) s'il était en marche.
+  * @param res : Nouvelle résolution
+  */
+void ADC_SetResolution (ADC_Resolution res)
+{
+	uint32_t was_on = ADC1->CR2 & (1<<0);
+
+	if (was_on)
+		ADC_Disable();
+	ADC1->CR1 = (ADC1->CR1 & ~(3U<<24)) | ((uint32_t)res << 24);
+	if (was_on)
+		ADC_Enable();
+}
+
+/**
+  * @brief Résolution active
+  */
+ADC_Resolution ADC_GetResolution (void)
+{
+	return (ADC_Resolution)((ADC1->CR1 >> 24) & 3);
+}
+
+/**
+  * @brief Régler le temps d'échantillonnage d'un canal
+  * @param channel : Canal (0 à 18)
+  * @param smp : Temps d'échantillonnage
+  */
+void ADC_SetSampleTime (int channel, ADC_SampleTime smp)
+{
+	if (channel < 10)
+		ADC1->SMPR2 = (ADC1->SMPR2 & ~(7U << (3 * channel))) | ((uint32_t)smp << (3 * channel));
+	else
+		ADC1->SMPR1 = (ADC1->SMPR1 & ~(7U << (3 * (channel - 10)))) | ((uint32_t)smp << (3 * (channel - 10)));
+}
+
+/**
+  * @brief Temps d'échantillonnage d'un canal
+  */
+ADC_SampleTime ADC_GetSampleTime (int channel)
+{
+	if (channel < 10)
+		return (ADC_SampleTime)((ADC1->SMPR2 >> (3 * channel)) & 7);
+	return (ADC_SampleTime)((ADC1->SMPR1 >> (3 * (channel - 10))) & 7);
+}
+
+/**
+  * @brief Pleine échelle de la résolution active (4096 en 12 bits)
+  */
+uint32_t ADC_GetFullScale (void)
+{
+	return 1U << ADC_ResolutionBits(ADC_GetResolution());
+}
+
+/**
+  * @brief Cadence de conversion théorique d'un canal (conversions continues)
+  * @retval Conversions par seconde
+  */
+uint32_t ADC_GetMaxRate (int channel)
+{
+	return ADC_GetClock() / ADC_ConvCycles(ADC_GetResolution(), ADC_GetSampleTime(channel));
+}
+
+// Interruption de débordement (OVRIE), active seulement pendant une acquisition (bloc, flux,
+// mode déclenché) : au repos, un OVR ne correspond à aucune perte et n'est pas compté
+static void ovr_irq (int on)
+{
+	if (on) {
+		ADC1->SR = ~SR_OVR;             // Débordement antérieur écarté
+		ADC1->CR1 |= (1<<26);
+	} else
+		ADC1->CR1 &= ~(1<<26);
+}
+
+// Attendre la conversion suivante d'une acquisition en scrutation. Un débordement, compté et
+// effacé par ADC_IRQHandler, arrête l'ADC : la séquence est relancée ici, hors interruption.
+static void wait_conv (uint32_t *seen)
+{
+	while (!(ADC1->SR & SR_EOC)) {
+		if (*seen != block_ovr) {
+			*seen = block_ovr;
+			ADC1->CR2 |= (1<<30);           // SWSTART
+		}
+	}
+}
+
+/**
+  * @brief Arrêter la conversion continue lancée par ADC_Start()
+  *        Effacer CONT laisse finir la conversion en cours, qui en relance une autre si CONT
+  *        est remis aussitôt : ADON = 0 arrête le convertisseur (RM0090 §13.3.1). Il est remis
+  *        sous tension au repos, CONT réarmé pour le prochain SWSTART (ni ADON ni CONT ne
+  *        lancent de conversion sur ce circuit), la dernière conversion et ses drapeaux écartés.
+  */
+static void adc_stop (void)
+{
+	ADC1->CR2 &= ~((1<<1) | (1<<0));    // CONT = 0, ADON = 0 : plus aucune conversion
+	(void)ADC1->DR;
+	ADC1->SR = ~(SR_OVR | SR_EOC | SR_STRT);
+	ADC1->CR2 |= (1<<1) | (1<<0);       // Au repos jusqu'au prochain SWSTART
+	DWT_Delay_us(ADC_TSTAB_US);
+}
+
+/**
+  * @brief Acquérir un bloc de conversions consécutives sur un canal
+  *        L'ADC tourne en conversion continue sur une séquence d'un seul canal ; chaque valeur
+  *        est lue dès la levée de EOC. La séquence d'origine est restaurée ensuite.
+  *        Un débordement (lecture trop tardive de DR) est compté par ADC_IRQHandler et la
+  *        séquence relancée par la boucle de lecture : le bloc reste complet mais n'est plus
+  *        équidistant.
+  * @param channel : Canal
+  * @param buf : Tampon de sortie
+  * @param count : Nombre de conversions
+  * @retval Nombre de débordements pendant le bloc (0 : bloc continu)
+  */
+uint32_t ADC_ReadBlock (int channel, uint16_t *buf, uint32_t count)
+{
+	uint32_t sqr1 = ADC1->SQR1, seen = 0;
+
+	TRACE(TRACE_ADC_BEGIN, channel);
+	block_ovr = 0;
+	ADC1->SQR1 = sqr1 & ~(0xFU << 20);  // Séquence d'une seule conversion
+	ovr_irq(1);
+	ADC_Start(channel);
+	while (count--) {
+		wait_conv(&seen);
+		*buf++ = ADC_GetVal();            // La lecture de DR efface EOC
+	}
+	adc_stop();
+	ovr_irq(0);
+	ADC1->SQR1 = sqr1;
+	TRACE(TRACE_ADC_END, channel);
+	return block_ovr;
+}
+
+/**
+  * @brief Lire un bloc de conversions d'un canal, une par déclenchement externe (front montant)
+  *        La cadence est celle de la source, qui doit être active ; lecture en scrutation comme
+  *        ADC_ReadBlock(). La configuration de l'ADC est restaurée ensuite.
+  * @param channel : Canal
+  * @param src : Source de déclenchement
+  * @param buf : Tampon de sortie
+  * @param count : Nombre de conversions
+  * @retval Nombre de débordements pendant le bloc (0 : bloc complet et régulier)
+  */
+uint32_t ADC_ReadTriggered (int channel, ADC_ExtTrigger src, uint16_t *buf, uint32_t count)
+{
+	uint32_t sqr1 = ADC1->SQR1, cr2 = ADC1->CR2;
+
+	block_ovr = 0;
+	ADC1->CR2 &= ~((1<<1) | (1<<8) | (1<<9));  // Ni conversion continue ni DMA
+	ADC1->SQR1 = sqr1 & ~(0xFU << 20);  // Séquence d'une seule conversion
+	ADC1->SQR3 = (uint32_t)channel;
+	ADC1->SR = ~(SR_EOC | SR_STRT);
+	ovr_irq(1);                         // Après un débordement, le front suivant relance
+	ADC1->CR2 = (ADC1->CR2 & ~((0xFU << 24) | (3U << 28))) | ((uint32_t)src << 24) | (1U << 28);
+	while (count--) {
+		ADC_WaitForConv();
+		*buf++ = ADC_GetVal();
+	}
+	ovr_irq(0);
+	ADC1->CR2 = cr2;
+	ADC1->SQR1 = sqr1;
+	return block_ovr;
+}
+
+/**
+  * @brief Mesurer la cadence de conversion réellement obtenue
+  *        Chronométrage au compteur de cycles d'un bloc de conversions continues.
+  * @param channel : Canal
+  * @param count : Nombre de conversions du bloc de mesure
+  * @retval Conversions par seconde
+  */
+uint32_t ADC_MeasureRate (int channel, uint32_t count)
+{
+	uint32_t sqr1 = ADC1->SQR1;
+	uint32_t start, cycles, n, seen = 0;
+
+	block_ovr = 0;
+	ADC1->SQR1 = sqr1 & ~(0xFU << 20);  // Séquence d'une seule conversion
+	ovr_irq(1);
+	ADC_Start(channel);
+	wait_conv(&seen);                   // Premier échantillon hors mesure
+	(void)ADC_GetVal();
+
+	start = DWT_GetCycles();
+	for (n = 0; n < count; n++) {
+		wait_conv(&seen);
+		(void)ADC_GetVal();
+	}
+	cycles = DWT_GetCycles() - start;
+
+	adc_stop();
+	ovr_irq(0);
+	ADC1->SQR1 = sqr1;
+
+	return (uint32_t)((uint64_t)count * SystemCoreClock / cycles);
+}
+
+// Armer le flux DMA sur l'anneau entier puis relancer les conversions (nouvelle époque)
+static MEM_RAMFUNC void stream_arm (void)
+{
+	DMA_Stream_TypeDef *d = DMA2_Stream0;
+
+	ADC1->CR2 &= ~((1<<8) | (1<<9));         // DMA = 0, DDS = 0 : plus de requêtes
+	d->CR &= ~(1<<0);
+	while (d->CR & (1<<0));                  // Attendre l'arrêt effectif du flux
+	DMA2->LIFCR = DMA_FEIF | DMA_DMEIF | DMA_TEIF | DMA_HTIF | DMA_TCIF;
+
+	d->PAR  = (uint32_t)&ADC1->DR;
+	d->M0AR = (uint32_t)stream.ring;
+	d->NDTR = stream.size;
+	d->CR   = (0U << 25) |                   // Canal 0 : ADC1
+	          (1<<13) | (1<<11) |            // Mémoire et périphérique 16 bits
+	          (1<<10) | (1<<8) |             // Incrément mémoire, mode circulaire
+	          (1<<4) | (1<<3) |              // Interruptions fin et moitié de transfert
+	          (1<<2) | (1<<1);               // Interruptions d'erreur (TE, DME)
+	stream.halves = 0;
+	d->CR |= (1<<0);
+
+	ADC1->SR = ~(SR_OVR | SR_EOC | SR_STRT);
+	ADC1->CR2 |= (1<<8) | (1<<9);            // DMA = 1, DDS = 1 : requêtes sans fin
+	stream.epoch_t0 = DWT_GetCycles() + (stream.dt_q8 >> 8);
+	ADC1->CR2 |= (1<<30);                    // SWSTART
+	stream.epoch++;
+}
+
+// Relance après une erreur, temps mort mesuré
+static MEM_RAMFUNC void stream_restart (void)
+{
+	uint32_t t = DWT_GetCycles();
+
+	stream_arm();
+	t = DWT_GetCycles() - t;
+	errors.restarts++;
+	if (t > errors.max_dead_cycles)
+		errors.max_dead_cycles = t;
+}
+
+/**
+  * @brief Démarrer l'acquisition continue d'un canal par DMA dans un anneau
+  *        L'anneau doit être en SRAM (le DMA n'a pas accès à la CCM).
+  * @param channel : Canal
+  * @param ring : Anneau d'échantillons
+  * @param size : Taille de l'anneau (puissance de 2)
+  */
+void ADC_StreamStart (int channel, uint16_t *ring, uint32_t size)
+{
+	RCC->AHB1ENR |= (1<<22);                 // Horloge DMA2
+
+	stream.ring = ring;
+	stream.size = size;
+	stream.sqr1 = ADC1->SQR1;
+	stream.dt_q8 = (uint32_t)(((uint64_t)ADC_ConvCycles(ADC_GetResolution(), ADC_GetSampleTime(channel))
+	                           * SystemCoreClock << 8) / ADC_GetClock());
+	stream.epoch = 0;
+
+	ADC1->SQR1 = stream.sqr1 & ~(0xFU << 20); // Séquence d'une seule conversion
+	ADC1->SQR3 = (uint32_t)channel;
+	ovr_irq(1);
+	stream_arm();
+	stream.rd_epoch = stream.epoch;
+	stream.rd = 0;
+	stream.active = 1;
+	NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+}
+
+/**
+  * @brief Arrêter l'acquisition continue et restaurer la séquence
+  */
+void ADC_StreamStop (void)
+{
+	stream.active = 0;
+	NVIC_DisableIRQ(DMA2_Stream0_IRQn);
+	ovr_irq(0);
+	ADC1->CR2 &= ~((1<<8) | (1<<9) | (1<<1));
+	DMA2_Stream0->CR &= ~(1<<0);
+	while (DMA2_Stream0->CR & (1<<0));
+	ADC1->CR2 |= (1<<1);
+	ADC1->SQR1 = stream.sqr1;
+}
+
+/**
+  * @brief Intervalle entre deux échantillons du flux
+  * @retval Cycles CPU en Q8
+  */
+uint32_t ADC_StreamPeriodQ8 (void)
+{
+	return stream.dt_q8;
+}
+
+/**
+  * @brief Lire les échantillons arrivés depuis la lecture précédente
+  *        Après un redémarrage de la chaîne ou un anneau écrasé, la lecture reprend au plus
+  *        ancien échantillon valide et info->lost signale la discontinuité.
+  * @param out : Sortie
+  * @param max : Nombre maximal d'échantillons
+  * @param info : Date du premier échantillon rendu et pertes
+  * @retval Nombre d'échantillons rendus
+  */
+uint32_t ADC_StreamRead (uint16_t *out, uint32_t max, ADC_StreamInfo *info)
+{
+	const uint32_t size = stream.size, half = size / 2;
+	uint32_t epoch, halves, pos, laps, wr, n, i;
+
+	// Instantané cohérent (époque, demi-anneaux, position du DMA)
+	do {
+		epoch = stream.epoch;
+		halves = stream.halves;
+		pos = size - DMA2_Stream0->NDTR;
+	} while (epoch != stream.epoch || halves != stream.halves);
+	if (pos >= size)
+		pos = 0;
+
+	// Fin d'anneau franchie mais interruption TC pas encore servie
+	laps = halves / 2 + ((halves & 1) && pos < half);
+	wr = laps * size + pos;                  // Écrits depuis le début de l'époque (modulo 2^32)
+
+	info->lost = 0;
+	if (epoch != stream.rd_epoch) {
+		info->lost = epoch - stream.rd_epoch;
+		stream.rd_epoch = epoch;
+		stream.rd = 0;
+	}
+	if (wr - stream.rd > size - 16) {        // Marge : le DMA écrit pendant la copie
+		errors.ring_overflows++;
+		info->lost++;
+		stream.rd = wr - half;
+	}
+
+	n = wr - stream.rd;
+	if (n > max)
+		n = max;
+	info->t0 = stream.epoch_t0 + (uint32_t)(((uint64_t)stream.rd * stream.dt_q8) >> 8);
+	for (i = 0; i < n; i++)
+		out[i] = stream.ring[(stream.rd + i) & (size - 1)];
+	stream.rd += n;
+	return n;
+}
+
+/**
+  * @brief Démarrer l'acquisition déclenchée : une conversion du canal à chaque front sur PB11
+  *        PB11 porte à la fois la ligne EXTI11 (déclenchement externe de l'ADC, EXTSEL = 1111)
+  *        et l'entrée de capture 4 de TIM2 (AF1), compteur libre sur 32 bits qui date les
+  *        fronts. Chaque résultat est lu par l'interruption EOC.
+  * @param channel : Canal
+  * @param edge : Front actif
+  */
+void ADC_TriggerStart (int channel, ADC_Edge edge)
+{
+	uint32_t conv;
+
+	// Durée d'une conversion en ticks de TIM2, synchronisation du déclenchement comprise (3 cycles ADC)
+	trig.tick_hz = SysClock_GetTree()->tim_apb1;
+	conv = (uint32_t)((uint64_t)(ADC_ConvCycles(ADC_GetResolution(), ADC_GetSampleTime(channel)) + 3)
+	                  * trig.tick_hz / ADC_GetClock());
+	Trigger_Init(&trig.t, conv);
+
+	// PB11 en fonction alternative TIM2_CH4 (l'entrée EXTI reste active)
+	RCC->AHB1ENR |= (1<<1);                  // Horloge GPIOB
+	RCC->APB1ENR |= (1<<0);                  // Horloge TIM2
+	GPIOB->MODER = (GPIOB->MODER & ~(3U << 22)) | (2U << 22);
+	GPIOB->AFR[1] = (GPIOB->AFR[1] & ~(0xFU << 12)) | (1U << 12);
+
+	// TIM2 libre à l'horloge des timers APB1, capture 4 sur TI4 sans filtre
+	TIM2->CR1 = 0;
+	TIM2->PSC = 0;
+	TIM2->ARR = 0xFFFFFFFF;
+	TIM2->CCMR2 = (TIM2->CCMR2 & ~(0xFFU << 8)) | (1U << 8);
+	TIM2->CCER = (1U << 12) |                                   // CC4E
+	             (edge != ADC_EDGE_RISING ? (1U << 13) : 0) |   // CC4P : descendant
+	             (edge == ADC_EDGE_BOTH ? (1U << 15) : 0);      // CC4NP : les deux
+	TIM2->EGR = 1;                           // Charger PSC
+	TIM2->SR = 0;
+	TIM2->DIER = (1U << 4);                  // CC4IE
+	TIM2->CR1 = 1;
+
+	// Ligne EXTI11 sur le port B, en mode événement (pas d'interruption EXTI)
+	RCC->APB2ENR |= (1<<14);                 // Horloge SYSCFG
+	SYSCFG->EXTICR[2] = (SYSCFG->EXTICR[2] & ~(0xFU << 12)) | (1U << 12);
+	EXTI->RTSR = (edge & ADC_EDGE_RISING) ? EXTI->RTSR | (1U << 11) : EXTI->RTSR & ~(1U << 11);
+	EXTI->FTSR = (edge & ADC_EDGE_FALLING) ? EXTI->FTSR | (1U << 11) : EXTI->FTSR & ~(1U << 11);
+	EXTI->EMR |= (1U << 11);
+
+	// ADC : une conversion par front, ni conversion continue ni DMA
+	trig.sqr1 = ADC1->SQR1;
+	trig.cr2 = ADC1->CR2;
+	ADC1->CR2 &= ~((1<<1) | (1<<8) | (1<<9));
+	ADC1->SQR1 = trig.sqr1 & ~(0xFU << 20);
+	ADC1->SQR3 = (uint32_t)channel;
+	ADC1->SR = ~(SR_OVR | SR_EOC | SR_STRT);
+
+	// La capture doit précéder la fin de conversion du même front
+	NVIC_SetPriority(TIM2_IRQn, 0);
+	NVIC_SetPriority(ADC_IRQn, 1);
+	NVIC_EnableIRQ(TIM2_IRQn);
+	trig.active = 1;
+	ovr_irq(1);
+	ADC1->CR1 |= (1<<5);                     // EOCIE
+	ADC1->CR2 = (ADC1->CR2 & ~((0xFU << 24) | (3U << 28))) | ((uint32_t)ADC_EXT_EXTI11 << 24) | ((uint32_t)edge << 28);
+}
+
+/**
+  * @brief Arrêter l'acquisition déclenchée et restaurer la configuration
+  */
+void ADC_TriggerStop (void)
+{
+	ADC1->CR2 &= ~(3U << 28);                // EXTEN = 0 : plus de déclenchement
+	ADC1->CR1 &= ~(1<<5);
+	ovr_irq(0);
+	trig.active = 0;
+	NVIC_DisableIRQ(TIM2_IRQn);
+	TIM2->CR1 = 0;
+	EXTI->EMR &= ~(1U << 11);
+	NVIC_SetPriority(ADC_IRQn, 0);
+	ADC1->SQR1 = trig.sqr1;
+	ADC1->CR2 = trig.cr2;
+}
+
+/**
+  * @brief Lire les échantillons déclenchés en attente
+  * @retval Nombre d'échantillons rendus
+  */
+uint32_t ADC_TriggerRead (Trigger_Sample *out, uint32_t max)
+{
+	return Trigger_Read(&trig.t, out, max);
+}
+
+/**
+  * @brief Âge d'un front (pour le ramener sur la base de temps Tick_GetUs())
+  * @param t_edge : Date du front (ticks de TIM2)
+  * @retval µs écoulées depuis le front
+  */
+uint32_t ADC_TriggerAgeUs (uint32_t t_edge)
+{
+	return (TIM2->CNT - t_edge) / (trig.tick_hz / 1000000U);
+}
+
+/**
+  * @brief Construire la ligne des compteurs de l'acquisition déclenchée
+  * @retval Nombre de caractères écrits
+  */
+int ADC_TriggerFormat (char *buf, uint32_t size)
+{
+	Trigger_Stats st = trig.t.stats;
+
+	return Trigger_Format(&st, trig.tick_hz, buf, size);
+}
+
+/**
+  * @brief Capture d'un front de déclenchement (TIM2 CH4)
+  *        Latence d'entrée : date de capture -> première instruction, en cycles CPU.
+  */
+MEM_RAMFUNC void TIM2_IRQHandler (void)
+{
+	uint32_t t0 = DWT_GetCycles();
+	uint32_t now = TIM2->CNT;
+	uint32_t sr = TIM2->SR;
+
+	TRACE(TRACE_ISR_BEGIN, ISR_EDGE);
+	if (sr & (1U << 4)) {
+		uint32_t edge;
+		TIM2->SR = ~(1U << 12);              // CC4OF : au moins un front écrasé avant lecture
+		edge = TIM2->CCR4;                   // La lecture efface CC4IF
+		Trigger_Edge(&trig.t, edge, (sr >> 12) & 1);
+		IsrTime_Add(&IsrTime_Stats[ISR_EDGE].latency, (now - edge) * (SystemCoreClock / trig.tick_hz));
+	}
+	TRACE(TRACE_ISR_END, ISR_EDGE);
+	IsrTime_Add(&IsrTime_Stats[ISR_EDGE].run, DWT_GetCycles() - t0);
+}
+
+/**
+  * @brief Copier les compteurs de pertes
+  */
+void ADC_GetErrors (ADC_Errors *e)
+{
+	*e = errors;
+}
+
+/**
+  * @brief Construire la ligne des compteurs de pertes
+  * @retval Nombre de caractères écrits
+  */
+int ADC_FormatErrors (char *buf, uint32_t size)
+{
+	return snprintf(buf, size, "ADC errors: ovr=%lu dma=%lu ring=%lu restarts=%lu dead=%lu cycles\r\n",
+	                (unsigned long)errors.overruns, (unsigned long)errors.dma_errors,
+	                (unsigned long)errors.ring_overflows, (unsigned long)errors.restarts,
+	                (unsigned long)errors.max_dead_cycles);
+}
+
+/**
+  * @brief Débordement de l'ADC (OVR) et fin de conversion déclenchée (EOC)
+  *        En flux DMA, les requêtes sont bloquées jusqu'à la relance de toute la chaîne ; en
+  *        mode déclenché, la conversion perdue est imputée au front en attente ; sinon le
+  *        débordement est compté et effacé, la relance revenant à la boucle de lecture
+  *        (wait_conv) ou au déclenchement externe suivant. OVRIE n'est actif que pendant une
+  *        acquisition : un ADC au repos ne peut pas entretenir une rafale d'interruptions.
+  */
+MEM_RAMFUNC void ADC_IRQHandler (void)
+{
+	uint32_t t0 = DWT_GetCycles();
+	uint32_t now = TIM2->CNT;
+	uint32_t sr = ADC1->SR;
+
+	TRACE(TRACE_ISR_BEGIN, ISR_ADC);
+	if (sr & SR_OVR)
+		TRACE(TRACE_ADC_OVR, errors.overruns + 1);
+	if (trig.active) {
+		if (sr & SR_OVR) {
+			errors.overruns++;
+			ADC1->SR = ~SR_OVR;              // Le front suivant relance une conversion
+			Trigger_Drop(&trig.t);           // DR contient la conversion suivante
+		}
+		if (sr & SR_EOC)
+			Trigger_Conversion(&trig.t, now, (uint16_t)ADC1->DR);  // La lecture de DR efface EOC
+	} else if (sr & SR_OVR) {
+		errors.overruns++;
+		block_ovr++;
+		if (stream.active)
+			stream_restart();
+		else
+			ADC1->SR = ~SR_OVR;              // Jamais de SWSTART ici : voir wait_conv()
+	}
+	TRACE(TRACE_ISR_END, ISR_ADC);
+	IsrTime_Add(&IsrTime_Stats[ISR_ADC].run, DWT_GetCycles() - t0);
+}
+
+/**
+  * @brief Flux DMA de l'ADC : progression de l'anneau et erreurs
+  *        Latence d'entrée : écart à la date prévue de la conversion qui termine le demi-anneau
+  *        (époque, cadence du flux), à la durée du transfert DMA près. Non mesurée si
+  *        l'entrée couvre plusieurs demi-anneaux.
+  */
+MEM_RAMFUNC void DMA2_Stream0_IRQHandler (void)
+{
+	uint32_t t0 = DWT_GetCycles();
+	uint32_t isr = DMA2->LISR;
+	uint32_t halves = stream.halves;
+
+	TRACE(TRACE_ISR_BEGIN, ISR_ADC_DMA);
+	if (isr & (DMA_TEIF | DMA_DMEIF)) {
+		errors.dma_errors++;
+		stream_restart();
+	} else {
+		if (isr & DMA_HTIF) {
+			DMA2->LIFCR = DMA_HTIF;
+			stream.halves++;
+		}
+		if (isr & DMA_TCIF) {
+			DMA2->LIFCR = DMA_TCIF;
+			stream.halves++;
+		}
+		DMA2->LIFCR = DMA_FEIF;              // Mode direct : FIFO non utilisée
+
+		if (stream.halves == halves + 1) {
+			uint64_t last = (uint64_t)(halves + 1) * (stream.size / 2) - 1;
+			uint32_t due = stream.epoch_t0 + (uint32_t)((last * stream.dt_q8) >> 8);
+			int32_t lat = (int32_t)(t0 - due);
+			IsrTime_Add(&IsrTime_Stats[ISR_ADC_DMA].latency, lat > 0 ? (uint32_t)lat : 0);
+		}
+	}
+	TRACE(TRACE_ISR_END, ISR_ADC_DMA);
+	IsrTime_Add(&IsrTime_Stats[ISR_ADC_DMA].run, DWT_GetCycles() - t0);
+}
@@ -1,11 +1,81 @@
-#ifndef ADC_H
-#define ADC_H
-#include <stdint.h>
-void ADC_Init(void);
-void ADC_Enable(void);
-void ADC_Start(int channel);
-void ADC_WaitForConv(void);
-uint16_t ADC_GetVal(void);
-void ADC_Disable(void);
-
-#endif /* ADC_H */
+#ifndef ADC_H
+#define ADC_H
+#include <stdint.h>
+#include "Trigger.h"
+
+#define ADC_CLK_MAX_HZ 36000000U  // ADCCLK maximal (VDDA >= 2,4 V)
+
+// Résolutions disponibles (champ RES de CR1) : moins de bits = conversion plus courte
+typedef enum {
+	ADC_RES_12 = 0,   // 12 cycles de conversion
+	ADC_RES_10 = 1,   // 10 cycles
+	ADC_RES_8  = 2,   // 8 cycles
+	ADC_RES_6  = 3    // 6 cycles
+} ADC_Resolution;
+
+// Temps d'échantillonnage (champ SMPx) en cycles ADC
+typedef enum {
+	ADC_SMP_3 = 0, ADC_SMP_15, ADC_SMP_28, ADC_SMP_56,
+	ADC_SMP_84, ADC_SMP_112, ADC_SMP_144, ADC_SMP_480
+} ADC_SampleTime;
+
+// Pertes constatées par l'ADC, pour dimensionner cadences et tampons
+typedef struct {
+	uint32_t overruns;          // OVR : conversion écrasée avant d'être lue
+	uint32_t dma_errors;        // Erreurs de transfert ou de mode direct du flux DMA
+	uint32_t ring_overflows;    // Flux DMA : lecteur trop lent, anneau écrasé
+	uint32_t restarts;          // Redémarrages de la chaîne ADC / DMA
+	uint32_t max_dead_cycles;   // Plus long temps mort d'un redémarrage (cycles CPU)
+} ADC_Errors;
+
+// Lecture du flux DMA
+typedef struct {
+	uint32_t t0;                // Date du premier échantillon rendu (cycles DWT)
+	uint32_t lost;              // Pertes depuis la lecture précédente (0 : flux continu)
+} ADC_StreamInfo;
+
+// Front du déclenchement externe (valeur du champ EXTEN de CR2)
+typedef enum {
+	ADC_EDGE_RISING  = 1,
+	ADC_EDGE_FALLING = 2,
+	ADC_EDGE_BOTH    = 3
+} ADC_Edge;
+
+// Source du déclenchement externe (valeur du champ EXTSEL de CR2)
+typedef enum {
+	ADC_EXT_TIM4_CC4 = 9,       // Stimulus du DAC (DAC_WaveStart)
+	ADC_EXT_EXTI11   = 15       // Front externe sur PB11 (ADC_TriggerStart)
+} ADC_ExtTrigger;
+
+uint32_t ADC_ComputePrescaler(uint32_t pclk2);
+uint32_t ADC_ResolutionBits(ADC_Resolution res);
+uint32_t ADC_ConvCycles(ADC_Resolution res, ADC_SampleTime smp);
+void ADC_SetResolution(ADC_Resolution res);
+ADC_Resolution ADC_GetResolution(void);
+void ADC_SetSampleTime(int channel, ADC_SampleTime smp);
+ADC_SampleTime ADC_GetSampleTime(int channel);
+uint32_t ADC_GetFullScale(void);
+uint32_t ADC_GetMaxRate(int channel);
+uint32_t ADC_ReadBlock(int channel, uint16_t *buf, uint32_t count);
+uint32_t ADC_MeasureRate(int channel, uint32_t count);
+uint32_t ADC_ReadTriggered(int channel, ADC_ExtTrigger src, uint16_t *buf, uint32_t count);
+uint32_t ADC_GetClock(void);
+void ADC_StreamStart(int channel, uint16_t *ring, uint32_t size);
+void ADC_StreamStop(void);
+uint32_t ADC_StreamRead(uint16_t *out, uint32_t max, ADC_StreamInfo *info);
+uint32_t ADC_StreamPeriodQ8(void);
+void ADC_TriggerStart(int channel, ADC_Edge edge);
+void ADC_TriggerStop(void);
+uint32_t ADC_TriggerRead(Trigger_Sample *out, uint32_t max);
+uint32_t ADC_TriggerAgeUs(uint32_t t_edge);
+int ADC_TriggerFormat(char *buf, uint32_t size);
+void ADC_GetErrors(ADC_Errors *e);
+int ADC_FormatErrors(char *buf, uint32_t size);
+void ADC_Init(void);
+void ADC_Enable(void);
+void ADC_Start(int channel);
+void ADC_WaitForConv(void);
+uint16_t ADC_GetVal(void);
+void ADC_Disable(void);
+
+#endif /* ADC_H */
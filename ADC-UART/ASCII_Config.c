@@ -1,43 +1,33 @@
-#include "ASCII_Config.h"
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-/**
- * @brief Fonction qui convertit un entier en une chane reprsentant les valeurs ASCII 
- *        de ses chiffres, spars par des espaces.
- *
- * @param input_integer : L'entier  convertir.
- * @return Une chane contenant les valeurs ASCII des chiffres de l'entier.
- *         La mmoire pour cette chane est alloue dynamiquement et doit tre libre
- *         par l'appelant  l'aide de `free()`.
- */
-char* shift_digits(int input_integer) {
-    // Convertir l'entier en une chane
-    char input_str[20]; // Suffisant pour contenir les chiffres d'un entier 64 bits
-    sprintf(input_str, "%d", input_integer);
-
-    // Allouer de la mmoire pour la chane rsultante
-    // Chaque chiffre donne une valeur ASCII (max 3 chiffres) + 1 espace + '\0'
-    char* result_str = malloc(3 * strlen(input_str) + 1); // +1 pour le terminateur '\0'
-
-    if (result_str == NULL) {
-        // Grer l'erreur d'allocation mmoire
-        perror("Erreur d'allocation mmoire");
-        exit(EXIT_FAILURE);
-    }
-
-    // Calculer les valeurs ASCII de chaque chiffre et les concatner avec des espaces
-    int index = 0;
-    for (int i = 0; i < strlen(input_str); i++) {
-        int shifted_digit = input_str[i]; // Obtenir la valeur ASCII du chiffre
-        index += sprintf(result_str + index, "%d ", shifted_digit); // Ajouter  la chane
-    }
-
-    // Supprimer l'espace final et ajouter le terminateur de chane
-    if (index > 0) {
-        result_str[index - 1] = '\0'; // Remplacer le dernier espace par '\0'
-    }
-
-    return result_str; // Retourner la chane rsultat
-}
+#include "ASCII_Config.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Fonction qui convertit un entier en une chaîne représentant les valeurs ASCII 
+ *        de ses chiffres, séparés par des espaces.
+ *
+ * @param input_integer : L'entier à convertir.
+ * @param result_str : Tampon de sortie d'au moins SHIFT_DIGITS_SIZE octets (fourni par
+ *        l'appelant : aucune allocation dynamique).
+ * @return result_str, contenant les valeurs ASCII des chiffres de l'entier.
+ */
+char* shift_digits(int input_integer, char *result_str) {
+    // Convertir l'entier en une chaîne
+    char input_str[12]; // Suffisant pour contenir les chiffres d'un entier 32 bits et le signe
+    int length = sprintf(input_str, "%d", input_integer);
+
+    // Calculer les valeurs ASCII de chaque chiffre et les concaténer avec des espaces
+    // Chaque caractère donne une valeur ASCII (2 chiffres) + 1 espace
+    int index = 0;
+    for (int i = 0; i < length; i++) {
+        int shifted_digit = input_str[i]; // Obtenir la valeur ASCII du chiffre
+        index += sprintf(result_str + index, "%d ", shifted_digit); // Ajouter à la chaîne
+    }
+
+    // Supprimer l'espace final et ajouter le terminateur de chaîne
+    if (index > 0) {
+        result_str[index - 1] = '\0'; // Remplacer le dernier espace par '\0'
+    }
+
+    return result_str; // Retourner la chaîne résultat
+}
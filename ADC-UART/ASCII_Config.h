@@ -1,6 +1,9 @@
-#ifndef ASCII_H
-#define ASCII_H
-
-char* shift_digits(int input_integer);
-
-#endif /* ASCII_H */
+#ifndef ASCII_H
+#define ASCII_H
+
+// Taille du tampon de shift_digits() : 11 caractères au plus ("-2147483648") x 3 + '\0'
+#define SHIFT_DIGITS_SIZE  34
+
+char* shift_digits(int input_integer, char *result_str);
+
+#endif /* ASCII_H */
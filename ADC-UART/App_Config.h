@@ -0,0 +1,206 @@
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+#include "UART_Config.h"
+#include "ADC_Config.h"
+
+/**
+  * @brief Choix des ports série de l'application
+  *        Port de données : USART2 (APB1, 42 MHz) par défaut. USART1 et USART6 sont sur APB2
+  *        (84 MHz) et acceptent jusqu'à 10,5 Mbauds, par exemple :
+  *            #define APP_DATA_UART  huart1
+  *            #define APP_DATA_BAUD  2000000
+  *        Un port console distinct peut fonctionner en parallèle (messages de démarrage).
+  */
+#define APP_DATA_UART     huart2
+#define APP_DATA_BAUD     115200
+
+// #define APP_CONSOLE_UART  huart6
+// #define APP_CONSOLE_BAUD  115200
+
+// Format de sortie du port de données
+#define APP_FORMAT_TEXT       0   // Lignes "ASCII Code: ..., Voltage: ... V"
+#define APP_FORMAT_BINARY     1   // Trames binaires horodatées (voir Frame.h)
+
+#define APP_OUTPUT_FORMAT     APP_FORMAT_TEXT
+
+// Période d'acquisition de la boucle principale
+#define APP_SAMPLE_PERIOD_MS  1000
+
+/**
+  * @brief Mode de conversion
+  *        Résolution ADC_RES_12 / 10 / 8 / 6 : 15, 13, 11 ou 9 cycles ADC par conversion (temps
+  *        d'échantillonnage de 3 cycles). En sortie binaire, les échantillons sont compactés à la
+  *        même résolution (1,5 / 1,25 / 1 / 0,75 octet par échantillon).
+  *        APP_BURST_SAMPLES conversions consécutives sont faites à chaque période et envoyées
+  *        dans une même trame.
+  */
+#define APP_ADC_RESOLUTION    ADC_RES_12
+#define APP_SAMPLE_TIME       ADC_SMP_3     // Temps d'échantillonnage du canal 1
+#define APP_BURST_SAMPLES     1
+
+// 1 : mesurer et envoyer, après la première trame, la cadence obtenue dans chaque résolution
+#define APP_REPORT_ADC_MODES  1
+
+// Période du rapport mémoire (pile, SRAM, CCM) ; 0 : rapport au démarrage seulement
+#define APP_MEM_REPORT_MS     60000
+
+/**
+  * @brief Latence des interruptions d'acquisition
+  *        Les gestionnaires SysTick, ADC et flux DMA s'exécutent en SRAM (option de compilation
+  *        MEM_RAM_ISR, MemPlan.h : 0 pour la mesure de référence en Flash). 1 : la table des
+  *        vecteurs est en outre recopiée en SRAM. Latence et durée de chaque gestionnaire
+  *        (IsrTime.h) sont envoyées avec le rapport mémoire.
+  */
+#define APP_RAM_VECTORS       1
+
+// Étalonnage de chaque rafale (Dsp_OffsetGain) : raw' = (raw + offset) x gain / 16384
+#define APP_CAL_OFFSET        0
+#define APP_CAL_GAIN          16384
+
+/**
+  * @brief Filtrage du canal 1 avant l'envoi et la journalisation (Filter.h)
+  *        Fréquences relatives à la cadence des conversions d'une rafale ; 0 : étage absent.
+  *        Les cellules sont en forme directe I, Q31 (voir Host/filterbench.c pour Q15 / DF2).
+  */
+#define APP_FILTER            0
+#define APP_FILTER_LP_FC      0.1f    // Passe-bas Butterworth du second ordre (fc / fs)
+#define APP_FILTER_NOTCH_F0   0.0f    // Réjecteur (f0 / fs), par exemple 50 Hz à 1 kHz : 0.05f
+#define APP_FILTER_NOTCH_Q    5.0f
+#define APP_FILTER_AVG_TAPS   0       // Moyenne glissante FIR (nombre de points, 32 au plus)
+
+/**
+  * @brief Émission sur variation du canal 1 (Deadband.h)
+  *        L'acquisition garde sa cadence ; une valeur (moyenne de la rafale) n'est émise ou
+  *        journalisée que si elle s'écarte de la dernière émise de plus que la bande, ou après
+  *        APP_DEADBAND_HEARTBEAT_MS de silence. Compteurs envoyés avec le rapport mémoire.
+  */
+#define APP_DEADBAND              0
+#define APP_DEADBAND_MODE         DEADBAND_ABS   // DEADBAND_ABS (LSB) ou DEADBAND_PCT (0,1 %)
+#define APP_DEADBAND_BAND         8
+#define APP_DEADBAND_HEARTBEAT_MS 30000          // 0 : pas de battement de coeur
+
+/**
+  * @brief Mode mesure de fréquence (Freq.h) : remplace le flux d'échantillons
+  *        Le canal 1 est acquis en continu par DMA ; une ligne « Freq: » (fréquence, période,
+  *        gigue de période, rapport cyclique) est envoyée par fenêtre. Pas de journalisation.
+  */
+#define APP_FREQ_MODE         0
+#define APP_FREQ_LEVEL        2048          // Seuil (LSB à la résolution active)
+#define APP_FREQ_HYST         40            // Hystérésis de part et d'autre du seuil (LSB)
+#define APP_FREQ_WINDOW_MS    1000
+#define APP_FREQ_SAMPLE_TIME  ADC_SMP_480   // 42,7 kéch./s en 12 bits (ADCCLK 21 MHz)
+#define APP_FREQ_RING         2048          // Anneau DMA (puissance de 2) : 48 ms à 42,7 kéch./s
+#define APP_FREQ_BLOCK        255           // Échantillons lus de l'anneau par passe
+
+/**
+  * @brief Acquisition déclenchée par un front externe : remplace le flux d'échantillons
+  *        Chaque front sur PB11 lance une conversion du canal 1 (déclenchement externe de
+  *        l'ADC par la ligne EXTI11), en phase avec l'équipement qui fournit le signal. Les
+  *        résultats partent par blocs (horodatage du premier front) ; les fronts manqués
+  *        (conversion en cours, file pleine) sont signalés par un marqueur de perte. Compteurs
+  *        et latence front -> échantillon envoyés périodiquement (APP_MEM_REPORT_MS).
+  */
+#define APP_TRIGGER_MODE      0
+#define APP_TRIGGER_EDGE      ADC_EDGE_RISING
+#define APP_TRIGGER_BLOCK     64            // Échantillons par trame
+#define APP_TRIGGER_FLUSH_MS  100           // Émission d'un bloc incomplet après ce délai
+
+/**
+  * @brief Autotest en boucle DAC -> ADC (Loopback.h) : remplace le flux d'échantillons
+  *        Le DAC1 pilote PA4, reconverti par l'ADC (canal 4) sans câblage extérieur : paliers
+  *        continus (décalage, gain, bruit), rampe code par code (INL, DNL), sinus cadencé par
+  *        TIM4 et converti à mi-palier (SNR, THD, SINAD, ENOB), cadences obtenues. Le DAC sert
+  *        d'étalon : les résultats couvrent toute la chaîne. Lignes « Selftest » à chaque passe.
+  */
+#define APP_SELFTEST_MODE        0
+#define APP_SELFTEST_PERIOD_MS   10000
+#define APP_SELFTEST_CHANNEL     4              // PA4 : sortie du DAC1
+#define APP_SELFTEST_SAMPLE_TIME ADC_SMP_28     // 488 kéch./s en continu en 12 bits
+#define APP_SELFTEST_LO          256            // Excursion du DAC (tampon : 0,2 V à VDDA - 0,2 V)
+#define APP_SELFTEST_HI          3840
+#define APP_SELFTEST_SETTLE_US   10             // Établissement du DAC après un changement de code
+#define APP_SELFTEST_DC_STEPS    16
+#define APP_SELFTEST_DC_SAMPLES  256
+#define APP_SELFTEST_PER_CODE    64             // Échantillons par code de la rampe (0,5 s en tout)
+#define APP_SELFTEST_SINE_RATE   100000         // Mises à jour du DAC et conversions par seconde
+#define APP_SELFTEST_TABLE       256            // Points de la table du sinus
+#define APP_SELFTEST_CYCLES      7              // Périodes dans la table (premier avec sa taille)
+#define APP_SELFTEST_BLOCK       2048           // Échantillons analysés (multiple de la table)
+
+/**
+  * @brief Multiplexage du port de données (Mux.h)
+  *        Flux données (échantillons, relus, pertes), télémétrie (démarrage, rapports) et
+  *        journal (événements). Parts garanties du débit en % (total 100) ; le journal est en
+  *        outre limité en octets/s et abandonné au-delà. Débit et pertes par flux envoyés avec
+  *        le rapport mémoire.
+  */
+#define APP_MUX_SHARE_DATA    70
+#define APP_MUX_SHARE_TEL     20
+#define APP_MUX_SHARE_LOG     10
+#define APP_MUX_LOG_RATE      200     // Octets/s ; 0 : illimité
+#define APP_MUX_LOG_BURST     512     // Rafale tolérée (octets)
+
+/**
+  * @brief Stockage puis réexpédition
+  *        1 : sans hôte, les échantillons sont journalisés en Flash (secteurs 8 à 11) et relus
+  *        au retour de l'hôte, entre les échantillons en direct. L'hôte doit envoyer au moins
+  *        un octet toutes les HOSTLINK_TIMEOUT_MS (3 s) pour être considéré présent.
+  *        0 : émission directe, sans détection de l'hôte.
+  */
+#define APP_STORE_FORWARD     1
+
+/**
+  * @brief Mode fiable du port de données (Arq.h), trames binaires seulement
+  *        1 : chaque trame est gardée jusqu'à son acquittement par l'hôte et réémise si elle
+  *        est signalée manquante ou sans acquittement à temps ; les acquittements arrivent sur
+  *        la ligne RX (réception sous interruption). Côté hôte : adcrx -r (Host/arq_peer.c).
+  *        Sans acquittement pendant 3 s, l'émission continue sans garantie.
+  *        0 : émission sans retour, pertes seulement détectées par l'hôte.
+  */
+#define APP_RELIABLE          0
+
+/**
+  * @brief Négociation du débit du port de données par l'hôte (BaudNeg.h)
+  *        1 : l'hôte propose des débits plus élevés (adcrx -n, Host/baud_peer.c) ; chacun est
+  *        vérifié par un motif de test dans les deux sens avant d'être gardé, sinon retour au
+  *        dernier débit vérifié. Réception sous interruption. Chaque démarrage repart du débit
+  *        configuré (APP_DATA_BAUD ou configuration enregistrée), où la carte revient aussi
+  *        après 5 s sans octet de l'hôte.
+  *        0 : débit fixe.
+  */
+#define APP_BAUDNEG           1
+
+/**
+  * @brief Vidage de la trace d'événements (Trace.h)
+  *        1 : l'hôte demande le contenu de l'anneau (Host/tracedump.c, trame FRAME_TRACE_CMD) ;
+  *        un anneau préservé à travers un reset ou gelé par une faute est envoyé après
+  *        l'enregistrement de démarrage. Trames FRAME_TRACE sur le flux de télémétrie.
+  *        Réception sous interruption.
+  *        0 : trace non vidée ; chaque démarrage repart d'un anneau vide.
+  *        Option de compilation TRACE_ENABLE=0 : aucun événement enregistré (sans coût).
+  */
+#define APP_TRACE             1
+
+/**
+  * @brief Configuration persistante (Settings.h)
+  *        Débit du port de données, période, résolution et temps d'échantillonnage, étalonnage et
+  *        parts du multiplexeur sont lus au démarrage en SRAM sauvegardée, sinon dans le secteur 7
+  *        de la Flash : les valeurs ci-dessus ne servent que par défaut, sans enregistrement
+  *        valide. Origine de la configuration et cause du reset envoyées au démarrage.
+  *        0 : valeurs ci-dessus, sans lecture ni écriture.
+  */
+#define APP_SETTINGS          1
+
+/**
+  * @brief Architecture à tâches FreeRTOS (Pipeline.h)
+  *        Option de compilation : définir APP_RTOS=1 dans les options du projet et ajouter le
+  *        noyau FreeRTOS (portage RVDS/ARM_CM4F, FreeRTOSConfig.h de ce dossier). Sinon, la
+  *        boucle principale de main.c est utilisée.
+  */
+#ifndef APP_RTOS
+#define APP_RTOS              0
+#endif
+#define APP_RTOS_STATS_MS     10000   // Période du rapport de charge et de pile des tâches
+
+#endif /* APP_CONFIG_H */
@@ -0,0 +1,271 @@
+#include "Arq.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MASK        (ARQ_WINDOW - 1)
+#define BACKOFF_MAX 4           // RTO doublé au plus 4 fois par trame
+
+/**
+  * @brief Initialiser l'émetteur (hôte considéré absent jusqu'au premier acquittement)
+  * @param first_seq : Numéro de la prochaine trame émise
+  */
+void Arq_Init (Arq *a, uint16_t first_seq, uint32_t now_ms)
+{
+	memset(a, 0, sizeof(*a));
+	a->base = a->next = a->peer_next = first_seq;
+	a->peer_win = ARQ_WINDOW;
+	a->peer_ms = now_ms;
+	a->rto = ARQ_RTO_INIT_MS;
+}
+
+// Libérer la plus ancienne trame de la fenêtre
+static void drop_base (Arq *a)
+{
+	Arq_Slot *s = &a->slot[a->base & MASK];
+
+	s->len = 0;
+	s->retx = 0;
+	a->base++;
+}
+
+// Hôte muet : abandonner les trames en attente et continuer sans garantie
+static void check_peer (Arq *a, uint32_t now_ms)
+{
+	if (!a->peer_up || now_ms - a->peer_ms < ARQ_PEER_TIMEOUT_MS)
+		return;
+	while (a->base != a->next) {
+		Arq_Slot *s = &a->slot[a->base & MASK];
+		if (s->len && !s->acked) {
+			a->c.abandoned++;
+			a->skip = 1;
+		}
+		drop_base(a);
+	}
+	a->peer_up = 0;
+}
+
+/**
+  * @brief Indiquer si une trame nouvelle peut partir (fenêtre non pleine)
+  */
+int Arq_CanSend (Arq *a, uint32_t now_ms)
+{
+	int full;
+
+	check_peer(a, now_ms);
+	full = a->peer_up && ((uint16_t)(a->next - a->base) >= ARQ_WINDOW ||
+	                      (uint16_t)(a->next - a->peer_next) >= a->peer_win);
+	if (full && !a->stalled)
+		a->c.stalls++;
+	a->stalled = (uint8_t)full;
+	return !full;
+}
+
+/**
+  * @brief Enregistrer une trame nouvelle qui vient de partir (après Arq_CanSend())
+  *        Hôte absent : la trame est gardée sans être réémise, la plus ancienne cède sa place
+  *        quand la fenêtre est pleine (l'hôte qui se présente peut encore demander les
+  *        ARQ_WINDOW dernières).
+  * @param frame : Trame complète (Frame_Encode), numéro de séquence compris
+  */
+void Arq_Sent (Arq *a, const uint8_t *frame, uint32_t length, uint32_t now_ms)
+{
+	uint16_t seq = Frame_GetU16(&frame[4]);
+	Arq_Slot *s = &a->slot[seq & MASK];
+
+	a->next = (uint16_t)(seq + 1);
+	a->c.frames++;
+	while ((uint16_t)(a->next - a->base) > ARQ_WINDOW)
+		drop_base(a);
+	memcpy(s->frame, frame, length);
+	s->len = (uint16_t)length;
+	s->acked = 0;
+	s->retx = 0;
+	s->tries = 1;
+	s->sent_ms = now_ms;
+}
+
+/**
+  * @brief Trame à réémettre en priorité : FRAME_SKIP, trame demandée par l'hôte ou trame
+  *        restée sans acquittement au-delà du RTO (la plus ancienne d'abord)
+  * @param out : Tampon de sortie (FRAME_MAX_SIZE octets)
+  * @retval Taille de la trame copiée dans out, 0 si rien n'est à réémettre
+  */
+uint32_t Arq_Resend (Arq *a, uint32_t now_ms, uint8_t *out)
+{
+	check_peer(a, now_ms);
+	if (a->skip) {
+		a->skip = 0;
+		return Frame_Encode(out, FRAME_SKIP, a->base, &out[FRAME_HDR_SIZE], 0);
+	}
+	if (!a->peer_up)
+		return 0;
+	for (uint16_t seq = a->base; seq != a->next; seq++) {
+		Arq_Slot *s = &a->slot[seq & MASK];
+		uint32_t rto, k = s->tries > 1 ? s->tries - 1u : 0;
+
+		if (!s->len || s->acked)
+			continue;
+		rto = a->rto << (k < BACKOFF_MAX ? k : BACKOFF_MAX);
+		if (rto > ARQ_RTO_MAX_MS)
+			rto = ARQ_RTO_MAX_MS;
+		if (!s->retx && now_ms - s->sent_ms < rto)
+			continue;
+		if (!s->retx)
+			a->c.timeouts++;
+		s->retx = 0;
+		s->tries = (uint8_t)(s->tries < 2 ? 2 : s->tries < 255 ? s->tries + 1 : 255);
+		s->sent_ms = now_ms;
+		a->c.retransmits++;
+		memcpy(out, s->frame, s->len);
+		return s->len;
+	}
+	return 0;
+}
+
+/**
+  * @brief Réémissions demandées par l'hôte et pas encore faites
+  */
+uint32_t Arq_Pending (const Arq *a)
+{
+	uint32_t n = a->skip;
+
+	for (uint16_t seq = a->base; seq != a->next; seq++)
+		n += a->slot[seq & MASK].retx;
+	return n;
+}
+
+// Mesure d'aller-retour (trame émise une seule fois) : estimateur de la RFC 6298
+static void rtt_update (Arq *a, int32_t rtt)
+{
+	int32_t err;
+
+	if (rtt < 1)
+		rtt = 1;
+	if (!a->srtt8) {
+		a->srtt8 = rtt * 8;
+		a->rttvar4 = rtt * 2;
+	} else {
+		err = rtt - a->srtt8 / 8;
+		a->srtt8 += err;
+		a->rttvar4 += (err < 0 ? -err : err) - a->rttvar4 / 4;
+	}
+	a->rto = (uint32_t)(a->srtt8 / 8 + (a->rttvar4 > 1 ? a->rttvar4 : 1));
+	if (a->rto < ARQ_RTO_MIN_MS)
+		a->rto = ARQ_RTO_MIN_MS;
+	if (a->rto > ARQ_RTO_MAX_MS)
+		a->rto = ARQ_RTO_MAX_MS;
+}
+
+// Trame de contrôle valide : hôte présent
+static void peer_alive (Arq *a, uint32_t now_ms)
+{
+	a->peer_ms = now_ms;
+	if (!a->peer_up) {
+		a->peer_up = 1;
+		a->peer_next = a->base;
+		for (uint16_t seq = a->base; seq != a->next; seq++)
+			a->slot[seq & MASK].tries = 0;   // Émise pendant l'absence : pas de mesure
+	}
+}
+
+// Mesure sur la trame la plus ancienne acquittée (acquittements groupés par l'hôte)
+static int32_t rtt_sample (const Arq_Slot *s, int32_t rtt, uint32_t now_ms)
+{
+	int32_t r;
+
+	if (!s->len || s->acked || s->tries != 1)
+		return rtt;             // Réémise : mesure ambiguë (Karn)
+	r = (int32_t)(now_ms - s->sent_ms);
+	return r > rtt ? r : rtt;
+}
+
+static void on_ack (Arq *a, uint16_t next, uint32_t sack, uint8_t win, uint32_t now_ms)
+{
+	uint16_t inflight;
+	int32_t rtt = -1;
+
+	peer_alive(a, now_ms);
+	a->c.acks++;
+	inflight = (uint16_t)(a->next - a->base);
+	if ((uint16_t)(next - a->base) > inflight) {
+		// L'hôte attend des trames abandonnées : lui indiquer où reprendre
+		if ((uint16_t)(a->base - next) < 0x8000)
+			a->skip = 1;
+		return;
+	}
+
+	while (a->base != next) {
+		rtt = rtt_sample(&a->slot[a->base & MASK], rtt, now_ms);
+		drop_base(a);
+	}
+	for (uint32_t i = 0; i < 32 && sack >> i; i++) {
+		uint16_t seq = (uint16_t)(next + 1 + i);
+		Arq_Slot *s = &a->slot[seq & MASK];
+
+		if (!(sack >> i & 1) || (uint16_t)(seq - a->base) >= (uint16_t)(a->next - a->base))
+			continue;
+		if (s->len && !s->acked) {
+			rtt = rtt_sample(s, rtt, now_ms);
+			s->acked = 1;
+			s->retx = 0;
+		}
+	}
+	a->peer_next = next;
+	a->peer_win = win;
+	if (rtt >= 0)
+		rtt_update(a, rtt);
+}
+
+static void on_nak (Arq *a, uint16_t seq, uint32_t now_ms)
+{
+	Arq_Slot *s = &a->slot[seq & MASK];
+	uint32_t recent = a->srtt8 ? (uint32_t)a->srtt8 / 8 : a->rto / 2;
+
+	a->c.naks++;
+	if ((uint16_t)(seq - a->base) >= (uint16_t)(a->next - a->base)) {
+		if ((uint16_t)(a->base - seq) < 0x8000)
+			a->skip = 1;        // Trame déjà abandonnée
+		return;
+	}
+	// Une réémission plus récente que l'aller-retour est peut-être encore en route
+	if (s->len && !s->acked && !(s->tries > 1 && now_ms - s->sent_ms < recent))
+		s->retx = 1;
+}
+
+/**
+  * @brief Traiter un octet reçu de l'hôte (FRAME_ACK, FRAME_NAK)
+  */
+void Arq_Input (Arq *a, uint8_t c, uint32_t now_ms)
+{
+	uint32_t n = Frame_RxByte(&a->rx, c);
+	const uint8_t *p = &a->rx.buf[FRAME_HDR_SIZE];
+	uint8_t type, len;
+
+	if (!n)
+		return;
+	type = FRAME_TYPE(a->rx.buf[2]);
+	len = a->rx.buf[3];
+	if (type == FRAME_ACK && len == FRAME_ACK_SIZE) {
+		on_ack(a, Frame_GetU16(p), Frame_GetU32(p + 2), p[6], now_ms);
+	} else if (type == FRAME_NAK && len % 2 == 0 && len / 2 <= FRAME_NAK_MAX) {
+		peer_alive(a, now_ms);
+		for (uint32_t i = 0; i < len; i += 2)
+			on_nak(a, Frame_GetU16(p + i), now_ms);
+	} else {
+		a->c.bad_rx++;
+	}
+}
+
+/**
+  * @brief Construire la ligne d'état du mode fiable
+  * @retval Nombre de caractères écrits
+  */
+int Arq_Format (const Arq *a, char *buf, uint32_t size)
+{
+	return snprintf(buf, size, "Arq: peer=%s, frames=%lu, retx=%lu (timeout %lu), nak=%lu, ack=%lu, stalls=%lu, abandoned=%lu, rx_err=%lu, rtt=%lu ms, rto=%lu ms\r\n",
+	                a->peer_up ? "up" : "down", (unsigned long)a->c.frames,
+	                (unsigned long)a->c.retransmits, (unsigned long)a->c.timeouts,
+	                (unsigned long)a->c.naks, (unsigned long)a->c.acks, (unsigned long)a->c.stalls,
+	                (unsigned long)a->c.abandoned, (unsigned long)(a->c.bad_rx + a->rx.crc_errors),
+	                (unsigned long)(a->srtt8 / 8), (unsigned long)a->rto);
+}
@@ -0,0 +1,76 @@
+#ifndef ARQ_H
+#define ARQ_H
+
+#include <stdint.h>
+#include "Frame.h"
+
+/**
+  * @brief Émission fiable par retransmission sélective (mode fiable du multiplexeur)
+  *        Chaque trame émise est gardée dans une fenêtre de ARQ_WINDOW trames jusqu'à son
+  *        acquittement par l'hôte (FRAME_ACK : cumul, bitmap des trames reçues au-delà, fenêtre
+  *        de réception). Une trame signalée manquante (FRAME_NAK) est réémise aussitôt ; une
+  *        trame sans acquittement après le délai de retransmission (RTO, estimé sur le temps
+  *        d'aller-retour mesuré, doublé à chaque essai) est réémise. Seules les trames perdues
+  *        reprennent du débit : avec une fenêtre couvrant l'aller-retour, le débit utile reste
+  *        proche de celui de la ligne.
+  *        Contrôle de flux : pas de nouvelle trame quand la fenêtre (ou celle annoncée par
+  *        l'hôte) est pleine ; le multiplexeur garde alors les trames dans ses files.
+  *        Hôte muet pendant ARQ_PEER_TIMEOUT_MS : les trames en attente sont abandonnées et
+  *        signalées par FRAME_SKIP, puis l'émission continue sans garantie jusqu'au prochain
+  *        acquittement ; les ARQ_WINDOW dernières trames restent gardées pour l'hôte qui se
+  *        présente.
+  *        Module sans dépendance matérielle (Host/arqbench.c, pair de référence Host/arq_peer.c).
+  */
+
+#define ARQ_WINDOW           32     // Trames en vol au plus (puissance de 2, 32 au plus)
+#define ARQ_RTO_INIT_MS      250
+#define ARQ_RTO_MIN_MS       10
+#define ARQ_RTO_MAX_MS       2000
+#define ARQ_PEER_TIMEOUT_MS  3000   // Comme HOSTLINK_TIMEOUT_MS
+
+typedef struct {
+	uint32_t sent_ms;              // Dernière émission
+	uint16_t len;                  // 0 : place libre
+	uint8_t  acked;                // Reçue par l'hôte (bitmap), en attente du cumul
+	uint8_t  retx;                 // Retransmission demandée (FRAME_NAK)
+	uint8_t  tries;                // Émissions (0 : émise en l'absence de l'hôte)
+	uint8_t  frame[FRAME_MAX_SIZE];
+} Arq_Slot;
+
+typedef struct {
+	uint32_t frames;               // Trames nouvelles émises
+	uint32_t retransmits;          // Réémissions (demandées ou sur délai)
+	uint32_t timeouts;             // Réémissions sur délai
+	uint32_t naks;                 // Trames demandées par l'hôte
+	uint32_t acks;                 // Acquittements reçus
+	uint32_t stalls;               // Passages à fenêtre pleine
+	uint32_t abandoned;            // Trames non acquittées abandonnées (hôte muet)
+	uint32_t bad_rx;               // Trames de l'hôte rejetées : type ou contenu (CRC : rx.crc_errors)
+} Arq_Counters;
+
+typedef struct {
+	Arq_Slot     slot[ARQ_WINDOW];
+	Frame_Rx     rx;
+	uint16_t     base;             // Plus ancienne trame non acquittée
+	uint16_t     next;             // Numéro de la prochaine trame nouvelle
+	uint16_t     peer_next;        // Dernier cumul de l'hôte
+	uint8_t      peer_win;
+	uint8_t      peer_up;          // Acquittement reçu depuis moins de ARQ_PEER_TIMEOUT_MS
+	uint8_t      skip;             // FRAME_SKIP à émettre
+	uint8_t      stalled;          // Fenêtre pleine au dernier appel de Arq_CanSend()
+	uint32_t     peer_ms;
+	int32_t      srtt8;            // Temps d'aller-retour lissé x 8 (ms), 0 : pas de mesure
+	int32_t      rttvar4;          // Variation x 4
+	uint32_t     rto;              // Délai de retransmission (ms)
+	Arq_Counters c;
+} Arq;
+
+void Arq_Init(Arq *a, uint16_t first_seq, uint32_t now_ms);
+int Arq_CanSend(Arq *a, uint32_t now_ms);
+void Arq_Sent(Arq *a, const uint8_t *frame, uint32_t length, uint32_t now_ms);
+uint32_t Arq_Resend(Arq *a, uint32_t now_ms, uint8_t *out);
+uint32_t Arq_Pending(const Arq *a);
+void Arq_Input(Arq *a, uint8_t c, uint32_t now_ms);
+int Arq_Format(const Arq *a, char *buf, uint32_t size);
+
+#endif /* ARQ_H */
@@ -0,0 +1,212 @@
+#include "BaudNeg.h"
+#include <stdio.h>
+#include <string.h>
+
+enum {
+	BN_IDLE = 0,                   // Au dernier débit vérifié, en attente d'une proposition
+	BN_TEST,                       // Au débit proposé, réception du motif de l'hôte
+	BN_CONFIRM                     // Motif renvoyé, en attente de BAUDNEG_COMMIT
+};
+
+/**
+  * @brief Initialiser la négociation
+  * @param drv : Accès au port
+  * @param base : Débit de démarrage (déjà appliqué)
+  */
+void BaudNeg_Init (BaudNeg *n, const BaudNeg_Driver *drv, uint32_t base, uint32_t now_ms)
+{
+	memset(n, 0, sizeof(*n));
+	n->drv = drv;
+	n->base = base;
+	n->good = base;
+	n->last_rx_ms = now_ms;
+	Frame_RxInit(&n->rx);
+}
+
+// Trame FRAME_BAUD vers l'hôte
+static void send_frame (BaudNeg *n, const uint8_t *p, uint8_t length)
+{
+	uint8_t out[FRAME_HDR_SIZE + BAUDNEG_ACCEPT_SIZE + FRAME_CRC_SIZE];
+
+	n->drv->send(out, Frame_Encode(out, FRAME_BAUD, 0, p, length));
+}
+
+static void send_short (BaudNeg *n, uint8_t op, uint32_t baud)
+{
+	uint8_t p[BAUDNEG_SHORT_SIZE];
+
+	p[0] = op;
+	Frame_PutU32(&p[1], baud);
+	send_frame(n, p, sizeof(p));
+}
+
+// Retour au dernier débit vérifié
+static void fall_back (BaudNeg *n)
+{
+	n->drv->apply(n->good);
+	n->state = BN_IDLE;
+	n->c.fallbacks++;
+	Frame_RxInit(&n->rx);
+}
+
+static void propose (BaudNeg *n, uint32_t baud, uint16_t test_len, uint32_t now_ms)
+{
+	BaudNeg_Rate rate;
+	uint8_t p[BAUDNEG_ACCEPT_SIZE];
+	int ok;
+
+	n->c.proposals++;
+	memset(&rate, 0, sizeof(rate));
+	ok = n->drv->check(baud, &rate) == 0;
+	p[0] = ok ? BAUDNEG_ACCEPT : BAUDNEG_REJECT;
+	Frame_PutU32(&p[1], baud);
+	Frame_PutU32(&p[5], rate.actual);
+	Frame_PutU32(&p[9], (uint32_t)rate.error_ppm);
+	Frame_PutU16(&p[13], rate.brr);
+	p[15] = rate.over8;
+	send_frame(n, p, sizeof(p));
+	if (!ok) {
+		n->c.rejected++;
+		return;
+	}
+
+	// Réponse partie au débit actuel : passer au débit proposé et attendre le motif
+	n->drv->apply(baud);
+	n->line0 = n->drv->line_errors();
+	n->trial = baud;
+	n->test_len = test_len == 0 ? BAUDNEG_TEST_LEN : test_len > BAUDNEG_TEST_MAX ? BAUDNEG_TEST_MAX : test_len;
+	n->mark = 0;
+	n->pos = 0;
+	n->errors = 0;
+	n->state = BN_TEST;
+	n->deadline_ms = now_ms + BAUDNEG_TIMEOUT_MS;
+}
+
+// Motif de l'hôte reçu : compte rendu puis motif de la carte, au débit à l'essai
+static void send_result (BaudNeg *n, uint32_t now_ms)
+{
+	uint8_t p[BAUDNEG_RESULT_SIZE], chunk[64];
+	uint32_t line = n->drv->line_errors() - n->line0, i, k;
+
+	n->c.test_errors += n->errors;
+	p[0] = BAUDNEG_RESULT;
+	Frame_PutU32(&p[1], n->trial);
+	Frame_PutU16(&p[5], n->pos);
+	Frame_PutU16(&p[7], n->errors);
+	Frame_PutU16(&p[9], (uint16_t)(line > 0xFFFF ? 0xFFFF : line));
+	send_frame(n, p, sizeof(p));
+
+	chunk[0] = BAUDNEG_MARK0;
+	chunk[1] = BAUDNEG_MARK1;
+	k = 2;
+	for (i = 0; i < n->test_len; i++) {
+		chunk[k++] = BaudNeg_Pattern(i);
+		if (k == sizeof(chunk) || i + 1 == n->test_len) {
+			n->drv->send(chunk, k);
+			k = 0;
+		}
+	}
+
+	// Délai compté après l'émission du motif (10 bits par octet)
+	n->state = BN_CONFIRM;
+	n->deadline_ms = now_ms + BAUDNEG_TIMEOUT_MS + (uint32_t)((uint64_t)(n->test_len + 32) * 10000 / n->trial);
+	Frame_RxInit(&n->rx);
+}
+
+static void test_byte (BaudNeg *n, uint8_t c, uint32_t now_ms)
+{
+	if (n->mark < 2) {
+		if (c == (n->mark ? BAUDNEG_MARK1 : BAUDNEG_MARK0))
+			n->mark++;
+		else
+			n->mark = (c == BAUDNEG_MARK0);
+		return;
+	}
+	if (c != BaudNeg_Pattern(n->pos))
+		n->errors++;
+	if (++n->pos == n->test_len)
+		send_result(n, now_ms);
+}
+
+static void message (BaudNeg *n, const uint8_t *p, uint32_t length, uint32_t now_ms)
+{
+	uint32_t baud = Frame_GetU32(&p[1]);
+
+	switch (p[0]) {
+	case BAUDNEG_PROPOSE:
+		if (n->state == BN_IDLE && length >= BAUDNEG_PROPOSE_SIZE)
+			propose(n, baud, Frame_GetU16(&p[5]), now_ms);
+		break;
+	case BAUDNEG_COMMIT:
+		if (n->state == BN_CONFIRM && baud == n->trial) {
+			n->good = baud;
+			n->state = BN_IDLE;
+			n->c.verified++;
+			send_short(n, BAUDNEG_DONE, baud);
+		} else if (n->state == BN_IDLE && baud == n->good)
+			send_short(n, BAUDNEG_DONE, baud);   // BAUDNEG_DONE perdu : l'hôte confirme de nouveau
+		break;
+	case BAUDNEG_REVERT:
+		if (n->state == BN_CONFIRM && baud == n->trial)
+			fall_back(n);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+  * @brief Traiter un octet reçu de l'hôte
+  */
+void BaudNeg_Input (BaudNeg *n, uint8_t c, uint32_t now_ms)
+{
+	uint32_t size;
+
+	n->last_rx_ms = now_ms;
+	if (n->state == BN_TEST) {
+		test_byte(n, c, now_ms);   // Le motif ne passe pas par le décodeur de trames
+		return;
+	}
+	size = Frame_RxByte(&n->rx, c);
+	if (size && FRAME_TYPE(n->rx.buf[2]) == FRAME_BAUD && n->rx.buf[3] >= BAUDNEG_SHORT_SIZE)
+		message(n, &n->rx.buf[FRAME_HDR_SIZE], n->rx.buf[3], now_ms);
+}
+
+/**
+  * @brief Échéances : essai sans confirmation, hôte muet
+  */
+void BaudNeg_Poll (BaudNeg *n, uint32_t now_ms)
+{
+	if (n->state != BN_IDLE) {
+		if ((int32_t)(now_ms - n->deadline_ms) >= 0)
+			fall_back(n);
+		return;
+	}
+	if (n->good != n->base && now_ms - n->last_rx_ms >= BAUDNEG_SILENCE_MS) {
+		n->drv->apply(n->base);
+		n->good = n->base;
+		n->c.silences++;
+		Frame_RxInit(&n->rx);
+	}
+}
+
+/**
+  * @brief Débit actuellement appliqué
+  */
+uint32_t BaudNeg_Current (const BaudNeg *n)
+{
+	return n->state == BN_IDLE ? n->good : n->trial;
+}
+
+/**
+  * @brief Construire la ligne d'état de la négociation
+  * @retval Nombre de caractères écrits
+  */
+int BaudNeg_Format (const BaudNeg *n, char *buf, uint32_t size)
+{
+	return snprintf(buf, size, "Baud: rate=%lu (boot %lu), proposals=%lu, rejected=%lu, verified=%lu, fallbacks=%lu, silences=%lu, test_err=%lu\r\n",
+	                (unsigned long)BaudNeg_Current(n), (unsigned long)n->base,
+	                (unsigned long)n->c.proposals, (unsigned long)n->c.rejected,
+	                (unsigned long)n->c.verified, (unsigned long)n->c.fallbacks,
+	                (unsigned long)n->c.silences, (unsigned long)n->c.test_errors);
+}
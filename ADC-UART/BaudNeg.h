@@ -0,0 +1,112 @@
+#ifndef BAUDNEG_H
+#define BAUDNEG_H
+
+#include <stdint.h>
+#include "Frame.h"
+
+/**
+  * @brief Négociation du débit du port de données à l'initiative de l'hôte
+  *        L'hôte propose un débit (BAUDNEG_PROPOSE) au débit en vigueur. La carte calcule BRR
+  *        et OVER8 : débit hors d'atteinte (BAUDNEG_REJECT) ou accepté (BAUDNEG_ACCEPT, débit
+  *        réel et erreur), puis passe au débit proposé. Les deux côtés s'échangent alors un
+  *        motif de test (BAUDNEG_MARK0/1 puis test_len octets de BaudNeg_Pattern()) : la carte
+  *        répond BAUDNEG_RESULT (octets faux, erreurs de ligne) suivi de son propre motif, et
+  *        l'hôte confirme (BAUDNEG_COMMIT -> BAUDNEG_DONE) si aucun sens n'a d'erreur.
+  *        Sans confirmation dans les BAUDNEG_TIMEOUT_MS, ou sur BAUDNEG_REVERT, la carte revient
+  *        au dernier débit vérifié ; l'hôte, sans BAUDNEG_DONE, fait de même et propose le
+  *        candidat suivant. Hôte muet pendant BAUDNEG_SILENCE_MS (battement de coeur, voir
+  *        HostLink.c) : retour au débit de démarrage, où un hôte relancé retrouve la carte.
+  *        Le débit négocié n'est pas enregistré (Settings.h) : chaque démarrage part du débit
+  *        configuré.
+  *        Module sans dépendance matérielle (Host/baudbench.c, négociateur Host/baud_peer.c).
+  *
+  *   Trames FRAME_BAUD (seq non utilisé), données : op (u8) | baud (u32 LE) | suite selon op
+  *     PROPOSE   hôte  : test_len (u16 LE, BAUDNEG_TEST_MAX au plus)
+  *     ACCEPT    carte : actual (u32 LE) | error_ppm (i32 LE) | brr (u16 LE) | over8 (u8)
+  *     REJECT    carte : idem (débit calculé, refusé : erreur ou maximum dépassés)
+  *     RESULT    carte : received (u16 LE) | errors (u16 LE) | line_errors (u16 LE), puis le motif
+  *     COMMIT, REVERT (hôte), DONE (carte) : rien de plus
+  */
+
+#define BAUDNEG_PROPOSE      1
+#define BAUDNEG_ACCEPT       2
+#define BAUDNEG_REJECT       3
+#define BAUDNEG_RESULT       4
+#define BAUDNEG_COMMIT       5
+#define BAUDNEG_REVERT       6
+#define BAUDNEG_DONE         7
+
+#define BAUDNEG_PROPOSE_SIZE 7
+#define BAUDNEG_ACCEPT_SIZE  16
+#define BAUDNEG_RESULT_SIZE  11
+#define BAUDNEG_SHORT_SIZE   5
+
+#define BAUDNEG_MARK0        0xC3   // Début du motif (distinct de FRAME_SYNC0)
+#define BAUDNEG_MARK1        0x3C
+#define BAUDNEG_TEST_LEN     1024   // Motif par défaut (octets)
+#define BAUDNEG_TEST_MAX     4096
+#define BAUDNEG_TIMEOUT_MS   1000   // Attente du motif puis de la confirmation
+#define BAUDNEG_SILENCE_MS   5000   // Au-delà de HOSTLINK_TIMEOUT_MS
+
+// Débit calculé par la carte pour une proposition
+typedef struct {
+	uint32_t actual;               // Débit réel (bauds)
+	int32_t  error_ppm;
+	uint16_t brr;
+	uint8_t  over8;
+} BaudNeg_Rate;
+
+// Accès au port, fournis par l'application (UART_Config.h sur cible)
+typedef struct {
+	int  (*check)(uint32_t baud, BaudNeg_Rate *rate);     // 0 si le débit est atteignable
+	void (*apply)(uint32_t baud);                         // Changer de débit (émission terminée)
+	void (*send)(const uint8_t *data, uint32_t length);   // Émettre, retour une fois sur la ligne
+	uint32_t (*line_errors)(void);                        // Bruit, trame, débordement (cumul)
+} BaudNeg_Driver;
+
+typedef struct {
+	uint32_t proposals;
+	uint32_t rejected;             // Hors d'atteinte
+	uint32_t verified;             // Débits confirmés par l'hôte
+	uint32_t fallbacks;            // Essais sans confirmation : retour au dernier débit vérifié
+	uint32_t silences;             // Retours au débit de démarrage, hôte muet
+	uint32_t test_errors;          // Octets de motif faux ou manquants (tous essais)
+} BaudNeg_Counters;
+
+typedef struct {
+	const BaudNeg_Driver *drv;
+	Frame_Rx  rx;
+	uint8_t   state;
+	uint8_t   mark;                // Octets du marqueur reçus
+	uint16_t  test_len;
+	uint16_t  pos;                 // Octets de motif reçus
+	uint16_t  errors;
+	uint32_t  line0;               // line_errors() au changement de débit
+	uint32_t  base;                // Débit de démarrage
+	uint32_t  good;                // Dernier débit vérifié (débit en vigueur hors essai)
+	uint32_t  trial;               // Débit à l'essai
+	uint32_t  deadline_ms;
+	uint32_t  last_rx_ms;
+	BaudNeg_Counters c;
+} BaudNeg;
+
+void BaudNeg_Init(BaudNeg *n, const BaudNeg_Driver *drv, uint32_t base, uint32_t now_ms);
+void BaudNeg_Input(BaudNeg *n, uint8_t c, uint32_t now_ms);
+void BaudNeg_Poll(BaudNeg *n, uint32_t now_ms);
+uint32_t BaudNeg_Current(const BaudNeg *n);
+int BaudNeg_Format(const BaudNeg *n, char *buf, uint32_t size);
+
+/**
+  * @brief Octet i du motif de test : 55 AA 00 FF puis une suite pseudo-aléatoire
+  */
+static __inline uint8_t BaudNeg_Pattern(uint32_t i)
+{
+	static const uint8_t head[4] = { 0x55, 0xAA, 0x00, 0xFF };
+
+	if (i < 4)
+		return head[i];
+	i *= 2654435761u;
+	return (uint8_t)((i >> 24) ^ (i >> 13));
+}
+
+#endif /* BAUDNEG_H */
@@ -0,0 +1,96 @@
+#include "BootTime.h"
+#include "DWT_Config.h"
+#include <stdio.h>
+
+/**
+  * @brief  Mesure du temps de démarrage
+  *         Chaque étape enregistre le temps écoulé depuis le reset, en µs : le compteur DWT
+  *         est démarré en tête de SystemInit(), le temps passé avant main() (initialisation
+  *         des données, copie du code en SRAM) est donc compté dans BOOT_MAIN.
+  *         La fréquence du coeur change pendant le démarrage (HSI 16 MHz puis PLL) :
+  *         chaque segment est donc converti avec la fréquence relevée au marquage
+  *         précédent, c'est-à-dire celle sur laquelle il a démarré, puis cumulé.
+  *         Le segment BOOT_CLOCK est ainsi compté à 16 MHz : seules les quelques
+  *         instructions qui suivent la bascule SW sur le PLL sont surestimées (< 1 µs).
+  *         La cause du reset (RCC_CSR) est relevée au même moment, puis effacée.
+  */
+
+static uint32_t boot_us[BOOT_STAGE_COUNT];  // Temps cumulé par étape (µs)
+static uint32_t last_cycles;                // Valeur de CYCCNT au dernier marquage
+static uint32_t last_mhz;                   // Fréquence du coeur au dernier marquage (MHz)
+static uint32_t total_us;                   // Temps cumulé depuis le reset
+static const char *reset_cause;
+
+/**
+  * @brief Démarrer la mesure (à appeler en tout premier dans main())
+  *        Sans démarrage dans SystemInit(), le compteur part d'ici et BOOT_MAIN vaut 0.
+  */
+void BootTime_Start (void)
+{
+	uint32_t csr = RCC->CSR;
+
+	// Du plus spécifique au plus général : une mise sous tension lève aussi BOR et PIN
+	if (csr & RCC_CSR_LPWRRSTF)
+		reset_cause = "lpwr";
+	else if (csr & RCC_CSR_WWDGRSTF)
+		reset_cause = "wwdg";
+	else if (csr & RCC_CSR_IWDGRSTF)
+		reset_cause = "iwdg";
+	else if (csr & RCC_CSR_SFTRSTF)
+		reset_cause = "soft";
+	else if (csr & RCC_CSR_PORRSTF)
+		reset_cause = "por";
+	else if (csr & RCC_CSR_BORRSTF)
+		reset_cause = "bor";
+	else
+		reset_cause = "pin";
+	RCC->CSR |= RCC_CSR_RMVF;
+
+	DWT_Init();                             // Sans effet si SystemInit() l'a démarré
+	last_cycles = 0;
+	last_mhz = SystemCoreClock / 1000000U;  // HSI depuis le reset : SystemInit ne touche pas à SW
+	total_us = 0;
+	BootTime_Mark(BOOT_MAIN);
+}
+
+/**
+  * @brief Horodater une étape du démarrage
+  * @param stage : Étape atteinte
+  */
+void BootTime_Mark (BootStage stage)
+{
+	uint32_t now = DWT_GetCycles();
+
+	total_us += (now - last_cycles) / last_mhz;
+	last_cycles = now;
+	last_mhz = SystemCoreClock / 1000000U;  // Fréquence du segment suivant
+	boot_us[stage] = total_us;
+}
+
+/**
+  * @brief Obtenir le temps écoulé entre le reset et une étape
+  * @param stage : Étape
+  * @retval Temps en µs
+  */
+uint32_t BootTime_GetUs (BootStage stage)
+{
+	return boot_us[stage];
+}
+
+/**
+  * @brief Construire l'enregistrement de démarrage envoyé avec la première trame
+  * @param buf : Tampon de sortie
+  * @param size : Taille du tampon
+  * @retval Nombre de caractères écrits
+  */
+int BootTime_Format (char *buf, uint32_t size)
+{
+	return snprintf(buf, size, "Boot: reset=%s, main=%lu us, settings=%lu us, periph=%lu us, clock=%lu us, adc=%lu us, first_sample=%lu us\r\n",
+	                reset_cause,
+	                (unsigned long)boot_us[BOOT_MAIN],
+	                (unsigned long)boot_us[BOOT_SETTINGS],
+	                (unsigned long)boot_us[BOOT_PERIPH],
+	                (unsigned long)boot_us[BOOT_CLOCK],
+	                (unsigned long)boot_us[BOOT_ADC_READY],
+	                (unsigned long)boot_us[BOOT_FIRST_SAMPLE]);
+}
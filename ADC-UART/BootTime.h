@@ -0,0 +1,22 @@
+#ifndef BOOTTIME_H
+#define BOOTTIME_H
+
+#include <stdint.h>
+
+// Étapes du démarrage horodatées entre le reset et le premier échantillon
+typedef enum {
+	BOOT_MAIN = 0,      // Entrée dans main() (SystemInit, initialisation des données)
+	BOOT_SETTINGS,      // Configuration persistante chargée (Settings.h)
+	BOOT_PERIPH,        // Périphériques configurés pendant le démarrage du HSE
+	BOOT_CLOCK,         // PLL verrouillée et sélectionnée
+	BOOT_ADC_READY,     // ADC activé et stabilisé (tSTAB)
+	BOOT_FIRST_SAMPLE,  // Première conversion disponible
+	BOOT_STAGE_COUNT
+} BootStage;
+
+void BootTime_Start(void);
+void BootTime_Mark(BootStage stage);
+uint32_t BootTime_GetUs(BootStage stage);
+int BootTime_Format(char *buf, uint32_t size);
+
+#endif /* BOOTTIME_H */
@@ -0,0 +1,41 @@
+#include "CRC16.h"
+
+/**
+  * @brief  CRC-16/CCITT-FALSE (polynôme 0x1021, valeur initiale 0xFFFF)
+  *         Calcul par quartets : table de 16 entrées, deux itérations par octet.
+  *         L'unité CRC matérielle du STM32F4 ne traite que des mots de 32 bits (CRC-32),
+  *         inadaptée aux trames de longueur quelconque.
+  */
+
+static const uint16_t crc_nibble[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+/**
+  * @brief Poursuivre un calcul de CRC
+  * @param crc : Valeur courante (CRC16_INIT au départ)
+  * @param data : Données
+  * @param length : Nombre d'octets
+  * @retval Nouvelle valeur du CRC
+  */
+uint16_t CRC16_Update (uint16_t crc, const uint8_t *data, uint32_t length)
+{
+	while (length--) {
+		crc = (crc << 4) ^ crc_nibble[(crc >> 12) ^ (*data >> 4)];
+		crc = (crc << 4) ^ crc_nibble[(crc >> 12) ^ (*data & 0x0F)];
+		data++;
+	}
+	return crc;
+}
+
+/**
+  * @brief Calculer le CRC d'un bloc
+  * @param data : Données
+  * @param length : Nombre d'octets
+  * @retval CRC-16
+  */
+uint16_t CRC16_Compute (const uint8_t *data, uint32_t length)
+{
+	return CRC16_Update(CRC16_INIT, data, length);
+}
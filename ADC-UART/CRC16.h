@@ -0,0 +1,11 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+
+#define CRC16_INIT 0xFFFF
+
+uint16_t CRC16_Update(uint16_t crc, const uint8_t *data, uint32_t length);
+uint16_t CRC16_Compute(const uint8_t *data, uint32_t length);
+
+#endif /* CRC16_H */
@@ -0,0 +1,112 @@
+#include "DAC_Config.h"
+#include "SystemClock.h"
+#include "stm32f4xx.h"
+
+/**
+  * @brief Configuration du DAC1 (sortie PA4) pour l'autotest en boucle
+  *        PA4 est déjà en mode analogique (ADC_Init, canal 4) : la sortie du DAC est reconvertie
+  *        par l'ADC sans câblage extérieur. Tampon de sortie actif (excursion utile de 0,2 V à
+  *        VDDA - 0,2 V). Forme d'onde : TIM4 cadence le DAC (TRGO sur mise à jour, DMA1 flux 5
+  *        canal 7 en circulaire) et l'ADC (CC4 à mi-palier, après établissement du DAC).
+  */
+
+// Bits de DAC_CR (voie 1)
+#define CR_EN1     (1U<<0)
+#define CR_TEN1    (1U<<2)
+#define CR_TSEL1   (7U<<3)
+#define CR_DMAEN1  (1U<<12)
+#define TSEL_TIM4  (5U<<3)
+
+/**
+  * @brief Initialiser le DAC1 : mise à jour logicielle, sortie à mi-échelle
+  */
+void DAC_Init (void)
+{
+	RCC->APB1ENR |= (1<<29);             // Horloge DAC
+	DAC->CR &= ~(CR_TEN1 | CR_TSEL1 | CR_DMAEN1);
+	DAC->DHR12R1 = 1U << (DAC_BITS - 1);
+	DAC->CR |= CR_EN1;                   // Tampon de sortie actif (BOFF1 = 0)
+}
+
+/**
+  * @brief Écrire un code (sortie mise à jour un cycle APB1 plus tard, puis établissement)
+  * @param code : Code 12 bits
+  */
+void DAC_Set (uint16_t code)
+{
+	DAC->DHR12R1 = code & ((1U << DAC_BITS) - 1);
+}
+
+/**
+  * @brief Jouer une table en boucle à cadence fixe
+  *        Le DMA recharge le DAC à chaque mise à jour de TIM4 ; CC4 (mode PWM 2, front montant
+  *        à mi-période) sert de déclenchement à l'ADC (ADC_EXT_TIM4_CC4). La table doit rester
+  *        valide jusqu'à DAC_WaveStop() et être en SRAM (accessible au DMA).
+  * @param table : Codes 12 bits
+  * @param size : Nombre de points (1 à 65535)
+  * @param rate_hz : Mises à jour par seconde souhaitées
+  * @retval Cadence obtenue (Hz), arrondie par les diviseurs de TIM4
+  */
+uint32_t DAC_WaveStart (const uint16_t *table, uint32_t size, uint32_t rate_hz)
+{
+	uint32_t timclk = SysClock_GetTree()->tim_apb1;
+	uint32_t ratio = (timclk + rate_hz / 2) / rate_hz;
+	uint32_t psc = (ratio - 1) / 65536;
+	uint32_t arr = ratio / (psc + 1) - 1;
+
+	RCC->APB1ENR |= (1<<2);              // Horloge TIM4
+	RCC->AHB1ENR |= (1<<21);             // Horloge DMA1
+
+	// TIM4 : TRGO sur mise à jour, CC4 à mi-palier
+	TIM4->CR1 = 0;
+	TIM4->PSC = psc;
+	TIM4->ARR = arr;
+	TIM4->CCR4 = (arr + 1) / 2;
+	TIM4->CCMR2 = (TIM4->CCMR2 & ~(0xFFU << 8)) | (7U << 12);   // OC4M = PWM 2
+	TIM4->CCER |= (1U << 12);            // CC4E (broche non affectée au timer)
+	TIM4->CR2 = (TIM4->CR2 & ~(7U << 4)) | (2U << 4);           // MMS = mise à jour
+	TIM4->EGR = 1;
+	TIM4->SR = 0;
+
+	// DMA1 flux 5 canal 7 : table -> DHR12R1, demi-mots, circulaire
+	DMA1_Stream5->CR &= ~(1U<<0);
+	while (DMA1_Stream5->CR & (1U<<0));
+	DMA1->HIFCR = (0x3DU << 6);          // Drapeaux du flux 5
+	DMA1_Stream5->PAR = (uint32_t)&DAC->DHR12R1;
+	DMA1_Stream5->M0AR = (uint32_t)table;
+	DMA1_Stream5->NDTR = size;
+	DMA1_Stream5->FCR = 0;               // Mode direct
+	DMA1_Stream5->CR = (7U << 25) |      // Canal 7
+	                   (1U << 13) |      // MSIZE 16 bits
+	                   (1U << 11) |      // PSIZE 16 bits
+	                   (1U << 10) |      // MINC
+	                   (1U << 8) |       // CIRC
+	                   (1U << 6);        // Mémoire -> périphérique
+	DMA1_Stream5->CR |= (1U<<0);
+
+	// DAC : premier point, puis déclenchement par TIM4 et requête DMA
+	DAC->DHR12R1 = table[0];
+	DAC->CR = (DAC->CR & ~CR_TSEL1) | TSEL_TIM4 | CR_TEN1 | CR_DMAEN1 | CR_EN1;
+
+	TIM4->CR1 = 1;
+	return timclk / ((psc + 1) * (arr + 1));
+}
+
+/**
+  * @brief Arrêter la forme d'onde ; le DAC repasse en mise à jour logicielle
+  */
+void DAC_WaveStop (void)
+{
+	TIM4->CR1 = 0;
+	DAC->CR &= ~(CR_TEN1 | CR_TSEL1 | CR_DMAEN1);
+	DMA1_Stream5->CR &= ~(1U<<0);
+	while (DMA1_Stream5->CR & (1U<<0));
+}
+
+/**
+  * @brief Couper le DAC : PA4 redevient une entrée analogique seule
+  */
+void DAC_Stop (void)
+{
+	DAC->CR &= ~CR_EN1;
+}
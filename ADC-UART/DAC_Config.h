@@ -0,0 +1,14 @@
+#ifndef DAC_H
+#define DAC_H
+
+#include <stdint.h>
+
+#define DAC_BITS 12
+
+void DAC_Init(void);
+void DAC_Set(uint16_t code);
+uint32_t DAC_WaveStart(const uint16_t *table, uint32_t size, uint32_t rate_hz);
+void DAC_WaveStop(void);
+void DAC_Stop(void);
+
+#endif /* DAC_H */
@@ -0,0 +1,32 @@
+#include "DWT_Config.h"
+
+/**
+  * @brief Initialisation du compteur de cycles DWT
+  *        Le compteur CYCCNT fonctionne à la fréquence du coeur (HCLK) et ne dépend
+  *        d'aucun périphérique : il est utilisable dès l'entrée dans main(), avant
+  *        même la configuration de l'horloge.
+  *        Sans effet si le compteur tourne déjà : CYCCNT n'est remis à zéro qu'au premier
+  *        démarrage, jamais sous les mesures en cours (BootTime, trace, statistiques FreeRTOS).
+  */
+void DWT_Init (void)
+{
+	if (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)
+		return;                                      // Déjà démarré (SystemInit) : ne pas remettre à zéro
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Activer le bloc de trace
+	DWT->CYCCNT = 0;                                 // Remise à zéro du compteur
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;             // Démarrer le comptage
+}
+
+/**
+  * @brief Délai calibré en microsecondes basé sur CYCCNT
+  *        Contrairement à une boucle vide, la durée est indépendante de l'optimisation
+  *        du compilateur et suit la fréquence réelle donnée par SystemCoreClock.
+  * @param us : Nombre de microsecondes à attendre
+  */
+void DWT_Delay_us (uint32_t us)
+{
+	uint32_t start  = DWT->CYCCNT;
+	uint32_t cycles = us * (SystemCoreClock / 1000000U);
+
+	while ((DWT->CYCCNT - start) < cycles); // Soustraction non signée : robuste au débordement
+}
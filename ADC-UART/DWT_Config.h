@@ -0,0 +1,18 @@
+#ifndef DWT_H
+#define DWT_H
+
+#include "stm32f4xx.h"
+
+void DWT_Init(void);
+void DWT_Delay_us(uint32_t us);
+
+/**
+  * @brief Lecture du compteur de cycles (CYCCNT)
+  * @retval Nombre de cycles CPU écoulés depuis le démarrage du compteur (SystemInit)
+  */
+static __inline uint32_t DWT_GetCycles(void)
+{
+	return DWT->CYCCNT;
+}
+
+#endif /* DWT_H */
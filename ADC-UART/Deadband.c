@@ -0,0 +1,86 @@
+#include "Deadband.h"
+#include <stdio.h>
+#include <string.h>
+
+static Deadband_Chan chans[DEADBAND_CHANNELS];
+
+/**
+  * @brief État de la bande morte d'un canal
+  * @param channel : Canal ADC (0 à 3)
+  * @retval Pointeur vers l'état, NULL si le canal n'existe pas
+  */
+Deadband_Chan *Deadband_Channel (uint8_t channel)
+{
+	return channel < DEADBAND_CHANNELS ? &chans[channel] : 0;
+}
+
+/**
+  * @brief Activer la bande morte d'un canal (les compteurs sont remis à zéro)
+  * @param d : Canal
+  * @param mode : DEADBAND_ABS ou DEADBAND_PCT
+  * @param band : Largeur (LSB, ou dixièmes de %)
+  * @param heartbeat_ms : Silence maximal (0 : aucun)
+  */
+void Deadband_Config (Deadband_Chan *d, uint8_t mode, uint16_t band, uint32_t heartbeat_ms)
+{
+	memset(d, 0, sizeof(*d));
+	d->enabled = 1;
+	d->mode = mode;
+	d->band = band;
+	d->heartbeat_ms = heartbeat_ms;
+}
+
+/**
+  * @brief Décider de l'émission d'une valeur
+  *        La référence n'est mise à jour que lors d'une émission : une dérive lente finit par
+  *        sortir de la bande au lieu d'être suivie pas à pas.
+  * @param d : Canal
+  * @param value : Valeur acquise
+  * @param now_ms : Heure courante
+  * @retval DEADBAND_SUPPRESS, ou le motif de l'émission (DEADBAND_DELTA, _HEARTBEAT, _FIRST)
+  */
+int Deadband_Check (Deadband_Chan *d, uint16_t value, uint32_t now_ms)
+{
+	uint32_t delta, band;
+	int reason;
+
+	if (!d->enabled)
+		reason = DEADBAND_DELTA;
+	else if (!d->has_last)
+		reason = DEADBAND_FIRST;
+	else {
+		delta = value > d->last ? value - d->last : d->last - value;
+		band = d->mode == DEADBAND_PCT ? (uint32_t)d->last * d->band / 1000 : d->band;
+		if (delta > band)
+			reason = DEADBAND_DELTA;
+		else if (d->heartbeat_ms && now_ms - d->last_ms >= d->heartbeat_ms)
+			reason = DEADBAND_HEARTBEAT;
+		else {
+			d->suppressed++;
+			return DEADBAND_SUPPRESS;
+		}
+	}
+
+	d->has_last = 1;
+	d->last = value;
+	d->last_ms = now_ms;
+	d->sent++;
+	return reason;
+}
+
+/**
+  * @brief Construire la ligne des compteurs d'un canal
+  * @retval Nombre de caractères écrits
+  */
+int Deadband_Format (uint8_t channel, char *buf, uint32_t size)
+{
+	const Deadband_Chan *d = Deadband_Channel(channel);
+	uint32_t total;
+
+	if (!d)
+		return 0;
+	total = d->sent + d->suppressed;
+	return snprintf(buf, size, "Deadband: ch%u sent=%lu suppressed=%lu (%lu%%)\r\n", channel,
+	                (unsigned long)d->sent, (unsigned long)d->suppressed,
+	                (unsigned long)(total ? (uint64_t)d->suppressed * 100 / total : 0));
+}
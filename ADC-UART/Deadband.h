@@ -0,0 +1,43 @@
+#ifndef DEADBAND_H
+#define DEADBAND_H
+
+#include <stdint.h>
+
+/**
+  * @brief Émission sur variation (send-on-delta) par canal
+  *        Une valeur n'est émise que si elle s'écarte de la dernière valeur émise de plus que
+  *        la bande morte, ou si rien n'a été émis depuis l'intervalle de battement de coeur.
+  *        Bande absolue (LSB) ou relative (dixièmes de % de la dernière valeur émise).
+  *        Module sans dépendance matérielle : l'appelant fournit l'heure en ms.
+  */
+
+#define DEADBAND_CHANNELS    4     // Canaux ADC 0 à 3
+
+// Nature de la bande morte
+#define DEADBAND_ABS         0     // LSB
+#define DEADBAND_PCT         1     // Dixièmes de % de la dernière valeur émise
+
+// Décision de Deadband_Check
+#define DEADBAND_SUPPRESS    0
+#define DEADBAND_DELTA       1     // Variation au-delà de la bande
+#define DEADBAND_HEARTBEAT   2     // Silence maximal atteint
+#define DEADBAND_FIRST       3     // Première valeur
+
+typedef struct {
+	uint8_t  enabled;
+	uint8_t  mode;
+	uint16_t band;
+	uint32_t heartbeat_ms;   // 0 : pas de battement de coeur
+	uint8_t  has_last;
+	uint16_t last;           // Dernière valeur émise
+	uint32_t last_ms;
+	uint32_t sent;
+	uint32_t suppressed;
+} Deadband_Chan;
+
+Deadband_Chan *Deadband_Channel(uint8_t channel);
+void Deadband_Config(Deadband_Chan *d, uint8_t mode, uint16_t band, uint32_t heartbeat_ms);
+int Deadband_Check(Deadband_Chan *d, uint16_t value, uint32_t now_ms);
+int Deadband_Format(uint8_t channel, char *buf, uint32_t size);
+
+#endif /* DEADBAND_H */
@@ -0,0 +1,287 @@
+#include "Dsp.h"
+#include <string.h>
+
+/**
+  * @brief  Noyaux SIMD 16 bits et versions de référence
+  *         Dsp_OffsetGain : out = sat((sat16(in + offset) * gain) >> 14, 0, 2^bits - 1),
+  *                          gain en Q14 (16384 = 1,0 ; de -2,0 à 2,0).
+  *         Les boucles SIMD lisent deux échantillons par accès 32 bits : un premier échantillon
+  *         isolé aligne le pointeur ; si deux tampons n'ont pas le même alignement, la version
+  *         de référence est utilisée.
+  */
+
+#if defined(__TARGET_FEATURE_DSPMUL) || defined(__ARM_FEATURE_DSP)
+
+#include "stm32f4xx.h"
+
+#define QADD16(a, b)      __QADD16(a, b)
+#define SMUAD(a, b)       __SMUAD(a, b)
+#define SMLAD(a, b, c)    __SMLAD(a, b, c)
+#define SMLALD(a, b, c)   __SMLALD(a, b, c)
+#define SSAT(a, n)        __SSAT(a, n)
+#define USAT16(a, n)      __USAT16(a, n)
+#define PKHBT(a, b, s)    __PKHBT(a, b, s)
+#define USUB16(a, b)      __USUB16(a, b)
+#define UADD16(a, b)      __UADD16(a, b)
+#define UQSUB16(a, b)     __UQSUB16(a, b)
+
+#define READ2(p)          (*(const uint32_t *)(p))
+#define WRITE2(p, v)      (*(uint32_t *)(p) = (v))
+
+#else
+
+// Émulation portable des instructions (mêmes résultats que le Cortex-M4)
+static int32_t sat_s (int32_t v, uint32_t n)
+{
+	int32_t hi = (1 << (n - 1)) - 1;
+	return v > hi ? hi : v < -hi - 1 ? -hi - 1 : v;
+}
+
+static uint32_t lane (uint32_t x, int hi)
+{
+	return hi ? x >> 16 : x & 0xFFFF;
+}
+
+static uint32_t QADD16 (uint32_t a, uint32_t b)
+{
+	uint32_t lo = (uint16_t)sat_s((int16_t)lane(a, 0) + (int16_t)lane(b, 0), 16);
+	uint32_t hi = (uint16_t)sat_s((int16_t)lane(a, 1) + (int16_t)lane(b, 1), 16);
+	return lo | hi << 16;
+}
+
+static uint32_t SMUAD (uint32_t a, uint32_t b)
+{
+	return (uint32_t)((int16_t)lane(a, 0) * (int16_t)lane(b, 0) + (int16_t)lane(a, 1) * (int16_t)lane(b, 1));
+}
+
+static uint32_t SMLAD (uint32_t a, uint32_t b, uint32_t acc)
+{
+	return SMUAD(a, b) + acc;
+}
+
+static uint64_t SMLALD (uint32_t a, uint32_t b, uint64_t acc)
+{
+	return acc + (uint64_t)((int64_t)(int16_t)lane(a, 0) * (int16_t)lane(b, 0)
+	                      + (int64_t)(int16_t)lane(a, 1) * (int16_t)lane(b, 1));
+}
+
+#define SSAT(a, n)  sat_s(a, n)
+
+static uint32_t USAT16 (uint32_t a, uint32_t n)
+{
+	int32_t top = (1 << n) - 1;
+	int32_t lo = (int16_t)lane(a, 0), hi = (int16_t)lane(a, 1);
+	lo = lo < 0 ? 0 : lo > top ? top : lo;
+	hi = hi < 0 ? 0 : hi > top ? top : hi;
+	return (uint32_t)lo | (uint32_t)hi << 16;
+}
+
+static uint32_t PKHBT (uint32_t a, uint32_t b, uint32_t s)
+{
+	return (a & 0xFFFF) | (b << s & 0xFFFF0000);
+}
+
+static uint32_t USUB16 (uint32_t a, uint32_t b)
+{
+	return ((lane(a, 0) - lane(b, 0)) & 0xFFFF) | (lane(a, 1) - lane(b, 1)) << 16;
+}
+
+static uint32_t UADD16 (uint32_t a, uint32_t b)
+{
+	return ((lane(a, 0) + lane(b, 0)) & 0xFFFF) | (lane(a, 1) + lane(b, 1)) << 16;
+}
+
+static uint32_t UQSUB16 (uint32_t a, uint32_t b)
+{
+	uint32_t lo = lane(a, 0) > lane(b, 0) ? lane(a, 0) - lane(b, 0) : 0;
+	uint32_t hi = lane(a, 1) > lane(b, 1) ? lane(a, 1) - lane(b, 1) : 0;
+	return lo | hi << 16;
+}
+
+static uint32_t READ2 (const uint16_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static void WRITE2 (uint16_t *p, uint32_t v)
+{
+	memcpy(p, &v, 4);
+}
+
+#endif
+
+#define MISALIGNED(p)  (((uintptr_t)(p) & 2) != 0)
+
+// Boucle d'ajustement ; bits doit être une constante pour USAT16
+#define OFFSET_GAIN_LOOP(BITS)                                                       \
+	for (; i + 2 <= count; i += 2) {                                                 \
+		uint32_t v = QADD16(READ2(&in[i]), off2);                                    \
+		int32_t lo = SSAT((int32_t)SMUAD(v, g_lo) >> 14, 16);                        \
+		int32_t hi = SSAT((int32_t)SMUAD(v, g_hi) >> 14, 16);                        \
+		WRITE2(&out[i], USAT16(PKHBT((uint32_t)lo, (uint32_t)hi, 16), BITS));        \
+	}
+
+/**
+  * @brief Ajuster un bloc : décalage puis gain, saturé dans la plage de l'ADC
+  * @param in : Échantillons
+  * @param out : Sortie (peut être égal à in)
+  * @param count : Nombre d'échantillons
+  * @param offset : Décalage ajouté (LSB)
+  * @param gain : Gain Q14
+  * @param bits : Résolution de sortie (6, 8, 10 ou 12)
+  */
+void Dsp_OffsetGain (const uint16_t *in, uint16_t *out, uint32_t count, int16_t offset, int16_t gain, uint32_t bits)
+{
+	const uint32_t off2 = (uint16_t)offset | (uint32_t)(uint16_t)offset << 16;
+	const uint32_t g_lo = (uint16_t)gain;
+	const uint32_t g_hi = (uint32_t)(uint16_t)gain << 16;
+	uint32_t i = 0;
+
+	if (MISALIGNED(in) != MISALIGNED(out)) {
+		Dsp_OffsetGain_Ref(in, out, count, offset, gain, bits);
+		return;
+	}
+	if (MISALIGNED(in) && count) {
+		Dsp_OffsetGain_Ref(in, out, 1, offset, gain, bits);
+		i = 1;
+	}
+
+	switch (bits) {
+	case 6:  OFFSET_GAIN_LOOP(6);  break;
+	case 8:  OFFSET_GAIN_LOOP(8);  break;
+	case 10: OFFSET_GAIN_LOOP(10); break;
+	default: OFFSET_GAIN_LOOP(12); break;
+	}
+
+	if (i < count)
+		Dsp_OffsetGain_Ref(&in[i], &out[i], count - i, offset, gain, bits);
+}
+
+/**
+  * @brief Somme d'un bloc (SMLAD par paire d'échantillons)
+  */
+uint32_t Dsp_Sum (const uint16_t *x, uint32_t count)
+{
+	uint32_t acc = 0, i = 0;
+
+	if (MISALIGNED(x) && count)
+		acc = x[i++];
+	for (; i + 2 <= count; i += 2)
+		acc = SMLAD(READ2(&x[i]), 0x00010001, acc);
+	if (i < count)
+		acc += x[i];
+	return acc;
+}
+
+/**
+  * @brief Moyenne d'un bloc, arrondie au plus proche
+  */
+uint16_t Dsp_Mean (const uint16_t *x, uint32_t count)
+{
+	return count ? (uint16_t)((Dsp_Sum(x, count) + count / 2) / count) : 0;
+}
+
+/**
+  * @brief Produit scalaire échantillons x coefficients (SMLALD, accumulation 64 bits)
+  */
+int64_t Dsp_Dot (const uint16_t *x, const int16_t *w, uint32_t count)
+{
+	uint64_t acc = 0;
+	uint32_t i = 0;
+
+	if (MISALIGNED(x) != MISALIGNED(w))
+		return Dsp_Dot_Ref(x, w, count);
+	if (MISALIGNED(x) && count) {
+		acc = (uint64_t)((int64_t)x[0] * w[0]);
+		i = 1;
+	}
+	for (; i + 2 <= count; i += 2)
+		acc = SMLALD(READ2(&x[i]), READ2((const uint16_t *)&w[i]), acc);
+	if (i < count)
+		acc += (uint64_t)((int64_t)x[i] * w[i]);
+	return (int64_t)acc;
+}
+
+/**
+  * @brief Minimum et maximum d'un bloc, deux voies à la fois sans branchement :
+  *        d = UQSUB16(v, m) = max(v - m, 0) ; min = v - d ; max = m + d
+  */
+void Dsp_MinMax (const uint16_t *x, uint32_t count, uint16_t *min, uint16_t *max)
+{
+	uint32_t mn = 0xFFFFFFFF, mx = 0, i = 0;
+	uint16_t lo, hi;
+
+	if (MISALIGNED(x) && count) {
+		mn = x[0] | 0xFFFF0000;
+		mx = x[0];
+		i = 1;
+	}
+	for (; i + 2 <= count; i += 2) {
+		uint32_t v = READ2(&x[i]);
+		mn = USUB16(v, UQSUB16(v, mn));
+		mx = UADD16(mx, UQSUB16(v, mx));
+	}
+	if (i < count) {
+		mn = (x[i] < (mn & 0xFFFF)) ? (mn & 0xFFFF0000) | x[i] : mn;
+		mx = (x[i] > (mx & 0xFFFF)) ? (mx & 0xFFFF0000) | x[i] : mx;
+	}
+
+	lo = (uint16_t)mn; hi = (uint16_t)(mn >> 16);
+	*min = lo < hi ? lo : hi;
+	lo = (uint16_t)mx; hi = (uint16_t)(mx >> 16);
+	*max = lo > hi ? lo : hi;
+}
+
+/**
+  * @brief Versions de référence scalaires
+  */
+void Dsp_OffsetGain_Ref (const uint16_t *in, uint16_t *out, uint32_t count, int16_t offset, int16_t gain, uint32_t bits)
+{
+	const int32_t top = (1 << bits) - 1;
+
+	for (uint32_t i = 0; i < count; i++) {
+		int32_t v = (int16_t)in[i] + offset;
+		v = v > 32767 ? 32767 : v < -32768 ? -32768 : v;
+		v = (v * gain) >> 14;
+		out[i] = (uint16_t)(v < 0 ? 0 : v > top ? top : v);
+	}
+}
+
+uint32_t Dsp_Sum_Ref (const uint16_t *x, uint32_t count)
+{
+	uint32_t acc = 0;
+
+	for (uint32_t i = 0; i < count; i++)
+		acc += x[i];
+	return acc;
+}
+
+uint16_t Dsp_Mean_Ref (const uint16_t *x, uint32_t count)
+{
+	return count ? (uint16_t)((Dsp_Sum_Ref(x, count) + count / 2) / count) : 0;
+}
+
+int64_t Dsp_Dot_Ref (const uint16_t *x, const int16_t *w, uint32_t count)
+{
+	int64_t acc = 0;
+
+	for (uint32_t i = 0; i < count; i++)
+		acc += (int64_t)x[i] * w[i];
+	return acc;
+}
+
+void Dsp_MinMax_Ref (const uint16_t *x, uint32_t count, uint16_t *min, uint16_t *max)
+{
+	uint16_t mn = 0xFFFF, mx = 0;
+
+	for (uint32_t i = 0; i < count; i++) {
+		if (x[i] < mn)
+			mn = x[i];
+		if (x[i] > mx)
+			mx = x[i];
+	}
+	*min = mn;
+	*max = mx;
+}
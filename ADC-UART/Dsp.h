@@ -0,0 +1,28 @@
+#ifndef DSP_H
+#define DSP_H
+
+#include <stdint.h>
+
+/**
+  * @brief Noyaux de calcul sur blocs d'échantillons uint16_t
+  *        Sur Cortex-M4, les échantillons sont traités deux par deux avec les instructions SIMD
+  *        16 bits (QADD16, SMUAD, SMLAD, SMLALD, UQSUB16, USAT16). Sur un autre processeur
+  *        (outils PC), les mêmes boucles s'exécutent avec une émulation portable des instructions.
+  *        Chaque noyau a une version de référence scalaire (_Ref) au résultat identique bit à bit.
+  *        Les échantillons doivent rester inférieurs à 32768 (ADC sur 12 bits au plus) : les
+  *        instructions de multiplication les traitent comme des entiers signés.
+  */
+
+void Dsp_OffsetGain(const uint16_t *in, uint16_t *out, uint32_t count, int16_t offset, int16_t gain, uint32_t bits);
+uint32_t Dsp_Sum(const uint16_t *x, uint32_t count);
+uint16_t Dsp_Mean(const uint16_t *x, uint32_t count);
+int64_t Dsp_Dot(const uint16_t *x, const int16_t *w, uint32_t count);
+void Dsp_MinMax(const uint16_t *x, uint32_t count, uint16_t *min, uint16_t *max);
+
+void Dsp_OffsetGain_Ref(const uint16_t *in, uint16_t *out, uint32_t count, int16_t offset, int16_t gain, uint32_t bits);
+uint32_t Dsp_Sum_Ref(const uint16_t *x, uint32_t count);
+uint16_t Dsp_Mean_Ref(const uint16_t *x, uint32_t count);
+int64_t Dsp_Dot_Ref(const uint16_t *x, const int16_t *w, uint32_t count);
+void Dsp_MinMax_Ref(const uint16_t *x, uint32_t count, uint16_t *min, uint16_t *max);
+
+#endif /* DSP_H */
@@ -0,0 +1,296 @@
+#include "Filter.h"
+#include "MemPlan.h"
+#include <math.h>
+#include <string.h>
+
+/**
+  * @brief  Moteur de filtrage IIR / FIR en virgule fixe
+  *         Un bloc est traité par passes de FILTER_CHUNK échantillons : conversion en Q15/Q31
+  *         dans un tampon de travail, puis chaque cellule parcourt toute la passe avec son état
+  *         dans des variables locales (registres), puis le FIR, puis la conversion de sortie.
+  *         Les accumulateurs sont sur 64 bits (SMLAL sur Cortex-M4) ; les résultats sont arrondis
+  *         et saturés.
+  */
+
+static MEM_CCM Filter_Chan chans[FILTER_CHANNELS];
+
+MEM_STATIC_ASSERT(sizeof(chans) <= MEM_CCM_FILTER, filter_budget);
+
+// Saturer une valeur 64 bits dans [lo, hi]
+static __inline int32_t sat (int64_t v, int32_t lo, int32_t hi)
+{
+	return v < lo ? lo : v > hi ? hi : (int32_t)v;
+}
+
+// Cellule en forme directe I ; rs = bits fractionnaires - décalage des coefficients
+static void biquad_df1 (Filter_Biquad *b, int32_t *w, uint32_t n, uint32_t rs, int32_t lo, int32_t hi)
+{
+	const int32_t b0 = b->c[0], b1 = b->c[1], b2 = b->c[2], a1 = b->c[3], a2 = b->c[4];
+	const int64_t round = (int64_t)1 << (rs - 1);
+	int32_t x1 = b->s[0], x2 = b->s[1], y1 = b->s[2], y2 = b->s[3];
+
+	for (uint32_t i = 0; i < n; i++) {
+		int32_t x = w[i];
+		int64_t acc = round + (int64_t)b0 * x + (int64_t)b1 * x1 + (int64_t)b2 * x2
+		                    - (int64_t)a1 * y1 - (int64_t)a2 * y2;
+		int32_t y = sat(acc >> rs, lo, hi);
+		x2 = x1; x1 = x;
+		y2 = y1; y1 = y;
+		w[i] = y;
+	}
+
+	b->s[0] = x1; b->s[1] = x2; b->s[2] = y1; b->s[3] = y2;
+}
+
+// Cellule en forme directe II ; l'état interne w est gardé divisé par 2^guard
+static void biquad_df2 (Filter_Biquad *b, int32_t *w, uint32_t n, uint32_t rs, int32_t lo, int32_t hi)
+{
+	const int32_t b0 = b->c[0], b1 = b->c[1], b2 = b->c[2], a1 = b->c[3], a2 = b->c[4];
+	const uint32_t guard = b->guard;
+	const int64_t round = (int64_t)1 << (rs - 1);
+	const int64_t round_y = (int64_t)1 << (rs - guard - 1);
+	int32_t w1 = b->s[0], w2 = b->s[1];
+
+	for (uint32_t i = 0; i < n; i++) {
+		int64_t acc = round + (((int64_t)w[i] << rs) >> guard) - (int64_t)a1 * w1 - (int64_t)a2 * w2;
+		int32_t w0 = sat(acc >> rs, INT32_MIN, INT32_MAX);
+		acc = round_y + (int64_t)b0 * w0 + (int64_t)b1 * w1 + (int64_t)b2 * w2;
+		w2 = w1; w1 = w0;
+		w[i] = sat(acc >> (rs - guard), lo, hi);
+	}
+
+	b->s[0] = w1; b->s[1] = w2;
+}
+
+// FIR Q15 ; in_shift ramène le tampon de travail en Q15 (15 pour le format Q31)
+static void fir_q15 (Filter_Chan *f, int32_t *w, uint32_t n, uint32_t in_shift)
+{
+	const uint32_t taps = f->taps;
+	const uint32_t rs = 15 - f->fir_shift;
+	const int64_t round = (int64_t)1 << (rs - 1);
+	uint32_t pos = f->fir_pos;
+
+	for (uint32_t i = 0; i < n; i++) {
+		int16_t x = (int16_t)sat(w[i] >> in_shift, INT16_MIN, INT16_MAX);
+		const int16_t *d;
+		int64_t acc = round;
+
+		pos = (pos == 0 ? taps : pos) - 1;
+		f->fir_dl[pos] = f->fir_dl[pos + taps] = x;
+		d = &f->fir_dl[pos];
+		for (uint32_t k = 0; k < taps; k++)
+			acc += (int32_t)f->fir_c[k] * d[k];
+		w[i] = sat(acc >> rs, INT16_MIN, INT16_MAX) << in_shift;
+	}
+
+	f->fir_pos = (uint8_t)pos;
+}
+
+// Plus petit décalage tel que max|c| / 2^shift tienne dans le format (frac bits fractionnaires)
+static uint32_t pick_shift (const float *c, uint32_t n, uint32_t frac)
+{
+	double m = 0;
+	uint32_t shift = 0;
+
+	for (uint32_t i = 0; i < n; i++)
+		if (fabs(c[i]) > m)
+			m = fabs(c[i]);
+	while (shift < frac - 1 && m >= ldexp(1.0, (int)shift) * (1.0 - ldexp(1.0, -(int)frac)))
+		shift++;
+	return shift;
+}
+
+static int32_t quantize (float c, uint32_t frac, uint32_t shift)
+{
+	return (int32_t)floor(ldexp(c, (int)(frac - shift)) + 0.5);
+}
+
+// Marge de l'état DF2 : somme des |h| de la réponse impulsionnelle de 1 / A(z), comparée à la
+// dynamique libre au-dessus de l'entrée (16 bits en Q15, 1 bit en Q31)
+static uint32_t df2_guard (const float *c, uint32_t frac, uint32_t rs)
+{
+	double w1 = 0, w2 = 0, x = 1, l1 = 0;
+	uint32_t bits = 0;
+
+	for (int i = 0; i < 4096; i++) {
+		double w0 = x - c[3] * w1 - c[4] * w2;
+		l1 += fabs(w0);
+		w2 = w1; w1 = w0; x = 0;
+	}
+	while (ldexp(1.0, (int)bits) < l1)
+		bits++;
+	bits = frac == 31 ? (bits > 1 ? bits - 1 : 0) : (bits > 16 ? bits - 16 : 0);
+	return bits < rs - 1 ? bits : rs - 1;
+}
+
+/**
+  * @brief Obtenir le filtre d'un canal ADC
+  * @param channel : Canal ADC (0 à FILTER_CHANNELS - 1)
+  * @retval Filtre du canal, NULL si le canal n'a pas de filtre
+  */
+Filter_Chan *Filter_Channel (uint8_t channel)
+{
+	return channel < FILTER_CHANNELS ? &chans[channel] : 0;
+}
+
+/**
+  * @brief Remettre à zéro l'état (les coefficients sont conservés)
+  * @param f : Filtre
+  */
+void Filter_Reset (Filter_Chan *f)
+{
+	for (uint32_t i = 0; i < FILTER_MAX_SECTIONS; i++)
+		memset(f->bq[i].s, 0, sizeof(f->bq[i].s));
+	memset(f->fir_dl, 0, sizeof(f->fir_dl));
+	f->fir_pos = 0;
+}
+
+/**
+  * @brief Charger une cascade de cellules biquad (peut être appelé pendant l'acquisition)
+  * @param f : Filtre
+  * @param form : FILTER_DF1 ou FILTER_DF2
+  * @param format : FILTER_Q15 ou FILTER_Q31
+  * @param coeffs : sections x { b0, b1, b2, a1, a2 }
+  * @param sections : Nombre de cellules (0 : supprimer la cascade)
+  * @retval 0 si réussi, -1 si trop de cellules
+  */
+int Filter_SetBiquads (Filter_Chan *f, FilterForm form, FilterFormat format, const float *coeffs, uint32_t sections)
+{
+	uint32_t frac = format == FILTER_Q31 ? 31 : 15;
+	uint32_t shift;
+
+	if (sections > FILTER_MAX_SECTIONS)
+		return -1;
+
+	shift = pick_shift(coeffs, 5 * sections, frac);
+	for (uint32_t i = 0; i < 5 * sections; i++)
+		f->bq[i / 5].c[i % 5] = quantize(coeffs[i], frac, shift);
+	for (uint32_t i = 0; i < sections; i++)
+		f->bq[i].guard = form == FILTER_DF2 ? df2_guard(&coeffs[5 * i], frac, frac - shift) : 0;
+	for (uint32_t i = 0; i < FILTER_MAX_SECTIONS; i++)
+		memset(f->bq[i].s, 0, sizeof(f->bq[i].s));
+
+	f->form = form;
+	f->format = format;
+	f->shift = (uint8_t)shift;
+	f->sections = (uint8_t)sections;
+	return 0;
+}
+
+/**
+  * @brief Charger le FIR d'un canal
+  * @param f : Filtre
+  * @param taps : Coefficients h[0] .. h[count - 1]
+  * @param count : Nombre de coefficients (0 : supprimer le FIR)
+  * @retval 0 si réussi, -1 si trop de coefficients
+  */
+int Filter_SetFir (Filter_Chan *f, const float *taps, uint32_t count)
+{
+	uint32_t shift;
+
+	if (count > FILTER_MAX_TAPS)
+		return -1;
+
+	shift = pick_shift(taps, count, 15);
+	for (uint32_t i = 0; i < count; i++)
+		f->fir_c[i] = (int16_t)quantize(taps[i], 15, shift);
+	memset(f->fir_dl, 0, sizeof(f->fir_dl));
+
+	f->fir_shift = (uint8_t)shift;
+	f->fir_pos = 0;
+	f->taps = (uint8_t)count;
+	return 0;
+}
+
+/**
+  * @brief Indiquer si un filtre modifie les échantillons
+  */
+int Filter_IsActive (const Filter_Chan *f)
+{
+	return f->sections != 0 || f->taps != 0;
+}
+
+/**
+  * @brief Filtrer un bloc d'échantillons bruts
+  * @param f : Filtre du canal
+  * @param bits : Résolution des échantillons (6 à 12)
+  * @param in : Échantillons bruts
+  * @param out : Sortie (peut être égal à in)
+  * @param count : Nombre d'échantillons
+  */
+void Filter_Process (Filter_Chan *f, uint32_t bits, const uint16_t *in, uint16_t *out, uint32_t count)
+{
+	const int q31 = f->sections != 0 && f->format == FILTER_Q31;
+	const uint32_t frac = q31 ? 31 : 15;
+	const uint32_t scale = (q31 ? 30 : 15) - bits;     // Q31 : 1 bit de marge
+	const int32_t lo = q31 ? INT32_MIN : INT16_MIN;
+	const int32_t hi = q31 ? INT32_MAX : INT16_MAX;
+	const int32_t full = (int32_t)(1u << bits) - 1;
+	int32_t w[FILTER_CHUNK];
+
+	while (count) {
+		uint32_t n = count < FILTER_CHUNK ? count : FILTER_CHUNK;
+
+		for (uint32_t i = 0; i < n; i++)
+			w[i] = (int32_t)in[i] << scale;
+
+		for (uint32_t s = 0; s < f->sections; s++) {
+			if (f->form == FILTER_DF2)
+				biquad_df2(&f->bq[s], w, n, frac - f->shift, lo, hi);
+			else
+				biquad_df1(&f->bq[s], w, n, frac - f->shift, lo, hi);
+		}
+
+		if (f->taps)
+			fir_q15(f, w, n, q31 ? 15 : 0);
+
+		for (uint32_t i = 0; i < n; i++) {
+			int32_t v = ((w[i] >> (scale - 1)) + 1) >> 1;     // Arrondi au plus proche
+			out[i] = (uint16_t)(v < 0 ? 0 : v > full ? full : v);
+		}
+
+		in += n;
+		out += n;
+		count -= n;
+	}
+}
+
+/**
+  * @brief Calculer un passe-bas du second ordre (RBJ)
+  * @param fc : Fréquence de coupure / fréquence d'échantillonnage (0 à 0,5)
+  * @param q : Facteur de qualité (0,7071 : Butterworth)
+  * @param coeffs : Sortie { b0, b1, b2, a1, a2 }
+  */
+void Filter_DesignLowpass (float fc, float q, float *coeffs)
+{
+	float w0 = 6.2831853f * fc;
+	float cw = cosf(w0);
+	float alpha = sinf(w0) / (2.0f * q);
+	float a0 = 1.0f + alpha;
+
+	coeffs[0] = (1.0f - cw) / 2.0f / a0;
+	coeffs[1] = (1.0f - cw) / a0;
+	coeffs[2] = coeffs[0];
+	coeffs[3] = -2.0f * cw / a0;
+	coeffs[4] = (1.0f - alpha) / a0;
+}
+
+/**
+  * @brief Calculer un réjecteur du second ordre (RBJ), par exemple pour le secteur 50 Hz
+  * @param f0 : Fréquence rejetée / fréquence d'échantillonnage (0 à 0,5)
+  * @param q : Facteur de qualité (largeur de la bande rejetée = f0 / q)
+  * @param coeffs : Sortie { b0, b1, b2, a1, a2 }
+  */
+void Filter_DesignNotch (float f0, float q, float *coeffs)
+{
+	float w0 = 6.2831853f * f0;
+	float cw = cosf(w0);
+	float alpha = sinf(w0) / (2.0f * q);
+	float a0 = 1.0f + alpha;
+
+	coeffs[0] = 1.0f / a0;
+	coeffs[1] = -2.0f * cw / a0;
+	coeffs[2] = coeffs[0];
+	coeffs[3] = -2.0f * cw / a0;
+	coeffs[4] = (1.0f - alpha) / a0;
+}
@@ -0,0 +1,65 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+
+/**
+  * @brief Filtrage en virgule fixe par canal
+  *        Chaque canal enchaîne une cascade de cellules biquad (forme directe I ou II, Q15 ou Q31)
+  *        puis un FIR court en Q15. Les échantillons bruts (0 .. 2^bits - 1) sont convertis en
+  *        fraction positive : Q15 pleine échelle, Q31 avec 1 bit de marge (raw << (30 - bits)).
+  *        La sortie est saturée dans la plage de l'ADC.
+  *        Les coefficients sont fournis en flottant (éventuellement calculés par
+  *        Filter_DesignLowpass/Notch) et quantifiés avec un décalage commun : c = q * 2^shift.
+  *        Convention : y = b0 x + b1 x[-1] + b2 x[-2] - a1 y[-1] - a2 y[-2], coefficients
+  *        rangés { b0, b1, b2, a1, a2 } par cellule (a0 = 1).
+  *        Q15 convient aux coupures au-delà de fs / 50 environ ; en dessous, la quantification
+  *        des coefficients décale le gain : utiliser Q31 (voir Host/filterbench.c).
+  *        Toute la mémoire est statique ; module sans dépendance matérielle (outils PC du dossier Host).
+  */
+
+#define FILTER_CHANNELS       4     // Canaux ADC 0 à 3
+#define FILTER_MAX_SECTIONS   4     // Cellules biquad par canal
+#define FILTER_MAX_TAPS       32    // Coefficients FIR par canal
+#define FILTER_CHUNK          32    // Échantillons traités par passe
+
+typedef enum {
+	FILTER_DF1 = 0,   // Forme directe I : robuste, 4 valeurs d'état par cellule
+	FILTER_DF2        // Forme directe II : 2 valeurs d'état, plus sensible aux débordements internes
+} FilterForm;
+
+typedef enum {
+	FILTER_Q15 = 0,
+	FILTER_Q31
+} FilterFormat;
+
+typedef struct {
+	int32_t  c[5];    // b0, b1, b2, a1, a2 quantifiés
+	int32_t  s[4];    // DF1 : x1, x2, y1, y2 ; DF2 : w1, w2 (divisés par 2^guard)
+	uint32_t guard;   // DF2 : bits de marge pour le gain de la partie récursive 1 / A(z)
+} Filter_Biquad;
+
+typedef struct {
+	FilterForm    form;
+	FilterFormat  format;
+	uint8_t       sections;               // 0 : pas de cascade biquad
+	uint8_t       shift;
+	uint8_t       taps;                   // 0 : pas de FIR
+	uint8_t       fir_shift;
+	uint8_t       fir_pos;
+	Filter_Biquad bq[FILTER_MAX_SECTIONS];
+	int16_t       fir_c[FILTER_MAX_TAPS];
+	int16_t       fir_dl[2 * FILTER_MAX_TAPS];  // Ligne à retard doublée : lecture contiguë
+} Filter_Chan;
+
+Filter_Chan *Filter_Channel(uint8_t channel);
+void Filter_Reset(Filter_Chan *f);
+int Filter_SetBiquads(Filter_Chan *f, FilterForm form, FilterFormat format, const float *coeffs, uint32_t sections);
+int Filter_SetFir(Filter_Chan *f, const float *taps, uint32_t count);
+void Filter_Process(Filter_Chan *f, uint32_t bits, const uint16_t *in, uint16_t *out, uint32_t count);
+int Filter_IsActive(const Filter_Chan *f);
+
+void Filter_DesignLowpass(float fc, float q, float *coeffs);
+void Filter_DesignNotch(float f0, float q, float *coeffs);
+
+#endif /* FILTER_H */
@@ -0,0 +1,496 @@
+#include "FlashLog.h"
+#include "CRC16.h"
+#include "MemPlan.h"
+#include "Trace.h"
+#include "stm32f4xx.h"
+#include <string.h>
+
+/**
+  * @brief  Journal d'échantillons en Flash interne (stockage puis réexpédition)
+  *         Quand l'hôte est absent, les échantillons sont ajoutés à un journal circulaire
+  *         réparti sur plusieurs secteurs ; au retour de l'hôte, ils sont relus dans l'ordre.
+  *
+  *         Organisation d'un secteur :
+  *            - en-tête (16 octets) : signature et nombre d'effacements du secteur
+  *            - enregistrements : en-tête de 12 octets puis données alignées sur 4 octets
+  *
+  *         Robustesse aux coupures : un enregistrement est écrit dans l'ordre longueur/CRC,
+  *         numéro de séquence, données, puis le mot de validation en dernier. Un enregistrement
+  *         sans validation est ignoré au redémarrage. L'acquittement efface le demi-mot
+  *         "consumed" (1 -> 0), sans effacement de secteur.
+  *
+  *         Usure : les secteurs sont utilisés à tour de rôle, chacun étant effacé une fois par
+  *         tour. Un secteur d'avance est préparé dès que possible : l'écriture n'attend pas un
+  *         effacement, et les enregistrements arrivant pendant un effacement sont mis en file.
+  * @note   Sur le STM32F407 (banque unique), toute lecture de la Flash est suspendue pendant un
+  *         effacement (1 à 2 s par secteur) : le processeur s'arrête dès l'instruction suivante,
+  *         seuls les gestionnaires placés en SRAM (MEM_RAMFUNC) continuent. Exécuter l'effacement
+  *         depuis la SRAM ne suffirait pas : la boucle d'acquisition, en Flash, resterait bloquée.
+  *         L'effacement n'est donc lancé que lorsque l'acquisition est inactive : l'appelant
+  *         indique à FlashLog_Poll() la durée pendant laquelle il n'a rien à acquérir, et
+  *         FlashLog_EraseDue() lui dit quand le secteur d'écriture va manquer de place sans
+  *         secteur d'avance prêt (pour qu'il prévoie une pause).
+  *         Une écriture de demi-mot suspend aussi la Flash, environ 16 µs.
+  */
+
+#define SECT_MAGIC       0x474C4653U  // "SFLG"
+#define REC_COMMIT       0xA55A
+#define REC_CONSUMED     0x0000
+#define SECT_HDR_SIZE    16
+#define REC_HDR_SIZE     12
+
+// Effacement réclamé quand il reste moins d'un huitième du secteur d'écriture (16 Ko) : de quoi
+// absorber plusieurs rafales de 255 échantillons avant que la pause d'acquisition ne commence
+#define ERASE_DUE_MARGIN 8
+
+#define FLASH_KEY1       0x45670123U
+#define FLASH_KEY2       0xCDEF89ABU
+
+// En-tête d'enregistrement tel qu'écrit en Flash
+typedef struct {
+	uint16_t commit;    // 0xFFFF tant que l'écriture n'est pas terminée
+	uint16_t consumed;  // 0xFFFF tant que l'enregistrement n'a pas été relu
+	uint16_t len;
+	uint16_t crc;
+	uint32_t seq;
+} RecHdr;
+
+// État d'un secteur
+typedef enum {
+	SECT_DIRTY = 0,   // À effacer
+	SECT_ERASING,
+	SECT_READY,       // Effacé, en-tête écrit, vide
+	SECT_DATA         // Contient des enregistrements
+} SectState;
+
+typedef struct {
+	SectState state;
+	uint32_t  erase_count;
+	uint32_t  write_off;
+} Sector;
+
+// Enregistrement en attente pendant un effacement
+typedef struct {
+	uint16_t len;
+	uint8_t  data[FLASHLOG_MAX_PAYLOAD];
+} Pending;
+
+static const FlashLog_Driver *drv;
+static MEM_CCM Sector sect[FLASHLOG_SECTOR_COUNT];
+static uint32_t wr_sect;
+static uint32_t rd_sect, rd_off;
+static uint32_t next_seq;
+static int erasing = -1;
+static MEM_CCM Pending pending[FLASHLOG_PENDING];   // Recopiée en Flash par le CPU : CCM possible
+static uint32_t pend_head, pend_count;
+static FlashLog_Stats stats;
+
+MEM_STATIC_ASSERT(sizeof(sect) + sizeof(pending) <= MEM_CCM_FLASHLOG, flashlog_budget);
+
+static const uint8_t *sect_ptr (uint32_t s)
+{
+	return drv->base + s * drv->sector_size;
+}
+
+static uint32_t rec_size (uint16_t len)
+{
+	return REC_HDR_SIZE + ((len + 3U) & ~3U);
+}
+
+// Écrire une suite d'octets (longueur paire) par demi-mots
+static int program_bytes (uint32_t offset, const uint8_t *data, uint32_t length)
+{
+	for (uint32_t i = 0; i < length; i += 2) {
+		if (drv->program16(offset + i, (uint16_t)(data[i] | (data[i + 1] << 8))))
+			return -1;
+	}
+	return 0;
+}
+
+// Parcourir un secteur au démarrage : fin des données, séquence maximale, enregistrements à relire
+static void scan_sector (uint32_t s, uint32_t *max_seq, int *found)
+{
+	const uint8_t *p = sect_ptr(s);
+	uint32_t off = SECT_HDR_SIZE;
+	uint32_t magic, erase_count;
+
+	memcpy(&magic, p, 4);
+	memcpy(&erase_count, p + 4, 4);
+	if (magic != SECT_MAGIC) {
+		sect[s].state = SECT_DIRTY;
+		sect[s].erase_count = 0;
+		return;
+	}
+	sect[s].erase_count = erase_count;
+	sect[s].state = SECT_READY;
+
+	while (off + REC_HDR_SIZE <= drv->sector_size) {
+		RecHdr h;
+		memcpy(&h, p + off, sizeof(h));
+		if (h.len == 0xFFFF)
+			break;                              // Espace libre
+		if (h.len > FLASHLOG_MAX_PAYLOAD || off + rec_size(h.len) > drv->sector_size) {
+			off = drv->sector_size;             // En-tête corrompu : secteur clos
+			break;
+		}
+		sect[s].state = SECT_DATA;
+		if (h.commit == REC_COMMIT && CRC16_Compute(p + off + REC_HDR_SIZE, h.len) == h.crc) {
+			if (!*found || (int32_t)(h.seq - *max_seq) > 0)
+				*max_seq = h.seq;
+			*found = 1;
+			if (h.consumed != REC_CONSUMED)
+				stats.backlog++;
+		}
+		off += rec_size(h.len);
+	}
+	sect[s].write_off = off;
+}
+
+// Préparer l'effacement du secteur suivant le secteur d'écriture
+static void schedule_next (void)
+{
+	uint32_t next = (wr_sect + 1) % drv->sector_count;
+
+	if (sect[next].state == SECT_DATA) {
+		// Le journal est plein : le secteur le plus ancien est recyclé
+		const uint8_t *p = sect_ptr(next);
+		uint32_t off = SECT_HDR_SIZE;
+		while (off < sect[next].write_off) {
+			RecHdr h;
+			memcpy(&h, p + off, sizeof(h));
+			if (h.commit == REC_COMMIT && h.consumed != REC_CONSUMED) {
+				stats.overwritten++;
+				stats.backlog--;
+			}
+			off += rec_size(h.len);
+		}
+		if (rd_sect == next) {
+			rd_sect = (next + 1) % drv->sector_count;
+			rd_off = SECT_HDR_SIZE;
+		}
+		sect[next].state = SECT_DIRTY;
+	}
+}
+
+// Écrire un enregistrement dans le secteur courant (Flash libre)
+static int write_record (const uint8_t *data, uint16_t length)
+{
+	uint8_t buf[FLASHLOG_MAX_PAYLOAD + 4];
+	uint32_t size = rec_size(length);
+	uint32_t base;
+	uint16_t crc;
+
+	if (sect[wr_sect].write_off + size > drv->sector_size) {
+		uint32_t next = (wr_sect + 1) % drv->sector_count;
+		if (sect[next].state != SECT_READY)
+			return -1;                          // Secteur suivant pas encore effacé
+		wr_sect = next;
+		schedule_next();
+	}
+
+	base = wr_sect * drv->sector_size + sect[wr_sect].write_off;
+	crc = CRC16_Compute(data, length);
+	memset(buf, 0xFF, sizeof(buf));
+	memcpy(buf, data, length);
+
+	// Longueur et CRC, séquence, données, puis validation
+	if (drv->program16(base + 4, length) ||
+	    drv->program16(base + 6, crc) ||
+	    drv->program16(base + 8, (uint16_t)next_seq) ||
+	    drv->program16(base + 10, (uint16_t)(next_seq >> 16)) ||
+	    program_bytes(base + REC_HDR_SIZE, buf, (length + 3U) & ~3U) ||
+	    drv->program16(base + 0, REC_COMMIT)) {
+		sect[wr_sect].write_off = drv->sector_size;  // Écriture échouée : secteur clos
+		return -1;
+	}
+
+	sect[wr_sect].write_off += size;
+	sect[wr_sect].state = SECT_DATA;
+	next_seq++;
+	stats.appended++;
+	stats.backlog++;
+	return 0;
+}
+
+/**
+  * @brief Initialiser le journal et reprendre son état après un redémarrage
+  * @param driver : Accès Flash (FlashLog_Stm32 sur cible)
+  */
+void FlashLog_Init (const FlashLog_Driver *driver)
+{
+	uint32_t max_seq = 0, best = 0, s;
+	int found = 0;
+
+	drv = driver;
+	memset(&stats, 0, sizeof(stats));
+	pend_head = pend_count = 0;
+	erasing = -1;
+
+	for (s = 0; s < drv->sector_count; s++) {
+		uint32_t before = max_seq;
+		int had = found;
+		scan_sector(s, &max_seq, &found);
+		if (found && (!had || max_seq != before))
+			best = s;                           // Secteur contenant l'enregistrement le plus récent
+	}
+
+	next_seq = found ? max_seq + 1 : 0;
+	if (found) {
+		wr_sect = best;
+	} else {
+		for (wr_sect = 0; wr_sect < drv->sector_count - 1; wr_sect++)
+			if (sect[wr_sect].state == SECT_READY)
+				break;
+		if (sect[wr_sect].state != SECT_READY)
+			sect[wr_sect].write_off = drv->sector_size;  // Pas de secteur prêt : attendre un effacement
+	}
+
+	// La relecture commence au secteur le plus ancien : le premier secteur de données qui suit
+	// le secteur d'écriture, ou celui-ci si le journal n'a pas encore fait le tour. Partir
+	// d'un secteur vide ferait sauter les données du secteur d'écriture dès que l'écriture
+	// passerait au secteur suivant.
+	rd_sect = (wr_sect + 1) % drv->sector_count;
+	while (rd_sect != wr_sect && sect[rd_sect].state != SECT_DATA)
+		rd_sect = (rd_sect + 1) % drv->sector_count;
+	rd_off = SECT_HDR_SIZE;
+	schedule_next();
+}
+
+/**
+  * @brief Ajouter un enregistrement au journal
+  *        Ne bloque jamais sur un effacement : pendant celui-ci, l'enregistrement est mis en file.
+  * @param data : Données
+  * @param length : Nombre d'octets (1 à FLASHLOG_MAX_PAYLOAD)
+  * @retval 0 si écrit ou mis en file, -1 si perdu
+  */
+int FlashLog_Append (const void *data, uint16_t length)
+{
+	if (length == 0 || length > FLASHLOG_MAX_PAYLOAD)
+		return -1;
+
+	if (erasing < 0 && pend_count == 0 && write_record(data, length) == 0)
+		return 0;
+
+	if (pend_count == FLASHLOG_PENDING) {
+		stats.dropped++;
+		return -1;
+	}
+	Pending *p = &pending[(pend_head + pend_count) % FLASHLOG_PENDING];
+	p->len = length;
+	memcpy(p->data, data, length);
+	pend_count++;
+	return 0;
+}
+
+/**
+  * @brief Faire avancer les effacements et vider la file d'attente
+  *        À appeler régulièrement. Un effacement n'est lancé que si idle_ms couvre sa durée
+  *        maximale (FLASHLOG_ERASE_MAX_MS) : pendant ce temps, le processeur est arrêté.
+  * @param idle_ms : Durée pendant laquelle l'appelant n'a pas d'acquisition à faire (ms)
+  */
+void FlashLog_Poll (uint32_t idle_ms)
+{
+	uint32_t s;
+
+	if (erasing >= 0) {
+		if (drv->busy())
+			return;
+		// Effacement terminé : écrire l'en-tête du secteur
+		s = (uint32_t)erasing;
+		TRACE(TRACE_ERASE_END, s);
+		sect[s].erase_count++;
+		drv->program16(s * drv->sector_size + 0, (uint16_t)SECT_MAGIC);
+		drv->program16(s * drv->sector_size + 2, (uint16_t)(SECT_MAGIC >> 16));
+		drv->program16(s * drv->sector_size + 4, (uint16_t)sect[s].erase_count);
+		drv->program16(s * drv->sector_size + 6, (uint16_t)(sect[s].erase_count >> 16));
+		sect[s].state = SECT_READY;
+		sect[s].write_off = SECT_HDR_SIZE;
+		erasing = -1;
+		stats.erases++;
+	}
+
+	// Vider la file d'attente
+	while (pend_count) {
+		Pending *p = &pending[pend_head];
+		if (write_record(p->data, p->len) != 0)
+			break;
+		pend_head = (pend_head + 1) % FLASHLOG_PENDING;
+		pend_count--;
+	}
+
+	// Lancer au plus un effacement (le secteur à préparer en priorité est le suivant)
+	if (erasing >= 0 || idle_ms < FLASHLOG_ERASE_MAX_MS)
+		return;
+	for (uint32_t i = 1; i <= drv->sector_count; i++) {
+		s = (wr_sect + i) % drv->sector_count;
+		if (sect[s].state == SECT_DIRTY && s != wr_sect) {
+			sect[s].state = SECT_ERASING;
+			erasing = (int)s;
+			TRACE(TRACE_ERASE_BEGIN, s);
+			drv->erase_start(s);
+			break;
+		}
+	}
+}
+
+/**
+  * @brief Fenêtre d'inactivité nécessaire au prochain effacement
+  *        Le secteur d'écriture est presque plein et aucun secteur d'avance n'est prêt : l'appelant
+  *        qui journalise doit prévoir une pause d'acquisition de cette durée. Tant qu'il reste de
+  *        la place, les secteurs à effacer attendent une fenêtre d'inactivité naturelle.
+  * @retval FLASHLOG_ERASE_MAX_MS si un effacement est nécessaire, 0 sinon
+  */
+uint32_t FlashLog_EraseDue (void)
+{
+	int dirty = 0;
+
+	if (erasing >= 0)
+		return 0;
+	for (uint32_t s = 0; s < drv->sector_count; s++) {
+		if (s == wr_sect)
+			continue;
+		if (sect[s].state == SECT_READY)
+			return 0;                           // Secteur d'avance prêt : l'écriture continue
+		if (sect[s].state == SECT_DIRTY)
+			dirty = 1;
+	}
+	if (!dirty || sect[wr_sect].write_off + drv->sector_size / ERASE_DUE_MARGIN <= drv->sector_size)
+		return 0;
+	return FLASHLOG_ERASE_MAX_MS;
+}
+
+/**
+  * @brief Lire l'enregistrement le plus ancien non encore relu
+  * @param data : Tampon de FLASHLOG_MAX_PAYLOAD octets
+  * @param length : Longueur lue
+  * @param seq : Numéro de séquence de l'enregistrement
+  * @retval 1 si un enregistrement est disponible, 0 sinon
+  */
+int FlashLog_Peek (void *data, uint16_t *length, uint32_t *seq)
+{
+	if (erasing >= 0)
+		return 0;                               // Pas d'acquittement possible pendant un effacement
+
+	while (stats.backlog) {
+		const uint8_t *p = sect_ptr(rd_sect);
+		RecHdr h;
+
+		if (rd_off >= sect[rd_sect].write_off || sect[rd_sect].state != SECT_DATA) {
+			if (rd_sect == wr_sect)
+				return 0;
+			rd_sect = (rd_sect + 1) % drv->sector_count;
+			rd_off = SECT_HDR_SIZE;
+			continue;
+		}
+
+		memcpy(&h, p + rd_off, sizeof(h));
+		if (h.commit == REC_COMMIT && h.consumed != REC_CONSUMED &&
+		    CRC16_Compute(p + rd_off + REC_HDR_SIZE, h.len) == h.crc) {
+			memcpy(data, p + rd_off + REC_HDR_SIZE, h.len);
+			*length = h.len;
+			*seq = h.seq;
+			return 1;
+		}
+		rd_off += rec_size(h.len);              // Enregistrement déjà relu ou incomplet
+	}
+	return 0;
+}
+
+/**
+  * @brief Acquitter l'enregistrement retourné par FlashLog_Peek()
+  */
+void FlashLog_Consume (void)
+{
+	RecHdr h;
+
+	memcpy(&h, sect_ptr(rd_sect) + rd_off, sizeof(h));
+	drv->program16(rd_sect * drv->sector_size + rd_off + 2, REC_CONSUMED);
+	rd_off += rec_size(h.len);
+	stats.replayed++;
+	stats.backlog--;
+}
+
+/**
+  * @brief Obtenir les compteurs du journal
+  */
+const FlashLog_Stats *FlashLog_GetStats (void)
+{
+	return &stats;
+}
+
+/**
+  * @brief Nombre d'effacements d'un secteur (suivi de l'usure)
+  */
+uint32_t FlashLog_GetEraseCount (uint32_t sector)
+{
+	return sect[sector].erase_count;
+}
+
+/************** ACCÈS FLASH STM32F4 *****************/
+
+static void stm32_unlock (void)
+{
+	if (FLASH->CR & FLASH_CR_LOCK) {
+		FLASH->KEYR = FLASH_KEY1;
+		FLASH->KEYR = FLASH_KEY2;
+	}
+}
+
+static int stm32_erase_active;
+
+// Les lignes du cache de données peuvent contenir l'ancien contenu d'une zone réécrite
+static void stm32_flush_dcache (void)
+{
+	FLASH->ACR &= ~FLASH_ACR_DCEN;
+	FLASH->ACR |= FLASH_ACR_DCRST;
+	FLASH->ACR &= ~FLASH_ACR_DCRST;
+	FLASH->ACR |= FLASH_ACR_DCEN;
+}
+
+static void stm32_erase_start (uint32_t sector)
+{
+	while (FLASH->SR & FLASH_SR_BSY);
+	stm32_unlock();
+	FLASH->CR = FLASH_CR_SER |                                            // Effacement de secteur
+	            ((FLASHLOG_SECTOR_FIRST + sector) << FLASH_CR_SNB_Pos) |
+	            (2U << 8);                                                // Parallélisme x32
+	FLASH->CR |= FLASH_CR_STRT;                                           // Lancer, sans attendre
+	stm32_erase_active = 1;
+}
+
+static int stm32_busy (void)
+{
+	if (FLASH->SR & FLASH_SR_BSY)
+		return 1;
+	if (stm32_erase_active) {
+		FLASH->CR &= ~FLASH_CR_SER;
+		stm32_flush_dcache();
+		stm32_erase_active = 0;
+	}
+	return 0;
+}
+
+static int stm32_program16 (uint32_t offset, uint16_t value)
+{
+	uint32_t err = FLASH_SR_PGSERR | FLASH_SR_PGPERR | FLASH_SR_PGAERR | FLASH_SR_WRPERR;
+
+	while (FLASH->SR & FLASH_SR_BSY);
+	stm32_unlock();
+	FLASH->SR = err | FLASH_SR_EOP;                     // Effacer les drapeaux (écriture de 1)
+	FLASH->CR = FLASH_CR_PG | FLASH_CR_PSIZE_0;         // Programmation par demi-mot (x16)
+	*(volatile uint16_t *)(FLASHLOG_BASE + offset) = value;
+	while (FLASH->SR & FLASH_SR_BSY);                   // ~16 µs
+	FLASH->CR &= ~FLASH_CR_PG;
+	stm32_flush_dcache();
+
+	return (FLASH->SR & err) ? -1 : 0;
+}
+
+const FlashLog_Driver FlashLog_Stm32 = {
+	(const uint8_t *)FLASHLOG_BASE,
+	FLASHLOG_SECTOR_SIZE,
+	FLASHLOG_SECTOR_COUNT,
+	stm32_erase_start,
+	stm32_busy,
+	stm32_program16
+};
@@ -0,0 +1,52 @@
+#ifndef FLASHLOG_H
+#define FLASHLOG_H
+
+#include <stdint.h>
+
+// Zone de journalisation : secteurs 8 à 11 de la Flash interne (4 x 128 Ko)
+#define FLASHLOG_SECTOR_FIRST   8
+#define FLASHLOG_SECTOR_COUNT   4
+#define FLASHLOG_SECTOR_SIZE    0x20000U
+#define FLASHLOG_BASE           0x08080000U
+
+#define FLASHLOG_MAX_PAYLOAD    32  // Taille maximale d'un enregistrement (octets)
+#define FLASHLOG_PENDING        8   // Enregistrements mis en attente pendant un effacement
+
+// Effacement d'un secteur de 128 Ko en parallélisme x32 : 1 s typique, 2 s au plus (DS8626).
+// Le STM32F407 n'a qu'une banque : toute lecture de la Flash, instructions comprises, reste
+// suspendue pendant ce temps. Un effacement n'est lancé que dans une fenêtre d'inactivité au
+// moins aussi longue (FlashLog_Poll).
+#define FLASHLOG_ERASE_MAX_MS   2000
+
+// Accès bas niveau à la Flash : le journal ne touche jamais directement aux registres,
+// ce qui permet de le faire tourner sur PC avec une Flash simulée.
+typedef struct {
+	const uint8_t *base;                                // Début de la zone (lecture directe)
+	uint32_t sector_size;
+	uint32_t sector_count;
+	void (*erase_start)(uint32_t sector);               // Lance l'effacement, sans attendre
+	int  (*busy)(void);                                 // 1 pendant un effacement / une écriture
+	int  (*program16)(uint32_t offset, uint16_t value); // Écrit un demi-mot (0 si succès)
+} FlashLog_Driver;
+
+typedef struct {
+	uint32_t appended;     // Enregistrements écrits
+	uint32_t replayed;     // Enregistrements relus et acquittés
+	uint32_t overwritten;  // Enregistrements non relus perdus par recyclage d'un secteur
+	uint32_t dropped;      // Enregistrements perdus (file d'attente pleine pendant un effacement)
+	uint32_t erases;       // Effacements de secteur
+	uint32_t backlog;      // Enregistrements en attente de relecture
+} FlashLog_Stats;
+
+extern const FlashLog_Driver FlashLog_Stm32;
+
+void FlashLog_Init(const FlashLog_Driver *driver);
+int FlashLog_Append(const void *data, uint16_t length);
+void FlashLog_Poll(uint32_t idle_ms);
+uint32_t FlashLog_EraseDue(void);
+int FlashLog_Peek(void *data, uint16_t *length, uint32_t *seq);
+void FlashLog_Consume(void);
+const FlashLog_Stats *FlashLog_GetStats(void);
+uint32_t FlashLog_GetEraseCount(uint32_t sector);
+
+#endif /* FLASHLOG_H */
@@ -0,0 +1,148 @@
+#include "Frame.h"
+#include "CRC16.h"
+#include "Pack.h"
+#include <string.h>
+
+/**
+  * @brief Construire une trame binaire
+  * @param out : Tampon de sortie (au moins FRAME_HDR_SIZE + length + FRAME_CRC_SIZE octets)
+  * @param type : Type de trame
+  * @param seq : Numéro de séquence
+  * @param payload : Données
+  * @param length : Nombre d'octets de données
+  * @retval Taille totale de la trame
+  */
+uint32_t Frame_Encode (uint8_t *out, uint8_t type, uint16_t seq, const uint8_t *payload, uint8_t length)
+{
+	out[0] = FRAME_SYNC0;
+	out[1] = FRAME_SYNC1;
+	out[2] = type;
+	out[3] = length;
+	Frame_PutU16(&out[4], seq);
+	if (payload != &out[FRAME_HDR_SIZE])
+		memcpy(&out[FRAME_HDR_SIZE], payload, length);
+	Frame_PutU16(&out[FRAME_HDR_SIZE + length], CRC16_Compute(&out[2], 4 + length));
+
+	return FRAME_HDR_SIZE + length + FRAME_CRC_SIZE;
+}
+
+/**
+  * @brief Construire une trame d'échantillons
+  *        Les données sont écrites directement à leur place dans la trame (pas de copie).
+  * @param out : Tampon de sortie (FRAME_MAX_SIZE octets)
+  * @param seq : Numéro de séquence
+  * @param t_us : Horodatage du premier échantillon (µs)
+  * @param channel : Canal ADC
+  * @param samples : Valeurs brutes
+  * @param count : Nombre d'échantillons (124 au plus)
+  * @retval Taille totale de la trame
+  */
+uint32_t Frame_EncodeSamples (uint8_t *out, uint16_t seq, uint32_t t_us, uint8_t channel,
+                              const uint16_t *samples, uint8_t count)
+{
+	uint8_t *p = &out[FRAME_HDR_SIZE];
+
+	Frame_PutU32(p, t_us);
+	p[4] = channel;
+	p[5] = count;
+	for (uint32_t i = 0; i < count; i++)
+		Frame_PutU16(&p[FRAME_SAMPLES_HDR + 2 * i], samples[i]);
+
+	return Frame_Encode(out, FRAME_SAMPLES, seq, p, (uint8_t)(FRAME_SAMPLES_HDR + 2 * count));
+}
+
+/**
+  * @brief Construire une trame d'échantillons compactés
+  * @param out : Tampon de sortie (FRAME_MAX_SIZE octets)
+  * @param seq : Numéro de séquence
+  * @param t_us : Horodatage du premier échantillon (µs)
+  * @param channel : Canal ADC
+  * @param bits : Résolution (6, 8, 10 ou 12)
+  * @param samples : Valeurs brutes
+  * @param count : Nombre d'échantillons (FRAME_PACKED_MAX(bits) au plus)
+  * @retval Taille totale de la trame
+  */
+uint32_t Frame_EncodePacked (uint8_t *out, uint16_t seq, uint32_t t_us, uint8_t channel,
+                             uint8_t bits, const uint16_t *samples, uint8_t count)
+{
+	uint8_t *p = &out[FRAME_HDR_SIZE];
+	uint32_t n = Frame_PutPacked(p, t_us, channel, bits, samples, count);
+
+	return Frame_Encode(out, FRAME_PACKED, seq, p, (uint8_t)n);
+}
+
+/**
+  * @brief Construire les seules données d'une trame FRAME_PACKED (sans en-tête ni CRC)
+  *        Pour un émetteur qui encode la trame plus tard (Mux.c).
+  * @param p : Tampon de sortie (FRAME_MAX_PAYLOAD octets)
+  * @retval Taille des données
+  */
+uint32_t Frame_PutPacked (uint8_t *p, uint32_t t_us, uint8_t channel, uint8_t bits,
+                          const uint16_t *samples, uint8_t count)
+{
+	Frame_PutU32(p, t_us);
+	p[4] = channel;
+	p[5] = count;
+	p[6] = bits;
+	return FRAME_PACKED_HDR + Pack_Samples(bits, samples, count, &p[FRAME_PACKED_HDR]);
+}
+
+/**
+  * @brief Initialiser un décodeur de trames
+  */
+void Frame_RxInit (Frame_Rx *r)
+{
+	memset(r, 0, sizeof(*r));
+}
+
+// Abandonner le début de la trame en cours : reprendre au prochain octet de synchronisation
+static void rx_resync (Frame_Rx *r)
+{
+	uint32_t i;
+
+	for (i = 1; i < r->pos; i++)
+		if (r->buf[i] == FRAME_SYNC0 && (i + 1 == r->pos || r->buf[i + 1] == FRAME_SYNC1))
+			break;
+	r->skipped += i;
+	r->pos = (uint16_t)(r->pos - i);
+	memmove(r->buf, &r->buf[i], r->pos);
+}
+
+/**
+  * @brief Ajouter un octet reçu
+  * @retval Taille de la trame complète et valide disponible dans r->buf (jusqu'à l'octet
+  *         suivant), 0 sinon
+  */
+uint32_t Frame_RxByte (Frame_Rx *r, uint8_t c)
+{
+	uint32_t size;
+
+	if (r->done) {
+		// Octets reçus après la trame rendue au dernier appel (reprise après un CRC faux)
+		r->pos = (uint16_t)(r->pos - r->done);
+		memmove(r->buf, &r->buf[r->done], r->pos);
+		r->done = 0;
+	}
+	r->buf[r->pos++] = c;
+	for (;;) {
+		if (r->buf[0] != FRAME_SYNC0 || (r->pos >= 2 && r->buf[1] != FRAME_SYNC1)) {
+			rx_resync(r);
+			if (r->pos == 0)
+				return 0;
+			continue;
+		}
+		if (r->pos < FRAME_HDR_SIZE)
+			return 0;
+		size = FRAME_HDR_SIZE + r->buf[3] + FRAME_CRC_SIZE;
+		if (r->pos < size)
+			return 0;
+		if (CRC16_Compute(&r->buf[2], 4 + r->buf[3]) == Frame_GetU16(&r->buf[FRAME_HDR_SIZE + r->buf[3]])) {
+			r->done = (uint16_t)size;
+			return size;
+		}
+		r->crc_errors++;
+		rx_resync(r);
+		if (r->pos == 0)
+			return 0;
+	}
+}
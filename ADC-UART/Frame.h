@@ -0,0 +1,126 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+
+/**
+  * @brief Format binaire des trames (partagé avec les outils PC du dossier Host)
+  *
+  *   octet  0     1     2      3     4..5     6 .. 6+len-1   6+len .. 7+len
+  *        +-----+-----+------+-----+--------+--------------+---------------+
+  *        | A5  | 5A  | type | len | seq LE |   données    | CRC-16 LE     |
+  *        +-----+-----+------+-----+--------+--------------+---------------+
+  *
+  *   Le CRC-16/CCITT-FALSE couvre type, len, seq et les données. Le numéro de séquence
+  *   s'incrémente à chaque trame émise : un trou révèle une perte.
+  */
+#define FRAME_SYNC0        0xA5
+#define FRAME_SYNC1        0x5A
+#define FRAME_HDR_SIZE     6
+#define FRAME_CRC_SIZE     2
+#define FRAME_MAX_PAYLOAD  255
+#define FRAME_MAX_SIZE     (FRAME_HDR_SIZE + FRAME_MAX_PAYLOAD + FRAME_CRC_SIZE)
+
+/**
+  * L'octet type porte aussi le flux d'origine (Mux.h) dans ses 2 bits de poids fort :
+  * flux 0 (données) = types inchangés ; un lecteur qui ignore les flux doit masquer FRAME_TYPE().
+  */
+#define FRAME_STREAM_SHIFT 6
+#define FRAME_TYPE(t)      ((uint8_t)((t) & 0x3F))
+#define FRAME_STREAM(t)    ((uint8_t)((t) >> FRAME_STREAM_SHIFT))
+#define FRAME_TAG(stream, type)  ((uint8_t)(((stream) << FRAME_STREAM_SHIFT) | (type)))
+
+// Types de trame
+#define FRAME_SAMPLES      0x01  // Échantillons en direct
+#define FRAME_TEXT         0x02  // Texte (enregistrement de démarrage, messages)
+#define FRAME_REPLAY       0x03  // Échantillons relus depuis le journal Flash
+#define FRAME_PACKED       0x04  // Échantillons compactés selon la résolution (voir Pack.h)
+#define FRAME_GAP          0x05  // Marqueur de discontinuité : échantillons perdus par l'ADC
+#define FRAME_SKIP         0x06  // Mode fiable : trames de numéro < seq abandonnées (sans données)
+#define FRAME_TRACE        0x07  // Vidage de la trace d'événements (Trace.h)
+
+// Types de trame de l'hôte vers la carte (mode fiable, Arq.h) ; seq n'y est pas utilisé
+#define FRAME_ACK          0x20  // Acquittement
+#define FRAME_NAK          0x21  // Demande de retransmission
+#define FRAME_BAUD         0x22  // Négociation du débit (BaudNeg.h), dans les deux sens
+#define FRAME_TRACE_CMD    0x23  // Demande de vidage de la trace (Trace.h), sans données
+
+/**
+  * Données d'une trame FRAME_SAMPLES / FRAME_REPLAY :
+  *   t_us (u32 LE) | channel (u8) | count (u8) | count x raw (u16 LE)
+  * Pour FRAME_REPLAY, t_us est l'horodatage d'origine et seq le numéro du journal (u32 LE)
+  * précède t_us.
+  */
+#define FRAME_SAMPLES_HDR  6
+#define FRAME_REPLAY_HDR   10
+
+/**
+  * Données d'une trame FRAME_PACKED :
+  *   t_us (u32 LE) | channel (u8) | count (u8) | bits (u8) | Pack_Bytes(bits, count) octets
+  */
+#define FRAME_PACKED_HDR   7
+#define FRAME_PACKED_MAX(bits)  (((FRAME_MAX_PAYLOAD - FRAME_PACKED_HDR) * 8) / (bits))
+
+/**
+  * Données d'une trame FRAME_GAP (émise avant le premier échantillon qui suit la perte) :
+  *   t_us (u32 LE) | channel (u8) | lost (u16 LE, événements de perte : débordement, redémarrage)
+  */
+#define FRAME_GAP_SIZE     7
+
+/**
+  * Données d'une trame FRAME_ACK :
+  *   next (u16 LE, toutes les trames < next reçues) | sack (u32 LE, bit i : trame next + 1 + i
+  *   reçue) | win (u8, trames que l'hôte accepte à partir de next)
+  * Données d'une trame FRAME_NAK :
+  *   n x seq (u16 LE) des trames manquantes, FRAME_NAK_MAX au plus
+  */
+#define FRAME_ACK_SIZE     7
+#define FRAME_NAK_MAX      16
+
+/**
+  * Décodeur de trames octet par octet (sens hôte -> carte, outils PC). Un en-tête incohérent
+  * ou un CRC faux relance la recherche de synchronisation dans les octets déjà reçus.
+  */
+typedef struct {
+	uint16_t pos;                  // Octets de la trame en cours
+	uint16_t done;                 // Taille de la trame rendue au dernier appel
+	uint8_t  buf[FRAME_MAX_SIZE];  // Trame complète après un retour non nul de Frame_RxByte()
+	uint32_t crc_errors;
+	uint32_t skipped;              // Octets ignorés pour retrouver la synchronisation
+} Frame_Rx;
+
+uint32_t Frame_Encode(uint8_t *out, uint8_t type, uint16_t seq, const uint8_t *payload, uint8_t length);
+uint32_t Frame_EncodeSamples(uint8_t *out, uint16_t seq, uint32_t t_us, uint8_t channel,
+                             const uint16_t *samples, uint8_t count);
+uint32_t Frame_EncodePacked(uint8_t *out, uint16_t seq, uint32_t t_us, uint8_t channel,
+                            uint8_t bits, const uint16_t *samples, uint8_t count);
+uint32_t Frame_PutPacked(uint8_t *p, uint32_t t_us, uint8_t channel, uint8_t bits,
+                         const uint16_t *samples, uint8_t count);
+void Frame_RxInit(Frame_Rx *r);
+uint32_t Frame_RxByte(Frame_Rx *r, uint8_t c);
+
+static __inline void Frame_PutU16(uint8_t *p, uint16_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+static __inline void Frame_PutU32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+static __inline uint16_t Frame_GetU16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static __inline uint32_t Frame_GetU32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#endif /* FRAME_H */
@@ -0,0 +1,68 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/**
+  * @brief Configuration FreeRTOS de la carte (build APP_RTOS=1, portage RVDS/ARM_CM4F)
+  *        Allocation uniquement statique : le plan mémoire (MemPlan.h) n'a pas de tas.
+  *        Le temps d'exécution des tâches est compté en cycles par le DWT.
+  */
+
+#include <stdint.h>
+#include "DWT_Config.h"
+
+extern uint32_t SystemCoreClock;
+
+#define configUSE_PREEMPTION                    1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+#define configCPU_CLOCK_HZ                      (SystemCoreClock)
+#define configTICK_RATE_HZ                      ((TickType_t)1000)
+#define configMAX_PRIORITIES                    5
+#define configMINIMAL_STACK_SIZE                ((uint16_t)128)
+#define configMAX_TASK_NAME_LEN                 8
+#define configSTACK_DEPTH_TYPE                  uint32_t
+#define configUSE_16_BIT_TICKS                  0
+#define configIDLE_SHOULD_YIELD                 1
+#define configUSE_IDLE_HOOK                     0
+#define configUSE_TICK_HOOK                     0
+#define configUSE_MUTEXES                       0
+#define configUSE_COUNTING_SEMAPHORES           0
+#define configUSE_TIMERS                        0
+#define configQUEUE_REGISTRY_SIZE               0
+
+// Mémoire
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        0
+#define configCHECK_FOR_STACK_OVERFLOW          2
+
+// Statistiques par tâche
+#define configUSE_TRACE_FACILITY                1
+#define configGENERATE_RUN_TIME_STATS           1
+#define configRUN_TIME_COUNTER_TYPE             uint32_t
+// Appelé par vTaskStartScheduler() : le compteur tourne déjà depuis SystemInit et DWT_Init()
+// le laisse alors intact (pas de remise à zéro sous BootTime ni sous la trace)
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() DWT_Init()
+#define portGET_RUN_TIME_COUNTER_VALUE()        DWT_GetCycles()
+
+// Fonctions incluses
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_xTaskDelayUntil                 1
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
+#define INCLUDE_vTaskSuspend                    1
+#define INCLUDE_xTaskGetSchedulerState          1
+
+// Priorités d'interruption (4 bits sur STM32F4) : les ISR qui appellent l'API FreeRTOS
+// doivent avoir une priorité numérique >= 5
+#define configPRIO_BITS                         4
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY      15
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY 5
+#define configKERNEL_INTERRUPT_PRIORITY         (configLIBRARY_LOWEST_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY    (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
+
+#define configASSERT(x)                         if ((x) == 0) { __disable_irq(); for (;;); }
+
+// Gestionnaires du noyau branchés sur la table des vecteurs ; le SysTick reste dans
+// Timer_Config.c, qui appelle xPortSysTickHandler() une fois l'ordonnanceur démarré
+#define vPortSVCHandler                         SVC_Handler
+#define xPortPendSVHandler                      PendSV_Handler
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,179 @@
+#include "Freq.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static void window_reset (Freq_Meter *m, int64_t t)
+{
+	m->win_start = t;
+	m->periods = 0;
+	m->sum_d = m->sum_d2 = 0;
+	m->min_p = m->max_p = 0;
+	m->sum_high = m->sum_cycle = 0;
+}
+
+/**
+  * @brief Initialiser un mesureur
+  * @param level : Seuil (LSB)
+  * @param hyst : Hystérésis (LSB)
+  * @param tick_hz : Fréquence de la base de temps des dates de bloc
+  * @param window_ms : Durée d'une fenêtre de mesure
+  */
+void Freq_Init (Freq_Meter *m, uint16_t level, uint16_t hyst, uint32_t tick_hz, uint32_t window_ms)
+{
+	memset(m, 0, sizeof(*m));
+	m->level = level;
+	m->hyst = hyst;
+	m->tick_hz = tick_hz;
+	m->window = (int64_t)tick_hz * window_ms / 1000 * 256;
+	m->state = -1;
+}
+
+// Instant du franchissement du seuil entre (t0, a) et (t1, b), a et b de part et d'autre
+static int64_t cross (const Freq_Meter *m, int64_t t0, int32_t a, int64_t t1, int32_t b)
+{
+	return t0 + (t1 - t0) * ((int32_t)m->level - a) / (b - a);
+}
+
+static void on_rise (Freq_Meter *m, int64_t t)
+{
+	if (m->have_rise) {
+		int64_t p = t - m->last_rise;
+		int64_t d;
+
+		if (m->periods == 0) {
+			m->p0 = p;
+			m->min_p = m->max_p = p;
+		}
+		d = p - m->p0;
+		m->sum_d += d;
+		m->sum_d2 += d * d;
+		if (p < m->min_p) m->min_p = p;
+		if (p > m->max_p) m->max_p = p;
+		m->periods++;
+
+		// Rapport cyclique sur les cycles montant -> descendant -> montant complets
+		if (m->have_fall && m->last_fall > m->last_rise) {
+			m->sum_high += m->last_fall - m->last_rise;
+			m->sum_cycle += p;
+		}
+	}
+	m->last_rise = t;
+	m->have_rise = 1;
+}
+
+static void window_result (const Freq_Meter *m, Freq_Result *res)
+{
+	double us = 1e6 / 256.0 / m->tick_hz;   // Microsecondes par tick Q8
+
+	memset(res, 0, sizeof(*res));
+	res->periods = m->periods;
+	res->duty = -1.0f;
+	if (m->periods == 0)
+		return;
+
+	double n = m->periods;
+	double mean_d = m->sum_d / n;
+	double var = m->sum_d2 / n - mean_d * mean_d;
+	double period = (m->p0 + mean_d) * us;
+
+	res->period_us = (float)period;
+	res->freq_hz = (float)(1e6 / period);
+	res->jitter_rms_us = (float)(sqrt(var > 0 ? var : 0) * us);
+	res->jitter_pp_us = (float)((m->max_p - m->min_p) * us);
+	if (m->sum_cycle)
+		res->duty = (float)((double)m->sum_high / m->sum_cycle);
+}
+
+/**
+  * @brief Signaler une discontinuité du flux (échantillons perdus)
+  *        Aucun front ni période n'est calculé à travers la perte ; la fenêtre continue.
+  */
+void Freq_Gap (Freq_Meter *m)
+{
+	m->have_prev = 0;
+	m->have_rise = 0;
+	m->have_fall = 0;
+	m->state = -1;
+}
+
+/**
+  * @brief Traiter un bloc d'échantillons équidistants
+  * @param x : Échantillons
+  * @param count : Nombre d'échantillons
+  * @param t0 : Date du premier échantillon (ticks, peut reboucler sur 32 bits)
+  * @param dt_q8 : Intervalle entre échantillons (ticks Q8)
+  * @param res : Résultat de la fenêtre terminée
+  * @retval 1 si une fenêtre s'est terminée avec ce bloc (res rempli), 0 sinon
+  *         Les fenêtres sont closes en fin de bloc : un bloc doit être plus court qu'une fenêtre.
+  */
+int Freq_Process (Freq_Meter *m, const uint16_t *x, uint32_t count, uint32_t t0, uint32_t dt_q8, Freq_Result *res)
+{
+	const int32_t level = m->level;
+	const int32_t hi = level + m->hyst, lo = level - m->hyst;
+	int64_t t;
+
+	if (count == 0)
+		return 0;
+
+	if (!m->started) {
+		m->last_tick = t0;                           // Premier bloc : origine des temps
+		m->started = 1;
+	}
+	m->base += (int64_t)(uint32_t)(t0 - m->last_tick) * 256;  // Écart modulo 2^32 : pas de saut au rebouclage
+	m->last_tick = t0;
+	t = m->base;
+
+	for (uint32_t i = 0; i < count; i++, t += dt_q8) {
+		int32_t v = x[i];
+
+		if (m->have_prev) {
+			int32_t p = m->prev;
+			if (m->state == 0) {
+				if (p < level && v >= level)
+					m->cand = cross(m, m->prev_t, p, t, v);
+				if (v >= hi) {
+					on_rise(m, m->cand);
+					m->state = 1;
+				}
+			} else if (m->state == 1) {
+				if (p >= level && v < level)
+					m->cand = cross(m, m->prev_t, p, t, v);
+				if (v < lo) {
+					m->last_fall = m->cand;
+					m->have_fall = 1;
+					m->state = 0;
+				}
+			}
+		}
+		if (m->state < 0)
+			m->state = v >= hi ? 1 : (v < lo ? 0 : -1);
+		m->prev = (uint16_t)v;
+		m->prev_t = t;
+		m->have_prev = 1;
+	}
+
+	if (m->prev_t - m->win_start >= m->window) {
+		window_result(m, res);
+		window_reset(m, m->prev_t);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+  * @brief Construire la ligne de résultat d'une fenêtre
+  * @retval Nombre de caractères écrits
+  */
+int Freq_Format (const Freq_Result *res, char *buf, uint32_t size)
+{
+	if (res->periods == 0)
+		return snprintf(buf, size, "Freq: no signal\r\n");
+	if (res->duty < 0)
+		return snprintf(buf, size, "Freq: f=%.4f Hz, T=%.2f us, jitter=%.3f us rms / %.3f us pp, n=%lu\r\n",
+		                res->freq_hz, res->period_us, res->jitter_rms_us, res->jitter_pp_us,
+		                (unsigned long)res->periods);
+	return snprintf(buf, size, "Freq: f=%.4f Hz, T=%.2f us, jitter=%.3f us rms / %.3f us pp, duty=%.2f %%, n=%lu\r\n",
+	                res->freq_hz, res->period_us, res->jitter_rms_us, res->jitter_pp_us,
+	                res->duty * 100.0f, (unsigned long)res->periods);
+}
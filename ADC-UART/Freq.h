@@ -0,0 +1,59 @@
+#ifndef FREQ_H
+#define FREQ_H
+
+#include <stdint.h>
+
+/**
+  * @brief Mesure de fréquence par passages de seuil
+  *        Un comparateur à hystérésis confirme un front quand le signal dépasse seuil + hyst
+  *        (montant) ou passe sous seuil - hyst (descendant) ; l'instant du front est celui du
+  *        dernier franchissement du seuil, interpolé linéairement entre les deux échantillons
+  *        qui l'encadrent (précision inférieure à la période d'échantillonnage).
+  *        Le temps est exprimé dans l'unité de l'appelant (ticks, par exemple cycles DWT) ;
+  *        chaque bloc est daté, ce qui tolère des interruptions entre blocs consécutifs.
+  *        Par fenêtre : fréquence (périodes complètes entre fronts montants), gigue de
+  *        période et rapport cyclique. Module sans dépendance matérielle (Host/freqbench.c).
+  */
+
+typedef struct {
+	uint32_t periods;        // Périodes complètes dans la fenêtre
+	float    freq_hz;        // 0 si aucune période complète
+	float    period_us;
+	float    jitter_rms_us;  // Écart-type des périodes
+	float    jitter_pp_us;   // Période maximale - minimale
+	float    duty;           // Rapport cyclique (0 à 1), -1 si inconnu
+} Freq_Result;
+
+typedef struct {
+	// Réglages
+	uint16_t level;          // Seuil (LSB)
+	uint16_t hyst;           // Hystérésis (LSB, de part et d'autre du seuil)
+	uint32_t tick_hz;        // Fréquence de la base de temps
+	int64_t  window;         // Durée d'une fenêtre (ticks Q8)
+
+	// Détection (instants en ticks Q8 sur 64 bits)
+	int8_t   state;          // -1 inconnu, 0 bas, 1 haut
+	uint8_t  started;
+	uint8_t  have_rise, have_fall, have_prev;
+	uint16_t prev;
+	int64_t  prev_t;
+	int64_t  cand;           // Dernier franchissement du seuil, en attente de confirmation
+	int64_t  last_rise, last_fall;
+	uint32_t last_tick;      // Extension à 64 bits des dates de bloc
+	int64_t  base;
+
+	// Fenêtre en cours
+	int64_t  win_start;
+	uint32_t periods;
+	int64_t  p0;             // Première période : référence du calcul de variance
+	int64_t  sum_d, sum_d2;
+	int64_t  min_p, max_p;
+	int64_t  sum_high, sum_cycle;
+} Freq_Meter;
+
+void Freq_Init(Freq_Meter *m, uint16_t level, uint16_t hyst, uint32_t tick_hz, uint32_t window_ms);
+void Freq_Gap(Freq_Meter *m);
+int Freq_Process(Freq_Meter *m, const uint16_t *x, uint32_t count, uint32_t t0, uint32_t dt_q8, Freq_Result *res);
+int Freq_Format(const Freq_Result *res, char *buf, uint32_t size);
+
+#endif /* FREQ_H */
@@ -0,0 +1,61 @@
+#include "HostLink.h"
+#include "Timer_Config.h"
+
+/**
+  * @brief  Détection de la présence de l'hôte
+  *         L'émission seule ne permet pas de savoir si quelqu'un écoute : l'hôte envoie
+  *         périodiquement un octet quelconque sur la ligne RX (battement de coeur). Le lien
+  *         est considéré actif tant qu'un octet a été reçu dans les HOSTLINK_TIMEOUT_MS
+  *         dernières millisecondes.
+  *         Les octets reçus peuvent être transmis à un consommateur (acquittements du mode
+  *         fiable, Mux_Input) : HostLink reste le seul lecteur du port.
+  */
+
+static UART_Handle *link_uart;
+static uint32_t last_rx_ms;
+static int link_seen;
+static void (*link_sink)(uint8_t c);
+
+/**
+  * @brief Associer la détection à un port série
+  * @param h : Port relié à l'hôte
+  */
+void HostLink_Init (UART_Handle *h)
+{
+	link_uart = h;
+	link_seen = 0;
+	link_sink = 0;
+}
+
+/**
+  * @brief Transmettre chaque octet reçu à un consommateur
+  * @param sink : Fonction appelée par HostLink_Poll() pour chaque octet, NULL : aucune
+  */
+void HostLink_SetSink (void (*sink)(uint8_t c))
+{
+	link_sink = sink;
+}
+
+/**
+  * @brief Consommer les octets reçus et mettre à jour l'horodatage du dernier octet
+  */
+void HostLink_Poll (void)
+{
+	uint8_t c;
+
+	while (UART_TryGetChar(link_uart, &c)) {
+		last_rx_ms = Tick_GetMs();
+		link_seen = 1;
+		if (link_sink)
+			link_sink(c);
+	}
+}
+
+/**
+  * @brief Indiquer si l'hôte est présent
+  * @retval 1 si un octet a été reçu récemment
+  */
+int HostLink_IsUp (void)
+{
+	return link_seen && (Tick_GetMs() - last_rx_ms) < HOSTLINK_TIMEOUT_MS;
+}
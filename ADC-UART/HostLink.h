@@ -0,0 +1,13 @@
+#ifndef HOSTLINK_H
+#define HOSTLINK_H
+
+#include "UART_Config.h"
+
+#define HOSTLINK_TIMEOUT_MS 3000  // Lien considéré perdu sans octet reçu pendant ce délai
+
+void HostLink_Init(UART_Handle *h);
+void HostLink_SetSink(void (*sink)(uint8_t c));
+void HostLink_Poll(void);
+int HostLink_IsUp(void);
+
+#endif /* HOSTLINK_H */
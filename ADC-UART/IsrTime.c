@@ -0,0 +1,79 @@
+#include "IsrTime.h"
+#include "stm32f4xx.h"
+#include <stdio.h>
+
+/**
+  * @brief  Statistiques des interruptions
+  *         En CCM : accès sans état d'attente depuis les gestionnaires, sans conflit avec le DMA.
+  */
+
+MEM_CCM IsrTime_Stat IsrTime_Stats[ISR_COUNT];
+MEM_STATIC_ASSERT(sizeof(IsrTime_Stats) <= MEM_CCM_ISR, isr_budget);
+
+static const char *const names[ISR_COUNT] = { "systick", "adc", "adc_dma", "edge" };
+
+// Borne supérieure de la classe qui contient le 99e centile, 0 si elle déborde
+static uint32_t p99 (const IsrTime_Dist *d)
+{
+	uint32_t need = d->count - d->count / 100, acc = 0;
+
+	for (uint32_t i = 0; i < ISRTIME_BINS - 1; i++) {
+		acc += d->hist[i];
+		if (acc >= need)
+			return (i + 1) * ISRTIME_BIN_CYCLES;
+	}
+	return 0;
+}
+
+static int format_dist (const char *label, const IsrTime_Dist *d, char *buf, uint32_t size)
+{
+	uint32_t avg10 = (uint32_t)(d->sum * 10 / d->count);
+	uint32_t p = p99(d);
+
+	if (p)
+		return snprintf(buf, size, " %s=%lu/%lu.%lu/%lu p99<=%lu", label, (unsigned long)d->min,
+		                (unsigned long)(avg10 / 10), (unsigned long)(avg10 % 10), (unsigned long)d->max,
+		                (unsigned long)p);
+	return snprintf(buf, size, " %s=%lu/%lu.%lu/%lu p99>%lu", label, (unsigned long)d->min,
+	                (unsigned long)(avg10 / 10), (unsigned long)(avg10 % 10), (unsigned long)d->max,
+	                (unsigned long)((ISRTIME_BINS - 1) * ISRTIME_BIN_CYCLES));
+}
+
+/**
+  * @brief Construire la ligne de configuration : emplacement des gestionnaires et de la table
+  *        des vecteurs, états d'attente de la Flash et cache ART
+  * @retval Nombre de caractères écrits
+  */
+int IsrTime_FormatConfig (char *buf, uint32_t size)
+{
+	return snprintf(buf, size, "ISR config: code=%s, vectors=%s, flash=%lu WS, art=%s\r\n",
+	                MEM_RAM_ISR ? "sram" : "flash",
+	                MemPlan_VectorsInRam() ? "sram" : "flash",
+	                (unsigned long)(FLASH->ACR & FLASH_ACR_LATENCY),
+	                (FLASH->ACR & FLASH_ACR_ICEN) ? "on" : "off");
+}
+
+/**
+  * @brief Construire la ligne d'un gestionnaire : latence et durée, min/moyenne/max et
+  *        99e centile en cycles CPU
+  * @retval Nombre de caractères écrits (0 si aucune mesure)
+  */
+int IsrTime_Format (IsrId id, char *buf, uint32_t size)
+{
+	IsrTime_Stat s = IsrTime_Stats[id];     // Copie : le gestionnaire peut écrire pendant la mise en forme
+	int len;
+
+	if (s.run.count == 0) {
+		if (size)
+			buf[0] = '\0';
+		return 0;
+	}
+	len = snprintf(buf, size, "ISR %s: n=%lu cycles", names[id], (unsigned long)s.run.count);
+	if (s.latency.count && len < (int)size)
+		len += format_dist("lat", &s.latency, buf + len, size - len);
+	if (len < (int)size)
+		len += format_dist("run", &s.run, buf + len, size - len);
+	if (len < (int)size)
+		len += snprintf(buf + len, size - len, "\r\n");
+	return len < (int)size ? len : (int)size - 1;
+}
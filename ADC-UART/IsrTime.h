@@ -0,0 +1,63 @@
+#ifndef ISRTIME_H
+#define ISRTIME_H
+
+#include <stdint.h>
+#include "MemPlan.h"
+
+/**
+  * @brief Mesure des interruptions d'acquisition au compteur de cycles DWT
+  *        Latence : de l'événement matériel à la première instruction du gestionnaire, quand
+  *        la date de l'événement est connue (SysTick : rechargement du compteur ; flux DMA de
+  *        l'ADC : fin de la conversion qui termine le demi-anneau, à une constante près ; front
+  *        de déclenchement : date capturée par TIM2).
+  *        Durée : de la première à la dernière instruction du gestionnaire.
+  *        Distribution par classes de ISRTIME_BIN_CYCLES cycles (la dernière reçoit le reste),
+  *        cumulée depuis le démarrage, pour comparer gestionnaires en Flash et en SRAM.
+  */
+
+#define ISRTIME_BINS        16
+#define ISRTIME_BIN_CYCLES  8
+
+// Gestionnaires mesurés
+typedef enum {
+	ISR_SYSTICK = 0,
+	ISR_ADC,            // ADC_IRQHandler (débordement)
+	ISR_ADC_DMA,        // DMA2_Stream0_IRQHandler (flux de l'ADC)
+	ISR_EDGE,           // TIM2_IRQHandler (capture du front de déclenchement externe)
+	ISR_COUNT
+} IsrId;
+
+typedef struct {
+	uint32_t count;
+	uint32_t min, max;
+	uint64_t sum;
+	uint32_t hist[ISRTIME_BINS];
+} IsrTime_Dist;
+
+typedef struct {
+	IsrTime_Dist latency;
+	IsrTime_Dist run;
+} IsrTime_Stat;
+
+extern IsrTime_Stat IsrTime_Stats[ISR_COUNT];
+
+/**
+  * @brief Ajouter une mesure (appelée depuis les gestionnaires)
+  */
+static __inline MEM_RAMFUNC void IsrTime_Add(IsrTime_Dist *d, uint32_t cycles)
+{
+	uint32_t bin = cycles / ISRTIME_BIN_CYCLES;
+
+	if (d->count == 0 || cycles < d->min)
+		d->min = cycles;
+	if (cycles > d->max)
+		d->max = cycles;
+	d->sum += cycles;
+	d->count++;
+	d->hist[bin < ISRTIME_BINS ? bin : ISRTIME_BINS - 1]++;
+}
+
+int IsrTime_FormatConfig(char *buf, uint32_t size);
+int IsrTime_Format(IsrId id, char *buf, uint32_t size);
+
+#endif /* ISRTIME_H */
@@ -0,0 +1,267 @@
+#include "Loopback.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PI 3.14159265358979323846
+
+/**
+  * @brief Initialiser l'essai en paliers continus
+  */
+void Loopback_DcInit (Loopback_Dc *d)
+{
+	memset(d, 0, sizeof(*d));
+}
+
+/**
+  * @brief Ajouter un palier
+  * @param dac_code : Code appliqué au DAC
+  * @param x : Conversions acquises sur le palier, après établissement
+  * @param count : Nombre de conversions (2 au moins)
+  */
+void Loopback_DcAdd (Loopback_Dc *d, uint16_t dac_code, const uint16_t *x, uint32_t count)
+{
+	uint64_t sum = 0, sum2 = 0;
+	double mean;
+
+	if (count < 2)
+		return;
+	for (uint32_t i = 0; i < count; i++) {
+		sum += x[i];
+		sum2 += (uint32_t)x[i] * x[i];
+	}
+	mean = (double)sum / count;
+	d->var += ((double)sum2 - (double)sum * mean) / count;
+	d->sx += dac_code;
+	d->sy += mean;
+	d->sxx += (double)dac_code * dac_code;
+	d->sxy += dac_code * mean;
+	d->steps++;
+}
+
+/**
+  * @brief Terminer l'essai : droite des moindres carrés et bruit
+  * @param ideal_gain : LSB ADC par code DAC attendus (1 pour deux convertisseurs de 12 bits)
+  * @retval 1 si la droite est définie (deux paliers distincts au moins), 0 sinon
+  */
+int Loopback_DcEnd (Loopback_Dc *d, float ideal_gain)
+{
+	double n = d->steps, den = n * d->sxx - d->sx * d->sx;
+
+	if (d->steps < 2 || den <= 0)
+		return 0;
+	d->gain = (float)((n * d->sxy - d->sx * d->sy) / den);
+	d->offset = (float)((d->sy - d->gain * d->sx) / n);
+	d->gain_err = d->gain / ideal_gain - 1.0f;
+	d->noise_rms = (float)sqrt(d->var / n);
+	return 1;
+}
+
+/**
+  * @brief Construire la ligne des paliers continus
+  * @retval Nombre de caractères écrits
+  */
+int Loopback_FormatDc (const Loopback_Dc *d, char *buf, uint32_t size)
+{
+	return snprintf(buf, size, "Selftest DC: steps=%lu, offset=%+.2f LSB, gain=%+.3f %%, noise=%.2f LSB rms\r\n",
+	                (unsigned long)d->steps, d->offset, d->gain_err * 100.0f, d->noise_rms);
+}
+
+/**
+  * @brief Initialiser l'essai en rampe
+  * @param ref : Paliers continus terminés (droite de référence de l'INL)
+  * @param lo : Premier code DAC
+  * @param hi : Dernier code DAC
+  * @param per_code : Échantillons acquis sur chaque code
+  */
+void Loopback_LinInit (Loopback_Lin *l, const Loopback_Dc *ref, uint16_t lo, uint16_t hi, uint32_t per_code)
+{
+	int32_t first = (int32_t)lrintf(ref->offset + ref->gain * lo) - LOOPBACK_WINDOW / 2;
+
+	memset(l, 0, sizeof(*l));
+	l->offset = ref->offset;
+	l->gain = ref->gain;
+	l->per_code = per_code;
+	l->lo = lo;
+	l->hi = hi;
+	l->code = lo;
+	l->base = first > 0 ? (uint32_t)first : 0;
+	l->inl_min = l->dnl_min = 1e9f;
+	l->inl_max = l->dnl_max = -1e9f;
+}
+
+// Transition vers le code base (codes DAC) : entrée à laquelle la sortie atteint base
+static float transition (const Loopback_Lin *l, uint32_t below)
+{
+	return l->lo - 0.5f + (float)below / l->per_code;
+}
+
+// Terminer le code base : plus aucun échantillon ne peut lui revenir
+static void finalize (Loopback_Lin *l)
+{
+	uint32_t c = l->base, h = l->hist[c & (LOOPBACK_WINDOW - 1)];
+	float t = transition(l, l->below), t1 = transition(l, l->below + h);
+
+	if (t >= l->lo + LOOPBACK_MARGIN && t1 <= l->hi - LOOPBACK_MARGIN) {
+		float inl = l->offset + l->gain * t - (c - 0.5f);
+		float dnl = l->gain * (t1 - t) - 1.0f;
+
+		if (inl < l->inl_min) {
+			l->inl_min = inl;
+			l->inl_min_code = (uint16_t)c;
+		}
+		if (inl > l->inl_max) {
+			l->inl_max = inl;
+			l->inl_max_code = (uint16_t)c;
+		}
+		if (dnl < l->dnl_min)
+			l->dnl_min = dnl;
+		if (dnl > l->dnl_max)
+			l->dnl_max = dnl;
+		l->codes++;
+		if (h == 0)
+			l->missing++;
+	}
+	l->below += h;
+	l->hist[c & (LOOPBACK_WINDOW - 1)] = 0;
+	l->base++;
+}
+
+/**
+  * @brief Ajouter le pas suivant de la rampe (codes DAC croissants à partir de lo)
+  * @param x : per_code conversions acquises sur ce code
+  */
+void Loopback_LinAdd (Loopback_Lin *l, const uint16_t *x)
+{
+	float expect;
+
+	for (uint32_t i = 0; i < l->per_code; i++) {
+		uint32_t c = x[i];
+		if (c < l->base)
+			l->below++;
+		else if (c - l->base < LOOPBACK_WINDOW)
+			l->hist[c & (LOOPBACK_WINDOW - 1)]++;
+		else
+			l->outliers++;
+	}
+	expect = l->offset + l->gain * l->code;
+	l->code++;
+	while (l->base + LOOPBACK_WINDOW / 2 < expect)
+		finalize(l);
+}
+
+/**
+  * @brief Terminer la rampe : évaluer les codes restants de la fenêtre
+  */
+void Loopback_LinEnd (Loopback_Lin *l)
+{
+	for (uint32_t i = 0; i < LOOPBACK_WINDOW; i++) {
+		uint32_t h = l->hist[l->base & (LOOPBACK_WINDOW - 1)];
+		if (transition(l, l->below + h) > l->hi - LOOPBACK_MARGIN)
+			break;
+		finalize(l);
+	}
+}
+
+/**
+  * @brief Construire la ligne de linéarité
+  * @retval Nombre de caractères écrits
+  */
+int Loopback_FormatLin (const Loopback_Lin *l, char *buf, uint32_t size)
+{
+	if (l->codes == 0)
+		return snprintf(buf, size, "Selftest lin: no code evaluated\r\n");
+	return snprintf(buf, size, "Selftest lin: codes=%lu, missing=%lu, INL=%+.2f (%u)/%+.2f (%u) LSB, DNL=%+.2f/%+.2f LSB, outliers=%lu\r\n",
+	                (unsigned long)l->codes, (unsigned long)l->missing,
+	                l->inl_min, l->inl_min_code, l->inl_max, l->inl_max_code,
+	                l->dnl_min, l->dnl_max, (unsigned long)l->outliers);
+}
+
+/**
+  * @brief Remplir une table de sinus pour le DAC
+  * @param size : Points de la table (une période de mise à jour du DAC par point)
+  * @param cycles : Périodes du sinus dans la table, premier avec size pour balayer plus de codes
+  * @param lo, hi : Excursion (codes DAC)
+  */
+void Loopback_SineTable (uint16_t *table, uint32_t size, uint32_t cycles, uint16_t lo, uint16_t hi)
+{
+	double mid = (lo + hi) / 2.0, amp = (hi - lo) / 2.0;
+
+	for (uint32_t i = 0; i < size; i++)
+		table[i] = (uint16_t)lrint(mid + amp * sin(2 * PI * ((uint64_t)i * cycles % size) / size));
+}
+
+/**
+  * @brief Analyser un bloc de sinus échantillonné de façon cohérente
+  *        Projection sur la fondamentale et ses harmoniques (repliées), exacte quand le bloc
+  *        contient un nombre entier de périodes. Une harmonique repliée sur le continu, sur la
+  *        fréquence de Nyquist ou sur une raie déjà comptée est ignorée. Bruit : puissance
+  *        alternative restante.
+  * @param count : Échantillons du bloc
+  * @param cycles : Périodes du sinus dans le bloc
+  * @param bits : Résolution de l'ADC (pleine échelle de l'ENOB)
+  * @retval 1 si le résultat est valide, 0 sinon
+  */
+int Loopback_SineFit (const uint16_t *x, uint32_t count, uint32_t cycles, uint32_t bits, Loopback_Sine *s)
+{
+	uint32_t folds[LOOPBACK_HARMONICS];
+	double mean = 0, p_ac = 0, p1 = 0, ph = 0, pn;
+
+	memset(s, 0, sizeof(*s));
+	if (cycles == 0 || 2 * cycles >= count)
+		return 0;
+	for (uint32_t i = 0; i < count; i++)
+		mean += x[i];
+	mean /= count;
+	for (uint32_t i = 0; i < count; i++)
+		p_ac += (x[i] - mean) * (x[i] - mean);
+	p_ac /= count;
+
+	for (uint32_t k = 1; k <= LOOPBACK_HARMONICS; k++) {
+		uint32_t bin = (uint32_t)((uint64_t)k * cycles % count);
+		uint32_t fold = bin <= count / 2 ? bin : count - bin, j;
+		double a = 0, b = 0, p;
+
+		for (j = 0; j < s->harmonics && folds[j] != fold; j++)
+			;
+		if (fold == 0 || 2 * fold == count || j < s->harmonics)
+			continue;
+		for (uint32_t i = 0; i < count; i++) {
+			double w = 2 * PI * ((uint64_t)bin * i % count) / count;
+			a += (x[i] - mean) * cos(w);
+			b += (x[i] - mean) * sin(w);
+		}
+		a *= 2.0 / count;
+		b *= 2.0 / count;
+		p = (a * a + b * b) / 2;
+		if (k == 1) {
+			p1 = p;
+			s->amplitude = (float)sqrt(a * a + b * b);
+		} else {
+			ph += p;
+		}
+		folds[s->harmonics++] = fold;
+	}
+	if (p1 <= 0)
+		return 0;
+
+	pn = p_ac - p1 - ph;
+	if (pn < p1 * 1e-12)
+		pn = p1 * 1e-12;
+	s->offset = (float)mean;
+	s->snr = (float)(10 * log10(p1 / pn));
+	s->thd = ph > 0 ? (float)(10 * log10(ph / p1)) : -200.0f;
+	s->sinad = (float)(10 * log10(p1 / (pn + ph)));
+	s->enob = (float)((s->sinad - 1.76 + 20 * log10((double)(1UL << bits) / 2 / s->amplitude)) / 6.02);
+	return 1;
+}
+
+/**
+  * @brief Construire la ligne du sinus
+  * @retval Nombre de caractères écrits
+  */
+int Loopback_FormatSine (const Loopback_Sine *s, char *buf, uint32_t size)
+{
+	return snprintf(buf, size, "Selftest sine: amplitude=%.1f LSB, offset=%.1f LSB, SNR=%.2f dB, THD=%.2f dB, SINAD=%.2f dB, ENOB=%.2f bits\r\n",
+	                s->amplitude, s->offset, s->snr, s->thd, s->sinad, s->enob);
+}
@@ -0,0 +1,77 @@
+#ifndef LOOPBACK_H
+#define LOOPBACK_H
+
+#include <stdint.h>
+
+/**
+  * @brief Analyse de l'autotest en boucle DAC -> ADC
+  *        Le DAC sert d'étalon, supposé idéal : les résultats couvrent toute la chaîne (DAC,
+  *        tampon de sortie, ADC). Trois essais :
+  *        - paliers continus : droite des moindres carrés sortie / entrée (décalage, erreur de
+  *          gain) et bruit sur un palier ;
+  *        - rampe, un code DAC par pas et le même nombre d'échantillons par pas : transitions
+  *          de l'ADC par densité de codes, INL (écart des transitions à la droite des paliers)
+  *          et DNL par code, sur un histogramme glissant de LOOPBACK_WINDOW codes ; incertitude
+  *          d'une transition de l'ordre de 1 / sqrt(échantillons par code) LSB ;
+  *        - sinus échantillonné de façon cohérente (nombre entier de périodes dans le bloc) :
+  *          fondamentale et harmoniques par projection, SNR, THD, SINAD et ENOB. L'arrondi
+  *          de la table du DAC compte dans le bruit : une chaîne idéale de 12 bits donne 11,5
+  *          bits.
+  *        Module sans dépendance matérielle (Host/loopbench.c).
+  */
+
+#define LOOPBACK_WINDOW     64     // Codes suivis par l'histogramme de la rampe (puissance de 2)
+#define LOOPBACK_MARGIN     8      // Codes DAC écartés aux extrémités de la rampe
+#define LOOPBACK_HARMONICS  5      // Fondamentale comprise
+
+// Paliers continus
+typedef struct {
+	uint32_t steps;
+	double   sx, sy, sxx, sxy;     // Régression sortie (LSB ADC) / entrée (codes DAC)
+	double   var;                  // Somme des variances par palier
+	float    offset;               // Sortie extrapolée au code DAC 0 (LSB)
+	float    gain;                 // LSB ADC par code DAC
+	float    gain_err;             // Écart relatif au gain idéal
+	float    noise_rms;            // Bruit moyen sur un palier (LSB)
+} Loopback_Dc;
+
+// Rampe : transitions par densité de codes
+typedef struct {
+	float    offset, gain;         // Droite de référence (paliers)
+	uint32_t per_code;             // Échantillons par code DAC
+	uint16_t lo, hi;               // Codes DAC de la rampe
+	uint32_t code;                 // Prochain code DAC attendu
+	uint32_t hist[LOOPBACK_WINDOW];
+	uint32_t base;                 // Premier code ADC non finalisé
+	uint32_t below;                // Échantillons de code < base
+	uint32_t outliers;             // Échantillons hors de la fenêtre
+	uint32_t codes;                // Codes ADC évalués
+	uint32_t missing;              // Codes évalués jamais produits
+	float    inl_min, inl_max;     // LSB
+	float    dnl_min, dnl_max;
+	uint16_t inl_min_code, inl_max_code;
+} Loopback_Lin;
+
+// Sinus
+typedef struct {
+	float    offset, amplitude;    // LSB
+	float    snr, thd, sinad;      // dB (THD négatif)
+	float    enob;                 // Bits, ramené à la pleine échelle
+	uint8_t  harmonics;            // Harmoniques prises en compte, fondamentale comprise
+} Loopback_Sine;
+
+void Loopback_DcInit(Loopback_Dc *d);
+void Loopback_DcAdd(Loopback_Dc *d, uint16_t dac_code, const uint16_t *x, uint32_t count);
+int Loopback_DcEnd(Loopback_Dc *d, float ideal_gain);
+int Loopback_FormatDc(const Loopback_Dc *d, char *buf, uint32_t size);
+
+void Loopback_LinInit(Loopback_Lin *l, const Loopback_Dc *ref, uint16_t lo, uint16_t hi, uint32_t per_code);
+void Loopback_LinAdd(Loopback_Lin *l, const uint16_t *x);
+void Loopback_LinEnd(Loopback_Lin *l);
+int Loopback_FormatLin(const Loopback_Lin *l, char *buf, uint32_t size);
+
+void Loopback_SineTable(uint16_t *table, uint32_t size, uint32_t cycles, uint16_t lo, uint16_t hi);
+int Loopback_SineFit(const uint16_t *x, uint32_t count, uint32_t cycles, uint32_t bits, Loopback_Sine *s);
+int Loopback_FormatSine(const Loopback_Sine *s, char *buf, uint32_t size);
+
+#endif /* LOOPBACK_H */
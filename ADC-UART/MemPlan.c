@@ -0,0 +1,106 @@
+#include "MemPlan.h"
+#include "stm32f4xx.h"
+#include <stdio.h>
+
+/**
+  * @brief  Plan mémoire : mesure de la pile et occupation des régions
+  *         La pile est peinte avec MEM_STACK_PAINT au démarrage ; le plus bas mot modifié
+  *         donne le maximum de pile utilisé depuis (high-water mark).
+  *         Les bornes viennent des régions d'exécution de ADC_UART_V2.sct (ER_RAMCODE, RW_IRAM1,
+  *         RW_STACK, RW_CCM).
+  */
+
+#if defined(__CC_ARM)
+#pragma import(__use_no_heap)   // Toute référence à malloc()/free() fait échouer l'édition de liens
+#endif
+
+extern uint32_t Image$$ER_RAMCODE$$Length[];
+extern uint32_t Image$$RW_STACK$$ZI$$Base[];
+extern uint32_t Image$$RW_STACK$$ZI$$Limit[];
+extern uint32_t Image$$RW_IRAM1$$RW$$Length[];
+extern uint32_t Image$$RW_IRAM1$$ZI$$Length[];
+extern uint32_t Image$$RW_CCM$$ZI$$Length[];
+
+#define STACK_BASE   (Image$$RW_STACK$$ZI$$Base)
+#define STACK_LIMIT  (Image$$RW_STACK$$ZI$$Limit)
+
+static uint32_t ram_vectors[MEM_VECTOR_COUNT] __attribute__((aligned(512)));
+
+/**
+  * @brief Peindre la partie libre de la pile (à appeler en tout début de main())
+  *        Seuls les mots situés sous le pointeur de pile courant sont écrits.
+  */
+void MemPlan_PaintStack (void)
+{
+	uint32_t *p = STACK_BASE;
+	uint32_t *sp = (uint32_t *)__get_MSP() - 8;   // Marge pour le cadre de cette fonction
+
+	while (p < sp)
+		*p++ = MEM_STACK_PAINT;
+}
+
+/**
+  * @brief Maximum de pile utilisé depuis MemPlan_PaintStack()
+  * @retval Octets
+  */
+uint32_t MemPlan_StackUsed (void)
+{
+	const uint32_t *p = STACK_BASE;
+
+	while (p < STACK_LIMIT && *p == MEM_STACK_PAINT)
+		p++;
+	return (uint32_t)(STACK_LIMIT - p) * 4;
+}
+
+/**
+  * @brief Taille de la pile réservée
+  * @retval Octets
+  */
+uint32_t MemPlan_StackSize (void)
+{
+	return (uint32_t)(STACK_LIMIT - STACK_BASE) * 4;
+}
+
+/**
+  * @brief Construire le rapport mémoire
+  * @param buf : Tampon de sortie
+  * @param size : Taille du tampon
+  * @retval Nombre de caractères écrits
+  */
+int MemPlan_Format (char *buf, uint32_t size)
+{
+	uint32_t sram = (uint32_t)Image$$RW_IRAM1$$RW$$Length + (uint32_t)Image$$RW_IRAM1$$ZI$$Length;
+
+	return snprintf(buf, size, "Memory: stack=%lu/%lu B, ramcode=%lu/%lu B, sram=%lu/%lu B, ccm=%lu/%lu B, heap=%lu B\r\n",
+	                (unsigned long)MemPlan_StackUsed(), (unsigned long)MemPlan_StackSize(),
+	                (unsigned long)(uint32_t)Image$$ER_RAMCODE$$Length, (unsigned long)MEM_RAMCODE_SIZE,
+	                (unsigned long)sram, (unsigned long)(MEM_SRAM_SIZE - MEM_STACK_SIZE - MEM_RAMCODE_SIZE),
+	                (unsigned long)(uint32_t)Image$$RW_CCM$$ZI$$Length, (unsigned long)MEM_CCM_SIZE,
+	                (unsigned long)MEM_HEAP_SIZE);
+}
+
+/**
+  * @brief Recopier la table des vecteurs en SRAM et y faire pointer VTOR
+  *        Le vecteur lu à chaque entrée en interruption ne passe plus par la Flash. À appeler
+  *        avant d'autoriser les interruptions ; la table d'origine reste valide en Flash.
+  */
+void MemPlan_RelocateVectors (void)
+{
+	const uint32_t *src = (const uint32_t *)SCB->VTOR;
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	for (uint32_t i = 0; i < MEM_VECTOR_COUNT; i++)
+		ram_vectors[i] = src[i];
+	SCB->VTOR = (uint32_t)ram_vectors;
+	__DSB();
+	__set_PRIMASK(primask);
+}
+
+/**
+  * @brief Indiquer si la table des vecteurs active est en SRAM
+  */
+int MemPlan_VectorsInRam (void)
+{
+	return SCB->VTOR == (uint32_t)ram_vectors;
+}
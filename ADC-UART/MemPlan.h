@@ -0,0 +1,82 @@
+#ifndef MEMPLAN_H
+#define MEMPLAN_H
+
+#include <stdint.h>
+
+/**
+  * @brief Plan mémoire statique
+  *        SRAM (0x20000000, 128 Ko) : gestionnaires d'interruption (MEM_RAMFUNC), données ordinaires,
+  *                                    pile, et tout tampon lu ou écrit par DMA.
+  *        CCM  (0x10000000, 64 Ko)  : tampons d'acquisition et état chaud, accès CPU seul, sans
+  *                                    conflit avec le DMA. Le DMA n'atteint pas la CCM : un tampon
+  *                                    passé à UART_WriteDMA() ne doit jamais être placé en CCM.
+  *        Tas : aucun (Heap_Size = 0 dans startup_stm32f407xx.s, malloc() refusé à l'édition de liens).
+  *        Le placement est fait par ADC_UART_V2.sct ; ce fichier répartit le budget CCM entre les
+  *        modules, chacun vérifiant à la compilation que ses tampons tiennent dans sa part.
+  */
+
+#define MEM_SRAM_SIZE       0x20000
+#define MEM_CCM_SIZE        0x10000
+#define MEM_STACK_SIZE      0x400     // Stack_Size de startup_stm32f407xx.s
+#define MEM_HEAP_SIZE       0         // Heap_Size de startup_stm32f407xx.s
+
+// Budget CCM par propriétaire (octets)
+#define MEM_CCM_ACQ         0x2000    // Tampons d'acquisition (main.c)
+#define MEM_CCM_FLASHLOG    0x0400    // File d'attente et état du journal Flash
+#define MEM_CCM_FILTER      0x0800    // Coefficients et état des filtres par canal
+#define MEM_CCM_MUX         0x1400    // Files d'attente du multiplexeur de flux
+#define MEM_CCM_ISR         0x0400    // Statistiques des interruptions (IsrTime.c)
+#define MEM_CCM_ARQ         0x2400    // Fenêtre de retransmission du mode fiable (Mux.c)
+#define MEM_CCM_TRACE       0x1400    // Anneau de la trace d'événements (Trace.c), en haut de la CCM
+#define MEM_CCM_FREE        (MEM_CCM_SIZE - MEM_CCM_ACQ - MEM_CCM_FLASHLOG - MEM_CCM_FILTER - MEM_CCM_MUX - MEM_CCM_ISR - MEM_CCM_ARQ - MEM_CCM_TRACE)
+
+// Motif de peinture de la pile
+#define MEM_STACK_PAINT     0xC5C5C5C5u
+
+// Placement d'une variable en CCM (zéro-initialisée au démarrage)
+#if defined(__CC_ARM)
+#define MEM_CCM             __attribute__((section(".ccmram"), zero_init))
+#else
+#define MEM_CCM             __attribute__((section(".ccmram")))
+#endif
+
+// Placement en CCM sans initialisation (région RW_TRACE) : le contenu survit à un reset
+#if defined(__CC_ARM)
+#define MEM_NOINIT          __attribute__((section(".ccmnoinit"), zero_init))
+#else
+#define MEM_NOINIT          __attribute__((section(".ccmnoinit")))
+#endif
+
+/**
+  * Exécution en SRAM (région ER_RAMCODE de ADC_UART_V2.sct, MEM_RAMCODE_SIZE octets, copiée au
+  * démarrage) : la durée d'un gestionnaire ne dépend plus des succès du cache ART devant les
+  * 5 états d'attente de la Flash. La CCM n'est pas exécutable (bus D seul). Les appels entre
+  * Flash et SRAM passent par des relais ajoutés par l'éditeur de liens.
+  * Option de compilation MEM_RAM_ISR=0 : tout reste en Flash (mesure de référence).
+  */
+#ifndef MEM_RAM_ISR
+#define MEM_RAM_ISR         1
+#endif
+#define MEM_RAMCODE_SIZE    0x800
+#if MEM_RAM_ISR
+#define MEM_RAMFUNC         __attribute__((section(".ramfunc")))
+#else
+#define MEM_RAMFUNC
+#endif
+
+// Table des vecteurs en SRAM : 16 exceptions + 82 interruptions, alignée sur 512 octets (VTOR)
+#define MEM_VECTOR_COUNT    98
+
+// Vérification à la compilation : un tableau de taille négative arrête la compilation
+#define MEM_STATIC_ASSERT(cond, name)  typedef char mem_assert_##name[(cond) ? 1 : -1]
+
+MEM_STATIC_ASSERT(MEM_CCM_ACQ + MEM_CCM_FLASHLOG + MEM_CCM_FILTER + MEM_CCM_MUX + MEM_CCM_ISR + MEM_CCM_ARQ + MEM_CCM_TRACE <= MEM_CCM_SIZE, ccm_budget);
+
+void MemPlan_PaintStack(void);
+uint32_t MemPlan_StackUsed(void);
+uint32_t MemPlan_StackSize(void);
+int MemPlan_Format(char *buf, uint32_t size);
+void MemPlan_RelocateVectors(void);
+int MemPlan_VectorsInRam(void);
+
+#endif /* MEMPLAN_H */
@@ -0,0 +1,358 @@
+#include "Mux.h"
+#include "Arq.h"
+#include "Frame.h"
+#include "HostLink.h"
+#include "MemPlan.h"
+#include "Timer_Config.h"
+#include "Trace.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+  * @brief  Multiplexeur de flux
+  *         Les charges utiles attendent en CCM (lues par le CPU seulement) ; la trame en cours
+  *         d'émission est encodée dans un tampon en SRAM lu par le DMA de l'UART, ce qui libère
+  *         sa place dans la file dès le début de l'émission.
+  *         Parts de débit : à chaque trame émise de L octets, chaque flux en attente gagne
+  *         part x L / 100 de crédit et le flux émetteur perd L. Un flux de crédit positif est
+  *         servi en priorité ; sinon l'ordre de priorité s'applique. Un flux vide n'accumule
+  *         pas de crédit.
+  *         Mode fiable (Mux_SetReliable) : les trames réémises par Arq.c passent avant toute
+  *         trame nouvelle, sans toucher aux crédits ; une trame nouvelle n'est prise dans les
+  *         files que si la fenêtre de retransmission a de la place, sinon les files se
+  *         remplissent et les flux non abandonnables font attendre leur émetteur.
+  */
+
+#define TOTAL_SLOTS  (MUX_DATA_SLOTS + MUX_TEL_SLOTS + MUX_LOG_SLOTS)
+#define CREDIT_MAX   FRAME_MAX_SIZE
+
+typedef struct {
+	uint8_t type;
+	uint8_t len;
+	uint8_t data[FRAME_MAX_PAYLOAD];
+} Slot;
+
+typedef struct {
+	uint8_t      first;        // Première place dans pool
+	uint8_t      depth;
+	uint8_t      head;
+	uint8_t      count;
+	uint8_t      share;        // Part garantie du débit (%)
+	uint8_t      droppable;
+	uint32_t     rate_bps;     // Limite de débit (octets/s), 0 : aucune
+	uint32_t     burst;
+	uint32_t     tokens;
+	uint32_t     last_ms;
+	int32_t      credit;
+	Mux_Counters c;
+	uint32_t     report_bytes; // Octets au rapport précédent
+} Stream;
+
+static MEM_CCM Slot pool[TOTAL_SLOTS];
+MEM_STATIC_ASSERT(sizeof(pool) <= MEM_CCM_MUX, mux_budget);
+static MEM_CCM Arq arq;
+MEM_STATIC_ASSERT(sizeof(arq) <= MEM_CCM_ARQ, arq_budget);
+
+static uint8_t tx[FRAME_MAX_SIZE];
+static Stream streams[MUX_STREAMS];
+static UART_Handle *link;
+static int framed;
+static int reliable;
+static uint16_t seq;
+static uint32_t report_ms;
+
+static const char *const names[MUX_STREAMS] = { "data", "tel", "log" };
+
+/**
+  * @brief Initialiser le multiplexeur (parts par défaut : données 70 %, télémétrie 20 %,
+  *        journal 10 % ; seul le journal est abandonnable)
+  * @param uart : Port de données (déjà initialisé)
+  * @param binary : 1 : trames binaires ; 0 : charges utiles texte brutes
+  */
+void Mux_Init (UART_Handle *uart, int binary)
+{
+	static const uint8_t depth[MUX_STREAMS] = { MUX_DATA_SLOTS, MUX_TEL_SLOTS, MUX_LOG_SLOTS };
+	uint8_t first = 0;
+
+	memset(streams, 0, sizeof(streams));
+	for (int s = 0; s < MUX_STREAMS; s++) {
+		streams[s].first = first;
+		streams[s].depth = depth[s];
+		first += depth[s];
+	}
+	link = uart;
+	framed = binary;
+	reliable = 0;
+	seq = 0;
+	report_ms = Tick_GetMs();
+
+	Mux_Config(MUX_DATA, 70, 0, 0, 0);
+	Mux_Config(MUX_TELEMETRY, 20, 0, 0, 0);
+	Mux_Config(MUX_LOG, 10, 0, 0, 1);
+}
+
+/**
+  * @brief Régler un flux
+  * @param stream : MUX_DATA, MUX_TELEMETRY ou MUX_LOG
+  * @param share : Part garantie du débit (%, total 100)
+  * @param rate_bps : Débit maximal en octets/s (0 : illimité)
+  * @param burst : Rafale tolérée par le limiteur (octets)
+  * @param droppable : 1 : trame refusée si la file est pleine ; 0 : l'émetteur attend
+  */
+void Mux_Config (uint8_t stream, uint8_t share, uint32_t rate_bps, uint32_t burst, int droppable)
+{
+	Stream *s = &streams[stream];
+
+	s->share = share;
+	s->rate_bps = rate_bps;
+	s->burst = burst;
+	s->tokens = burst;
+	s->last_ms = Tick_GetMs();
+	s->droppable = (uint8_t)droppable;
+}
+
+// Recharger le seau à jetons d'un flux limité
+static void refill (Stream *s)
+{
+	uint32_t now = Tick_GetMs();
+	uint32_t add = (uint32_t)((uint64_t)s->rate_bps * (now - s->last_ms) / 1000);
+
+	if (add) {
+		s->tokens = s->tokens + add > s->burst ? s->burst : s->tokens + add;
+		s->last_ms = now;
+	}
+}
+
+/**
+  * @brief Réserver la place d'une charge utile dans la file d'un flux
+  *        Flux non abandonnable plein : attente (en faisant avancer l'émission).
+  * @param stream : Flux
+  * @param length : Taille prévue (FRAME_MAX_PAYLOAD au plus), pour la limite de débit
+  * @retval Zone à remplir, NULL si la trame est abandonnée
+  */
+uint8_t *Mux_Reserve (uint8_t stream, uint32_t length)
+{
+	Stream *s = &streams[stream];
+
+	if (length > FRAME_MAX_PAYLOAD)
+		return 0;
+	if (s->rate_bps) {
+		refill(s);
+		if (s->tokens < length) {
+			s->c.dropped_rate++;
+			TRACE(TRACE_MUX_DROP, stream);
+			return 0;
+		}
+	}
+	if (s->count == s->depth) {
+		if (s->droppable) {
+			s->c.dropped_full++;
+			TRACE(TRACE_MUX_DROP, stream);
+			return 0;
+		}
+		s->c.waits++;
+		TRACE(TRACE_MUX_WAIT_BEGIN, stream);
+		while (s->count == s->depth)
+			Mux_Poll();
+		TRACE(TRACE_MUX_WAIT_END, stream);
+	}
+	return pool[s->first + (s->head + s->count) % s->depth].data;
+}
+
+/**
+  * @brief Valider la charge utile réservée et lancer l'émission si le lien est libre
+  * @param stream : Flux
+  * @param type : Type de trame (FRAME_*)
+  * @param length : Taille effective
+  */
+void Mux_Commit (uint8_t stream, uint8_t type, uint32_t length)
+{
+	Stream *s = &streams[stream];
+	Slot *slot = &pool[s->first + (s->head + s->count) % s->depth];
+
+	slot->type = type;
+	slot->len = (uint8_t)length;
+	s->count++;
+	if (s->rate_bps)
+		s->tokens = s->tokens > length ? s->tokens - length : 0;
+	Mux_Poll();
+}
+
+/**
+  * @brief Mettre une charge utile en file (copie)
+  * @retval 0 si acceptée, -1 si abandonnée
+  */
+int Mux_Send (uint8_t stream, uint8_t type, const void *payload, uint32_t length)
+{
+	uint8_t *p = Mux_Reserve(stream, length);
+
+	if (!p)
+		return -1;
+	memcpy(p, payload, length);
+	Mux_Commit(stream, type, length);
+	return 0;
+}
+
+/**
+  * @brief Places libres dans la file d'un flux
+  */
+uint32_t Mux_Space (uint8_t stream)
+{
+	return streams[stream].depth - streams[stream].count;
+}
+
+// Flux à servir : crédit positif d'abord, puis priorité
+static int pick (void)
+{
+	int fallback = -1;
+
+	for (int i = 0; i < MUX_STREAMS; i++) {
+		if (!streams[i].count)
+			continue;
+		if (streams[i].credit >= 0)
+			return i;
+		if (fallback < 0)
+			fallback = i;
+	}
+	return fallback;
+}
+
+// Émettre la trame en tête de la file d'un flux
+static void emit (int i)
+{
+	Stream *s = &streams[i];
+	Slot *slot = &pool[s->first + s->head];
+	uint32_t n;
+
+	if (framed)
+		n = Frame_Encode(tx, FRAME_TAG(i, slot->type), seq++, slot->data, slot->len);
+	else {
+		memcpy(tx, slot->data, slot->len);
+		n = slot->len;
+	}
+	s->head = (uint8_t)((s->head + 1) % s->depth);
+	s->count--;
+	UART_WriteDMA(link, tx, n);
+	if (reliable)
+		Arq_Sent(&arq, tx, n, Tick_GetMs());
+
+	s->c.frames++;
+	s->c.bytes += n;
+	for (int k = 0; k < MUX_STREAMS; k++) {
+		Stream *o = &streams[k];
+		if (k == i)
+			o->credit -= (int32_t)n;
+		if (o->count || k == i) {
+			o->credit += (int32_t)(o->share * n / 100);
+			if (o->credit > CREDIT_MAX)
+				o->credit = CREDIT_MAX;
+			if (o->credit < -CREDIT_MAX)
+				o->credit = -CREDIT_MAX;
+		} else if (o->credit > 0) {
+			o->credit = 0;                 // Flux vide : pas d'accumulation
+		}
+	}
+}
+
+/**
+  * @brief Faire avancer l'émission : si le lien est libre, émettre la trame suivante
+  *        À appeler régulièrement (boucle principale, attente de période).
+  * @retval Trames en file, à réémettre ou en cours d'émission (0 : tout est parti)
+  */
+uint32_t Mux_Poll (void)
+{
+	uint32_t pending = 0, n;
+	int i;
+
+	if (reliable)
+		HostLink_Poll();               // Acquittements, y compris pendant une attente de place
+	if (!UART_TxBusy(link)) {
+		if (reliable && (n = Arq_Resend(&arq, Tick_GetMs(), tx)) != 0) {
+			UART_WriteDMA(link, tx, n);
+			i = FRAME_STREAM(tx[2]);
+			if (i < MUX_STREAMS)
+				streams[i].c.bytes += n;
+		} else if ((i = pick()) >= 0 && (!reliable || Arq_CanSend(&arq, Tick_GetMs()))) {
+			emit(i);
+		}
+	}
+
+	for (i = 0; i < MUX_STREAMS; i++)
+		pending += streams[i].count;
+	if (reliable)
+		pending += Arq_Pending(&arq);
+	return pending + (UART_TxBusy(link) ? 1 : 0);
+}
+
+/**
+  * @brief Activer ou couper le mode fiable (Arq.h), trames binaires seulement
+  *        Les octets reçus de l'hôte doivent parvenir à Mux_Input() (HostLink_SetSink) ;
+  *        Mux_Poll() lit alors le port (HostLink_Poll), HostLink doit être initialisé.
+  * @retval 0, -1 en mode texte
+  */
+int Mux_SetReliable (int on)
+{
+	if (on && !framed)
+		return -1;
+	if (on && !reliable)
+		Arq_Init(&arq, seq, Tick_GetMs());
+	reliable = on;
+	return 0;
+}
+
+/**
+  * @brief Traiter un octet reçu de l'hôte (acquittements du mode fiable)
+  */
+void Mux_Input (uint8_t c)
+{
+	if (reliable)
+		Arq_Input(&arq, c, Tick_GetMs());
+}
+
+/**
+  * @brief Émettre tout ce qui est en file et attendre la fin de l'émission
+  */
+void Mux_Flush (void)
+{
+	while (Mux_Poll())
+		;
+}
+
+/**
+  * @brief Copier les compteurs d'un flux
+  */
+void Mux_GetCounters (uint8_t stream, Mux_Counters *c)
+{
+	*c = streams[stream].c;
+}
+
+/**
+  * @brief Construire la ligne de débit et de pertes par flux depuis le rapport précédent
+  * @retval Nombre de caractères écrits
+  */
+int Mux_Format (char *buf, uint32_t size)
+{
+	uint32_t now = Tick_GetMs();
+	uint32_t dt = now - report_ms ? now - report_ms : 1;
+	int len = snprintf(buf, size, "Mux:");
+
+	for (int i = 0; i < MUX_STREAMS && len < (int)size; i++) {
+		Stream *s = &streams[i];
+		len += snprintf(buf + len, size - len, " %s=%lu B/s drop=%lu+%lu%s", names[i],
+		                (unsigned long)((uint64_t)(s->c.bytes - s->report_bytes) * 1000 / dt),
+		                (unsigned long)s->c.dropped_full, (unsigned long)s->c.dropped_rate,
+		                i < MUX_STREAMS - 1 ? "," : "\r\n");
+		s->report_bytes = s->c.bytes;
+	}
+	report_ms = now;
+	return len < (int)size ? len : (int)size - 1;
+}
+
+/**
+  * @brief Construire la ligne d'état du mode fiable
+  * @retval Nombre de caractères écrits, 0 hors mode fiable
+  */
+int Mux_FormatArq (char *buf, uint32_t size)
+{
+	return reliable ? Arq_Format(&arq, buf, size) : 0;
+}
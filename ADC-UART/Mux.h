@@ -0,0 +1,53 @@
+#ifndef MUX_H
+#define MUX_H
+
+#include <stdint.h>
+#include "UART_Config.h"
+
+/**
+  * @brief Multiplexage de plusieurs flux sur le port de données
+  *        Chaque flux a sa file de trames ; l'identifiant du flux est porté par l'octet type
+  *        de la trame (FRAME_TAG, Frame.h). Le numéro de séquence est attribué à l'émission :
+  *        l'hôte détecte toujours les pertes sur le lien.
+  *        Ordonnancement : par priorité (flux 0 d'abord), corrigée par des parts de débit
+  *        garanties : un flux resté sous sa part passe avant un flux plus prioritaire. Un flux
+  *        non abandonnable (données, télémétrie) fait attendre l'émetteur quand sa file est
+  *        pleine ; un flux abandonnable (journal) perd la trame. Tout flux peut être limité en
+  *        débit (seau à jetons) : au-delà, la trame est perdue.
+  *        En mode texte, les charges utiles sont émises telles quelles, sans en-tête.
+  *        Mode fiable en option (Mux_SetReliable) : retransmission sélective, voir Arq.h.
+  */
+
+#define MUX_DATA        0     // Échantillons, relus, marqueurs de perte
+#define MUX_TELEMETRY   1     // Enregistrement de démarrage, rapports
+#define MUX_LOG         2     // Journal de mise au point
+#define MUX_STREAMS     3
+
+// Profondeur des files (trames)
+#define MUX_DATA_SLOTS  8
+#define MUX_TEL_SLOTS   4
+#define MUX_LOG_SLOTS   4
+
+typedef struct {
+	uint32_t frames;         // Trames émises
+	uint32_t bytes;          // Octets émis (en-têtes compris)
+	uint32_t dropped_full;   // Refusées : file pleine
+	uint32_t dropped_rate;   // Refusées : limite de débit
+	uint32_t waits;          // Flux non abandonnable : attentes d'une place libre
+} Mux_Counters;
+
+void Mux_Init(UART_Handle *uart, int binary);
+void Mux_Config(uint8_t stream, uint8_t share, uint32_t rate_bps, uint32_t burst, int droppable);
+uint8_t *Mux_Reserve(uint8_t stream, uint32_t length);
+void Mux_Commit(uint8_t stream, uint8_t type, uint32_t length);
+int Mux_Send(uint8_t stream, uint8_t type, const void *payload, uint32_t length);
+uint32_t Mux_Space(uint8_t stream);
+uint32_t Mux_Poll(void);
+void Mux_Flush(void);
+int Mux_SetReliable(int on);
+void Mux_Input(uint8_t c);
+void Mux_GetCounters(uint8_t stream, Mux_Counters *c);
+int Mux_Format(char *buf, uint32_t size);
+int Mux_FormatArq(char *buf, uint32_t size);
+
+#endif /* MUX_H */
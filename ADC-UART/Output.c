@@ -0,0 +1,93 @@
+#include "Output.h"
+#include "ASCII_Config.h"
+#include "Frame.h"
+#include "Pack.h"
+#include "Mux.h"
+#include "Dsp.h"
+#include "Filter.h"
+#include "Deadband.h"
+#include "Trace.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+  * @brief Traiter une rafale en place : étalonnage, filtre, puis bande morte
+  * @param c : Étages actifs et coût mesuré du filtre
+  * @param raw : Rafale, modifiée en place
+  * @param count : Nombre d'échantillons
+  * @param channel : Canal (filtre et bande morte propres au canal)
+  * @param bits : Résolution de la conversion
+  * @param now_ms : Heure, pour le battement de coeur de la bande morte
+  * @retval Nombre d'échantillons à émettre ou journaliser (0 ou 1 avec la bande morte,
+  *         dans raw[0])
+  */
+uint32_t Output_Process (Output_Chain *c, uint16_t *raw, uint32_t count, uint8_t channel, uint32_t bits,
+                         uint32_t now_ms)
+{
+	if (c->cal_offset != 0 || c->cal_gain != 16384)
+		Dsp_OffsetGain(raw, raw, count, c->cal_offset, c->cal_gain, bits);
+
+	if (c->filter) {
+		// Horloge de la trace : compteur de cycles sur la carte, temps simulé sur PC
+		uint32_t c0 = TRACE_CLOCK();
+		Filter_Process(Filter_Channel(channel), bits, raw, raw, count);
+		c->filter_cycles += TRACE_CLOCK() - c0;
+		c->filter_samples += count;
+	}
+
+	if (c->deadband && count) {
+		// Rafale réduite à sa moyenne
+		raw[0] = Dsp_Mean(raw, count);
+		count = Deadband_Check(Deadband_Channel(channel), raw[0], now_ms) != DEADBAND_SUPPRESS;
+	}
+	return count;
+}
+
+/**
+  * @brief Construire la ligne texte d'un échantillon
+  * @param msg : Tampon de sortie (OUTPUT_LINE_SIZE octets)
+  * @param raw : Valeur brute ADC
+  * @param bits : Résolution de la conversion
+  */
+void Output_FormatSample (char *msg, uint16_t raw, uint32_t bits)
+{
+	// Calculer la tension en volts (pleine échelle au plus, même sur une valeur hors résolution)
+	float vin = raw * (3.3f / (1U << bits));
+	if (!(vin >= 0.0f && vin <= 3.3f))
+		vin = 3.3f;
+
+	// Convertir la valeur brute ADC en chaîne ASCII
+	char msg2[SHIFT_DIGITS_SIZE];
+	shift_digits(raw, msg2);
+
+	// Construire le message final : 5 chiffres au plus, 45 caractères sur OUTPUT_LINE_SIZE
+	snprintf(msg, OUTPUT_LINE_SIZE, "ASCII Code: %.*s, Voltage: %.2f V\r\n", OUTPUT_DIGITS_MAX, msg2, vin);
+}
+
+/**
+  * @brief Envoyer un bloc d'échantillons en direct
+  *        En binaire, une trame compactée à la résolution donnée ; en texte, une ligne par
+  *        échantillon.
+  * @param raw : Échantillons
+  * @param count : Nombre d'échantillons (FRAME_PACKED_MAX(bits) au plus en binaire)
+  * @param t_us : Date du premier échantillon
+  * @param channel : Canal
+  * @param bits : Résolution de la conversion
+  * @param binary : 1 : trame compactée, 0 : lignes texte
+  */
+void Output_SendBlock (const uint16_t *raw, uint32_t count, uint32_t t_us, uint8_t channel,
+                       uint32_t bits, int binary)
+{
+	if (binary) {
+		// Compactage directement dans la file du flux de données
+		uint8_t *p = Mux_Reserve(MUX_DATA, FRAME_PACKED_HDR + Pack_Bytes(bits, count));
+		if (p)
+			Mux_Commit(MUX_DATA, FRAME_PACKED, Frame_PutPacked(p, t_us, channel, (uint8_t)bits, raw, (uint8_t)count));
+		return;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		char msg[OUTPUT_LINE_SIZE];
+		Output_FormatSample(msg, raw[i], bits);
+		Mux_Send(MUX_DATA, 0, msg, strlen(msg));
+	}
+}
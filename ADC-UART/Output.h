@@ -0,0 +1,34 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdint.h>
+
+/**
+  * @brief Traitement et sortie des rafales d'échantillons
+  *        Étages de la carte dans leur ordre (étalonnage, filtre, bande morte), puis envoi sur
+  *        le flux de données du multiplexeur (Mux.h) : trame compactée (FRAME_PACKED) ou une
+  *        ligne texte par échantillon. Module sans dépendance matérielle : résolution, format
+  *        et heure sont fournis par l'appelant, ce qui permet au banc de capacité
+  *        (Host/capbench.c) d'exécuter le même code que la boucle principale.
+  */
+
+#define OUTPUT_LINE_SIZE  64   // Ligne texte d'un échantillon, '\0' compris
+#define OUTPUT_DIGITS_MAX 14   // Codes ASCII de 5 chiffres au plus ("54 53 53 51 53")
+
+// Étages de traitement d'une rafale
+typedef struct {
+	int16_t  cal_offset;       // Étalonnage (Dsp_OffsetGain), sans effet à 0 et 16384
+	int16_t  cal_gain;         // Q14
+	uint8_t  filter;           // Filtre du canal (Filter_Channel)
+	uint8_t  deadband;         // Moyenne de la rafale soumise à la bande morte du canal
+	uint32_t filter_cycles;    // Coût mesuré du filtrage (horloge de la trace)
+	uint32_t filter_samples;
+} Output_Chain;
+
+uint32_t Output_Process(Output_Chain *c, uint16_t *raw, uint32_t count, uint8_t channel, uint32_t bits,
+                        uint32_t now_ms);
+void Output_FormatSample(char *msg, uint16_t raw, uint32_t bits);
+void Output_SendBlock(const uint16_t *raw, uint32_t count, uint32_t t_us, uint8_t channel,
+                      uint32_t bits, int binary);
+
+#endif /* OUTPUT_H */
@@ -0,0 +1,68 @@
+#include "Pack.h"
+
+/**
+  * @brief Taille compactée d'un bloc
+  * @param bits : Résolution (6, 8, 10 ou 12)
+  * @param count : Nombre d'échantillons
+  * @retval Nombre d'octets
+  */
+uint32_t Pack_Bytes (uint32_t bits, uint32_t count)
+{
+	return (bits * count + 7) / 8;
+}
+
+/**
+  * @brief Compacter un bloc d'échantillons
+  * @param bits : Résolution (6, 8, 10 ou 12)
+  * @param in : Valeurs brutes (alignées à droite)
+  * @param count : Nombre d'échantillons
+  * @param out : Tampon de sortie (Pack_Bytes(bits, count) octets)
+  * @retval Nombre d'octets écrits
+  */
+uint32_t Pack_Samples (uint32_t bits, const uint16_t *in, uint32_t count, uint8_t *out)
+{
+	uint32_t acc = 0, nacc = 0, n = 0;
+	uint32_t mask = (1U << bits) - 1;
+
+	if (bits == 8) {
+		for (n = 0; n < count; n++)
+			out[n] = (uint8_t)in[n];
+		return count;
+	}
+
+	while (count--) {
+		acc |= (*in++ & mask) << nacc;
+		nacc += bits;
+		while (nacc >= 8) {
+			out[n++] = (uint8_t)acc;
+			acc >>= 8;
+			nacc -= 8;
+		}
+	}
+	if (nacc)
+		out[n++] = (uint8_t)acc;
+	return n;
+}
+
+/**
+  * @brief Décompacter un bloc d'échantillons
+  * @param bits : Résolution (6, 8, 10 ou 12)
+  * @param in : Données compactées
+  * @param count : Nombre d'échantillons
+  * @param out : Valeurs brutes
+  */
+void Pack_Unpack (uint32_t bits, const uint8_t *in, uint32_t count, uint16_t *out)
+{
+	uint32_t acc = 0, nacc = 0;
+	uint32_t mask = (1U << bits) - 1;
+
+	while (count--) {
+		while (nacc < bits) {
+			acc |= (uint32_t)*in++ << nacc;
+			nacc += 8;
+		}
+		*out++ = (uint16_t)(acc & mask);
+		acc >>= bits;
+		nacc -= bits;
+	}
+}
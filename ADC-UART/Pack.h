@@ -0,0 +1,18 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include <stdint.h>
+
+/**
+  * @brief Compactage des échantillons selon leur résolution
+  *        Les valeurs sont concaténées en flux de bits, bit de poids faible en premier :
+  *           12 bits : 2 échantillons sur 3 octets   10 bits : 4 échantillons sur 5 octets
+  *            8 bits : 1 échantillon par octet        6 bits : 4 échantillons sur 3 octets
+  *        Module sans dépendance matérielle, partagé avec les outils PC du dossier Host.
+  */
+
+uint32_t Pack_Bytes(uint32_t bits, uint32_t count);
+uint32_t Pack_Samples(uint32_t bits, const uint16_t *in, uint32_t count, uint8_t *out);
+void Pack_Unpack(uint32_t bits, const uint8_t *in, uint32_t count, uint16_t *out);
+
+#endif /* PACK_H */
@@ -0,0 +1,268 @@
+#include "Pipeline.h"
+
+#if defined(APP_RTOS) && APP_RTOS
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+  * @brief  Tâches d'acquisition, de traitement et de transport
+  *         Trois files de pointeurs relient les tâches : libres -> traitement -> transport -> libres.
+  *         Toute la mémoire (blocs, files, piles, TCB) est statique (configSUPPORT_STATIC_ALLOCATION).
+  *         Une quatrième tâche, de priorité minimale, publie périodiquement la charge CPU et la
+  *         pile jamais atteinte de chaque tâche ; ses lignes passent par la file de transport
+  *         pour ne pas s'intercaler au milieu d'une trame, coupées entre deux lignes en trames
+  *         d'au plus PIPELINE_TEXT_MAX octets.
+  */
+
+#define PRIO_ACQ    (configMAX_PRIORITIES - 1)
+#define PRIO_PROC   (configMAX_PRIORITIES - 2)
+#define PRIO_TX     (configMAX_PRIORITIES - 3)
+#define PRIO_STATS  (tskIDLE_PRIORITY + 1)
+
+#define IDLE_POLL_MS  10   // Appel de driver->idle quand le transport n'a rien à émettre
+
+static Pipeline_Block blocks[PIPELINE_BLOCKS];
+static const Pipeline_Driver *drv;
+static uint32_t period_ms, report_ms;
+static Pipeline_Stats stats;
+static volatile TickType_t acq_next;        // Prochain réveil de la tâche d'acquisition
+static volatile uint32_t reserve_ms;        // Fenêtre d'inactivité demandée (Pipeline_Reserve)
+
+static QueueHandle_t free_q, proc_q, tx_q;
+static StaticQueue_t free_qs, proc_qs, tx_qs;
+static uint8_t free_store[PIPELINE_BLOCKS * sizeof(Pipeline_Block *)];
+static uint8_t proc_store[PIPELINE_BLOCKS * sizeof(Pipeline_Block *)];
+static uint8_t tx_store[PIPELINE_BLOCKS * sizeof(Pipeline_Block *)];
+
+static StaticTask_t acq_tcb, proc_tcb, tx_tcb, stats_tcb, idle_tcb;
+static StackType_t acq_stack[PIPELINE_STACK_ACQ];
+static StackType_t proc_stack[PIPELINE_STACK_PROC];
+static StackType_t tx_stack[PIPELINE_STACK_TX];
+static StackType_t stats_stack[PIPELINE_STACK_STATS];
+static StackType_t idle_stack[configMINIMAL_STACK_SIZE];
+
+// Temps d'exécution au rapport précédent, pour une charge calculée sur la dernière période
+static uint32_t prev_run[PIPELINE_MAX_TASKS + 1];
+static uint32_t prev_total;
+static char report[PIPELINE_MAX_TASKS * 48 + 96];   // Rapport complet, hors de la pile de la tâche
+
+// Acquisition : cadence fixe, jamais bloquée par l'aval
+static void acq_task (void *arg)
+{
+	TickType_t last = xTaskGetTickCount();
+	Pipeline_Block *b;
+
+	(void)arg;
+	for (;;) {
+		if (xTaskDelayUntil(&last, pdMS_TO_TICKS(period_ms)) == pdFALSE)
+			stats.late++;
+
+		if (xQueueReceive(free_q, &b, 0) != pdPASS) {
+			stats.dropped++;                   // Aval saturé : la période est perdue
+			continue;
+		}
+		b->kind = PIPELINE_SAMPLES;
+		b->lost = 0;
+		drv->acquire(b);
+		if (reserve_ms) {
+			// Fenêtre demandée : sauter les périodes qui la couvrent, en comptant le passage du
+			// bloc par le traitement et l'attente du transport avant son appel à driver->idle
+			TickType_t want = xTaskGetTickCount() + pdMS_TO_TICKS(reserve_ms + 2 * IDLE_POLL_MS);
+			TickType_t due = last + pdMS_TO_TICKS(period_ms);
+			if ((int32_t)(want - due) > 0) {
+				uint32_t skip = (want - due + pdMS_TO_TICKS(period_ms) - 1) / pdMS_TO_TICKS(period_ms);
+				last += skip * pdMS_TO_TICKS(period_ms);
+				stats.skipped += skip;
+			}
+			reserve_ms = 0;
+		}
+		acq_next = last + pdMS_TO_TICKS(period_ms);
+		stats.acquired++;
+		xQueueSend(proc_q, &b, portMAX_DELAY);  // Jamais pleine : PIPELINE_BLOCKS places
+	}
+}
+
+static void proc_task (void *arg)
+{
+	Pipeline_Block *b;
+
+	(void)arg;
+	for (;;) {
+		xQueueReceive(proc_q, &b, portMAX_DELAY);
+		if (drv->process)
+			drv->process(b);
+		stats.processed++;
+		xQueueSend(tx_q, &b, portMAX_DELAY);
+	}
+}
+
+static void tx_task (void *arg)
+{
+	TickType_t wait = drv->idle ? pdMS_TO_TICKS(IDLE_POLL_MS) : portMAX_DELAY;
+	Pipeline_Block *b;
+
+	(void)arg;
+	for (;;) {
+		if (xQueueReceive(tx_q, &b, wait) != pdPASS) {
+			drv->idle();
+			continue;
+		}
+		drv->transmit(b);
+		if (b->kind == PIPELINE_SAMPLES)
+			stats.sent++;
+		xQueueSend(free_q, &b, 0);
+	}
+}
+
+static void stats_task (void *arg)
+{
+	Pipeline_Block *b;
+
+	(void)arg;
+	for (;;) {
+		vTaskDelay(pdMS_TO_TICKS(report_ms));
+		if (xQueueReceive(free_q, &b, 0) != pdPASS)
+			continue;                          // Pas de bloc libre : rapport sauté
+		int len = Pipeline_FormatTasks(report, sizeof(report));
+		// Une trame de texte par groupe de lignes complètes d'au plus PIPELINE_TEXT_MAX octets
+		for (int pos = 0; pos < len; ) {
+			int n = len - pos;
+			if (n > PIPELINE_TEXT_MAX) {
+				n = PIPELINE_TEXT_MAX;
+				while (n > 0 && report[pos + n - 1] != '\n')
+					n--;
+				if (!n)
+					n = PIPELINE_TEXT_MAX;
+			}
+			if (!b && xQueueReceive(free_q, &b, 0) != pdPASS)
+				break;                         // Plus de bloc libre : fin du rapport sautée
+			b->kind = PIPELINE_TEXT;
+			b->count = 0;
+			memcpy(b->out, report + pos, n);
+			b->out_len = (uint16_t)n;
+			xQueueSend(tx_q, &b, portMAX_DELAY);
+			b = 0;
+			pos += n;
+		}
+		if (b)
+			xQueueSend(free_q, &b, 0);         // Rapport vide
+	}
+}
+
+/**
+  * @brief Créer les files et les tâches (vTaskStartScheduler() reste à appeler)
+  * @param driver : Opérations de la carte ou du simulateur
+  * @param period : Période d'acquisition en ms
+  * @param stats_period : Période du rapport des tâches en ms (0 : pas de rapport)
+  */
+void Pipeline_Start (const Pipeline_Driver *driver, uint32_t period, uint32_t stats_period)
+{
+	drv = driver;
+	period_ms = period ? period : 1;
+	report_ms = stats_period;
+
+	free_q = xQueueCreateStatic(PIPELINE_BLOCKS, sizeof(Pipeline_Block *), free_store, &free_qs);
+	proc_q = xQueueCreateStatic(PIPELINE_BLOCKS, sizeof(Pipeline_Block *), proc_store, &proc_qs);
+	tx_q = xQueueCreateStatic(PIPELINE_BLOCKS, sizeof(Pipeline_Block *), tx_store, &tx_qs);
+	for (uint32_t i = 0; i < PIPELINE_BLOCKS; i++) {
+		Pipeline_Block *b = &blocks[i];
+		xQueueSend(free_q, &b, 0);
+	}
+
+	xTaskCreateStatic(acq_task, "acq", PIPELINE_STACK_ACQ, 0, PRIO_ACQ, acq_stack, &acq_tcb);
+	xTaskCreateStatic(proc_task, "proc", PIPELINE_STACK_PROC, 0, PRIO_PROC, proc_stack, &proc_tcb);
+	xTaskCreateStatic(tx_task, "tx", PIPELINE_STACK_TX, 0, PRIO_TX, tx_stack, &tx_tcb);
+	if (report_ms)
+		xTaskCreateStatic(stats_task, "stats", PIPELINE_STACK_STATS, 0, PRIO_STATS, stats_stack, &stats_tcb);
+}
+
+/**
+  * @brief Copier les compteurs du pipeline
+  */
+void Pipeline_GetStats (Pipeline_Stats *out)
+{
+	*out = stats;
+}
+
+/**
+  * @brief Temps restant avant la prochaine acquisition, pour un travail qui arrête le processeur
+  *        (effacement Flash)
+  * @retval Durée en ms (0 si l'acquisition est due ou n'a pas commencé)
+  */
+uint32_t Pipeline_IdleMs (void)
+{
+	TickType_t left = acq_next - xTaskGetTickCount();
+
+	return ((int32_t)left > 0) ? (uint32_t)left * portTICK_PERIOD_MS : 0;
+}
+
+/**
+  * @brief Réserver une fenêtre d'inactivité (effacement Flash, qui arrête le processeur)
+  *        Après sa prochaine acquisition, la tâche d'acquisition saute les périodes qui couvrent
+  *        la fenêtre : Pipeline_IdleMs() l'annonce ensuite à driver->idle.
+  * @param ms : Durée de la fenêtre en ms
+  */
+void Pipeline_Reserve (uint32_t ms)
+{
+	reserve_ms = ms;
+}
+
+/**
+  * @brief Construire le rapport des tâches : charge CPU depuis le rapport précédent et minimum
+  *        de pile libre depuis le démarrage, puis les compteurs du pipeline
+  * @param buf : Tampon de sortie
+  * @param size : Taille du tampon
+  * @retval Nombre de caractères écrits
+  */
+int Pipeline_FormatTasks (char *buf, uint32_t size)
+{
+	TaskStatus_t ts[PIPELINE_MAX_TASKS];
+	configRUN_TIME_COUNTER_TYPE total;
+	UBaseType_t n = uxTaskGetSystemState(ts, PIPELINE_MAX_TASKS, &total);
+	uint32_t span = (uint32_t)total - prev_total;
+	int len = 0;
+
+	prev_total = (uint32_t)total;
+	for (UBaseType_t i = 0; i < n && len < (int)size; i++) {
+		UBaseType_t id = ts[i].xTaskNumber <= PIPELINE_MAX_TASKS ? ts[i].xTaskNumber : 0;
+		uint32_t run = (uint32_t)ts[i].ulRunTimeCounter - prev_run[id];
+		uint32_t permil = span ? (uint32_t)((uint64_t)run * 1000 / span) : 0;
+
+		prev_run[id] = (uint32_t)ts[i].ulRunTimeCounter;
+		len += snprintf(buf + len, size - len, "Task %s: cpu=%lu.%lu%% stack=%lu B\r\n",
+		                ts[i].pcTaskName, (unsigned long)(permil / 10), (unsigned long)(permil % 10),
+		                (unsigned long)(ts[i].usStackHighWaterMark * sizeof(StackType_t)));
+	}
+	if (len < (int)size)
+		len += snprintf(buf + len, size - len, "Pipeline: acq=%lu sent=%lu drop=%lu late=%lu skip=%lu\r\n",
+		                (unsigned long)stats.acquired, (unsigned long)stats.sent,
+		                (unsigned long)stats.dropped, (unsigned long)stats.late,
+		                (unsigned long)stats.skipped);
+	return len < (int)size ? len : (int)size - 1;
+}
+
+/**
+  * @brief Mémoire de la tâche inactive (allocation statique)
+  */
+void vApplicationGetIdleTaskMemory (StaticTask_t **tcb, StackType_t **stack, uint32_t *size)
+{
+	*tcb = &idle_tcb;
+	*stack = idle_stack;
+	*size = configMINIMAL_STACK_SIZE;
+}
+
+/**
+  * @brief Débordement de pile détecté par le noyau (configCHECK_FOR_STACK_OVERFLOW)
+  */
+void vApplicationStackOverflowHook (TaskHandle_t task, char *name)
+{
+	(void)task;
+	(void)name;
+	configASSERT(0);
+}
+
+#endif /* APP_RTOS */
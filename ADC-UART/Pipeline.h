@@ -0,0 +1,71 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+
+/**
+  * @brief Architecture à tâches (FreeRTOS), compilée si APP_RTOS vaut 1
+  *        acquisition (priorité haute) -> traitement -> transport (priorité basse)
+  *        Les tâches s'échangent des pointeurs vers des blocs pris dans un réservoir statique :
+  *        aucun échantillon n'est recopié entre les étapes. Un bloc revient au réservoir quand le
+  *        transport l'a émis ; s'il n'y a plus de bloc libre, l'acquisition compte une perte au
+  *        lieu d'attendre, et garde ainsi sa cadence quelle que soit la lenteur du lien.
+  *        Le travail propre à la carte ou au simulateur PC est fourni par un Pipeline_Driver.
+  */
+
+#define PIPELINE_BLOCKS        4      // Blocs en circulation
+#define PIPELINE_MAX_SAMPLES   255    // Échantillons par bloc (compteur u8 des trames)
+#define PIPELINE_OUT_SIZE      263    // Données encodées par bloc (FRAME_MAX_SIZE)
+#define PIPELINE_MAX_TASKS     8      // Tâches suivies par les statistiques
+
+// Piles des tâches (mots de StackType_t) ; le portage POSIX demande des piles de thread plus
+// grandes (PTHREAD_STACK_MIN) : -DPIPELINE_STACK_SCALE=64
+#ifndef PIPELINE_STACK_SCALE
+#define PIPELINE_STACK_SCALE   1
+#endif
+#define PIPELINE_STACK_ACQ     (256 * PIPELINE_STACK_SCALE)
+#define PIPELINE_STACK_PROC    (384 * PIPELINE_STACK_SCALE)
+#define PIPELINE_STACK_TX      (384 * PIPELINE_STACK_SCALE)
+#define PIPELINE_STACK_STATS   (384 * PIPELINE_STACK_SCALE)
+
+// Nature d'un bloc
+#define PIPELINE_SAMPLES       0      // Échantillons acquis
+#define PIPELINE_TEXT          1      // Texte (statistiques) dans out, transmis dans l'ordre du flux
+#define PIPELINE_TEXT_MAX      255    // Longueur maximale d'un texte (charge utile d'une trame)
+
+typedef struct {
+	uint8_t  kind;
+	uint8_t  channel;
+	uint8_t  bits;                           // Résolution
+	uint16_t count;
+	uint32_t t_us;                           // Horodatage du premier échantillon
+	uint16_t lost;                           // Pertes signalées par l'ADC pendant l'acquisition
+	uint16_t samples[PIPELINE_MAX_SAMPLES];
+	uint16_t out_len;
+	uint8_t  out[PIPELINE_OUT_SIZE];         // Texte, ou tampon d'encodage du transport
+} Pipeline_Block;
+
+// Opérations fournies par la carte (main.c) ou le simulateur (Host/rtos)
+typedef struct {
+	void (*acquire)(Pipeline_Block *b);      // Remplir samples, count, t_us, channel, bits (lost)
+	void (*process)(Pipeline_Block *b);      // Étalonner, filtrer (en place)
+	void (*transmit)(Pipeline_Block *b);     // Encoder dans out et émettre (peut bloquer)
+	void (*idle)(void);                      // Transport inoccupé (relecture du journal) ; peut être NULL
+} Pipeline_Driver;
+
+typedef struct {
+	uint32_t acquired;
+	uint32_t processed;
+	uint32_t sent;
+	uint32_t dropped;      // Acquisitions sans bloc libre
+	uint32_t late;         // Périodes d'acquisition manquées
+	uint32_t skipped;      // Périodes sautées pour une fenêtre réservée (effacement Flash)
+} Pipeline_Stats;
+
+void Pipeline_Start(const Pipeline_Driver *driver, uint32_t period_ms, uint32_t stats_ms);
+void Pipeline_GetStats(Pipeline_Stats *stats);
+uint32_t Pipeline_IdleMs(void);
+void Pipeline_Reserve(uint32_t ms);
+int Pipeline_FormatTasks(char *buf, uint32_t size);
+
+#endif /* PIPELINE_H */
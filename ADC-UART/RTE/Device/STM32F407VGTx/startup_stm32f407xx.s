@@ -40,7 +40,7 @@
 ;*******************************************************************************
 
 ; Amount of memory (in bytes) allocated for Stack
-; Tailor this value to your application needs
+; Tailor this value to your application needs (keep MEM_STACK_SIZE in MemPlan.h in step)
 ; <h> Stack Configuration
 ;   <o> Stack Size (in Bytes) <0x0-0xFFFFFFFF:8>
 ; </h>
@@ -56,7 +56,7 @@ __initial_sp
 ;   <o>  Heap Size (in Bytes) <0x0-0xFFFFFFFF:8>
 ; </h>
 
-Heap_Size       EQU     0x00000200
+Heap_Size       EQU     0x00000000
 
                 AREA    HEAP, NOINIT, READWRITE, ALIGN=3
 __heap_base
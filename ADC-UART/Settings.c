@@ -0,0 +1,329 @@
+#include "Settings.h"
+#include "App_Config.h"
+#include "CRC16.h"
+#include "MemPlan.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+  * @brief  Configuration persistante en SRAM sauvegardée, avec secours en Flash
+  *         La SRAM sauvegardée se lit en quelques µs : un redémarrage à chaud (chien de garde,
+  *         sous-tension, broche de reset) applique directement la configuration, sans attendre
+  *         l'hôte. Elle est perdue à la coupure d'alimentation sans pile sur VBAT ; la copie en
+  *         Flash prend alors le relais.
+  *
+  *         Secteur de secours : enregistrements ajoutés à la suite dans des emplacements de
+  *         SETTINGS_SLOT octets, le dernier valide l'emporte ; le secteur n'est effacé que plein.
+  *         Robustesse aux coupures : la signature est écrite en dernier, un emplacement
+  *         incomplet est ignoré. En SRAM sauvegardée, une écriture interrompue échoue au CRC
+  *         et la Flash reprend la main.
+  */
+
+#define CRC_OFFSET   offsetof(Settings, crc)
+
+MEM_STATIC_ASSERT(sizeof(Settings) <= SETTINGS_SLOT && sizeof(Settings) % 4 == 0, settings_slot);
+MEM_STATIC_ASSERT(offsetof(Settings, data_baud) == SETTINGS_HDR_SIZE, settings_header);
+
+static const Settings_Driver *drv;
+static Settings current;
+static Settings_Source source;
+
+// CRC16 d'un enregistrement, champ crc exclu
+static uint16_t record_crc (const uint8_t *rec, uint32_t size)
+{
+	uint16_t crc = CRC16_Update(CRC16_INIT, rec, CRC_OFFSET);
+	return CRC16_Update(crc, rec + CRC_OFFSET + 2, size - CRC_OFFSET - 2);
+}
+
+// Valeurs applicables sans risque (la configuration est appliquée sans autre contrôle)
+static int check (const Settings *s)
+{
+	uint32_t total = 0;
+
+	for (uint32_t i = 0; i < MUX_STREAMS; i++)
+		total += s->share[i];
+	return s->data_baud >= 1200 && s->data_baud <= 10500000 &&
+	       s->sample_period_ms >= 1 &&
+	       s->cal_gain > 0 &&
+	       s->adc_resolution <= ADC_RES_6 &&
+	       s->sample_time <= ADC_SMP_480 &&
+	       total == 100;
+}
+
+/**
+  * @brief Remplir une configuration avec les valeurs de App_Config.h
+  */
+void Settings_Defaults (Settings *s)
+{
+	memset(s, 0, sizeof(*s));
+	s->magic = SETTINGS_MAGIC;
+	s->version = SETTINGS_VERSION;
+	s->size = sizeof(Settings);
+	s->data_baud = APP_DATA_BAUD;
+	s->sample_period_ms = APP_SAMPLE_PERIOD_MS;
+	s->cal_offset = APP_CAL_OFFSET;
+	s->cal_gain = APP_CAL_GAIN;
+	s->log_rate = APP_MUX_LOG_RATE;
+	s->log_burst = APP_MUX_LOG_BURST;
+	s->adc_resolution = APP_ADC_RESOLUTION;
+	s->sample_time = APP_SAMPLE_TIME;
+	s->share[MUX_DATA] = APP_MUX_SHARE_DATA;
+	s->share[MUX_TELEMETRY] = APP_MUX_SHARE_TEL;
+	s->share[MUX_LOG] = APP_MUX_SHARE_LOG;
+}
+
+/**
+  * @brief Valider un enregistrement et le convertir à la version courante
+  *        Les champs absents de l'enregistrement (version antérieure) prennent leur valeur par
+  *        défaut ; ceux d'une version ultérieure sont ignorés.
+  * @param rec : Enregistrement tel que stocké
+  * @param avail : Octets lisibles à partir de rec
+  * @param s : Configuration obtenue (en-tête à la version courante, seq conservé)
+  * @retval 1 si l'enregistrement est intègre et ses valeurs applicables, 0 sinon
+  */
+int Settings_Parse (const uint8_t *rec, uint32_t avail, Settings *s)
+{
+	Settings h;
+
+	if (avail < SETTINGS_HDR_SIZE)
+		return 0;
+	memcpy(&h, rec, SETTINGS_HDR_SIZE);
+	if (h.magic != SETTINGS_MAGIC || h.size < SETTINGS_HDR_SIZE || h.size > avail || h.size > SETTINGS_SLOT)
+		return 0;
+	if (record_crc(rec, h.size) != h.crc)
+		return 0;
+
+	Settings_Defaults(s);
+	memcpy((uint8_t *)s + SETTINGS_HDR_SIZE, rec + SETTINGS_HDR_SIZE,
+	       (h.size < sizeof(Settings) ? h.size : sizeof(Settings)) - SETTINGS_HDR_SIZE);
+	s->seq = h.seq;
+	s->crc = h.crc;
+	return check(s);
+}
+
+// Emplacement vierge (jamais programmé depuis l'effacement)
+static int slot_blank (const uint8_t *p)
+{
+	for (uint32_t i = 0; i < SETTINGS_SLOT; i++)
+		if (p[i] != 0xFF)
+			return 0;
+	return 1;
+}
+
+/**
+  * @brief Parcourir le secteur de secours
+  * @param latest : Dernier enregistrement valide
+  * @param free_off : Premier emplacement vierge (flash_size si le secteur est plein)
+  * @retval 1 si un enregistrement valide a été trouvé, 0 sinon
+  */
+static int flash_scan (Settings *latest, uint32_t *free_off)
+{
+	Settings s;
+	uint32_t off;
+	int found = 0;
+
+	for (off = 0; off + SETTINGS_SLOT <= drv->flash_size; off += SETTINGS_SLOT) {
+		if (slot_blank(drv->flash + off))
+			break;
+		if (Settings_Parse(drv->flash + off, SETTINGS_SLOT, &s)) {
+			*latest = s;
+			found = 1;
+		}
+	}
+	*free_off = off + SETTINGS_SLOT <= drv->flash_size ? off : drv->flash_size;
+	return found;
+}
+
+// Enregistrement au format courant, CRC compris
+static void seal (Settings *s, uint32_t seq)
+{
+	s->magic = SETTINGS_MAGIC;
+	s->version = SETTINGS_VERSION;
+	s->size = sizeof(Settings);
+	s->seq = seq;
+	s->reserved = 0;
+	memset(s->spare, 0, sizeof(s->spare));
+	s->crc = record_crc((const uint8_t *)s, sizeof(Settings));
+}
+
+/**
+  * @brief Charger la configuration : SRAM sauvegardée, Flash, puis valeurs par défaut
+  *        Un enregistrement trouvé en Flash est recopié en SRAM sauvegardée pour le
+  *        redémarrage suivant. Le secteur de secours n'est pas lu si la SRAM sauvegardée
+  *        est valide.
+  */
+void Settings_Init (const Settings_Driver *driver)
+{
+	uint32_t free_off;
+
+	drv = driver;
+	drv->backup_enable();
+
+	if (Settings_Parse(drv->backup, SETTINGS_SLOT, &current)) {
+		source = SETTINGS_BACKUP;
+	} else if (flash_scan(&current, &free_off)) {
+		source = SETTINGS_FLASH;
+		seal(&current, current.seq);
+		memcpy(drv->backup, &current, sizeof(current));
+	} else {
+		source = SETTINGS_DEFAULTS;
+		Settings_Defaults(&current);
+	}
+}
+
+/**
+  * @brief Configuration en vigueur
+  */
+const Settings *Settings_Get (void)
+{
+	return &current;
+}
+
+/**
+  * @brief Origine de la configuration chargée au démarrage
+  */
+Settings_Source Settings_GetSource (void)
+{
+	return source;
+}
+
+/**
+  * @brief Enregistrer une configuration en SRAM sauvegardée et en Flash
+  *        Prise en compte au prochain démarrage : l'appelant applique lui-même les valeurs
+  *        qu'il modifie en marche. Une configuration identique à la dernière copie en Flash
+  *        n'y est pas réécrite.
+  * @note  Secteur plein : effacement de 1 à 2 s, pendant lequel la lecture d'instructions en
+  *        Flash est suspendue (une fois toutes les 2048 écritures).
+  * @param s : Configuration (seuls les champs après l'en-tête sont pris en compte)
+  * @retval 0 si les deux copies sont écrites, -1 si les valeurs sont refusées ou si la
+  *         Flash a échoué (la copie en SRAM sauvegardée reste alors valide)
+  */
+int Settings_Save (const Settings *s)
+{
+	Settings rec = *s, last;
+	uint32_t seq = current.seq, off;
+	int in_flash = flash_scan(&last, &off);
+	uint16_t hw[sizeof(Settings) / 2];
+
+	if (in_flash && last.seq > seq)
+		seq = last.seq;
+	seal(&rec, seq + 1);
+	if (!check(&rec))
+		return -1;
+
+	if (in_flash && memcmp((uint8_t *)&rec + SETTINGS_HDR_SIZE, (uint8_t *)&last + SETTINGS_HDR_SIZE,
+	                       sizeof(Settings) - SETTINGS_HDR_SIZE) == 0) {
+		// Déjà en Flash : la SRAM sauvegardée reçoit la même copie
+		current = last;
+		seal(&current, last.seq);
+		memcpy(drv->backup, &current, sizeof(current));
+		return 0;
+	}
+	current = rec;
+	memcpy(drv->backup, &current, sizeof(current));
+
+	if (off >= drv->flash_size) {
+		if (drv->flash_erase() != 0)
+			return -1;
+		off = 0;
+	}
+	// Signature en dernier : un emplacement interrompu reste invalide
+	memcpy(hw, &rec, sizeof(rec));
+	for (uint32_t i = 2; i < sizeof(Settings) / 2; i++)
+		if (drv->flash_program16(off + 2 * i, hw[i]) != 0)
+			return -1;
+	if (drv->flash_program16(off, hw[0]) != 0 || drv->flash_program16(off + 2, hw[1]) != 0)
+		return -1;
+	return Settings_Parse(drv->flash + off, SETTINGS_SLOT, &last) && last.seq == rec.seq ? 0 : -1;
+}
+
+/**
+  * @brief Construire la ligne de configuration envoyée au démarrage
+  * @retval Nombre de caractères écrits
+  */
+int Settings_Format (char *buf, uint32_t size)
+{
+	static const char *const names[] = { "defaults", "backup", "flash" };
+	const Settings *s = &current;
+
+	return snprintf(buf, size, "Settings: source=%s, seq=%lu, v%u, baud=%lu, res=%lu bits, conv=%lu cycles, period=%lu ms\r\n",
+	                names[source], (unsigned long)s->seq, s->version, (unsigned long)s->data_baud,
+	                (unsigned long)ADC_ResolutionBits((ADC_Resolution)s->adc_resolution),
+	                (unsigned long)ADC_ConvCycles((ADC_Resolution)s->adc_resolution, (ADC_SampleTime)s->sample_time),
+	                (unsigned long)s->sample_period_ms);
+}
+
+/************** ACCÈS STM32F4 *****************/
+
+#define FLASH_KEY1       0x45670123U
+#define FLASH_KEY2       0xCDEF89ABU
+
+static void stm32_backup_enable (void)
+{
+	RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+	PWR->CR |= PWR_CR_DBP;                   // Écriture autorisée dans le domaine sauvegardé
+	RCC->AHB1ENR |= RCC_AHB1ENR_BKPSRAMEN;
+	PWR->CSR |= PWR_CSR_BRE;                 // Régulateur de sauvegarde : contenu gardé sur VBAT
+}
+
+static void stm32_unlock (void)
+{
+	if (FLASH->CR & FLASH_CR_LOCK) {
+		FLASH->KEYR = FLASH_KEY1;
+		FLASH->KEYR = FLASH_KEY2;
+	}
+}
+
+// Les lignes du cache de données peuvent contenir l'ancien contenu d'une zone réécrite
+static void stm32_flush_dcache (void)
+{
+	FLASH->ACR &= ~FLASH_ACR_DCEN;
+	FLASH->ACR |= FLASH_ACR_DCRST;
+	FLASH->ACR &= ~FLASH_ACR_DCRST;
+	FLASH->ACR |= FLASH_ACR_DCEN;
+}
+
+static int stm32_erase (void)
+{
+	uint32_t err = FLASH_SR_PGSERR | FLASH_SR_PGPERR | FLASH_SR_PGAERR | FLASH_SR_WRPERR;
+
+	while (FLASH->SR & FLASH_SR_BSY);
+	stm32_unlock();
+	FLASH->SR = err | FLASH_SR_EOP;
+	FLASH->CR = FLASH_CR_SER |                                            // Effacement de secteur
+	            (SETTINGS_FLASH_SECTOR << FLASH_CR_SNB_Pos) |
+	            (2U << 8);                                                // Parallélisme x32
+	FLASH->CR |= FLASH_CR_STRT;
+	while (FLASH->SR & FLASH_SR_BSY);
+	FLASH->CR &= ~FLASH_CR_SER;
+	stm32_flush_dcache();
+
+	return (FLASH->SR & err) ? -1 : 0;
+}
+
+static int stm32_program16 (uint32_t offset, uint16_t value)
+{
+	uint32_t err = FLASH_SR_PGSERR | FLASH_SR_PGPERR | FLASH_SR_PGAERR | FLASH_SR_WRPERR;
+
+	while (FLASH->SR & FLASH_SR_BSY);
+	stm32_unlock();
+	FLASH->SR = err | FLASH_SR_EOP;
+	FLASH->CR = FLASH_CR_PG | FLASH_CR_PSIZE_0;         // Programmation par demi-mot (x16)
+	*(volatile uint16_t *)(SETTINGS_FLASH_BASE + offset) = value;
+	while (FLASH->SR & FLASH_SR_BSY);
+	FLASH->CR &= ~FLASH_CR_PG;
+	stm32_flush_dcache();
+
+	return (FLASH->SR & err) ? -1 : 0;
+}
+
+const Settings_Driver Settings_Stm32 = {
+	(uint8_t *)BKPSRAM_BASE,
+	stm32_backup_enable,
+	(const uint8_t *)SETTINGS_FLASH_BASE,
+	SETTINGS_FLASH_SIZE,
+	stm32_erase,
+	stm32_program16
+};
@@ -0,0 +1,76 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdint.h>
+#include "Mux.h"
+
+/**
+  * @brief Configuration persistante
+  *        Un enregistrement versionné et protégé par CRC16 est gardé en SRAM sauvegardée (4 Ko,
+  *        conservée par un reset de chien de garde, de broche ou de sous-tension, et sur VBAT) et
+  *        recopié dans un secteur de Flash de secours (secteur 7). Au démarrage : SRAM
+  *        sauvegardée, sinon Flash (recopiée en SRAM sauvegardée), sinon valeurs de App_Config.h.
+  *        Compatibilité : les champs ne sont ajoutés qu'en fin d'enregistrement ; un
+  *        enregistrement d'une autre version fournit les champs communs, les autres prennent
+  *        leur valeur par défaut.
+  */
+
+#define SETTINGS_MAGIC        0x47464353U   // "SCFG"
+#define SETTINGS_VERSION      1
+#define SETTINGS_HDR_SIZE     16            // Octets avant le premier champ
+#define SETTINGS_SLOT         64            // Place d'un enregistrement en Flash (taille maximale)
+
+// Secteur de secours : secteur 7 de la Flash interne (128 Ko, 2048 écritures par effacement)
+#define SETTINGS_FLASH_SECTOR 7
+#define SETTINGS_FLASH_BASE   0x08060000U
+#define SETTINGS_FLASH_SIZE   0x20000U
+
+typedef struct {
+	// En-tête
+	uint32_t magic;
+	uint16_t version;
+	uint16_t size;                // Octets de l'enregistrement, en-tête compris
+	uint32_t seq;                 // Numéro d'écriture : le plus grand l'emporte en Flash
+	uint16_t crc;                 // CRC16 de l'enregistrement, ce champ exclu
+	uint16_t reserved;
+	// Version 1
+	uint32_t data_baud;           // Port de données
+	uint32_t sample_period_ms;    // Période d'acquisition
+	int16_t  cal_offset;          // Étalonnage du canal 1 (Dsp_OffsetGain)
+	int16_t  cal_gain;            // Q14 (16384 : 1)
+	uint16_t log_rate;            // Flux de journal : octets/s (0 : illimité) et rafale
+	uint16_t log_burst;
+	uint8_t  adc_resolution;      // ADC_Resolution
+	uint8_t  sample_time;         // ADC_SampleTime du canal 1
+	uint8_t  share[MUX_STREAMS];  // Parts du débit par flux (%, total 100)
+	uint8_t  spare[3];            // À zéro (alignement)
+} Settings;
+
+// Origine de la configuration en vigueur
+typedef enum {
+	SETTINGS_DEFAULTS = 0,
+	SETTINGS_BACKUP,
+	SETTINGS_FLASH
+} Settings_Source;
+
+// Accès bas niveau, sur le modèle de FlashLog_Driver
+typedef struct {
+	uint8_t *backup;                                     // Enregistrement en SRAM sauvegardée
+	void (*backup_enable)(void);                         // Horloges et accès en écriture
+	const uint8_t *flash;                                // Secteur de secours (lecture directe)
+	uint32_t flash_size;
+	int  (*flash_erase)(void);                           // Efface le secteur (bloquant, 0 si succès)
+	int  (*flash_program16)(uint32_t offset, uint16_t value);
+} Settings_Driver;
+
+extern const Settings_Driver Settings_Stm32;
+
+void Settings_Defaults(Settings *s);
+int Settings_Parse(const uint8_t *rec, uint32_t avail, Settings *s);
+void Settings_Init(const Settings_Driver *driver);
+const Settings *Settings_Get(void);
+Settings_Source Settings_GetSource(void);
+int Settings_Save(const Settings *s);
+int Settings_Format(char *buf, uint32_t size);
+
+#endif /* SETTINGS_H */
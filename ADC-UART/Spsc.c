@@ -0,0 +1,105 @@
+#include "Spsc.h"
+#include <string.h>
+
+/**
+  * @brief Initialiser une file vide
+  * @param storage : slots x slot_size octets, aligné sur 4 pour des places d'un multiple de 4
+  * @param slot_size : Taille d'une place (octets)
+  * @param slots : Nombre de places (puissance de 2)
+  * @retval 0, -1 si le nombre de places n'est pas une puissance de 2
+  */
+int Spsc_Init (Spsc *q, void *storage, uint32_t slot_size, uint32_t slots)
+{
+	if (!slots || (slots & (slots - 1)) || !slot_size)
+		return -1;
+	memset(q, 0, sizeof(*q));
+	q->buf = storage;
+	q->slot_size = slot_size;
+	q->mask = slots - 1;
+	return 0;
+}
+
+/**
+  * @brief Réserver des places consécutives en mémoire (producteur, par lot)
+  *        S'arrête à la fin de l'anneau : un second appel donne la suite.
+  * @param slot : Première place à remplir
+  * @retval Nombre de places réservées, 0 si la file est pleine
+  */
+uint32_t Spsc_ClaimN (Spsc *q, void **slot)
+{
+	uint32_t size = q->mask + 1, head = q->head, pos = head & q->mask, n;
+
+	if (size - (head - q->tail_seen) < size - pos)
+		q->tail_seen = Spsc_LoadAcquire(&q->tail);  // Relu seulement s'il limite le lot
+	n = size - (head - q->tail_seen);              // Places libres
+	if (n > size - pos)
+		n = size - pos;                            // Jusqu'à la fin de l'anneau
+	if (!n)
+		q->full++;
+	*slot = q->buf + pos * q->slot_size;
+	return n;
+}
+
+/**
+  * @brief Publier les n premières places réservées par Spsc_ClaimN()
+  */
+void Spsc_CommitN (Spsc *q, uint32_t n)
+{
+	Spsc_StoreRelease(&q->head, q->head + n);
+}
+
+/**
+  * @brief Places consécutives en mémoire à lire (consommateur, par lot)
+  * @param slot : Première place
+  * @retval Nombre de places lisibles, 0 si la file est vide
+  */
+uint32_t Spsc_PeekN (Spsc *q, void **slot)
+{
+	uint32_t size = q->mask + 1, tail = q->tail, pos = tail & q->mask, n;
+
+	if (q->head_seen - tail < size - pos)
+		q->head_seen = Spsc_LoadAcquire(&q->head);
+	n = q->head_seen - tail;
+	if (n > size - pos)
+		n = size - pos;
+	*slot = q->buf + pos * q->slot_size;
+	return n;
+}
+
+/**
+  * @brief Rendre les n premières places lues par Spsc_PeekN()
+  */
+void Spsc_ReleaseN (Spsc *q, uint32_t n)
+{
+	Spsc_StoreRelease(&q->tail, q->tail + n);
+}
+
+/**
+  * @brief Mettre en file une copie de item (slot_size octets)
+  * @retval 0, -1 si la file est pleine
+  */
+int Spsc_Push (Spsc *q, const void *item)
+{
+	void *p = Spsc_Claim(q);
+
+	if (!p)
+		return -1;
+	memcpy(p, item, q->slot_size);
+	Spsc_Commit(q);
+	return 0;
+}
+
+/**
+  * @brief Retirer l'élément le plus ancien (copie dans item)
+  * @retval 0, -1 si la file est vide
+  */
+int Spsc_Pop (Spsc *q, void *item)
+{
+	void *p = Spsc_Peek(q);
+
+	if (!p)
+		return -1;
+	memcpy(item, p, q->slot_size);
+	Spsc_Release(q);
+	return 0;
+}
@@ -0,0 +1,124 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <stdint.h>
+
+/**
+  * @brief File sans verrou à un producteur et un consommateur (interruption -> boucle principale,
+  *        tâche -> tâche, fil -> fil sur PC)
+  *        Anneau de 2^n places de taille fixe ; les index sont des compteurs libres 32 bits
+  *        (plein : head - tail = places), chacun écrit par un seul côté. Le producteur réserve
+  *        une place (Spsc_Claim), la remplit sur place puis la publie (Spsc_Commit) ; le
+  *        consommateur la lit sur place (Spsc_Peek) puis la rend (Spsc_Release) : aucune copie,
+  *        aucune interruption masquée. Un index est publié après l'accès aux données (écriture
+  *        avec libération) et lu avant (lecture avec acquisition) : DMB sur la carte, accès
+  *        atomiques sur PC. Chaque côté garde la dernière valeur lue de l'index de l'autre et
+  *        ne la relit qu'à court de places ou de données.
+  *        Côté producteur et côté consommateur sont alignés sur SPSC_LINE : mot sur la carte
+  *        (pas de cache de données), ligne de cache sur PC (pas de faux partage entre coeurs).
+  *        Module sans dépendance matérielle (Host/spscbench.c).
+  */
+
+#ifndef SPSC_LINE
+#define SPSC_LINE  4
+#endif
+
+// Index de l'autre côté : lu avant les données ; index de ce côté : écrit après les données
+#if defined(__CC_ARM)
+static __inline uint32_t Spsc_LoadAcquire(const volatile uint32_t *p)
+{
+	uint32_t v = *p;
+	__dmb(0xF);
+	return v;
+}
+static __inline void Spsc_StoreRelease(volatile uint32_t *p, uint32_t v)
+{
+	__dmb(0xF);
+	*p = v;
+}
+#else
+#define Spsc_LoadAcquire(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define Spsc_StoreRelease(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+typedef struct {
+	/* producteur */
+	volatile uint32_t head __attribute__((aligned(SPSC_LINE)));   // Places publiées
+	uint32_t          tail_seen;   // Dernier tail lu
+	uint32_t          full;        // Réservations refusées : file pleine
+	/* consommateur */
+	volatile uint32_t tail __attribute__((aligned(SPSC_LINE)));   // Places rendues
+	uint32_t          head_seen;   // Dernier head lu
+	/* constantes */
+	uint8_t          *buf __attribute__((aligned(SPSC_LINE)));
+	uint32_t          slot_size;
+	uint32_t          mask;        // Places - 1
+} Spsc;
+
+int Spsc_Init(Spsc *q, void *storage, uint32_t slot_size, uint32_t slots);
+uint32_t Spsc_ClaimN(Spsc *q, void **slot);
+void Spsc_CommitN(Spsc *q, uint32_t n);
+uint32_t Spsc_PeekN(Spsc *q, void **slot);
+void Spsc_ReleaseN(Spsc *q, uint32_t n);
+int Spsc_Push(Spsc *q, const void *item);
+int Spsc_Pop(Spsc *q, void *item);
+
+/**
+  * @brief Réserver la place suivante (producteur)
+  * @retval Place à remplir, NULL si la file est pleine
+  */
+static __inline void *Spsc_Claim(Spsc *q)
+{
+	uint32_t head = q->head;
+
+	if (head - q->tail_seen > q->mask) {
+		q->tail_seen = Spsc_LoadAcquire(&q->tail);   // Place lue avant d'être réécrite
+		if (head - q->tail_seen > q->mask) {
+			q->full++;
+			return 0;
+		}
+	}
+	return q->buf + (head & q->mask) * q->slot_size;
+}
+
+/**
+  * @brief Publier la place réservée (producteur)
+  */
+static __inline void Spsc_Commit(Spsc *q)
+{
+	Spsc_StoreRelease(&q->head, q->head + 1);   // Données écrites avant l'index
+}
+
+/**
+  * @brief Place la plus ancienne (consommateur)
+  * @retval Place à lire, NULL si la file est vide
+  */
+static __inline void *Spsc_Peek(Spsc *q)
+{
+	uint32_t tail = q->tail;
+
+	if (tail == q->head_seen) {
+		q->head_seen = Spsc_LoadAcquire(&q->head);   // Index lu avant les données
+		if (tail == q->head_seen)
+			return 0;
+	}
+	return q->buf + (tail & q->mask) * q->slot_size;
+}
+
+/**
+  * @brief Rendre la place lue (consommateur)
+  */
+static __inline void Spsc_Release(Spsc *q)
+{
+	Spsc_StoreRelease(&q->tail, q->tail + 1);   // Données lues avant de rendre la place
+}
+
+/**
+  * @brief Places occupées (valeur instantanée, depuis l'un ou l'autre côté)
+  */
+static __inline uint32_t Spsc_Count(const Spsc *q)
+{
+	return Spsc_LoadAcquire(&q->head) - Spsc_LoadAcquire(&q->tail);
+}
+
+#endif /* SPSC_H */
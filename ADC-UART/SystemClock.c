@@ -1,69 +1,223 @@
-/**
-  * @brief  Configuration du systme d'horloge
-  *         Ce fichier configure l'horloge principale du microcontrleur en suivant ces paramtres :
-  *            - Source de l'horloge : PLL avec HSE (8 MHz)
-  *            - Frquence principale (SYSCLK) : 180 MHz
-  *            - Frquence du bus AHB (HCLK) : 180 MHz
-  *            - Frquence des bus APB1 et APB2 : 45 MHz et 90 MHz respectivement
-  *            - Configuration du rgulateur de tension : mode Scale 1
-  *            - Latence mmoire Flash : 5 cycles
-  * @note   Cette configuration est optimise pour des performances leves
-  * @param  Aucun
-  * @retval Aucun
-  */
-
-#include "SystemClock.h"
-
-// Fonction principale pour configurer l'horloge systme
-void SysClockConfig (void)
-{
-		/************* TAPES POUR CONFIGURER L'HORLOGE ************
-	
-	1. Activer la source d'horloge externe HSE et vrifier son tat.
-	2. Initialiser l'horloge d'alimentation et activer le rgulateur de tension.
-	3. Rgler la mmoire Flash pour supporter des frquences leves.
-	4. Appliquer les diviseurs ncessaires aux bus AHB, APB1 et APB2.
-	5. Configurer le PLL pour atteindre la frquence cible de 180 MHz.
-	6. Activer le PLL et attendre qu'il soit oprationnel.
-	7. Slectionner le PLL comme source principale pour le microcontrleur.
-	
-	********************************************************/
-	
-	// Dfinition des paramtres du PLL
-	#define PLL_M 	4    // Diviseur de l'oscillateur HSE
-	#define PLL_N 	180  // Multiplicateur pour atteindre 180 MHz
-	#define PLL_P 	0    // Correspond  une division par 2 (PLLP = 2)
-
-	// tape 1 : Activer HSE et attendre son tat prt
-	RCC->CR |= RCC_CR_HSEON;             // Activation de l'oscillateur externe
-	while (!(RCC->CR & RCC_CR_HSERDY));  // Attente de sa stabilisation
-	
-	// tape 2 : Activer l'alimentation et configurer le rgulateur de tension
-	RCC->APB1ENR |= RCC_APB1ENR_PWREN;  // Activation de l'horloge pour le rgulateur
-	PWR->CR |= PWR_CR_VOS;              // Rgulateur en mode "Scale 1"
-	
-	// tape 3 : Configuration des paramtres de la mmoire Flash
-	FLASH->ACR = FLASH_ACR_ICEN |       // Activation du cache des instructions
-	             FLASH_ACR_DCEN |       // Activation du cache des donnes
-	             FLASH_ACR_PRFTEN |     // Prlecture active
-	             FLASH_ACR_LATENCY_5WS; // 5 cycles d'attente pour 180 MHz
-	
-	// tape 4 : Rgler les diviseurs pour les bus AHB, APB1 et APB2
-	RCC->CFGR |= RCC_CFGR_HPRE_DIV1;    // AHB sans division (HCLK = SYSCLK)
-	RCC->CFGR |= RCC_CFGR_PPRE1_DIV4;   // APB1 divis par 4 (PCLK1 = 45 MHz)
-	RCC->CFGR |= RCC_CFGR_PPRE2_DIV2;   // APB2 divis par 2 (PCLK2 = 90 MHz)
-	
-	// tape 5 : Configurer le PLL avec les paramtres dfinis
-	RCC->PLLCFGR = (PLL_M << 0) |       // Diviseur HSE
-	               (PLL_N << 6) |       // Multiplicateur PLL
-	               (PLL_P << 16) |      // Diviseur PLLP (par 2)
-	               RCC_PLLCFGR_PLLSRC_HSE; // Source PLL : HSE
-	
-	// tape 6 : Activer le PLL et attendre qu'il soit prt
-	RCC->CR |= RCC_CR_PLLON;            // Activation du PLL
-	while (!(RCC->CR & RCC_CR_PLLRDY)); // Attente de sa stabilisation
-	
-	// tape 7 : Slectionner le PLL comme source principale
-	RCC->CFGR |= RCC_CFGR_SW_PLL;       // Source systme : PLL
-	while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL); // Vrification
-}
+/**
+  * @brief  Configuration du système d'horloge
+  *         Ce fichier configure l'horloge principale du microcontrôleur selon un profil choisi :
+  *            - CLOCK_PROFILE_PERF     : PLL sur HSE (8 MHz), SYSCLK = HCLK = 168 MHz,
+  *                                       APB1 = 42 MHz, APB2 = 84 MHz, Scale 1, 5 cycles Flash
+  *            - CLOCK_PROFILE_LOWPOWER : HSE direct, 8 MHz sur tous les bus, Scale 2, 0 cycle Flash
+  *            - CLOCK_PROFILE_HSI      : HSI direct, 16 MHz sur tous les bus, 0 cycle Flash
+  * @note   Les fréquences de bus actives sont publiées par SysClock_GetTree() : les modules
+  *         Timer, UART et ADC en dérivent leurs prescalers au lieu de supposer une horloge fixe.
+  *         Si le HSE ne démarre pas, le profil HSI est appliqué en repli.
+  */
+
+#include "SystemClock.h"
+
+// Délai maximal de démarrage du HSE (en itérations de scrutation, ~ quelques ms sur HSI)
+#define HSE_STARTUP_TIMEOUT  0x10000U
+
+// Limites de la fiche technique STM32F407 (VDD 2,7 - 3,6 V)
+#define SYSCLK_MAX_HZ        168000000U
+#define FLASH_HZ_PER_WS      30000000U   // 1 cycle d'attente par tranche de 30 MHz
+#define SCALE2_MAX_HZ        144000000U
+
+static const ClockProfile profiles[CLOCK_PROFILE_COUNT] = {
+	//  nom         source             M  N    P  Q  AHB APB1 APB2
+	{ "perf-168",  CLOCK_SRC_PLL_HSE, 4, 168, 2, 7, 1,  4,   2 },  // VCO = 2 MHz x 168 = 336 MHz
+	{ "lowpower",  CLOCK_SRC_HSE,     0, 0,   0, 0, 1,  1,   1 },
+	{ "hsi-16",    CLOCK_SRC_HSI,     0, 0,   0, 0, 1,  1,   1 },
+};
+
+// Arbre actif : HSI 16 MHz après reset, jusqu'au premier appel de SysClockConfigProfile()
+static ClockTree active_tree = {
+	CLOCK_PROFILE_HSI, HSI_HZ, HSI_HZ, HSI_HZ, HSI_HZ, HSI_HZ, HSI_HZ, 0, 0
+};
+
+/**
+  * @brief Obtenir la description d'un profil
+  * @param id : Profil demandé
+  * @retval Pointeur vers le profil (constant)
+  */
+const ClockProfile *SysClock_GetProfile (ClockProfileId id)
+{
+	return &profiles[id];
+}
+
+/**
+  * @brief Calculer les fréquences d'un profil sans toucher au matériel
+  *        Fonction pure : utilisable sur PC pour vérifier les valeurs dérivées.
+  * @param id : Profil
+  * @param tree : Arbre d'horloge résultant
+  */
+void SysClock_ComputeTree (ClockProfileId id, ClockTree *tree)
+{
+	const ClockProfile *p = &profiles[id];
+
+	switch (p->source) {
+	case CLOCK_SRC_PLL_HSE:
+		tree->sysclk = HSE_HZ / p->pll_m * p->pll_n / p->pll_p;
+		break;
+	case CLOCK_SRC_HSE:
+		tree->sysclk = HSE_HZ;
+		break;
+	default:
+		tree->sysclk = HSI_HZ;
+		break;
+	}
+
+	tree->profile  = id;
+	tree->hclk     = tree->sysclk / p->ahb_div;
+	tree->pclk1    = tree->hclk / p->apb1_div;
+	tree->pclk2    = tree->hclk / p->apb2_div;
+	tree->tim_apb1 = (p->apb1_div == 1) ? tree->pclk1 : 2 * tree->pclk1;
+	tree->tim_apb2 = (p->apb2_div == 1) ? tree->pclk2 : 2 * tree->pclk2;
+	tree->flash_ws = (tree->hclk - 1) / FLASH_HZ_PER_WS;
+	tree->vos_scale1 = (tree->hclk > SCALE2_MAX_HZ);
+}
+
+/**
+  * @brief Obtenir l'arbre d'horloge actif
+  * @retval Pointeur vers les fréquences en vigueur
+  */
+const ClockTree *SysClock_GetTree (void)
+{
+	return &active_tree;
+}
+
+/**
+  * @brief Démarrer l'oscillateur HSE sans attendre sa stabilisation
+  *        Le démarrage du quartz prend de l'ordre de la milliseconde : l'appelant peut
+  *        configurer pendant ce temps les périphériques dont les réglages ne dépendent
+  *        pas de la fréquence (GPIO, ADC), avant d'appeler SysClockConfig().
+  */
+void SysClockStartHSE (void)
+{
+	RCC->CR |= RCC_CR_HSEON;             // Activation de l'oscillateur externe
+}
+
+// Codage des diviseurs AHB (HPRE) et APB (PPREx) dans RCC_CFGR
+static uint32_t ahb_bits (uint32_t div)
+{
+	switch (div) {
+	case 2:   return 0x8;
+	case 4:   return 0x9;
+	case 8:   return 0xA;
+	case 16:  return 0xB;
+	case 64:  return 0xC;   // Pas de division par 32
+	case 128: return 0xD;
+	case 256: return 0xE;
+	case 512: return 0xF;
+	default:  return 0x0;
+	}
+}
+
+static uint32_t apb_bits (uint32_t div)
+{
+	switch (div) {
+	case 2:  return 4;
+	case 4:  return 5;
+	case 8:  return 6;
+	case 16: return 7;
+	default: return 0;
+	}
+}
+
+/**
+  * @brief Appliquer le profil d'horloge par défaut
+  */
+void SysClockConfig (void)
+{
+	SysClockConfigProfile(CLOCK_PROFILE_DEFAULT);
+}
+
+/**
+  * @brief Appliquer un profil d'horloge
+  * @param id : Profil demandé
+  * @retval Profil effectivement appliqué (CLOCK_PROFILE_HSI si le HSE n'a pas démarré)
+  */
+ClockProfileId SysClockConfigProfile (ClockProfileId id)
+{
+	/************* ÉTAPES POUR CONFIGURER L'HORLOGE ************
+
+	1. Activer HSE si nécessaire et vérifier son état (repli sur HSI en cas d'échec).
+	2. Calculer l'arbre d'horloge et initialiser le régulateur de tension.
+	3. Augmenter la latence Flash avant de monter en fréquence.
+	4. Repasser temporairement sur HSI et arrêter le PLL pour le reconfigurer.
+	5. Configurer et verrouiller le PLL si le profil l'utilise.
+	6. Appliquer les diviseurs AHB, APB1 et APB2.
+	7. Sélectionner la source principale et ajuster la latence Flash finale.
+
+	********************************************************/
+
+	const ClockProfile *p = &profiles[id];
+	ClockTree tree;
+
+	// Étape 1 : Démarrer le HSE avec un délai maximal
+	if (p->source != CLOCK_SRC_HSI) {
+		uint32_t timeout = HSE_STARTUP_TIMEOUT;
+		RCC->CR |= RCC_CR_HSEON;
+		while (!(RCC->CR & RCC_CR_HSERDY) && --timeout);
+		if (!timeout) {
+			id = CLOCK_PROFILE_HSI;      // Quartz absent ou défectueux : repli sur HSI
+			p = &profiles[id];
+		}
+	}
+
+	// Étape 2 : Arbre d'horloge et régulateur de tension
+	SysClock_ComputeTree(id, &tree);
+	if (tree.sysclk > SYSCLK_MAX_HZ)
+		return active_tree.profile;      // Profil hors spécification : refusé
+
+	RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+	if (tree.vos_scale1)
+		PWR->CR |= PWR_CR_VOS;           // Régulateur en mode "Scale 1"
+	else
+		PWR->CR &= ~PWR_CR_VOS;          // Scale 2 : consommation réduite
+
+	// Étape 3 : Latence Flash suffisante pour l'ancienne et la nouvelle fréquence
+	uint32_t ws = (tree.flash_ws > active_tree.flash_ws) ? tree.flash_ws : active_tree.flash_ws;
+	FLASH->ACR = FLASH_ACR_ICEN | FLASH_ACR_DCEN | FLASH_ACR_PRFTEN | ws;
+
+	// Étape 4 : HSI comme source transitoire, PLL arrêté
+	RCC->CR |= RCC_CR_HSION;
+	while (!(RCC->CR & RCC_CR_HSIRDY));
+	RCC->CFGR &= ~RCC_CFGR_SW;                              // SW = HSI
+	while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_HSI);
+	RCC->CR &= ~RCC_CR_PLLON;
+	while (RCC->CR & RCC_CR_PLLRDY);
+
+	// Étape 5 : PLL
+	if (p->source == CLOCK_SRC_PLL_HSE) {
+		RCC->PLLCFGR = (p->pll_m << 0) |                // Diviseur HSE
+		               (p->pll_n << 6) |                // Multiplicateur PLL
+		               (((p->pll_p >> 1) - 1) << 16) |  // Diviseur PLLP (00 = /2 ... 11 = /8)
+		               (p->pll_q << 24) |               // Diviseur PLLQ (48 MHz)
+		               RCC_PLLCFGR_PLLSRC_HSE;          // Source PLL : HSE
+		RCC->CR |= RCC_CR_PLLON;
+		while (!(RCC->CR & RCC_CR_PLLRDY));
+	}
+
+	// Étape 6 : Diviseurs de bus
+	RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)) |
+	            (ahb_bits(p->ahb_div) << 4) |
+	            (apb_bits(p->apb1_div) << 10) |
+	            (apb_bits(p->apb2_div) << 13);
+
+	// Étape 7 : Source principale
+	if (p->source == CLOCK_SRC_PLL_HSE) {
+		RCC->CFGR |= RCC_CFGR_SW_PLL;
+		while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL);
+	} else if (p->source == CLOCK_SRC_HSE) {
+		RCC->CFGR |= RCC_CFGR_SW_HSE;
+		while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_HSE);
+	}
+	if (p->source == CLOCK_SRC_HSI)
+		RCC->CR &= ~RCC_CR_HSEON;        // HSE inutile : arrêté
+
+	FLASH->ACR = FLASH_ACR_ICEN | FLASH_ACR_DCEN | FLASH_ACR_PRFTEN | tree.flash_ws;
+
+	// Publier l'arbre actif et la fréquence du coeur utilisée par les délais calibrés
+	active_tree = tree;
+	SystemCoreClock = tree.hclk;
+
+	return id;
+}
@@ -1,6 +1,63 @@
-
-#include "stm32f4xx.h"                  // Device header
-#include "stm32f407xx.h"
-
-void SysClockConfig (void);
-
+#ifndef SYSCLOCK_H
+#define SYSCLOCK_H
+
+#include "stm32f4xx.h"                  // Device header
+#include "stm32f407xx.h"
+
+#define HSE_HZ   8000000U   // Quartz externe de la carte
+#define HSI_HZ   16000000U  // Oscillateur interne
+
+// Profils d'horloge sélectionnables
+typedef enum {
+	CLOCK_PROFILE_PERF = 0,   // PLL sur HSE, 168 MHz (maximum de la fiche technique)
+	CLOCK_PROFILE_LOWPOWER,   // HSE direct, 8 MHz, régulateur en Scale 2
+	CLOCK_PROFILE_HSI,        // HSI direct, 16 MHz (repli si le HSE ne démarre pas)
+	CLOCK_PROFILE_COUNT
+} ClockProfileId;
+
+#define CLOCK_PROFILE_DEFAULT CLOCK_PROFILE_PERF
+
+// Source de SYSCLK
+typedef enum {
+	CLOCK_SRC_HSI = 0,
+	CLOCK_SRC_HSE,
+	CLOCK_SRC_PLL_HSE
+} ClockSource;
+
+// Description d'un profil : source, facteurs PLL et diviseurs de bus
+typedef struct {
+	const char *name;
+	ClockSource source;
+	uint32_t    pll_m;     // Diviseur d'entrée PLL (2..63)
+	uint32_t    pll_n;     // Multiplicateur VCO (50..432)
+	uint32_t    pll_p;     // Diviseur SYSCLK (2, 4, 6 ou 8)
+	uint32_t    pll_q;     // Diviseur 48 MHz (2..15)
+	uint32_t    ahb_div;   // 1, 2, 4 ... 512
+	uint32_t    apb1_div;  // 1, 2, 4, 8 ou 16
+	uint32_t    apb2_div;  // 1, 2, 4, 8 ou 16
+} ClockProfile;
+
+// Fréquences dérivées de l'arbre d'horloge actif
+typedef struct {
+	ClockProfileId profile;
+	uint32_t sysclk;
+	uint32_t hclk;
+	uint32_t pclk1;       // APB1 : USART2/3, UART4/5, TIM2..7
+	uint32_t pclk2;       // APB2 : USART1/6, ADC, TIM1/8..11
+	uint32_t tim_apb1;    // Horloge des timers APB1 (x2 si APB1 divisé)
+	uint32_t tim_apb2;    // Horloge des timers APB2 (x2 si APB2 divisé)
+	uint32_t flash_ws;    // Cycles d'attente Flash
+	uint32_t vos_scale1;  // 1 si le régulateur doit être en Scale 1
+} ClockTree;
+
+const ClockProfile *SysClock_GetProfile(ClockProfileId id);
+void SysClock_ComputeTree(ClockProfileId id, ClockTree *tree);
+const ClockTree *SysClock_GetTree(void);
+
+void SysClockStartHSE (void);
+
+void SysClockConfig (void);
+
+ClockProfileId SysClockConfigProfile (ClockProfileId id);
+
+#endif /* SYSCLOCK_H */
@@ -1,55 +1,143 @@
-#include "Timer_Config.h"
-#include "SystemClock.h"
-
-/**
-  * @brief Configuration du Timer 6 (TIM6)
-  *        Ce module configure le Timer 6 pour gnrer des dlais prcis en microsecondes.
-  *        La frquence est rgle de manire  obtenir une rsolution de 1 s par incrment.
-  */
-
-void TIM6Config (void)
-{
-	/************** TAPES DE CONFIGURATION ***************
-	1. Activer l'horloge du Timer 6
-	2. Configurer le prescaler et le registre de rechargement automatique (ARR)
-	3. Dmarrer le Timer et attendre que le drapeau de mise  jour soit activ
-	*******************************************************/
-
-	// 1. Activation de l'horloge du Timer 6
-	RCC->APB1ENR |= (1<<4);  // Activation de l'horloge pour TIM6
-	
-	// 2. Configuration du prescaler et du registre ARR
-	TIM6->PSC = 90-1;        // Division de la frquence d'horloge (90 MHz) par 90 pour obtenir 1 MHz (~ 1 s)
-	TIM6->ARR = 0xffff;      // Valeur maximale du registre ARR (priode max)
-
-	// 3. Activation du Timer et attente du drapeau de mise  jour
-	TIM6->CR1 |= (1<<0);     // Activation du compteur
-	while (!(TIM6->SR & (1<<0)));  // Attente du drapeau "UIF" indiquant la mise  jour des registres
-}
-
-/**
-  * @brief Gnrer un dlai en microsecondes
-  * @param us : Nombre de microsecondes  attendre
-  */
-void Delay_us (uint16_t us)
-{
-	/************** TAPES POUR LE DLAI *****************
-	1. Rinitialiser le compteur du Timer
-	2. Attendre que le compteur atteigne la valeur souhaite.
-	   Chaque incrment correspond  un dlai de 1 s.
-	*****************************************************/
-	TIM6->CNT = 0;                // Rinitialisation du compteur
-	while (TIM6->CNT < us);       // Attente jusqu' ce que le compteur atteigne la valeur "us"
-}
-
-/**
-  * @brief Gnrer un dlai en millisecondes
-  * @param ms : Nombre de millisecondes  attendre
-  */
-void Delay_ms (uint16_t ms)
-{
-	for (uint16_t i = 0; i < ms; i++)
-	{
-		Delay_us(1000);           // 1 ms correspond  1000 s
-	}
-}
+#include "Timer_Config.h"
+#include "SystemClock.h"
+#include "DWT_Config.h"
+#include "IsrTime.h"
+#include "Trace.h"
+
+#if defined(APP_RTOS) && APP_RTOS
+#include "FreeRTOS.h"
+#include "task.h"
+void xPortSysTickHandler(void);
+#endif
+
+/**
+  * @brief Configuration du Timer 6 (TIM6)
+  *        Ce module configure le Timer 6 pour générer des délais précis en microsecondes.
+  *        La fréquence est réglée de manière à obtenir une résolution de 1 µs par incrément.
+  */
+
+/**
+  * @brief Calculer le prescaler d'un timer pour une fréquence de comptage donnée
+  *        Fonction pure : ne dépend que de l'horloge du timer, issue de SysClock_GetTree().
+  * @param timclk : Horloge d'entrée du timer (Hz)
+  * @param tick_hz : Fréquence de comptage souhaitée (Hz)
+  * @retval Valeur à écrire dans TIMx_PSC
+  */
+uint32_t TIM_ComputePrescaler (uint32_t timclk, uint32_t tick_hz)
+{
+	return (timclk + tick_hz / 2) / tick_hz - 1;
+}
+
+void TIM6Config (void)
+{
+	/************** ÉTAPES DE CONFIGURATION ***************
+	1. Activer l'horloge du Timer 6
+	2. Configurer le prescaler et le registre de rechargement automatique (ARR)
+	3. Charger le prescaler par un événement de mise à jour, puis démarrer le Timer
+	*******************************************************/
+
+	// 1. Activation de l'horloge du Timer 6
+	RCC->APB1ENR |= (1<<4);  // Activation de l'horloge pour TIM6
+	
+	// 2. Configuration du prescaler et du registre ARR
+	TIM6->PSC = TIM_ComputePrescaler(SysClock_GetTree()->tim_apb1, 1000000); // Horloge timer APB1 ramenée à 1 MHz (1 µs)
+	TIM6->ARR = 0xffff;      // Valeur maximale du registre ARR (période max)
+
+	// 3. Forcer la mise à jour (UG) pour charger PSC immédiatement, plutôt que d'attendre
+	//    le premier débordement du compteur (65 ms à 1 MHz) pendant le démarrage
+	TIM6->EGR = (1<<0);      // Génération d'un événement de mise à jour (UG)
+	TIM6->SR = 0;            // Effacer le drapeau "UIF" positionné par UG
+	TIM6->CR1 |= (1<<0);     // Activation du compteur
+}
+
+/**
+  * @brief Générer un délai en microsecondes
+  * @param us : Nombre de microsecondes à attendre
+  */
+void Delay_us (uint16_t us)
+{
+	/************** ÉTAPES POUR LE DÉLAI *****************
+	1. Réinitialiser le compteur du Timer
+	2. Attendre que le compteur atteigne la valeur souhaitée.
+	   Chaque incrément correspond à un délai de 1 µs.
+	*****************************************************/
+	TIM6->CNT = 0;                // Réinitialisation du compteur
+	while (TIM6->CNT < us);       // Attente jusqu'à ce que le compteur atteigne la valeur "us"
+}
+
+/**
+  * @brief Générer un délai en millisecondes
+  * @param ms : Nombre de millisecondes à attendre
+  */
+void Delay_ms (uint16_t ms)
+{
+	for (uint16_t i = 0; i < ms; i++)
+	{
+		Delay_us(1000);           // 1 ms correspond à 1000 µs
+	}
+}
+
+/**
+  * @brief Base de temps en millisecondes (SysTick)
+  *        Horodate les échantillons et cadence la boucle principale sans dépendre de TIM6,
+  *        dont le compteur est remis à zéro par Delay_us().
+  *        Latence d'entrée : le compteur, cadencé par HCLK, a décompté LOAD - VAL cycles depuis
+  *        son rechargement, qui a déclenché l'interruption.
+  */
+static volatile uint32_t tick_ms;
+
+MEM_RAMFUNC void SysTick_Handler (void)
+{
+	uint32_t t0 = DWT_GetCycles();
+	uint32_t lat = SysTick->LOAD - SysTick->VAL;
+
+#if TRACE_SYSTICK
+	TRACE(TRACE_ISR_BEGIN, ISR_SYSTICK);
+#endif
+	tick_ms++;
+#if defined(APP_RTOS) && APP_RTOS
+	// Le SysTick est partagé avec le noyau (même fréquence : configTICK_RATE_HZ = 1000)
+	if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+		xPortSysTickHandler();
+#endif
+#if TRACE_SYSTICK
+	TRACE(TRACE_ISR_END, ISR_SYSTICK);
+#endif
+	IsrTime_Add(&IsrTime_Stats[ISR_SYSTICK].latency, lat);
+	IsrTime_Add(&IsrTime_Stats[ISR_SYSTICK].run, DWT_GetCycles() - t0);
+}
+
+/**
+  * @brief Démarrer le SysTick à 1 kHz (à appeler après la configuration de l'horloge)
+  */
+void Tick_Init (void)
+{
+	SysTick_Config(SystemCoreClock / 1000);
+}
+
+/**
+  * @brief Obtenir le temps écoulé depuis Tick_Init()
+  * @retval Temps en millisecondes
+  */
+uint32_t Tick_GetMs (void)
+{
+	return tick_ms;
+}
+
+/**
+  * @brief Obtenir le temps écoulé depuis Tick_Init() avec une résolution de 1 µs
+  *        Combine le compteur de millisecondes et la valeur courante du SysTick ; la lecture
+  *        est répétée si une interruption SysTick survient entre les deux.
+  * @retval Temps en microsecondes (reboucle toutes les ~71 minutes)
+  */
+uint32_t Tick_GetUs (void)
+{
+	uint32_t ms, val;
+
+	do {
+		ms  = tick_ms;
+		val = SysTick->VAL;
+	} while (ms != tick_ms);
+
+	return ms * 1000 + (SysTick->LOAD - val) / (SystemCoreClock / 1000000);
+}
@@ -1,9 +1,17 @@
-
-#include <stdint.h>
-
-void TIM6Config (void);
-
-void Delay_us (uint16_t us);
-
-void Delay_ms (uint16_t ms);
-
+
+#include <stdint.h>
+
+uint32_t TIM_ComputePrescaler (uint32_t timclk, uint32_t tick_hz);
+
+void TIM6Config (void);
+
+void Delay_us (uint16_t us);
+
+void Delay_ms (uint16_t ms);
+
+void Tick_Init (void);
+
+uint32_t Tick_GetMs (void);
+
+uint32_t Tick_GetUs (void);
+
@@ -0,0 +1,211 @@
+#include "Trace.h"
+#include "Frame.h"
+#include <stdio.h>
+#include <string.h>
+#if defined(__CC_ARM)
+#include "stm32f4xx.h"
+#endif
+
+/**
+  * @brief  Trace d'événements : anneau préservé à travers un reset et vidage par trames
+  *         Le vidage copie les enregistrements au fil de l'eau depuis l'anneau gelé : il n'a
+  *         pas de tampon propre. L'anneau reprend là où il en était après un vidage demandé
+  *         par l'hôte ; un anneau préservé est vidé une fois puis remis à zéro.
+  */
+
+Trace_Buffer Trace_Buf MEM_NOINIT;
+MEM_STATIC_ASSERT(sizeof(Trace_Buf) <= MEM_CCM_TRACE, trace_budget);
+
+static struct {
+	uint8_t  active;
+	uint8_t  part;                 // Prochaine partie à produire
+	uint8_t  cause;
+	uint16_t count;                // Enregistrements du vidage
+	uint16_t pos;                  // Enregistrements déjà envoyés
+	uint32_t first;                // Rang du plus ancien (compté depuis le départ)
+} dump;
+
+static uint32_t clock_now;         // Horloge de la session en cours
+
+/**
+  * @brief Préparer l'anneau (avant la première interruption, horloge système réglée)
+  * @param clock_hz : Fréquence du compteur de cycles
+  * @param keep : 1 : garder un anneau préservé jusqu'à son vidage ; 0 : repartir à zéro
+  */
+void Trace_Init (uint32_t clock_hz, int keep)
+{
+	Trace_Buffer *b = &Trace_Buf;
+
+	clock_now = clock_hz;
+	if (keep && b->magic == TRACE_MAGIC && b->size == TRACE_RECORDS && b->head != 0) {
+		if (b->frozen != TRACE_CAUSE_FAULT)
+			b->frozen = TRACE_CAUSE_RESET;
+		return;
+	}
+	memset(b, 0, sizeof(*b) - sizeof(b->rec));
+	b->size = TRACE_RECORDS;
+	b->clock_hz = clock_hz;
+	b->magic = TRACE_MAGIC;
+}
+
+/**
+  * @brief Indiquer si l'anneau vient de la session précédente (à vider)
+  * @retval TRACE_CAUSE_RESET, TRACE_CAUSE_FAULT, 0 sinon
+  */
+int Trace_Preserved (void)
+{
+	return Trace_Buf.frozen == TRACE_CAUSE_RESET || Trace_Buf.frozen == TRACE_CAUSE_FAULT ? (int)Trace_Buf.frozen : 0;
+}
+
+/**
+  * @brief Commencer un vidage (sans effet si un vidage est en cours)
+  *        Anneau préservé : son contenu ; sinon l'anneau courant, gelé jusqu'à la fin de l'envoi.
+  */
+void Trace_DumpStart (void)
+{
+	Trace_Buffer *b = &Trace_Buf;
+
+	if (dump.active)
+		return;
+	if (!b->frozen)
+		b->frozen = TRACE_CAUSE_COMMAND;
+	dump.cause = (uint8_t)b->frozen;
+	dump.count = (uint16_t)(b->head < TRACE_RECORDS ? b->head : TRACE_RECORDS);
+	dump.first = b->head - dump.count;
+	dump.pos = 0;
+	dump.part = TRACE_PART_INFO;
+	dump.active = 1;
+}
+
+/**
+  * @brief Indiquer si un vidage est en cours
+  */
+int Trace_Dumping (void)
+{
+	return dump.active;
+}
+
+// Fin du vidage : reprise de l'enregistrement, anneau préservé remis à zéro
+static void dump_end (void)
+{
+	Trace_Buffer *b = &Trace_Buf;
+
+	if (dump.cause != TRACE_CAUSE_COMMAND) {
+		memset(b, 0, sizeof(*b) - sizeof(b->rec));
+		b->size = TRACE_RECORDS;
+		b->clock_hz = clock_now;
+		b->magic = TRACE_MAGIC;
+	}
+	b->frozen = 0;
+	dump.active = 0;
+}
+
+/**
+  * @brief Données de la trame FRAME_TRACE suivante du vidage
+  * @param p : Tampon de sortie (TRACE_PAYLOAD_MAX octets)
+  * @retval Taille des données, 0 si aucun vidage n'est en cours (la partie TRACE_PART_END
+  *         termine le vidage)
+  */
+uint32_t Trace_DumpNext (uint8_t *p)
+{
+	const Trace_Buffer *b = &Trace_Buf;
+	uint32_t n, i;
+
+	if (!dump.active)
+		return 0;
+	p[0] = dump.part;
+	switch (dump.part) {
+	case TRACE_PART_INFO:
+		p[1] = dump.cause;
+		Frame_PutU16(&p[2], dump.count);
+		Frame_PutU32(&p[4], b->head);
+		Frame_PutU32(&p[8], b->clock_hz);
+		Frame_PutU32(&p[12], b->fault_pc);
+		Frame_PutU32(&p[16], b->fault_lr);
+		Frame_PutU32(&p[20], b->cfsr);
+		Frame_PutU32(&p[24], b->hfsr);
+		dump.part = dump.count ? TRACE_PART_RECORDS : TRACE_PART_END;
+		return TRACE_INFO_SIZE;
+
+	case TRACE_PART_RECORDS:
+		n = dump.count - dump.pos;
+		if (n > TRACE_CHUNK)
+			n = TRACE_CHUNK;
+		Frame_PutU16(&p[1], dump.pos);
+		p[3] = (uint8_t)n;
+		for (i = 0; i < n; i++) {
+			const Trace_Record *r = &b->rec[(dump.first + dump.pos + i) & (TRACE_RECORDS - 1)];
+			uint8_t *q = &p[TRACE_RECORDS_HDR + i * TRACE_RECORD_SIZE];
+			Frame_PutU32(q, r->cycles);
+			Frame_PutU16(&q[4], r->id);
+			Frame_PutU16(&q[6], r->arg);
+		}
+		dump.pos = (uint16_t)(dump.pos + n);
+		if (dump.pos == dump.count)
+			dump.part = TRACE_PART_END;
+		return TRACE_RECORDS_HDR + n * TRACE_RECORD_SIZE;
+
+	default:
+		Frame_PutU16(&p[1], dump.count);
+		dump_end();
+		return TRACE_END_SIZE;
+	}
+}
+
+/**
+  * @brief Construire la ligne d'état de la trace
+  * @retval Nombre de caractères écrits
+  */
+int Trace_Format (char *buf, uint32_t size)
+{
+	static const char *const causes[] = { "recording", "dump", "reset", "fault" };
+	const Trace_Buffer *b = &Trace_Buf;
+
+	if (b->frozen == TRACE_CAUSE_FAULT)
+		return snprintf(buf, size, "Trace: %s, records=%lu, pc=0x%08lX, lr=0x%08lX, cfsr=0x%08lX, hfsr=0x%08lX\r\n",
+		                causes[TRACE_CAUSE_FAULT], (unsigned long)b->head,
+		                (unsigned long)b->fault_pc, (unsigned long)b->fault_lr,
+		                (unsigned long)b->cfsr, (unsigned long)b->hfsr);
+	return snprintf(buf, size, "Trace: %s, records=%lu, ring=%u\r\n",
+	                causes[b->frozen <= TRACE_CAUSE_FAULT ? b->frozen : 0], (unsigned long)b->head,
+	                (unsigned)TRACE_RECORDS);
+}
+
+#if defined(__CC_ARM)
+/**
+  * @brief Faute (HardFault, ou MemManage/BusFault/UsageFault remontées) : enregistrer l'adresse
+  *        fautive, geler l'anneau et relancer la carte
+  * @param frame : Cadre empilé par l'exception (R0-R3, R12, LR, PC, xPSR)
+  */
+void Trace_Fault (const uint32_t *frame)
+{
+	Trace_Buffer *b = &Trace_Buf;
+
+	if (b->magic != TRACE_MAGIC || b->size != TRACE_RECORDS) {
+		memset(b, 0, sizeof(*b) - sizeof(b->rec));   // Faute avant Trace_Init()
+		b->size = TRACE_RECORDS;
+		b->magic = TRACE_MAGIC;
+	}
+	b->frozen = 0;
+	Trace_Event(TRACE_FAULT, (uint16_t)(__get_IPSR() & 0x1FF));
+	b->fault_pc = frame[6];
+	b->fault_lr = frame[5];
+	b->cfsr = SCB->CFSR;
+	b->hfsr = SCB->HFSR;
+	b->frozen = TRACE_CAUSE_FAULT;
+	NVIC_SystemReset();
+}
+
+/**
+  * @brief Gestionnaire de faute : cadre sur MSP ou PSP selon EXC_RETURN, puis Trace_Fault()
+  */
+__asm void HardFault_Handler (void)
+{
+	IMPORT  Trace_Fault
+	TST     LR, #4
+	ITE     EQ
+	MRSEQ   R0, MSP
+	MRSNE   R0, PSP
+	B       Trace_Fault
+}
+#endif
@@ -0,0 +1,149 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "MemPlan.h"
+
+/**
+  * @brief Trace binaire d'événements horodatés au compteur de cycles, pour l'analyse après coup
+  *        Chaque événement est un enregistrement de 8 octets (cycles CYCCNT, identifiant,
+  *        argument) écrit dans un anneau de TRACE_RECORDS places en CCM : une dizaine de cycles
+  *        par événement, sans appel ni test autre que le gel. Les identifiants sont fixés à la
+  *        compilation (TraceId) ; Host/tracedump.c en fait une chronologie lisible par les
+  *        visionneuses de traces (Perfetto, chrome://tracing).
+  *        L'anneau n'est pas initialisé au démarrage (région RW_TRACE de ADC_UART_V2.sct) : il
+  *        survit à un reset sans coupure d'alimentation. Une faute (HardFault_Handler) y
+  *        enregistre TRACE_FAULT et l'adresse fautive, gèle l'anneau et relance la carte ; au
+  *        démarrage suivant, un anneau préservé (faute ou simple reset) reste gelé jusqu'à son
+  *        vidage, envoyé après l'enregistrement de démarrage. L'hôte peut aussi demander un
+  *        vidage à tout moment (trame FRAME_TRACE_CMD) ; l'enregistrement est suspendu pendant
+  *        l'envoi.
+  *        Option de compilation TRACE_ENABLE=0 : aucun enregistrement (mesure de référence).
+  *        Hors cible (bancs d'essai du dossier Host), l'horloge est Trace_Clock(), fournie par
+  *        le banc, et l'enregistrement n'est pas protégé des interruptions.
+  *
+  *   Trames FRAME_TRACE (carte -> hôte, seq non utilisé), données : part (u8) | suite selon part
+  *     TRACE_PART_INFO    : cause (u8) | records (u16 LE, enregistrements du vidage) |
+  *                          total (u32 LE, enregistrements écrits depuis le départ) |
+  *                          clock_hz (u32 LE) | fault_pc | fault_lr | cfsr | hfsr (u32 LE)
+  *     TRACE_PART_RECORDS : index (u16 LE, rang du premier dans le vidage) | n (u8) |
+  *                          n x (cycles u32 LE | id u16 LE | arg u16 LE), du plus ancien au plus récent
+  *     TRACE_PART_END     : records (u16 LE)
+  *   Trame FRAME_TRACE_CMD (hôte -> carte) : sans données, demande de vidage
+  */
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE        1
+#endif
+#ifndef TRACE_SYSTICK
+#define TRACE_SYSTICK       0         // 1 : SysTick aussi (1 kHz : remplit l'anneau en 0,25 s)
+#endif
+
+#define TRACE_RECORDS       512       // Puissance de 2
+#define TRACE_MAGIC         0x54524331u
+#define TRACE_CHUNK         30        // Enregistrements par trame (trame encodée de 255 octets au plus)
+
+#define TRACE_PART_INFO     0
+#define TRACE_PART_RECORDS  1
+#define TRACE_PART_END      2
+#define TRACE_INFO_SIZE     28
+#define TRACE_RECORDS_HDR   4
+#define TRACE_RECORD_SIZE   8
+#define TRACE_END_SIZE      3
+#define TRACE_PAYLOAD_MAX   (TRACE_RECORDS_HDR + TRACE_CHUNK * TRACE_RECORD_SIZE)
+
+// Origine d'un vidage (0 : enregistrement en cours)
+#define TRACE_CAUSE_COMMAND 1         // Demande de l'hôte
+#define TRACE_CAUSE_RESET   2         // Anneau préservé à travers un reset
+#define TRACE_CAUSE_FAULT   3         // Anneau gelé par une faute, puis reset
+
+// Événements : paires _BEGIN / _END (même argument) et événements ponctuels
+typedef enum {
+	TRACE_NONE = 0,
+	TRACE_ISR_BEGIN,          // Entrée d'un gestionnaire mesuré, arg : IsrId (IsrTime.h)
+	TRACE_ISR_END,
+	TRACE_ADC_BEGIN,          // ADC_ReadBlock(), arg : canal
+	TRACE_ADC_END,
+	TRACE_TXE_BEGIN,          // UART_SendChar() bloqué sur TXE, arg : 0
+	TRACE_TXE_END,
+	TRACE_WRITE_BEGIN,        // UART_Write() en scrutation, arg : octets
+	TRACE_WRITE_END,
+	TRACE_FLUSH_BEGIN,        // UART_Flush() bloqué (DMA ou dernier octet), arg : 0
+	TRACE_FLUSH_END,
+	TRACE_MUX_WAIT_BEGIN,     // Mux_Reserve() sur file pleine, arg : flux
+	TRACE_MUX_WAIT_END,
+	TRACE_ERASE_BEGIN,        // Effacement d'un secteur du journal (Flash suspendue), arg : secteur
+	TRACE_ERASE_END,
+	TRACE_ADC_OVR,            // Débordement de l'ADC, arg : débordements (16 bits de poids faible)
+	TRACE_UART_DMA,           // Émission DMA lancée, arg : octets
+	TRACE_MUX_DROP,           // Trame abandonnée, arg : flux
+	TRACE_BAUD,               // Changement de débit, arg : débit / 100
+	TRACE_HOST,               // arg : 1 hôte présent, 0 absent
+	TRACE_LOOP,               // Période de la boucle principale, arg : 0
+	TRACE_FAULT,              // arg : numéro d'exception (IPSR)
+	TRACE_MARK,               // Marque libre, arg au choix
+	TRACE_ID_COUNT
+} TraceId;
+
+typedef struct {
+	uint32_t cycles;
+	uint16_t id;
+	uint16_t arg;
+} Trace_Record;
+
+typedef struct {
+	uint32_t magic;               // TRACE_MAGIC : contenu valide (préservé à travers un reset)
+	uint32_t size;                // TRACE_RECORDS à l'écriture
+	uint32_t head;                // Enregistrements écrits ; place suivante : head % TRACE_RECORDS
+	uint32_t frozen;              // 0 : enregistrement en cours, sinon TRACE_CAUSE_*
+	uint32_t clock_hz;
+	uint32_t fault_pc, fault_lr, cfsr, hfsr;
+	Trace_Record rec[TRACE_RECORDS];
+} Trace_Buffer;
+
+extern Trace_Buffer Trace_Buf;
+
+#if defined(__CC_ARM)
+#define TRACE_CLOCK()       (*(volatile uint32_t *)0xE0001004u)   // DWT->CYCCNT
+#else
+uint32_t Trace_Clock(void);
+#define TRACE_CLOCK()       Trace_Clock()
+#endif
+
+/**
+  * @brief Enregistrer un événement (tout contexte, gestionnaires compris)
+  */
+static __inline MEM_RAMFUNC void Trace_Event(uint16_t id, uint16_t arg)
+{
+#if defined(__CC_ARM)
+	int masked = __disable_irq();   // Ancien état de PRIMASK
+#endif
+	uint32_t i = Trace_Buf.head;
+
+	if (!Trace_Buf.frozen) {
+		Trace_Record *r = &Trace_Buf.rec[i & (TRACE_RECORDS - 1)];
+		r->cycles = TRACE_CLOCK();
+		r->id = id;
+		r->arg = arg;
+		Trace_Buf.head = i + 1;
+	}
+#if defined(__CC_ARM)
+	if (!masked)
+		__enable_irq();
+#endif
+}
+
+#if TRACE_ENABLE
+#define TRACE(id, arg)      Trace_Event((uint16_t)(id), (uint16_t)(arg))
+#else
+#define TRACE(id, arg)      ((void)0)
+#endif
+
+void Trace_Init(uint32_t clock_hz, int keep);
+int Trace_Preserved(void);
+void Trace_DumpStart(void);
+int Trace_Dumping(void);
+uint32_t Trace_DumpNext(uint8_t *p);
+int Trace_Format(char *buf, uint32_t size);
+
+#endif /* TRACE_H */
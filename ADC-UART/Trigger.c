@@ -0,0 +1,140 @@
+#include "Trigger.h"
+#include "MemPlan.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+  * @brief Initialiser l'appariement
+  * @param conv_ticks : Durée d'une conversion déclenchée, synchronisation comprise (ticks)
+  */
+void Trigger_Init (Trigger *t, uint32_t conv_ticks)
+{
+	memset(t, 0, sizeof(*t));
+	t->conv_ticks = conv_ticks;
+	Spsc_Init(&t->q, t->ring, sizeof(Trigger_Sample), TRIGGER_RING);
+}
+
+static MEM_RAMFUNC void count_missed (Trigger *t, uint32_t n)
+{
+	t->stats.missed += n;
+	t->pending_missed = (uint16_t)(t->pending_missed + n > 0xFFFF ? 0xFFFF : t->pending_missed + n);
+}
+
+/**
+  * @brief Enregistrer un front (interruption de capture)
+  * @param t_edge : Date capturée
+  * @param lost : Fronts perdus par la capture elle-même depuis l'appel précédent (écrasement)
+  */
+MEM_RAMFUNC void Trigger_Edge (Trigger *t, uint32_t t_edge, uint32_t lost)
+{
+	t->stats.edges += 1 + lost;
+	if (lost)
+		count_missed(t, lost);
+	if (t->f_count == 0 && t->converted && t_edge - t->t_last < t->conv_ticks) {
+		count_missed(t, 1);                  // Arrivé pendant une conversion déjà lue
+		return;
+	}
+	if (t->f_count == TRIGGER_FIFO) {
+		count_missed(t, 1);                  // Plus de conversion depuis TRIGGER_FIFO fronts
+		return;
+	}
+	t->fifo[(t->f_rd + t->f_count) % TRIGGER_FIFO] = t_edge;
+	t->f_count++;
+}
+
+/**
+  * @brief Enregistrer une conversion terminée (interruption EOC)
+  *        Elle appartient au plus ancien front en attente ; les fronts suivants arrivés pendant
+  *        sa conversion ont été ignorés par l'ADC.
+  * @param t_now : Date de lecture du résultat
+  * @param value : Résultat
+  */
+MEM_RAMFUNC void Trigger_Conversion (Trigger *t, uint32_t t_now, uint16_t value)
+{
+	Trigger_Sample *s;
+	uint32_t e, lat;
+
+	if (t->f_count == 0) {
+		t->stats.orphans++;
+		return;
+	}
+	e = t->fifo[t->f_rd];
+	t->f_rd = (uint8_t)((t->f_rd + 1) % TRIGGER_FIFO);
+	t->f_count--;
+	while (t->f_count && t->fifo[t->f_rd] - e < t->conv_ticks) {
+		t->f_rd = (uint8_t)((t->f_rd + 1) % TRIGGER_FIFO);
+		t->f_count--;
+		count_missed(t, 1);
+	}
+	t->t_last = e;
+	t->converted = 1;
+
+	lat = t_now - e;
+	if (t->stats.samples == 0 || lat < t->stats.lat_min)
+		t->stats.lat_min = lat;
+	if (lat > t->stats.lat_max)
+		t->stats.lat_max = lat;
+	t->stats.lat_sum += lat;
+	t->stats.samples++;
+
+	s = Spsc_Claim(&t->q);
+	if (!s) {
+		t->stats.overflows++;
+		if (t->pending_missed < 0xFFFF)
+			t->pending_missed++;             // Signalé avec l'échantillon suivant
+		return;
+	}
+	s->t_edge = e;
+	s->latency = lat;
+	s->value = value;
+	s->missed = t->pending_missed;
+	t->pending_missed = 0;
+	Spsc_Commit(&t->q);
+}
+
+/**
+  * @brief Conversion perdue (débordement de l'ADC) : le plus ancien front en attente est manqué
+  */
+MEM_RAMFUNC void Trigger_Drop (Trigger *t)
+{
+	if (t->f_count) {
+		t->t_last = t->fifo[t->f_rd];
+		t->converted = 1;
+		t->f_rd = (uint8_t)((t->f_rd + 1) % TRIGGER_FIFO);
+		t->f_count--;
+		count_missed(t, 1);
+	}
+}
+
+/**
+  * @brief Lire les échantillons en attente
+  * @retval Nombre d'échantillons rendus
+  */
+uint32_t Trigger_Read (Trigger *t, Trigger_Sample *out, uint32_t max)
+{
+	const Trigger_Sample *s;
+	uint32_t n = 0;
+
+	while (n < max && (s = Spsc_Peek(&t->q)) != 0) {
+		out[n++] = *s;
+		Spsc_Release(&t->q);
+	}
+	return n;
+}
+
+/**
+  * @brief Construire la ligne des compteurs et de la latence
+  * @param tick_hz : Fréquence de la base de temps
+  * @retval Nombre de caractères écrits
+  */
+int Trigger_Format (const Trigger_Stats *s, uint32_t tick_hz, char *buf, uint32_t size)
+{
+	double ns = 1e9 / tick_hz;
+	double avg = s->samples ? (double)s->lat_sum / s->samples : 0;
+
+	return snprintf(buf, size, "Trigger: edges=%lu samples=%lu missed=%lu orphans=%lu overflows=%lu, latency=%lu/%lu/%lu ns\r\n",
+	                (unsigned long)s->edges, (unsigned long)s->samples, (unsigned long)s->missed,
+	                (unsigned long)s->orphans, (unsigned long)s->overflows,
+	                (unsigned long)(s->lat_min * ns), (unsigned long)(avg * ns),
+	                (unsigned long)(s->lat_max * ns));
+}
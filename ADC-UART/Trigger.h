@@ -0,0 +1,57 @@
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stdint.h>
+#include "Spsc.h"
+
+/**
+  * @brief Acquisition déclenchée par un front externe : appariement fronts / conversions
+  *        Les fronts sont datés par capture (Trigger_Edge, interruption de capture) et chaque
+  *        conversion terminée est datée à la lecture du résultat (Trigger_Conversion,
+  *        interruption EOC), dans la même base de temps (ticks 32 bits, rebouclage toléré).
+  *        L'ADC ignore un front pendant une conversion : un front arrivé moins de conv_ticks
+  *        après le front converti est compté manqué. Latence : du front à la disponibilité de
+  *        l'échantillon pour le CPU (conversion et entrée en interruption comprises).
+  *        Module sans dépendance matérielle (Host/trigbench.c).
+  */
+
+#define TRIGGER_FIFO    8      // Fronts en attente de conversion
+#define TRIGGER_RING    128    // Échantillons en attente de lecture (puissance de 2)
+
+typedef struct {
+	uint32_t t_edge;             // Date du front (ticks)
+	uint32_t latency;            // Front -> échantillon disponible (ticks)
+	uint16_t value;
+	uint16_t missed;             // Fronts manqués et échantillons perdus depuis le précédent
+} Trigger_Sample;
+
+typedef struct {
+	uint32_t edges;              // Fronts capturés
+	uint32_t samples;            // Conversions appariées à un front
+	uint32_t missed;             // Fronts sans conversion (ADC occupé, capture écrasée)
+	uint32_t orphans;            // Conversions sans front connu
+	uint32_t overflows;          // Échantillons perdus : anneau plein
+	uint32_t lat_min, lat_max;   // Latence (ticks)
+	uint64_t lat_sum;
+} Trigger_Stats;
+
+typedef struct {
+	uint32_t          conv_ticks;            // Durée d'une conversion (ticks)
+	uint32_t          fifo[TRIGGER_FIFO];
+	uint8_t           f_rd, f_count;
+	uint8_t           converted;             // t_last valide
+	uint32_t          t_last;                // Dernier front converti ou perdu par débordement
+	uint16_t          pending_missed;        // Manqués à reporter sur le prochain échantillon
+	Trigger_Sample    ring[TRIGGER_RING];
+	Spsc              q;                     // File de ring : interruption EOC -> Trigger_Read()
+	Trigger_Stats     stats;
+} Trigger;
+
+void Trigger_Init(Trigger *t, uint32_t conv_ticks);
+void Trigger_Edge(Trigger *t, uint32_t t_edge, uint32_t lost);
+void Trigger_Conversion(Trigger *t, uint32_t t_now, uint16_t value);
+void Trigger_Drop(Trigger *t);
+uint32_t Trigger_Read(Trigger *t, Trigger_Sample *out, uint32_t max);
+int Trigger_Format(const Trigger_Stats *s, uint32_t tick_hz, char *buf, uint32_t size);
+
+#endif /* TRIGGER_H */
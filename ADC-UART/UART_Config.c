@@ -1,90 +1,447 @@
-#include "UART_Config.h"
-#include "SystemClock.h"
-
-/**
-  * @brief Configuration de l'UART2
-  *        Cette fonction initialise l'UART2 pour la communication srie, avec un dbit en bauds
-  *        configur  115200. Les broches PA2 et PA3 sont utilises en mode fonction alternative.
-  */
-void Uart2Config (void)
-{
-	/************** TAPES DE CONFIGURATION ***************
-	1. Activer les horloges pour l'UART2 et les GPIO
-	2. Configurer les broches de l'UART en mode fonction alternative
-	3. Activer l'UART en rglant le bit UE dans le registre USART_CR1
-	4. Dfinir la longueur des mots avec le bit M dans le registre USART_CR1
-	5. Configurer le dbit en bauds dans le registre USART_BRR
-	6. Activer l'metteur et le rcepteur en rglant les bits TE et RE dans USART_CR1
-	*******************************************************/
-
-	// 1. Activer les horloges pour l'UART2 et GPIOA
-	RCC->APB1ENR |= (1<<17);  // Activer l'horloge de l'UART2
-	RCC->AHB1ENR |= (1<<0);   // Activer l'horloge de GPIOA
-	
-	// 2. Configurer les broches PA2 (TX) et PA3 (RX) en mode fonction alternative
-	GPIOA->MODER |= (2<<4);  // PA2 : mode fonction alternative
-	GPIOA->MODER |= (2<<6);  // PA3 : mode fonction alternative
-	
-	GPIOA->OSPEEDR |= (3<<4) | (3<<6);  // PA2 et PA3 : haute vitesse
-	
-	GPIOA->AFR[0] |= (7<<8);   // PA2 : AF7 (USART2)
-	GPIOA->AFR[0] |= (7<<12);  // PA3 : AF7 (USART2)
-	
-	// 3. Activer l'UART2
-	USART2->CR1 = 0x00;            // Rinitialiser le registre CR1
-	USART2->CR1 |= (1<<13);        // Activer l'UART2 (UE = 1)
-	
-	// 4. Dfinir la longueur des mots  8 bits
-	USART2->CR1 &= ~(1<<12);       // M = 0 (8 bits)
-	
-	// 5. Configurer le dbit en bauds (115200 bauds)
-	USART2->BRR = (7<<0) | (24<<4); // Baud Rate  115200 pour une horloge PCLK1 de 45 MHz
-	
-	// 6. Activer le rcepteur et l'metteur
-	USART2->CR1 |= (1<<2); // Activer le rcepteur (RE = 1)
-	USART2->CR1 |= (1<<3); // Activer l'metteur (TE = 1)
-}
-
-/**
-  * @brief Envoyer un caractre via UART2
-  * @param c : Caractre  envoyer
-  */
-void UART2_SendChar (uint8_t c)
-{
-	/************** TAPES POUR L'ENVOI ***************
-	1. Charger le caractre  envoyer dans le registre USART_DR
-	2. Attendre que le drapeau TC (Transmission Complete) soit activ
-	***************************************************/
-	USART2->DR = c;  // Charger le caractre dans le registre DR
-	while (!(USART2->SR & (1<<6)));  // Attendre que le drapeau TC soit activ
-}
-
-/**
-  * @brief Envoyer une chane de caractres via UART2
-  * @param USARTx : Priphrique UART
-  * @param string : Pointeur vers la chane  envoyer
-  * @param length : Longueur de la chane
-  * @param timeout : Dlai d'attente (non utilis ici)
-  */
-void UART2_SendString(USART_TypeDef *USARTx, uint8_t *string, uint32_t length, uint32_t timeout)
-{
-	while (*string && length--) {
-		UART2_SendChar(*string++);
-	}
-}
-
-/**
-  * @brief Recevoir un caractre via UART2
-  * @retval Caractre reu
-  */
-uint8_t UART2_GetChar (void)
-{
-	/************** TAPES POUR LA RCEPTION ***************
-	1. Attendre que le drapeau RXNE soit activ (donnes reues prtes)
-	2. Lire les donnes dans le registre USART_DR, ce qui rinitialise le drapeau RXNE
-	*******************************************************/
-	uint8_t data;
-	while (!(USART2->SR & (1<<5)));  // Attendre que RXNE soit activ
-	data = USART2->DR;               // Lire les donnes reues
-	return data;
-}
+#include "UART_Config.h"
+#include "SystemClock.h"
+#include "Trace.h"
+
+/**
+  * @brief  Pilote USART multi-instance
+  *         Chaque instance est décrite par un UART_HwConfig constant (broches, horloges, DMA)
+  *         et un UART_Handle contenant son état. Les USART1 et USART6 sont sur APB2 (84 MHz
+  *         en profil performance) et atteignent 10,5 Mbauds avec OVER8 ; l'USART2 est sur
+  *         APB1 (42 MHz). Les anciennes fonctions UART2_xxx restent disponibles.
+  */
+
+static const UART_HwConfig uart1_hw = {
+	USART1, GPIOA, 9, 10, 7, 1, (1<<4), (1<<0), DMA2, DMA2_Stream7, 4, 1, 22, USART1_IRQn
+};
+static const UART_HwConfig uart2_hw = {
+	USART2, GPIOA, 2, 3, 7, 0, (1<<17), (1<<0), DMA1, DMA1_Stream6, 4, 1, 16, USART2_IRQn
+};
+static const UART_HwConfig uart6_hw = {
+	USART6, GPIOC, 6, 7, 8, 1, (1<<5), (1<<2), DMA2, DMA2_Stream6, 5, 1, 16, USART6_IRQn
+};
+
+UART_Handle huart1 = { .hw = &uart1_hw };
+UART_Handle huart2 = { .hw = &uart2_hw };
+UART_Handle huart6 = { .hw = &uart6_hw };
+
+/**
+  * @brief Indiquer si le suréchantillonnage par 8 est nécessaire
+  *        Avec OVER8 = 0, le débit maximal est PCLK/16 ; au-delà, OVER8 = 1 permet PCLK/8.
+  * @param pclk : Horloge du bus APB de l'USART (Hz)
+  * @param baud : Débit souhaité
+  * @retval 1 si OVER8 doit être activé
+  */
+uint32_t UART_NeedsOver8 (uint32_t pclk, uint32_t baud)
+{
+	return (baud > pclk / 16);
+}
+
+/**
+  * @brief Calculer la valeur du registre BRR
+  *        USARTDIV = PCLK / (8 x (2 - OVER8) x baud), arrondi au plus proche.
+  *        Avec OVER8 = 1, la fraction est sur 3 bits et le bit 3 de BRR doit rester à 0.
+  * @param pclk : Horloge du bus APB de l'USART (Hz)
+  * @param baud : Débit souhaité
+  * @param over8 : Mode de suréchantillonnage (0 ou 1)
+  * @retval Valeur à écrire dans USART_BRR
+  */
+uint32_t UART_ComputeBRR (uint32_t pclk, uint32_t baud, uint32_t over8)
+{
+	if (!over8)
+		return (pclk + baud / 2) / baud;             // USARTDIV x 16 = mantisse << 4 | fraction
+
+	uint32_t div8 = (pclk + baud / 2) / baud;        // USARTDIV x 8
+	return ((div8 >> 3) << 4) | (div8 & 0x7);
+}
+
+/**
+  * @brief Calculer BRR, OVER8, le débit réel et l'erreur pour un débit demandé
+  * @param pclk : Horloge du bus APB de l'USART (Hz)
+  * @param baud : Débit souhaité
+  * @param info : Résultat
+  */
+void UART_ComputeBaud (uint32_t pclk, uint32_t baud, UART_BaudInfo *info)
+{
+	uint32_t div;
+
+	info->over8 = UART_NeedsOver8(pclk, baud);
+	info->brr   = UART_ComputeBRR(pclk, baud, info->over8);
+
+	// Diviseur effectif en 1/16 (OVER8 = 0) ou 1/8 (OVER8 = 1) de période bit
+	div = info->over8 ? (((info->brr >> 4) << 3) | (info->brr & 0x7)) : info->brr;
+	info->actual = div ? (pclk + div / 2) / div : 0;
+	info->error_ppm = (int32_t)(((int64_t)info->actual - baud) * 1000000 / baud);
+}
+
+/**
+  * @brief Horloge APB d'une instance, selon l'arbre d'horloge actif
+  */
+uint32_t UART_GetPclk (const UART_Handle *h)
+{
+	return h->hw->apb2 ? SysClock_GetTree()->pclk2 : SysClock_GetTree()->pclk1;
+}
+
+/**
+  * @brief Débit maximal d'une instance (OVER8 = 1, USARTDIV = 1)
+  */
+uint32_t UART_MaxBaud (const UART_Handle *h)
+{
+	return UART_GetPclk(h) / 8;
+}
+
+/**
+  * @brief Calculer le réglage d'un débit et vérifier qu'il est atteignable
+  * @param h : Instance (horloge APB)
+  * @param baud : Débit souhaité
+  * @param info : Résultat (rempli si baud > 0)
+  * @retval 0 si le débit est atteignable à UART_BAUD_TOL_PPM près, -1 sinon
+  */
+int UART_CheckBaud (const UART_Handle *h, uint32_t baud, UART_BaudInfo *info)
+{
+	if (baud == 0)
+		return -1;
+	UART_ComputeBaud(UART_GetPclk(h), baud, info);
+	if (baud > UART_MaxBaud(h) || info->error_ppm > UART_BAUD_TOL_PPM || info->error_ppm < -UART_BAUD_TOL_PPM)
+		return -1;
+	return 0;
+}
+
+/**
+  * @brief Configuration d'une instance USART
+  *        Broches en fonction alternative, 8 bits sans parité, émission DMA préparée.
+  * @param h : Instance
+  * @param baud : Débit souhaité
+  * @retval 0 si le débit est atteignable à UART_BAUD_TOL_PPM près, -1 sinon
+  */
+int UART_Init (UART_Handle *h, uint32_t baud)
+{
+	/************** ÉTAPES DE CONFIGURATION ***************
+	1. Calculer BRR / OVER8 et vérifier l'erreur de débit
+	2. Activer les horloges de l'USART, du port GPIO et du DMA
+	3. Configurer les broches de l'UART en mode fonction alternative
+	4. Configurer l'USART : 8 bits, débit, DMA en émission, TE / RE puis UE
+	*******************************************************/
+	const UART_HwConfig *hw = h->hw;
+	USART_TypeDef *u = hw->usart;
+	UART_BaudInfo info;
+
+	// 1. Débit
+	if (UART_CheckBaud(h, baud, &info) != 0)
+		return -1;
+
+	// 2. Horloges
+	if (hw->apb2)
+		RCC->APB2ENR |= hw->rcc_bit;
+	else
+		RCC->APB1ENR |= hw->rcc_bit;
+	RCC->AHB1ENR |= hw->gpio_bit;
+	RCC->AHB1ENR |= (hw->dma == DMA1) ? (1<<21) : (1<<22);  // DMA1EN / DMA2EN
+
+	// 3. Broches TX / RX en fonction alternative, haute vitesse
+	hw->port->MODER   = (hw->port->MODER & ~((3U << (2 * hw->tx_pin)) | (3U << (2 * hw->rx_pin))))
+	                  | (2U << (2 * hw->tx_pin)) | (2U << (2 * hw->rx_pin));
+	hw->port->OSPEEDR |= (3U << (2 * hw->tx_pin)) | (3U << (2 * hw->rx_pin));
+	hw->port->AFR[hw->tx_pin >> 3] = (hw->port->AFR[hw->tx_pin >> 3] & ~(0xFU << (4 * (hw->tx_pin & 7))))
+	                               | ((uint32_t)hw->af << (4 * (hw->tx_pin & 7)));
+	hw->port->AFR[hw->rx_pin >> 3] = (hw->port->AFR[hw->rx_pin >> 3] & ~(0xFU << (4 * (hw->rx_pin & 7))))
+	                               | ((uint32_t)hw->af << (4 * (hw->rx_pin & 7)));
+
+	// 4. USART
+	u->CR1 = 0x00;                   // Réinitialiser (UE = 0 pour modifier OVER8)
+	if (info.over8)
+		u->CR1 |= (1<<15);           // Suréchantillonnage par 8 (OVER8 = 1)
+	u->BRR = info.brr;
+	u->CR3 |= (1<<7);                // Émission par DMA (DMAT = 1)
+	u->CR1 |= (1<<2) | (1<<3);       // Activer le récepteur et l'émetteur (RE = TE = 1)
+	if (h->rx_irq)
+		u->CR1 |= (1<<5);            // Réception sous interruption conservée (RXNEIE = 1)
+	u->CR1 |= (1<<13);               // Activer l'USART (UE = 1)
+
+	h->baud = info;
+	h->requested = baud;
+	return 0;
+}
+
+/**
+  * @brief Changer le débit d'une instance initialisée
+  *        Attend la fin de l'émission en cours ; broches, DMA et réception sous interruption
+  *        sont conservés. Un octet en cours de réception est perdu.
+  * @param h : Instance
+  * @param baud : Débit souhaité
+  * @retval 0, -1 si le débit n'est pas atteignable (débit inchangé)
+  */
+int UART_SetBaud (UART_Handle *h, uint32_t baud)
+{
+	USART_TypeDef *u = h->hw->usart;
+	UART_BaudInfo info;
+
+	if (UART_CheckBaud(h, baud, &info) != 0)
+		return -1;
+	UART_Flush(h);
+	u->CR1 &= ~(1<<13);              // UE = 0 pour modifier OVER8
+	if (info.over8)
+		u->CR1 |= (1<<15);
+	else
+		u->CR1 &= ~(1<<15);
+	u->BRR = info.brr;
+	u->CR1 |= (1<<13);
+
+	h->baud = info;
+	h->requested = baud;
+	TRACE(TRACE_BAUD, baud / 100);
+	return 0;
+}
+
+/**
+  * @brief Envoyer un caractère
+  *        Attend que le registre de données soit libre (TXE) plutôt que la fin de trame (TC) :
+  *        l'octet suivant est chargé pendant l'émission du précédent. Une attente effective
+  *        est tracée (TRACE_TXE_BEGIN / END).
+  * @param h : Instance
+  * @param c : Caractère à envoyer
+  */
+void UART_SendChar (UART_Handle *h, uint8_t c)
+{
+	if (!(h->hw->usart->SR & (1<<7))) {
+		TRACE(TRACE_TXE_BEGIN, 0);
+		while (!(h->hw->usart->SR & (1<<7)));  // Attendre que TXE soit activé
+		TRACE(TRACE_TXE_END, 0);
+	}
+	h->hw->usart->DR = c;
+	h->tx_bytes++;
+}
+
+/**
+  * @brief Envoyer un bloc d'octets en scrutation
+  *        Tracé d'un bloc (TRACE_WRITE_BEGIN / END) : les attentes octet par octet ne le sont pas.
+  * @param h : Instance
+  * @param data : Données
+  * @param length : Nombre d'octets
+  */
+void UART_Write (UART_Handle *h, const uint8_t *data, uint32_t length)
+{
+	USART_TypeDef *u = h->hw->usart;
+
+	TRACE(TRACE_WRITE_BEGIN, length);
+	h->tx_bytes += length;
+	while (length--) {
+		while (!(u->SR & (1<<7)));
+		u->DR = *data++;
+	}
+	TRACE(TRACE_WRITE_END, 0);
+}
+
+/**
+  * @brief Indiquer si une émission DMA est en cours
+  */
+int UART_TxBusy (const UART_Handle *h)
+{
+	return (h->hw->tx_stream->CR & (1<<0)) != 0;  // EN est remis à 0 par le matériel en fin de transfert
+}
+
+/**
+  * @brief Lancer l'émission d'un bloc par DMA, sans attendre
+  *        Le tampon doit rester valide jusqu'à ce que UART_TxBusy() retourne 0.
+  * @param h : Instance
+  * @param data : Données
+  * @param length : Nombre d'octets (1 à 65535)
+  * @retval 0 si le transfert est lancé, -1 si une émission est déjà en cours
+  */
+int UART_WriteDMA (UART_Handle *h, const uint8_t *data, uint32_t length)
+{
+	const UART_HwConfig *hw = h->hw;
+	DMA_Stream_TypeDef *s = hw->tx_stream;
+
+	if (UART_TxBusy(h))
+		return -1;
+
+	// Effacer les drapeaux du flux (FEIF, DMEIF, TEIF, HTIF, TCIF)
+	if (hw->tx_flag_hi)
+		hw->dma->HIFCR = (0x3DU << hw->tx_flag_sh);
+	else
+		hw->dma->LIFCR = (0x3DU << hw->tx_flag_sh);
+
+	s->PAR  = (uint32_t)&hw->usart->DR;
+	s->M0AR = (uint32_t)data;
+	s->NDTR = length;
+	s->CR   = ((uint32_t)hw->tx_channel << 25) |  // Canal de requête
+	          (1<<10) |                          // Incrément mémoire
+	          (1<<6);                            // Mémoire vers périphérique
+	hw->usart->SR &= ~(1<<6);                    // Effacer TC
+	s->CR  |= (1<<0);                            // Démarrer le flux
+	TRACE(TRACE_UART_DMA, length);
+
+	h->tx_bytes += length;
+	return 0;
+}
+
+/**
+  * @brief Attendre la fin de toute émission (DMA et dernier octet sur la ligne)
+  */
+void UART_Flush (const UART_Handle *h)
+{
+	if (UART_TxBusy(h) || !(h->hw->usart->SR & (1<<6))) {
+		TRACE(TRACE_FLUSH_BEGIN, 0);
+		while (UART_TxBusy(h));
+		while (!(h->hw->usart->SR & (1<<6)));  // Attendre que le drapeau TC soit activé
+		TRACE(TRACE_FLUSH_END, 0);
+	}
+}
+
+/**
+  * @brief Recevoir un caractère
+  * @param h : Instance
+  * @retval Caractère reçu
+  */
+uint8_t UART_GetChar (UART_Handle *h)
+{
+	/************** ÉTAPES POUR LA RÉCEPTION ***************
+	1. Attendre que le drapeau RXNE soit activé (données reçues prêtes)
+	2. Lire les données dans le registre USART_DR, ce qui réinitialise le drapeau RXNE
+	*******************************************************/
+	uint8_t c;
+
+	if (h->rx_irq) {
+		while (!UART_TryGetChar(h, &c));
+		return c;
+	}
+	while (!(h->hw->usart->SR & (1<<5)));  // Attendre que RXNE soit activé
+	return h->hw->usart->DR;               // Lire les données reçues
+}
+
+/**
+  * @brief Lire un caractère s'il y en a un, sans attendre
+  * @param h : Instance
+  * @param c : Caractère reçu
+  * @retval 1 si un caractère a été lu, 0 sinon
+  */
+int UART_TryGetChar (UART_Handle *h, uint8_t *c)
+{
+	if (h->rx_irq) {
+		const uint8_t *p = Spsc_Peek(&h->rx);
+		if (!p)
+			return 0;
+		*c = *p;
+		Spsc_Release(&h->rx);
+		return 1;
+	}
+	if (!(h->hw->usart->SR & (1<<5)))      // RXNE
+		return 0;
+	*c = h->hw->usart->DR;
+	return 1;
+}
+
+/**
+  * @brief Recevoir sous interruption dans une file de UART_RX_SIZE octets
+  *        En scrutation, un octet non lu avant l'arrivée du suivant est perdu : une trame
+  *        reçue d'un bloc (acquittements du mode fiable) exige une file. Un seul lecteur
+  *        (UART_TryGetChar) ; l'interruption est le seul écrivain (Spsc.h).
+  * @param h : Instance (déjà initialisée)
+  */
+void UART_EnableRxIrq (UART_Handle *h)
+{
+	USART_TypeDef *u = h->hw->usart;
+
+	Spsc_Init(&h->rx, h->rx_buf, 1, UART_RX_SIZE);
+	h->rx_overruns = 0;
+	h->rx_errors = 0;
+	h->rx_irq = 1;
+	(void)u->SR;
+	(void)u->DR;                           // Octet en attente éventuel
+	NVIC_SetPriority(h->hw->irq, UART_RX_PRIO);
+	NVIC_EnableIRQ(h->hw->irq);
+	u->CR1 |= (1<<5);                      // RXNEIE = 1
+}
+
+// Octet reçu (RXNE) ou débordement (ORE) : la lecture de SR puis DR efface aussi NF, FE et PE
+static void rx_irq (UART_Handle *h)
+{
+	USART_TypeDef *u = h->hw->usart;
+	uint32_t sr = u->SR;
+	uint8_t c, *p;
+
+	if (!(sr & ((1<<5) | (1<<3))))
+		return;
+	c = (uint8_t)u->DR;
+	if (sr & (1<<3))
+		h->rx_overruns++;
+	if (sr & ((1<<2) | (1<<1) | (1<<0)))
+		h->rx_errors++;
+	p = Spsc_Claim(&h->rx);
+	if (p) {
+		*p = c;
+		Spsc_Commit(&h->rx);
+	}
+}
+
+void USART1_IRQHandler (void)
+{
+	rx_irq(&huart1);
+}
+
+void USART2_IRQHandler (void)
+{
+	rx_irq(&huart2);
+}
+
+void USART6_IRQHandler (void)
+{
+	rx_irq(&huart6);
+}
+
+/**
+  * @brief Retrouver l'instance associée à un périphérique USART
+  * @param USARTx : Périphérique
+  * @retval Instance, ou NULL si le périphérique n'est pas géré
+  */
+UART_Handle *UART_FromInstance (USART_TypeDef *USARTx)
+{
+	if (USARTx == USART1) return &huart1;
+	if (USARTx == USART2) return &huart2;
+	if (USARTx == USART6) return &huart6;
+	return 0;
+}
+
+/**
+  * @brief Configuration de l'UART2
+  *        Cette fonction initialise l'UART2 pour la communication série, avec un débit en bauds
+  *        configuré à 115200. Les broches PA2 et PA3 sont utilisées en mode fonction alternative.
+  */
+void Uart2Config (void)
+{
+	UART_Init(&huart2, UART2_BAUD);
+}
+
+/**
+  * @brief Envoyer un caractère via UART2
+  * @param c : Caractère à envoyer
+  */
+void UART2_SendChar (uint8_t c)
+{
+	UART_SendChar(&huart2, c);
+}
+
+/**
+  * @brief Envoyer une chaîne de caractères via un UART
+  * @param USARTx : Périphérique UART
+  * @param string : Pointeur vers la chaîne à envoyer
+  * @param length : Longueur de la chaîne
+  * @param timeout : Délai d'attente (non utilisé ici)
+  */
+void UART2_SendString(USART_TypeDef *USARTx, uint8_t *string, uint32_t length, uint32_t timeout)
+{
+	UART_Handle *h = UART_FromInstance(USARTx);
+
+	while (h && *string && length--) {
+		UART_SendChar(h, *string++);
+	}
+}
+
+/**
+  * @brief Recevoir un caractère via UART2
+  * @retval Caractère reçu
+  */
+uint8_t UART2_GetChar (void)
+{
+	return UART_GetChar(&huart2);
+}
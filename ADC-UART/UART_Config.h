@@ -1,12 +1,81 @@
-#ifndef UART_H
-#define UART_H
-
-#include "stm32f4xx.h"
-
-void Uart2Config(void);
-void UART2_SendChar(uint8_t c);
-void UART2_SendString(USART_TypeDef *USARTx, uint8_t *string, uint32_t length, uint32_t timeout);
-uint8_t UART2_GetChar(void);
-
-
-#endif /* UART_H */
+#ifndef UART_H
+#define UART_H
+
+#include "stm32f4xx.h"
+#include "Spsc.h"
+
+#define UART2_BAUD 115200
+
+#define UART_BAUD_TOL_PPM 20000   // Erreur de débit maximale acceptée (2 %)
+#define UART_RX_SIZE      64      // File de réception sous interruption (puissance de 2)
+#define UART_RX_PRIO      8       // Sous l'acquisition, sans appel au noyau
+
+// Câblage d'une instance USART : broches, horloges et flux DMA d'émission
+typedef struct {
+	USART_TypeDef      *usart;
+	GPIO_TypeDef       *port;       // Port des broches TX/RX
+	uint8_t             tx_pin;
+	uint8_t             rx_pin;
+	uint8_t             af;         // Fonction alternative des broches
+	uint8_t             apb2;       // 1 si l'USART est sur APB2 (PCLK2), 0 sur APB1
+	uint32_t            rcc_bit;    // Bit d'activation dans APB1ENR / APB2ENR
+	uint32_t            gpio_bit;   // Bit d'activation du port dans AHB1ENR
+	DMA_TypeDef        *dma;
+	DMA_Stream_TypeDef *tx_stream;
+	uint8_t             tx_channel; // Canal de requête DMA (CHSEL)
+	uint8_t             tx_flag_hi; // 1 si les drapeaux du flux sont dans HISR/HIFCR
+	uint8_t             tx_flag_sh; // Décalage des drapeaux du flux (0, 6, 16 ou 22)
+	IRQn_Type           irq;
+} UART_HwConfig;
+
+// Débit obtenu pour une demande donnée
+typedef struct {
+	uint32_t brr;
+	uint32_t over8;
+	uint32_t actual;     // Débit réel (bauds)
+	int32_t  error_ppm;  // Écart relatif au débit demandé (ppm)
+} UART_BaudInfo;
+
+// État propre à chaque instance
+typedef struct {
+	const UART_HwConfig *hw;
+	UART_BaudInfo        baud;
+	uint32_t             requested;  // Débit demandé
+	uint32_t             tx_bytes;   // Octets émis
+	uint8_t              rx_irq;     // Réception sous interruption (UART_EnableRxIrq)
+	Spsc                 rx;         // Interruption -> UART_TryGetChar (file pleine : rx.full)
+	uint32_t             rx_overruns;// Octets perdus par l'USART (ORE)
+	uint32_t             rx_errors;  // Octets reçus avec bruit, erreur de trame ou de parité
+	uint8_t              rx_buf[UART_RX_SIZE];
+} UART_Handle;
+
+extern UART_Handle huart1;  // USART1 : PA9/PA10, APB2, DMA2 Stream7
+extern UART_Handle huart2;  // USART2 : PA2/PA3, APB1, DMA1 Stream6
+extern UART_Handle huart6;  // USART6 : PC6/PC7, APB2, DMA2 Stream6
+
+uint32_t UART_NeedsOver8(uint32_t pclk, uint32_t baud);
+uint32_t UART_ComputeBRR(uint32_t pclk, uint32_t baud, uint32_t over8);
+void UART_ComputeBaud(uint32_t pclk, uint32_t baud, UART_BaudInfo *info);
+uint32_t UART_GetPclk(const UART_Handle *h);
+uint32_t UART_MaxBaud(const UART_Handle *h);
+int UART_CheckBaud(const UART_Handle *h, uint32_t baud, UART_BaudInfo *info);
+
+int UART_Init(UART_Handle *h, uint32_t baud);
+int UART_SetBaud(UART_Handle *h, uint32_t baud);
+void UART_SendChar(UART_Handle *h, uint8_t c);
+void UART_Write(UART_Handle *h, const uint8_t *data, uint32_t length);
+int UART_WriteDMA(UART_Handle *h, const uint8_t *data, uint32_t length);
+int UART_TxBusy(const UART_Handle *h);
+void UART_Flush(const UART_Handle *h);
+uint8_t UART_GetChar(UART_Handle *h);
+int UART_TryGetChar(UART_Handle *h, uint8_t *c);
+void UART_EnableRxIrq(UART_Handle *h);
+UART_Handle *UART_FromInstance(USART_TypeDef *USARTx);
+
+void Uart2Config(void);
+void UART2_SendChar(uint8_t c);
+void UART2_SendString(USART_TypeDef *USARTx, uint8_t *string, uint32_t length, uint32_t timeout);
+uint8_t UART2_GetChar(void);
+
+
+#endif /* UART_H */
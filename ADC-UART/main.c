@@ -1,53 +1,889 @@
-#include "SystemClock.h" // Configuration de l'horloge
-#include "Timer_Config.h"     // Fonctions de temporisation
-#include "UART_Config.h"      // Communication UART
-#include "ADC_Config.h"        // Configuration et lecture ADC
-#include "ASCII_Config.h"      // Conversion des valeurs ADC en ASCII
-#include <stdio.h>      // Fonctions pour sprintf
-#include <stdlib.h>     // Gestion de la mmoire dynamique
-#include <string.h>     // Gestion des chanes de caractres
-
-int main(void) {
-    // Initialiser l'horloge systme
-    SysClockConfig();
-
-    // Configurer le timer pour la gestion des dlais
-    TIM6Config();
-
-    // Configurer l'UART2
-    Uart2Config();
-
-    // Initialiser et activer l'ADC
-    ADC_Init();
-    ADC_Enable();
-
-    while (1) {
-        // Dmarrer une conversion ADC sur le canal 1
-        ADC_Start(1);
-        ADC_WaitForConv();
-
-        // Lire la valeur brute ADC
-        uint16_t raw = ADC_GetVal();
-
-        // Calculer la tension en volts
-        float vin = raw * (3.3 / 4096);
-
-        // Convertir la valeur brute ADC en chane ASCII
-        char *msg2 = shift_digits(raw);
-
-        // Construire le message final
-        char msg[50];
-        sprintf(msg, "ASCII Code: %s, Voltage: %.2f V\r\n", msg2, vin);
-
-        // Envoyer le message via UART
-        UART2_SendString(USART2, (uint8_t *)msg, strlen(msg), 300);
-
-        // Librer la mmoire alloue dynamiquement
-        free(msg2);
-
-        // Dlai de 1 seconde
-        Delay_ms(1000);
-    }
-
-    return 0;
-}
+#include "SystemClock.h" // Configuration de l'horloge
+#include "Timer_Config.h"     // Fonctions de temporisation
+#include "UART_Config.h"      // Communication UART
+#include "ADC_Config.h"        // Configuration et lecture ADC
+#include "BootTime.h"          // Mesure du temps de démarrage
+#include "App_Config.h"        // Choix des ports série
+#include "HostLink.h"          // Détection de l'hôte
+#include "FlashLog.h"          // Journal en Flash en l'absence de l'hôte
+#include "Frame.h"             // Trames binaires
+#include "MemPlan.h"           // Plan mémoire et mesure de la pile
+#include "Filter.h"            // Filtrage en virgule fixe
+#include "Dsp.h"               // Noyaux SIMD sur blocs d'échantillons
+#include "DWT_Config.h"        // Compteur de cycles
+#include "Pipeline.h"          // Tâches d'acquisition, de traitement et de transport
+#include "Freq.h"              // Mesure de fréquence par passages de seuil
+#include "Deadband.h"          // Émission sur variation
+#include "Mux.h"               // Flux multiplexés sur le port de données
+#include "IsrTime.h"           // Latence des interruptions
+#include "DAC_Config.h"        // DAC1 sur PA4 (autotest)
+#include "Loopback.h"          // Analyse de l'autotest DAC -> ADC
+#include "Settings.h"          // Configuration persistante
+#include "BaudNeg.h"           // Négociation du débit du port de données
+#include "Trace.h"             // Trace d'événements
+#include "Output.h"            // Envoi des échantillons sur le flux de données
+#if APP_RTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+#include <stdio.h>      // Fonctions pour sprintf
+#include <string.h>     // Gestion des chaînes de caractères
+
+// Échantillon journalisé en Flash pendant l'absence de l'hôte
+typedef struct {
+    uint32_t t_us;
+    uint16_t raw;
+    uint16_t channel;
+} LoggedSample;
+
+// Vidage de la trace sur demande de l'hôte et après un reset
+#define TRACE_DUMP  (APP_TRACE && TRACE_ENABLE)
+
+// Ligne RX du port de données lue sous interruption : négociation du débit, trace, mode fiable
+#define LINK_RX  (APP_BAUDNEG || TRACE_DUMP || (APP_RELIABLE && APP_OUTPUT_FORMAT == APP_FORMAT_BINARY))
+
+// Configuration en vigueur (Settings.h) : appliquée au démarrage
+static const Settings *cfg;
+static Output_Chain chain;         // Étages de traitement des rafales (Output.c)
+#if !APP_SETTINGS
+static Settings cfg_defaults;
+#endif
+
+// Une rafale tient dans une seule trame compactée, même en 12 bits
+MEM_STATIC_ASSERT(APP_BURST_SAMPLES <= FRAME_PACKED_MAX(12), burst_frame);
+MEM_STATIC_ASSERT(APP_BURST_SAMPLES <= PIPELINE_MAX_SAMPLES, burst_block);
+
+#if !APP_RTOS
+// Tampon d'acquisition en CCM (lu par le CPU uniquement), aligné pour les accès SIMD 32 bits
+static MEM_CCM uint16_t burst[APP_BURST_SAMPLES] __attribute__((aligned(4)));
+MEM_STATIC_ASSERT(sizeof(burst) <= MEM_CCM_ACQ, acq_budget);
+#endif
+
+/**
+  * @brief Envoyer un texte sur le flux de télémétrie (trame FRAME_TEXT en mode binaire)
+  */
+static void send_text(const char *text) {
+    uint32_t n = strlen(text);
+    Mux_Send(MUX_TELEMETRY, FRAME_TEXT, text, n < FRAME_MAX_PAYLOAD ? n : FRAME_MAX_PAYLOAD);
+}
+
+/**
+  * @brief Envoyer l'enregistrement de démarrage, suivi de l'origine de la configuration et de
+  *        l'état de la trace ; une trace préservée de la session précédente est ensuite vidée
+  */
+static void send_boot_report(void) {
+    char line[160];
+
+    BootTime_Format(line, sizeof(line));
+    send_text(line);
+#if APP_SETTINGS
+    Settings_Format(line, sizeof(line));
+    send_text(line);
+#endif
+#if TRACE_DUMP
+    Trace_Format(line, sizeof(line));
+    send_text(line);
+    if (Trace_Preserved())
+        Trace_DumpStart();
+#endif
+}
+
+/**
+  * @brief Envoyer un événement sur le flux de journal (limité en débit, abandonnable)
+  */
+static void send_log(const char *text) {
+    uint32_t n = strlen(text);
+    Mux_Send(MUX_LOG, FRAME_TEXT, text, n < FRAME_MAX_PAYLOAD ? n : FRAME_MAX_PAYLOAD);
+}
+
+/**
+  * @brief Envoyer un bloc d'échantillons en direct (Output.c), à la résolution active et au
+  *        format de App_Config.h
+  */
+static void send_block(const uint16_t *raw, uint32_t count, uint32_t t_us, uint8_t channel) {
+    Output_SendBlock(raw, count, t_us, channel, ADC_ResolutionBits(ADC_GetResolution()),
+                     APP_OUTPUT_FORMAT == APP_FORMAT_BINARY);
+}
+
+/**
+  * @brief Signaler des échantillons perdus par l'ADC (trame FRAME_GAP ou ligne « Gap: »)
+  *        dans le flux de données, à sa place entre les échantillons
+  */
+static void send_gap(uint32_t t_us, uint8_t channel, uint32_t lost) {
+    char msg[64];
+#if APP_OUTPUT_FORMAT == APP_FORMAT_BINARY
+    uint8_t p[FRAME_GAP_SIZE];
+    Frame_PutU32(&p[0], t_us);
+    p[4] = channel;
+    Frame_PutU16(&p[5], (uint16_t)(lost > 0xFFFF ? 0xFFFF : lost));
+    Mux_Send(MUX_DATA, FRAME_GAP, p, FRAME_GAP_SIZE);
+#else
+    sprintf(msg, "Gap: ch%u, t=%lu ms, lost=%lu\r\n", channel, (unsigned long)(t_us / 1000), (unsigned long)lost);
+    Mux_Send(MUX_DATA, 0, msg, strlen(msg));
+#endif
+    // Et l'événement sur le journal
+    sprintf(msg, "Log: t=%lu ms, ADC ch%u lost x%lu\r\n", (unsigned long)(t_us / 1000), channel, (unsigned long)lost);
+    send_log(msg);
+}
+
+/**
+  * @brief Envoyer l'emplacement des gestionnaires d'interruption et leur latence mesurée
+  */
+static void send_isr_report(void) {
+    char line[128];
+
+    IsrTime_FormatConfig(line, sizeof(line));
+    send_text(line);
+    for (int i = 0; i < ISR_COUNT; i++)
+        if (IsrTime_Format((IsrId)i, line, sizeof(line)))
+            send_text(line);
+}
+
+/**
+  * @brief Envoyer l'état du mode fiable (rien hors mode fiable)
+  */
+static void send_arq_report(void) {
+    char line[192];
+
+    if (Mux_FormatArq(line, sizeof(line)))
+        send_text(line);
+}
+
+#if APP_BAUDNEG
+static BaudNeg baudneg;
+
+static int baud_check(uint32_t baud, BaudNeg_Rate *rate) {
+    UART_BaudInfo info = { 0 };
+    int r = UART_CheckBaud(&APP_DATA_UART, baud, &info);
+
+    rate->actual = info.actual;
+    rate->error_ppm = info.error_ppm;
+    rate->brr = (uint16_t)info.brr;
+    rate->over8 = (uint8_t)info.over8;
+    return r;
+}
+
+static void baud_apply(uint32_t baud) {
+    UART_SetBaud(&APP_DATA_UART, baud);
+}
+
+static void baud_send(const uint8_t *data, uint32_t length) {
+    UART_Flush(&APP_DATA_UART);     // Trame du multiplexeur en cours d'émission par DMA
+    UART_Write(&APP_DATA_UART, data, length);
+    UART_Flush(&APP_DATA_UART);
+}
+
+static uint32_t baud_line_errors(void) {
+    return APP_DATA_UART.rx_errors + APP_DATA_UART.rx_overruns;
+}
+
+static const BaudNeg_Driver baud_driver = {
+    baud_check,
+    baud_apply,
+    baud_send,
+    baud_line_errors
+};
+#endif
+
+#if TRACE_DUMP
+static Frame_Rx trace_rx;
+
+/**
+  * @brief Envoyer la suite du vidage de la trace tant que la file de télémétrie a de la place
+  *        (une place reste aux rapports). En mode texte, la trame est encodée ici : le
+  *        multiplexeur passe alors les charges utiles telles quelles.
+  */
+static void trace_send(void) {
+    uint8_t p[TRACE_PAYLOAD_MAX];
+    uint32_t n;
+
+    while (Trace_Dumping() && Mux_Space(MUX_TELEMETRY) > 1 && (n = Trace_DumpNext(p)) != 0) {
+#if APP_OUTPUT_FORMAT == APP_FORMAT_BINARY
+        Mux_Send(MUX_TELEMETRY, FRAME_TRACE, p, n);
+#else
+        uint8_t f[FRAME_HDR_SIZE + TRACE_PAYLOAD_MAX + FRAME_CRC_SIZE];
+        Mux_Send(MUX_TELEMETRY, 0, f, Frame_Encode(f, FRAME_TRACE, 0, p, (uint8_t)n));
+#endif
+    }
+}
+#endif
+
+#if LINK_RX
+/**
+  * @brief Octet reçu de l'hôte (HostLink) : négociation du débit, demande de vidage de la
+  *        trace, acquittements du mode fiable
+  */
+static void link_input(uint8_t c) {
+#if APP_BAUDNEG
+    BaudNeg_Input(&baudneg, c, Tick_GetMs());
+#endif
+#if TRACE_DUMP
+    if (Frame_RxByte(&trace_rx, c) && FRAME_TYPE(trace_rx.buf[2]) == FRAME_TRACE_CMD)
+        Trace_DumpStart();
+#endif
+#if APP_RELIABLE && APP_OUTPUT_FORMAT == APP_FORMAT_BINARY
+    Mux_Input(c);
+#endif
+}
+#endif
+
+/**
+  * @brief Lire l'hôte, faire avancer la négociation du débit et le vidage de la trace
+  */
+static void link_poll(void) {
+#if LINK_RX
+    HostLink_Poll();
+#endif
+#if APP_BAUDNEG
+    BaudNeg_Poll(&baudneg, Tick_GetMs());
+#endif
+#if TRACE_DUMP
+    trace_send();
+#endif
+}
+
+/**
+  * @brief Envoyer l'état de la négociation du débit (rien sans APP_BAUDNEG)
+  */
+static void send_baud_report(void) {
+#if APP_BAUDNEG
+    char line[160];
+
+    BaudNeg_Format(&baudneg, line, sizeof(line));
+    send_text(line);
+#endif
+}
+
+#if APP_REPORT_ADC_MODES
+/**
+  * @brief Mesurer et envoyer la cadence de conversion et le coût en octets de chaque résolution
+  *        La résolution configurée est rétablie à la fin.
+  */
+static void report_adc_modes(void) {
+    ADC_Resolution active = ADC_GetResolution();
+    char line[128];                     // 121 caractères au plus, '\0' compris
+
+    for (int r = ADC_RES_12; r <= ADC_RES_6; r++) {
+        uint32_t bits = ADC_ResolutionBits((ADC_Resolution)r);
+        ADC_SetResolution((ADC_Resolution)r);
+        snprintf(line, sizeof(line), "ADC mode: %lu bits, %lu cycles, max=%lu conv/s, measured=%lu conv/s, %lu.%02lu B/sample\r\n",
+                (unsigned long)bits,
+                (unsigned long)ADC_ConvCycles((ADC_Resolution)r, ADC_GetSampleTime(1)),
+                (unsigned long)ADC_GetMaxRate(1),
+                (unsigned long)ADC_MeasureRate(1, 1000),
+                (unsigned long)(bits / 8), (unsigned long)((bits % 8) * 100 / 8));
+        send_text(line);
+    }
+    ADC_SetResolution(active);
+}
+#endif
+
+/**
+  * @brief Envoyer un échantillon relu depuis le journal Flash
+  */
+static void send_replay(uint32_t seq, const LoggedSample *rec) {
+#if APP_OUTPUT_FORMAT == APP_FORMAT_BINARY
+    uint8_t p[FRAME_REPLAY_HDR + 2];
+    Frame_PutU32(&p[0], seq);
+    Frame_PutU32(&p[4], rec->t_us);
+    p[8] = (uint8_t)rec->channel;
+    p[9] = 1;
+    Frame_PutU16(&p[FRAME_REPLAY_HDR], rec->raw);
+    Mux_Send(MUX_DATA, FRAME_REPLAY, p, sizeof(p));
+#else
+    char msg[40 + OUTPUT_LINE_SIZE];    // Préfixe de 39 caractères au plus
+    int n = sprintf(msg, "Replay: seq=%lu, t=%lu ms, ", (unsigned long)seq, (unsigned long)(rec->t_us / 1000));
+    Output_FormatSample(msg + n, rec->raw, ADC_ResolutionBits(ADC_GetResolution()));
+    Mux_Send(MUX_DATA, 0, msg, strlen(msg));
+#endif
+}
+
+#if APP_FILTER
+/**
+  * @brief Configurer le filtre du canal 1 d'après App_Config.h
+  */
+static void setup_filters(void) {
+    Filter_Chan *f = Filter_Channel(1);
+    float c[5 * FILTER_MAX_SECTIONS];
+    uint32_t sections = 0;
+
+    if (APP_FILTER_LP_FC > 0)
+        Filter_DesignLowpass(APP_FILTER_LP_FC, 0.7071f, &c[5 * sections++]);
+    if (APP_FILTER_NOTCH_F0 > 0)
+        Filter_DesignNotch(APP_FILTER_NOTCH_F0, APP_FILTER_NOTCH_Q, &c[5 * sections++]);
+    Filter_SetBiquads(f, FILTER_DF1, FILTER_Q31, c, sections);
+
+#if APP_FILTER_AVG_TAPS > 0
+    float h[APP_FILTER_AVG_TAPS];
+    for (uint32_t i = 0; i < APP_FILTER_AVG_TAPS; i++)
+        h[i] = 1.0f / APP_FILTER_AVG_TAPS;
+    Filter_SetFir(f, h, APP_FILTER_AVG_TAPS);
+#endif
+}
+#endif
+
+#if APP_FREQ_MODE
+// Anneau du flux DMA (en SRAM : le DMA n'a pas accès à la CCM) et passe de lecture en CCM
+static uint16_t freq_ring[APP_FREQ_RING];
+static MEM_CCM uint16_t freq_buf[APP_FREQ_BLOCK];
+MEM_STATIC_ASSERT(sizeof(freq_buf) + APP_BURST_SAMPLES * 2 <= MEM_CCM_ACQ, freq_budget);
+
+/**
+  * @brief Mode mesure de fréquence : acquisition continue du canal 1 par DMA, une ligne de
+  *        résultat par fenêtre. Une perte (débordement, redémarrage) est signalée et la
+  *        mesure reprend sans calculer de période à travers le trou. Ne revient pas.
+  */
+static void freq_mode(void) {
+    Freq_Meter meter;
+    Freq_Result res;
+    ADC_StreamInfo info;
+    char line[128];
+#if APP_MEM_REPORT_MS
+    uint32_t report_ms = Tick_GetMs();
+#endif
+
+    ADC_SetSampleTime(1, APP_FREQ_SAMPLE_TIME);
+    ADC_StreamStart(1, freq_ring, APP_FREQ_RING);
+    Freq_Init(&meter, APP_FREQ_LEVEL, APP_FREQ_HYST, SystemCoreClock, APP_FREQ_WINDOW_MS);
+
+    BootTime_Mark(BOOT_FIRST_SAMPLE);
+    send_boot_report();
+
+    while (1) {
+        uint32_t n = ADC_StreamRead(freq_buf, APP_FREQ_BLOCK, &info);
+        Mux_Poll();
+        link_poll();
+        if (info.lost) {
+            Freq_Gap(&meter);
+            send_gap(Tick_GetUs(), 1, info.lost);
+        }
+        if (n && Freq_Process(&meter, freq_buf, n, info.t0, ADC_StreamPeriodQ8(), &res)) {
+            Freq_Format(&res, line, sizeof(line));
+            send_text(line);  // Émission par DMA : l'anneau n'est pas interrompu
+        }
+#if APP_MEM_REPORT_MS
+        if ((int32_t)(Tick_GetMs() - report_ms) >= APP_MEM_REPORT_MS) {
+            send_isr_report();  // Latence du flux DMA sous charge réelle
+            send_baud_report();
+            report_ms = Tick_GetMs();
+        }
+#endif
+    }
+}
+#endif
+
+#if APP_TRIGGER_MODE
+// Bloc en cours de constitution (CCM : lu par le CPU seulement)
+static MEM_CCM uint16_t trig_buf[APP_TRIGGER_BLOCK];
+MEM_STATIC_ASSERT(sizeof(trig_buf) + APP_BURST_SAMPLES * 2 <= MEM_CCM_ACQ, trig_budget);
+
+/**
+  * @brief Mode déclenché : une conversion du canal 1 par front externe, émise par blocs
+  *        Un bloc part plein ou après APP_TRIGGER_FLUSH_MS ; des fronts manqués le terminent
+  *        et sont signalés avant l'échantillon suivant. Ne revient pas.
+  */
+static void trigger_mode(void) {
+    char line[128];
+    uint32_t n = 0, t_us = 0, flush_ms = Tick_GetMs();
+#if APP_MEM_REPORT_MS
+    uint32_t report_ms = flush_ms;
+#endif
+
+    ADC_TriggerStart(1, APP_TRIGGER_EDGE);
+
+    BootTime_Mark(BOOT_FIRST_SAMPLE);
+    send_boot_report();
+
+    while (1) {
+        Trigger_Sample s;
+
+        Mux_Poll();
+        link_poll();
+        while (n < APP_TRIGGER_BLOCK && ADC_TriggerRead(&s, 1)) {
+            uint32_t edge_us = Tick_GetUs() - ADC_TriggerAgeUs(s.t_edge);
+            if (s.missed) {
+                if (n)
+                    send_block(trig_buf, n, t_us, 1);
+                n = 0;
+                send_gap(edge_us, 1, s.missed);
+            }
+            if (n == 0) {
+                t_us = edge_us;
+                flush_ms = Tick_GetMs();
+            }
+            trig_buf[n++] = s.value;
+        }
+        if (n == APP_TRIGGER_BLOCK || (n && Tick_GetMs() - flush_ms >= APP_TRIGGER_FLUSH_MS)) {
+            send_block(trig_buf, n, t_us, 1);
+            n = 0;
+        }
+#if APP_MEM_REPORT_MS
+        if ((int32_t)(Tick_GetMs() - report_ms) >= APP_MEM_REPORT_MS) {
+            ADC_TriggerFormat(line, sizeof(line));
+            send_text(line);
+            send_isr_report();
+            send_baud_report();
+            report_ms = Tick_GetMs();
+        }
+#endif
+    }
+}
+#endif
+
+#if APP_SELFTEST_MODE
+// Bloc analysé et état de la rampe en CCM (CPU seul) ; table du sinus en SRAM (lue par le DMA)
+static MEM_CCM uint16_t selftest_buf[APP_SELFTEST_BLOCK];
+static MEM_CCM Loopback_Lin selftest_lin;
+static uint16_t selftest_table[APP_SELFTEST_TABLE];
+MEM_STATIC_ASSERT(sizeof(selftest_buf) + sizeof(selftest_lin) + APP_BURST_SAMPLES * 2 <= MEM_CCM_ACQ, selftest_budget);
+MEM_STATIC_ASSERT(APP_SELFTEST_BLOCK % APP_SELFTEST_TABLE == 0 && APP_SELFTEST_PER_CODE <= APP_SELFTEST_BLOCK &&
+                  APP_SELFTEST_DC_SAMPLES <= APP_SELFTEST_BLOCK, selftest_sizes);
+
+/**
+  * @brief Mode autotest : paliers, rampe et sinus sur la boucle DAC1 -> PA4 -> ADC, puis
+  *        cadences obtenues, toutes les APP_SELFTEST_PERIOD_MS. Ne revient pas.
+  */
+static void selftest_mode(void) {
+    uint32_t bits = ADC_ResolutionBits(ADC_GetResolution());
+    char line[160];
+
+    ADC_SetSampleTime(APP_SELFTEST_CHANNEL, APP_SELFTEST_SAMPLE_TIME);
+    DAC_Init();
+    Loopback_SineTable(selftest_table, APP_SELFTEST_TABLE, APP_SELFTEST_CYCLES, APP_SELFTEST_LO, APP_SELFTEST_HI);
+
+    BootTime_Mark(BOOT_FIRST_SAMPLE);
+    send_boot_report();
+
+    while (1) {
+        uint32_t start_ms = Tick_GetMs(), dac_rate, cycles, ovr;
+        Loopback_Dc dc;
+        Loopback_Sine sine;
+
+        // Paliers continus : droite de transfert et bruit
+        Loopback_DcInit(&dc);
+        for (uint32_t i = 0; i < APP_SELFTEST_DC_STEPS; i++) {
+            uint16_t code = (uint16_t)(APP_SELFTEST_LO + (APP_SELFTEST_HI - APP_SELFTEST_LO) * i / (APP_SELFTEST_DC_STEPS - 1));
+            DAC_Set(code);
+            DWT_Delay_us(APP_SELFTEST_SETTLE_US);
+            ADC_ReadBlock(APP_SELFTEST_CHANNEL, selftest_buf, APP_SELFTEST_DC_SAMPLES);
+            Loopback_DcAdd(&dc, code, selftest_buf, APP_SELFTEST_DC_SAMPLES);
+            Mux_Poll();
+        }
+        if (Loopback_DcEnd(&dc, (float)(1UL << bits) / (1UL << DAC_BITS))) {
+            Loopback_FormatDc(&dc, line, sizeof(line));
+            send_text(line);
+
+            // Rampe : un code DAC par pas, transitions par densité de codes
+            Loopback_LinInit(&selftest_lin, &dc, APP_SELFTEST_LO, APP_SELFTEST_HI, APP_SELFTEST_PER_CODE);
+            for (uint32_t code = APP_SELFTEST_LO; code <= APP_SELFTEST_HI; code++) {
+                DAC_Set((uint16_t)code);
+                DWT_Delay_us(APP_SELFTEST_SETTLE_US);
+                ADC_ReadBlock(APP_SELFTEST_CHANNEL, selftest_buf, APP_SELFTEST_PER_CODE);
+                Loopback_LinAdd(&selftest_lin, selftest_buf);
+                Mux_Poll();
+            }
+            Loopback_LinEnd(&selftest_lin);
+            Loopback_FormatLin(&selftest_lin, line, sizeof(line));
+            send_text(line);
+        }
+
+        // Sinus : DAC et ADC cadencés par TIM4, une conversion à mi-palier par point de la table.
+        // Une première conversion synchronise la mesure : le bloc dure exactement
+        // APP_SELFTEST_BLOCK périodes.
+        dac_rate = DAC_WaveStart(selftest_table, APP_SELFTEST_TABLE, APP_SELFTEST_SINE_RATE);
+        ADC_ReadTriggered(APP_SELFTEST_CHANNEL, ADC_EXT_TIM4_CC4, selftest_buf, 1);
+        cycles = DWT_GetCycles();
+        ovr = ADC_ReadTriggered(APP_SELFTEST_CHANNEL, ADC_EXT_TIM4_CC4, selftest_buf, APP_SELFTEST_BLOCK);
+        cycles = DWT_GetCycles() - cycles;
+        DAC_WaveStop();
+        if (ovr == 0 && Loopback_SineFit(selftest_buf, APP_SELFTEST_BLOCK,
+                                         APP_SELFTEST_CYCLES * (APP_SELFTEST_BLOCK / APP_SELFTEST_TABLE), bits, &sine)) {
+            Loopback_FormatSine(&sine, line, sizeof(line));
+            send_text(line);
+        }
+
+        // Cadences : sinus, conversions déclenchées obtenues, maximum en continu sur ce canal
+        snprintf(line, sizeof(line), "Selftest rate: dac=%lu Hz, sine=%lu.%02lu Hz, adc=%lu sps triggered / %lu sps continuous (max %lu), ovr=%lu, pass=%lu ms\r\n",
+                 (unsigned long)dac_rate,
+                 (unsigned long)((uint64_t)dac_rate * APP_SELFTEST_CYCLES / APP_SELFTEST_TABLE),
+                 (unsigned long)((uint64_t)dac_rate * APP_SELFTEST_CYCLES * 100 / APP_SELFTEST_TABLE % 100),
+                 (unsigned long)((uint64_t)APP_SELFTEST_BLOCK * SystemCoreClock / cycles),
+                 (unsigned long)ADC_MeasureRate(APP_SELFTEST_CHANNEL, 1000),
+                 (unsigned long)ADC_GetMaxRate(APP_SELFTEST_CHANNEL),
+                 (unsigned long)ovr, (unsigned long)(Tick_GetMs() - start_ms));
+        send_text(line);
+
+        send_baud_report();
+
+        DAC_Set(1U << (DAC_BITS - 1));
+        while ((int32_t)(Tick_GetMs() - start_ms) < APP_SELFTEST_PERIOD_MS) {
+            Mux_Poll();
+            link_poll();
+        }
+    }
+}
+#endif
+
+#if APP_RTOS
+static volatile int first_sample = 1;
+static int first_tx = 1;
+
+/**
+  * @brief Tâche d'acquisition : une rafale sur le canal 1
+  */
+static void board_acquire(Pipeline_Block *b) {
+    b->t_us = Tick_GetUs();
+    b->channel = 1;
+    b->bits = (uint8_t)ADC_ResolutionBits(ADC_GetResolution());
+    b->count = APP_BURST_SAMPLES;
+    b->lost = (uint16_t)ADC_ReadBlock(1, b->samples, APP_BURST_SAMPLES);
+    if (first_sample) {
+        BootTime_Mark(BOOT_FIRST_SAMPLE);
+        first_sample = 0;
+    }
+}
+
+/**
+  * @brief Tâche de traitement : étalonnage et filtrage en place
+  */
+static void board_process(Pipeline_Block *b) {
+    b->count = (uint16_t)Output_Process(&chain, b->samples, b->count, b->channel, b->bits, Tick_GetMs());
+}
+
+/**
+  * @brief Tâche de transport : seule tâche qui écrit sur le port de données
+  */
+static void board_transmit(Pipeline_Block *b) {
+    if (first_tx) {
+        char line[96];
+        send_boot_report();
+        MemPlan_Format(line, sizeof(line));
+        send_text(line);
+        first_tx = 0;
+    }
+
+    if (b->kind == PIPELINE_TEXT) {
+        char line[128];
+        b->out[b->out_len] = '\0';
+        send_text((const char *)b->out);
+        Mux_Format(line, sizeof(line));   // Avec le rapport périodique des tâches
+        send_text(line);
+        send_arq_report();
+        send_baud_report();
+        send_isr_report();
+        while (Mux_Poll())
+            vTaskDelay(1);
+        return;
+    }
+    if (b->lost)
+        send_gap(b->t_us, b->channel, b->lost);
+    if (b->count == 0)
+        return;              // Supprimé par la bande morte
+
+#if APP_STORE_FORWARD
+    HostLink_Poll();
+    if (!HostLink_IsUp()) {
+        for (uint32_t i = 0; i < b->count; i++) {
+            LoggedSample rec = { b->t_us, b->samples[i], b->channel };
+            FlashLog_Append(&rec, sizeof(rec));
+        }
+        return;
+    }
+#endif
+
+    send_block(b->samples, b->count, b->t_us, b->channel);
+    while (Mux_Poll())
+        vTaskDelay(1);       // Le processeur reste aux autres tâches pendant l'émission
+    link_poll();
+}
+
+#if APP_STORE_FORWARD || APP_BAUDNEG || TRACE_DUMP
+/**
+  * @brief Transport inoccupé : détection de l'hôte, négociation du débit, vidage de la trace
+  *        et relecture du journal Flash
+  */
+static void board_idle(void) {
+    link_poll();
+#if APP_STORE_FORWARD
+    LoggedSample rec;
+    uint16_t len;
+    uint32_t seq;
+
+    HostLink_Poll();
+    // Effacement seulement si la période le permet. Hôte absent, le journal a besoin du secteur
+    // suivant : comme dans la boucle principale, l'acquisition saute les périodes couvrant
+    // l'effacement, sans quoi une période inférieure à 2 s n'en laisserait jamais le temps
+    if (!HostLink_IsUp() && FlashLog_EraseDue() > Pipeline_IdleMs())
+        Pipeline_Reserve(FlashLog_EraseDue());
+    FlashLog_Poll(Pipeline_IdleMs());
+    Mux_Poll();
+    if (HostLink_IsUp() && Mux_Space(MUX_DATA) > 2 && FlashLog_Peek(&rec, &len, &seq)) {
+        send_replay(seq, &rec);
+        FlashLog_Consume();
+    }
+#endif
+}
+#endif
+
+static const Pipeline_Driver board_pipeline = {
+    board_acquire,
+    board_process,
+    board_transmit,
+#if APP_STORE_FORWARD || APP_BAUDNEG || TRACE_DUMP
+    board_idle
+#else
+    0
+#endif
+};
+#endif
+
+int main(void) {
+    // Peindre la pile pour en mesurer l'utilisation maximale
+    MemPlan_PaintStack();
+
+#if APP_RAM_VECTORS
+    // Table des vecteurs en SRAM avant la première interruption
+    MemPlan_RelocateVectors();
+#endif
+
+    // Démarrer la mesure du temps de démarrage
+    BootTime_Start();
+
+    // Lancer le quartz HSE, puis charger la configuration et configurer l'ADC pendant sa stabilisation
+    SysClockStartHSE();
+#if APP_SETTINGS
+    Settings_Init(&Settings_Stm32);
+    cfg = Settings_Get();
+#else
+    Settings_Defaults(&cfg_defaults);
+    cfg = &cfg_defaults;
+#endif
+    BootTime_Mark(BOOT_SETTINGS);
+    ADC_Init();
+    BootTime_Mark(BOOT_PERIPH);
+
+    // Initialiser l'horloge système
+    SysClockConfig();
+    BootTime_Mark(BOOT_CLOCK);
+
+    // Trace d'événements : un anneau préservé de la session précédente attend son vidage
+    Trace_Init(SystemCoreClock, TRACE_DUMP);
+
+    // Configurer le timer pour la gestion des délais
+    TIM6Config();
+
+    // Configurer le port de données (le débit dépend de PCLK : après la PLL)
+    UART_Init(&APP_DATA_UART, cfg->data_baud);
+    Mux_Init(&APP_DATA_UART, APP_OUTPUT_FORMAT == APP_FORMAT_BINARY);
+    Mux_Config(MUX_DATA, cfg->share[MUX_DATA], 0, 0, 0);
+    Mux_Config(MUX_TELEMETRY, cfg->share[MUX_TELEMETRY], 0, 0, 0);
+    Mux_Config(MUX_LOG, cfg->share[MUX_LOG], cfg->log_rate, cfg->log_burst, 1);
+
+#ifdef APP_CONSOLE_UART
+    // Port console : débit obtenu sur le port de données
+    UART_Init(&APP_CONSOLE_UART, APP_CONSOLE_BAUD);
+    {
+        char info[64];
+        sprintf(info, "Data UART: %lu baud (%ld ppm)\r\n",
+                (unsigned long)APP_DATA_UART.baud.actual, (long)APP_DATA_UART.baud.error_ppm);
+        UART_Write(&APP_CONSOLE_UART, (uint8_t *)info, strlen(info));
+    }
+#endif
+
+    // Activer l'ADC dans la résolution choisie
+    ADC_SetResolution((ADC_Resolution)cfg->adc_resolution);
+    ADC_SetSampleTime(1, (ADC_SampleTime)cfg->sample_time);
+    ADC_Enable();
+    BootTime_Mark(BOOT_ADC_READY);
+
+    // Base de temps en millisecondes
+    Tick_Init();
+
+#if APP_FILTER
+    setup_filters();
+#endif
+
+#if APP_DEADBAND
+    Deadband_Config(Deadband_Channel(1), APP_DEADBAND_MODE, APP_DEADBAND_BAND, APP_DEADBAND_HEARTBEAT_MS);
+#endif
+    chain.cal_offset = cfg->cal_offset;
+    chain.cal_gain = cfg->cal_gain;
+    chain.filter = APP_FILTER;
+    chain.deadband = APP_DEADBAND;
+
+#if APP_STORE_FORWARD
+    // Détection de l'hôte et reprise du journal Flash
+    HostLink_Init(&APP_DATA_UART);
+    FlashLog_Init(&FlashLog_Stm32);
+#endif
+
+#if LINK_RX
+    // Octets de l'hôte reçus sous interruption, remis par HostLink à la négociation du débit,
+    // à la demande de vidage de la trace et au multiplexeur (acquittements du mode fiable)
+    UART_EnableRxIrq(&APP_DATA_UART);
+    HostLink_Init(&APP_DATA_UART);
+    HostLink_SetSink(link_input);
+#endif
+#if APP_BAUDNEG
+    BaudNeg_Init(&baudneg, &baud_driver, APP_DATA_UART.requested, Tick_GetMs());
+#endif
+#if APP_RELIABLE && APP_OUTPUT_FORMAT == APP_FORMAT_BINARY
+    Mux_SetReliable(1);
+#endif
+
+#if APP_FREQ_MODE
+    freq_mode();
+#endif
+
+#if APP_TRIGGER_MODE
+    trigger_mode();
+#endif
+
+#if APP_SELFTEST_MODE
+    selftest_mode();
+#endif
+
+#if APP_RTOS
+    // Acquisition, traitement et transport dans des tâches de priorités distinctes
+#if APP_REPORT_ADC_MODES
+    report_adc_modes();      // Avant les tâches : l'acquisition ne doit pas voir changer la résolution
+#endif
+    Pipeline_Start(&board_pipeline, cfg->sample_period_ms, APP_RTOS_STATS_MS);
+    vTaskStartScheduler();   // Ne revient pas
+#else
+    int first_frame = 1;
+    uint32_t next_ms = Tick_GetMs();
+#if APP_STORE_FORWARD
+    int host_up = 1;
+#endif
+#if APP_MEM_REPORT_MS
+    uint32_t mem_report_ms = next_ms;
+#endif
+
+    while (1) {
+        // Acquérir APP_BURST_SAMPLES conversions consécutives sur le canal 1
+        uint16_t *raw = burst;
+        uint32_t t_us = Tick_GetUs();
+        uint32_t lost;
+
+        TRACE(TRACE_LOOP, 0);
+        lost = ADC_ReadBlock(1, raw, APP_BURST_SAMPLES);
+
+        // Étalonnage, filtre et bande morte : nombre d'échantillons à émettre ou journaliser
+        uint32_t count = Output_Process(&chain, raw, APP_BURST_SAMPLES, 1,
+                                        ADC_ResolutionBits(ADC_GetResolution()), Tick_GetMs());
+
+        // Envoyer l'enregistrement de démarrage avec la première trame
+        if (first_frame) {
+            BootTime_Mark(BOOT_FIRST_SAMPLE);
+            send_boot_report();
+        }
+
+#if APP_STORE_FORWARD
+        HostLink_Poll();
+        if (HostLink_IsUp() != host_up) {
+            char msg[48];
+            host_up = HostLink_IsUp();
+            TRACE(TRACE_HOST, host_up);
+            sprintf(msg, "Log: t=%lu ms, host %s\r\n", (unsigned long)Tick_GetMs(), host_up ? "up" : "down");
+            send_log(msg);
+        }
+        if (!host_up) {
+            // Hôte absent : journaliser les échantillons
+            for (uint32_t i = 0; i < count; i++) {
+                LoggedSample rec = { t_us, raw[i], 1 };
+                FlashLog_Append(&rec, sizeof(rec));
+            }
+        } else
+#endif
+        {
+            // Envoyer les échantillons via le port de données, précédés d'un marqueur de perte
+            if (lost)
+                send_gap(t_us, 1, lost);
+            if (count)
+                send_block(raw, count, t_us, 1);
+        }
+
+#if APP_REPORT_ADC_MODES
+        if (first_frame)
+            report_adc_modes();
+#endif
+
+        // Rapport mémoire : au démarrage puis périodiquement (maximum de pile atteint)
+        if (first_frame
+#if APP_MEM_REPORT_MS
+            || (int32_t)(Tick_GetMs() - mem_report_ms) >= APP_MEM_REPORT_MS
+#endif
+           ) {
+            char mem[128];
+            MemPlan_Format(mem, sizeof(mem));
+            send_text(mem);
+#if APP_FILTER
+            sprintf(mem, "Filter: ch1 %u biquads, %u taps, %lu cycles/sample\r\n",
+                    Filter_Channel(1)->sections, Filter_Channel(1)->taps,
+                    (unsigned long)(chain.filter_cycles / chain.filter_samples));
+            send_text(mem);
+#endif
+#if APP_DEADBAND
+            Deadband_Format(1, mem, sizeof(mem));
+            send_text(mem);
+#endif
+            ADC_FormatErrors(mem, sizeof(mem));
+            send_text(mem);
+            Mux_Format(mem, sizeof(mem));
+            send_text(mem);
+            send_arq_report();
+            send_baud_report();
+            send_isr_report();
+#if APP_MEM_REPORT_MS
+            mem_report_ms = Tick_GetMs();
+#endif
+        }
+        first_frame = 0;
+
+        // Période fixe : l'échéance ne dérive pas avec la durée d'émission
+        next_ms += cfg->sample_period_ms;
+
+#if APP_STORE_FORWARD
+        // Un effacement arrête le processeur jusqu'à 2 s : il n'est lancé que si l'acquisition
+        // est inactive assez longtemps. Hôte absent, le journal a besoin du secteur suivant :
+        // les périodes couvrant l'effacement sont sautées (trou visible dans les horodatages
+        // relus), plutôt que décalées par un arrêt imprévu.
+        int32_t left_ms = (int32_t)(next_ms - Tick_GetMs());   // Lu une fois : l'échéance peut être passée
+        uint32_t idle_ms = left_ms > 0 ? (uint32_t)left_ms : 0;
+        uint32_t erase_ms = FlashLog_EraseDue();
+        if (!host_up && erase_ms > idle_ms) {
+            uint32_t skip = (erase_ms - idle_ms + cfg->sample_period_ms - 1) / cfg->sample_period_ms;
+            next_ms += skip * cfg->sample_period_ms;
+            idle_ms += skip * cfg->sample_period_ms;
+        }
+        FlashLog_Poll(idle_ms);
+
+        // Jusqu'à l'échantillon suivant : relire le journal à la vitesse du lien, en laissant
+        // de la place au direct dans la file de données
+        while ((int32_t)(Tick_GetMs() - next_ms) < 0) {
+            LoggedSample rec;
+            uint16_t len;
+            uint32_t seq;
+
+            HostLink_Poll();
+            left_ms = (int32_t)(next_ms - Tick_GetMs());        // L'échéance a pu passer pendant HostLink_Poll()
+            FlashLog_Poll(left_ms > 0 ? (uint32_t)left_ms : 0);
+            Mux_Poll();
+            link_poll();
+            if (HostLink_IsUp() && Mux_Space(MUX_DATA) > 2 && FlashLog_Peek(&rec, &len, &seq)) {
+                send_replay(seq, &rec);
+                FlashLog_Consume();
+            }
+        }
+#else
+        while ((int32_t)(Tick_GetMs() - next_ms) < 0) {
+            Mux_Poll();
+            link_poll();
+        }
+#endif
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+#define _GNU_SOURCE
+#include "adc_capture.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+  * @brief  Écriture / lecture des fichiers de capture en colonnes
+  *         En écriture, seul le bloc courant est projeté : le fichier est agrandi d'un bloc
+  *         à la fois (ftruncate) et l'ajout d'une ligne se réduit à six écritures mémoire.
+  *         Le nombre de lignes de l'en-tête est tenu à jour à chaque ajout : une capture
+  *         interrompue reste lisible jusqu'à la dernière ligne écrite.
+  */
+
+static void block_columns (uint8_t *base, AdcCapColumns *cols)
+{
+	const size_t n = ADCCAP_BLOCK_ROWS;
+
+	cols->seq        = (uint32_t *)base;
+	cols->t_us       = (uint32_t *)(base + n * 4);
+	cols->arrival_ns = (uint64_t *)(base + n * 8);
+	cols->raw        = (uint16_t *)(base + n * 16);
+	cols->channel    = base + n * 18;
+	cols->flags      = base + n * 19;
+}
+
+static int map_block (AdcCapture *c, uint64_t block)
+{
+	off_t off = ADCCAP_HDR_SIZE + (off_t)(block * ADCCAP_BLOCK_SIZE);
+
+	if (c->map)
+		munmap(c->map, c->map_size);
+	c->map = NULL;
+	if (ftruncate(c->fd, off + (off_t)ADCCAP_BLOCK_SIZE) != 0)
+		return -1;
+	c->map = mmap(NULL, ADCCAP_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, c->fd, off);
+	if (c->map == MAP_FAILED) {
+		c->map = NULL;
+		return -1;
+	}
+	c->map_size = ADCCAP_BLOCK_SIZE;
+	c->block = block;
+	block_columns(c->map, &c->cols);
+	return 0;
+}
+
+/**
+  * @brief Créer un fichier de capture
+  * @retval 0 si succès, -1 sinon
+  */
+int adccap_create (AdcCapture *c, const char *path)
+{
+	memset(c, 0, sizeof(*c));
+	c->writable = 1;
+	c->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (c->fd < 0)
+		return -1;
+	if (ftruncate(c->fd, ADCCAP_HDR_SIZE) != 0)
+		goto fail;
+	c->hdr = mmap(NULL, ADCCAP_HDR_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, c->fd, 0);
+	if (c->hdr == MAP_FAILED)
+		goto fail;
+	memcpy(c->hdr->magic, ADCCAP_MAGIC, 8);
+	c->hdr->rows = 0;
+	c->hdr->block_rows = ADCCAP_BLOCK_ROWS;
+	c->hdr->version = 1;
+	if (map_block(c, 0) != 0)
+		goto fail;
+	return 0;
+
+fail:
+	adccap_close(c);                                 // En-tête et bloc projetés compris
+	return -1;
+}
+
+/**
+  * @brief Ajouter une ligne
+  * @retval 0 si succès, -1 si le fichier ne peut pas être agrandi
+  */
+int adccap_append (AdcCapture *c, uint32_t seq, uint32_t t_us, uint64_t arrival_ns,
+                   uint16_t raw, uint8_t channel, uint8_t flags)
+{
+	uint64_t row = c->hdr->rows;
+	uint64_t block = row / ADCCAP_BLOCK_ROWS;
+	size_t i = (size_t)(row % ADCCAP_BLOCK_ROWS);
+
+	if (block != c->block && map_block(c, block) != 0)
+		return -1;
+
+	c->cols.seq[i] = seq;
+	c->cols.t_us[i] = t_us;
+	c->cols.arrival_ns[i] = arrival_ns;
+	c->cols.raw[i] = raw;
+	c->cols.channel[i] = channel;
+	c->cols.flags[i] = flags;
+	c->hdr->rows = row + 1;
+	return 0;
+}
+
+/**
+  * @brief Fermer un fichier de capture (écriture ou lecture)
+  */
+void adccap_close (AdcCapture *c)
+{
+	if (c->map)
+		munmap(c->map, c->map_size);
+	if (c->writable && c->hdr && c->hdr != MAP_FAILED)
+		munmap(c->hdr, ADCCAP_HDR_SIZE);
+	if (c->fd >= 0)
+		close(c->fd);
+	memset(c, 0, sizeof(*c));
+	c->fd = -1;
+}
+
+/**
+  * @brief Ouvrir un fichier de capture en lecture (projection complète)
+  * @retval 0 si succès, -1 sinon
+  */
+int adccap_open (AdcCapture *c, const char *path)
+{
+	struct stat st;
+
+	memset(c, 0, sizeof(*c));
+	c->fd = open(path, O_RDONLY);
+	if (c->fd < 0)
+		return -1;
+	if (fstat(c->fd, &st) != 0 || st.st_size < ADCCAP_HDR_SIZE)
+		goto fail;
+	c->map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, c->fd, 0);
+	if (c->map == MAP_FAILED) {
+		c->map = NULL;
+		goto fail;
+	}
+	c->map_size = (size_t)st.st_size;
+	c->hdr = (AdcCapHeader *)c->map;
+	if (memcmp(c->hdr->magic, ADCCAP_MAGIC, 8) != 0 || c->hdr->block_rows != ADCCAP_BLOCK_ROWS)
+		goto fail;
+	// Chaque ligne annoncée doit être dans le fichier : blocs complets, colonnes comprises
+	if ((c->hdr->rows + ADCCAP_BLOCK_ROWS - 1) / ADCCAP_BLOCK_ROWS >
+	    (uint64_t)(st.st_size - ADCCAP_HDR_SIZE) / ADCCAP_BLOCK_SIZE)
+		goto fail;
+	madvise(c->map, c->map_size, MADV_SEQUENTIAL);
+	return 0;
+
+fail:
+	adccap_close(c);
+	return -1;
+}
+
+/**
+  * @brief Nombre de lignes de la capture
+  */
+uint64_t adccap_rows (const AdcCapture *c)
+{
+	return c->hdr->rows;
+}
+
+/**
+  * @brief Colonnes d'un bloc d'une capture ouverte en lecture
+  *        Le bloc b contient les lignes b x ADCCAP_BLOCK_ROWS et suivantes.
+  */
+void adccap_block (const AdcCapture *c, uint64_t block, AdcCapColumns *cols)
+{
+	block_columns(c->map + ADCCAP_HDR_SIZE + block * ADCCAP_BLOCK_SIZE, cols);
+}
@@ -0,0 +1,58 @@
+#ifndef ADC_CAPTURE_H
+#define ADC_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+  * @brief Fichier de capture en colonnes, projeté en mémoire (mmap)
+  *
+  *   En-tête (4096 octets, dont 64 utiles) puis blocs de ADCCAP_BLOCK_ROWS lignes.
+  *   Dans chaque bloc, chaque colonne est contiguë :
+  *      seq[N] (u32) | t_us[N] (u32) | arrival_ns[N] (u64) | raw[N] (u16) | channel[N] (u8) | flags[N] (u8)
+  *   Un outil d'analyse lit directement une colonne entière sans décoder les autres.
+  */
+
+#define ADCCAP_MAGIC       "ADCCAP1"
+#define ADCCAP_HDR_SIZE    4096
+#define ADCCAP_BLOCK_ROWS  65536
+#define ADCCAP_ROW_BYTES   (4 + 4 + 8 + 2 + 1 + 1)
+#define ADCCAP_BLOCK_SIZE  ((size_t)ADCCAP_BLOCK_ROWS * ADCCAP_ROW_BYTES)
+
+typedef struct {
+	char     magic[8];
+	uint64_t rows;
+	uint32_t block_rows;
+	uint32_t version;
+} AdcCapHeader;
+
+// Colonnes d'un bloc
+typedef struct {
+	uint32_t *seq;
+	uint32_t *t_us;
+	uint64_t *arrival_ns;
+	uint16_t *raw;
+	uint8_t  *channel;
+	uint8_t  *flags;
+} AdcCapColumns;
+
+typedef struct {
+	int           fd;
+	int           writable;
+	AdcCapHeader *hdr;        // En-tête projeté
+	uint8_t      *map;        // Fichier entier (lecture) ou bloc courant (écriture)
+	size_t        map_size;
+	uint64_t      block;      // Bloc projeté (écriture)
+	AdcCapColumns cols;       // Colonnes du bloc courant (écriture)
+} AdcCapture;
+
+int adccap_create(AdcCapture *c, const char *path);
+int adccap_append(AdcCapture *c, uint32_t seq, uint32_t t_us, uint64_t arrival_ns,
+                  uint16_t raw, uint8_t channel, uint8_t flags);
+void adccap_close(AdcCapture *c);
+
+int adccap_open(AdcCapture *c, const char *path);
+uint64_t adccap_rows(const AdcCapture *c);
+void adccap_block(const AdcCapture *c, uint64_t block, AdcCapColumns *cols);
+
+#endif /* ADC_CAPTURE_H */
@@ -0,0 +1,336 @@
+#include "adc_stream.h"
+#include "../ADC-UART/Frame.h"
+#include "../ADC-UART/CRC16.h"
+#include "../ADC-UART/Pack.h"
+#include <string.h>
+#include <stdlib.h>
+
+/**
+  * @brief  Analyse incrémentale du flux texte / binaire
+  *         Chaque appel à adcs_feed() traite toutes les unités complètes (trame ou ligne)
+  *         directement dans le tampon de l'appelant. L'unité incomplète en fin de tampon est
+  *         conservée dans s->carry et complétée au prochain appel.
+  */
+
+#define MAX_LINE 256   // Ligne texte plus longue : considérée comme du bruit
+
+// Vérifier la séquence des trames et compter les pertes
+static void check_seq (AdcStream *s, uint16_t seq)
+{
+	if (s->have_seq && seq != (uint16_t)(s->last_seq + 1)) {
+		s->stats.seq_gaps++;
+		s->stats.lost_frames += (uint16_t)(seq - s->last_seq - 1);
+	}
+	s->last_seq = seq;
+	s->have_seq = 1;
+}
+
+static void handle_frame (AdcStream *s, const uint8_t *f)
+{
+	uint8_t type = FRAME_TYPE(f[2]);           // Flux de la carte dans les bits de poids fort
+	uint8_t len  = f[3];
+	uint16_t seq = Frame_GetU16(&f[4]);
+	const uint8_t *p = &f[FRAME_HDR_SIZE];
+	AdcBlock b;
+
+	if (type == FRAME_SKIP)
+		return;                                 // Mode fiable : le trou sera compté à la trame suivante
+	check_seq(s, seq);
+	s->stats.frames++;
+	s->stats.stream_frames[FRAME_STREAM(f[2])]++;
+	s->stats.stream_bytes[FRAME_STREAM(f[2])] += FRAME_HDR_SIZE + len + FRAME_CRC_SIZE;
+	memset(&b, 0, sizeof(b));
+
+	switch (type) {
+	case FRAME_SAMPLES:
+		if (len < FRAME_SAMPLES_HDR || len != FRAME_SAMPLES_HDR + 2 * p[5])
+			break;
+		b.seq = seq;
+		b.t_us = Frame_GetU32(p);
+		b.channel = p[4];
+		b.count = p[5];
+		b.flags = ADCS_F_BINARY | ADCS_F_HAS_TS | ADCS_F_HAS_SEQ;
+		b.bits = 12;
+		b.data = p + FRAME_SAMPLES_HDR;
+		s->stats.samples += b.count;
+		if (s->on_block)
+			s->on_block(s->user, &b);
+		return;
+
+	case FRAME_REPLAY:
+		if (len < FRAME_REPLAY_HDR || len != FRAME_REPLAY_HDR + 2 * p[9])
+			break;
+		b.seq = Frame_GetU32(p);
+		b.t_us = Frame_GetU32(p + 4);
+		b.channel = p[8];
+		b.count = p[9];
+		b.flags = ADCS_F_BINARY | ADCS_F_REPLAY | ADCS_F_HAS_TS | ADCS_F_HAS_SEQ;
+		b.bits = 12;
+		b.data = p + FRAME_REPLAY_HDR;
+		s->stats.samples += b.count;
+		if (s->on_block)
+			s->on_block(s->user, &b);
+		return;
+
+	case FRAME_PACKED:
+		// Ramener les échantillons compactés en u16 little-endian comme les autres blocs
+		if (len < FRAME_PACKED_HDR || (p[6] != 12 && p[6] != 10 && p[6] != 8 && p[6] != 6) ||
+		    len != FRAME_PACKED_HDR + Pack_Bytes(p[6], p[5]))
+			break;
+		b.seq = seq;
+		b.t_us = Frame_GetU32(p);
+		b.channel = p[4];
+		b.count = p[5];
+		b.bits = p[6];
+		b.flags = ADCS_F_BINARY | ADCS_F_HAS_TS | ADCS_F_HAS_SEQ;
+		Pack_Unpack(b.bits, p + FRAME_PACKED_HDR, b.count, s->unpack);
+		for (unsigned i = 0; i < b.count; i++)
+			Frame_PutU16(&s->unpack_buf[2 * i], s->unpack[i]);
+		b.data = s->unpack_buf;
+		s->stats.samples += b.count;
+		if (s->on_block)
+			s->on_block(s->user, &b);
+		return;
+
+	case FRAME_GAP:
+		if (len != FRAME_GAP_SIZE)
+			break;
+		b.seq = seq;
+		b.t_us = Frame_GetU32(p);
+		b.channel = p[4];
+		b.lost = Frame_GetU16(p + 5);
+		b.flags = ADCS_F_BINARY | ADCS_F_GAP | ADCS_F_HAS_TS | ADCS_F_HAS_SEQ;
+		s->stats.board_gaps++;
+		s->stats.board_lost += b.lost;
+		if (s->on_block)
+			s->on_block(s->user, &b);
+		return;
+
+	case FRAME_TEXT:
+		if (s->on_text)
+			s->on_text(s->user, (const char *)p, len);
+		return;
+
+	default:
+		return;                                 // Type inconnu : ignoré (compatibilité)
+	}
+
+	s->stats.frames--;
+	s->stats.crc_errors++;                      // Longueur incohérente avec le contenu
+}
+
+// Décoder "ASCII Code: 52 48 57 53, Voltage: 3.30 V" ; retourne -1 si la ligne est incohérente
+// La résolution n'est pas transmise : elle est déduite de la tension affichée (12, 10, 8 ou 6 bits)
+static int parse_ascii_codes (const char *p, const char *end, uint16_t *raw, uint8_t *bits)
+{
+	uint32_t value = 0;
+	int digits = 0;
+	char *q;
+
+	if (end - p < 12 || memcmp(p, "ASCII Code: ", 12) != 0)
+		return -1;
+	p += 12;
+	while (p < end && *p >= '0' && *p <= '9') {
+		long code = strtol(p, &q, 10);
+		if (code < '0' || code > '9' || q > end)
+			return -1;
+		value = value * 10 + (uint32_t)(code - '0');
+		digits++;
+		p = q;
+		if (p < end && *p == ' ')
+			p++;
+	}
+	if (!digits || value > 0xFFFF || end - p < 11 || memcmp(p, ", Voltage: ", 11) != 0)
+		return -1;
+
+	// Contrôle croisé avec la tension affichée (arrondie au centième)
+	double v = strtod(p + 11, &q);
+	if (q == p + 11)
+		return -1;
+	for (int b = 12; b >= 6; b -= 2) {
+		double expect = value * (3.3 / (1u << b));
+		if (value < (1u << b) && v - expect <= 0.0051 && expect - v <= 0.0051) {
+			*raw = (uint16_t)value;
+			*bits = (uint8_t)b;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+static void handle_line (AdcStream *s, const char *p, size_t len)
+{
+	const char *end = p + len;
+	AdcBlock b;
+	uint16_t raw;
+
+	if (len && end[-1] == '\r')
+		end--;
+
+	memset(&b, 0, sizeof(b));
+	b.channel = 1;
+	b.count = 1;
+
+	if (end - p >= 8 && memcmp(p, "Replay: ", 8) == 0) {
+		// "Replay: seq=N, t=T ms, ASCII Code: ..."
+		char *q;
+		const char *r = p + 8;
+		if (end - r < 4 || memcmp(r, "seq=", 4) != 0)
+			goto bad;
+		b.seq = (uint32_t)strtoul(r + 4, &q, 10);
+		if (q + 4 > end || memcmp(q, ", t=", 4) != 0)
+			goto bad;
+		b.t_us = (uint32_t)(strtoul(q + 4, &q, 10) * 1000);
+		if (q + 5 > end || memcmp(q, " ms, ", 5) != 0)
+			goto bad;
+		p = q + 5;
+		b.flags = ADCS_F_REPLAY | ADCS_F_HAS_SEQ | ADCS_F_HAS_TS;
+	} else if (end - p >= 7 && memcmp(p, "Gap: ch", 7) == 0) {
+		// "Gap: ch1, t=T ms, lost=N"
+		char *q;
+		b.channel = (uint8_t)strtoul(p + 7, &q, 10);
+		if (q + 4 > end || memcmp(q, ", t=", 4) != 0)
+			goto bad;
+		b.t_us = (uint32_t)(strtoul(q + 4, &q, 10) * 1000);
+		if (q + 10 > end || memcmp(q, " ms, lost=", 10) != 0)
+			goto bad;
+		b.lost = (uint16_t)strtoul(q + 10, &q, 10);
+		b.count = 0;
+		b.flags = ADCS_F_GAP | ADCS_F_HAS_TS;
+		s->stats.board_gaps++;
+		s->stats.board_lost += b.lost;
+		if (s->on_block)
+			s->on_block(s->user, &b);
+		return;
+	} else if (end - p < 6 || memcmp(p, "ASCII ", 6) != 0) {
+		if (s->on_text)
+			s->on_text(s->user, p, (size_t)(end - p));
+		return;
+	}
+
+	if (parse_ascii_codes(p, end, &raw, &b.bits) != 0)
+		goto bad;
+
+	s->raw_buf[0] = (uint8_t)raw;
+	s->raw_buf[1] = (uint8_t)(raw >> 8);
+	b.data = s->raw_buf;
+	s->stats.lines++;
+	s->stats.samples++;
+	if (s->on_block)
+		s->on_block(s->user, &b);
+	return;
+
+bad:
+	s->stats.bad_lines++;
+}
+
+// Analyser toutes les unités complètes ; retourne le nombre d'octets consommés
+static size_t parse (AdcStream *s, const uint8_t *p, size_t len)
+{
+	size_t i = 0;
+
+	while (i < len) {
+		if (p[i] == FRAME_SYNC0) {
+			if (i + 1 >= len)
+				break;
+			if (p[i + 1] != FRAME_SYNC1) {
+				i++;
+				s->stats.resync_bytes++;
+				continue;
+			}
+			if (i + FRAME_HDR_SIZE > len)
+				break;
+			size_t total = FRAME_HDR_SIZE + p[i + 3] + FRAME_CRC_SIZE;
+			if (i + total > len)
+				break;
+			uint16_t crc = Frame_GetU16(&p[i + total - FRAME_CRC_SIZE]);
+			if (CRC16_Compute(&p[i + 2], total - 4) != crc) {
+				s->stats.crc_errors++;
+				i++;                                // Fausse synchronisation ou trame corrompue
+				continue;
+			}
+			handle_frame(s, &p[i]);
+			i += total;
+		} else {
+			// Texte : ASCII jusqu'au saut de ligne ; un octet non ASCII interrompt la ligne
+			size_t j = i;
+			while (j < len && p[j] != '\n' && p[j] < 0x80)
+				j++;
+			if (j == len) {
+				if (j - i <= MAX_LINE)
+					break;                          // Ligne incomplète
+				s->stats.bad_lines++;
+				i = j;
+				continue;
+			}
+			if (p[j] != '\n') {
+				if (j == i)
+					j++;                            // Octet non ASCII isolé
+				s->stats.resync_bytes += j - i;     // Bruit avant une trame binaire
+				i = j;
+				continue;
+			}
+			if (j - i > MAX_LINE)
+				s->stats.bad_lines++;
+			else if (j > i)
+				handle_line(s, (const char *)&p[i], j - i);
+			i = j + 1;
+		}
+	}
+	return i;
+}
+
+/**
+  * @brief Initialiser l'analyseur
+  * @param s : État
+  * @param on_block : Rappel appelé pour chaque bloc d'échantillons
+  * @param on_text : Rappel pour les textes (démarrage, messages) ; peut être NULL
+  * @param user : Contexte transmis aux rappels
+  */
+void adcs_init (AdcStream *s, AdcBlockFn on_block, AdcTextFn on_text, void *user)
+{
+	memset(s, 0, sizeof(*s));
+	s->on_block = on_block;
+	s->on_text = on_text;
+	s->user = user;
+}
+
+/**
+  * @brief Fournir de nouveaux octets reçus
+  * @param s : État
+  * @param data : Octets (analysés en place)
+  * @param length : Nombre d'octets
+  */
+void adcs_feed (AdcStream *s, const uint8_t *data, size_t length)
+{
+	size_t used;
+
+	s->stats.bytes += length;
+
+	// Compléter l'unité coupée lors de l'appel précédent
+	while (s->carry_len && length) {
+		size_t k = sizeof(s->carry) - s->carry_len;
+		if (k > length)
+			k = length;
+		memcpy(s->carry + s->carry_len, data, k);
+		size_t total = s->carry_len + k;
+		used = parse(s, s->carry, total);
+		if (used >= s->carry_len) {
+			data += used - s->carry_len;
+			length -= used - s->carry_len;
+			s->carry_len = 0;
+		} else {
+			memmove(s->carry, s->carry + used, total - used);
+			s->carry_len = total - used;
+			data += k;
+			length -= k;
+		}
+	}
+
+	// Analyse en place
+	used = parse(s, data, length);
+	if (used < length) {
+		memcpy(s->carry, data + used, length - used);
+		s->carry_len = length - used;
+	}
+}
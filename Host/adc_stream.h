@@ -0,0 +1,79 @@
+#ifndef ADC_STREAM_H
+#define ADC_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+  * @brief Analyse incrémentale du flux de la carte ADC-UART
+  *        Accepte indifféremment les lignes texte ("ASCII Code: 52 48 57 53, Voltage: 3.30 V",
+  *        "Replay: ...", "Gap: ...", "Boot: ...") et les trames binaires décrites dans
+  *        ADC-UART/Frame.h.
+  *        Les données sont analysées en place dans le tampon fourni par l'appelant : seule une
+  *        trame ou une ligne coupée en fin de tampon est recopiée.
+  */
+
+// Indicateurs d'un bloc d'échantillons
+#define ADCS_F_BINARY   0x01  // Issu d'une trame binaire
+#define ADCS_F_REPLAY   0x02  // Relu depuis le journal Flash de la carte
+#define ADCS_F_HAS_TS   0x04  // t_us est un horodatage de la carte
+#define ADCS_F_HAS_SEQ  0x08  // seq est significatif
+#define ADCS_F_GAP      0x10  // Marqueur de perte de la carte : count = 0, lost renseigné
+
+// Bloc d'échantillons décodé (pointe dans le tampon de l'appelant, valable pendant le rappel)
+typedef struct {
+	uint32_t       seq;       // Séquence de trame (ou du journal pour un relu)
+	uint32_t       t_us;      // Horodatage carte du premier échantillon
+	uint8_t        channel;
+	uint8_t        flags;
+	uint8_t        bits;      // Résolution des échantillons (12 sauf trame FRAME_PACKED)
+	uint16_t       count;     // Nombre d'échantillons
+	uint16_t       lost;      // ADCS_F_GAP : événements de perte signalés par la carte
+	const uint8_t *data;      // count valeurs u16 little-endian
+} AdcBlock;
+
+typedef struct {
+	uint64_t bytes;
+	uint64_t frames;          // Trames binaires valides
+	uint64_t lines;           // Lignes texte d'échantillon valides
+	uint64_t samples;
+	uint64_t crc_errors;      // Trames binaires au CRC faux ou au contenu incohérent
+	uint64_t bad_lines;       // Lignes texte illisibles
+	uint64_t seq_gaps;        // Discontinuités de séquence
+	uint64_t lost_frames;     // Trames manquantes estimées d'après la séquence
+	uint64_t resync_bytes;    // Octets ignorés pour retrouver la synchronisation
+	uint64_t board_gaps;      // Marqueurs de perte émis par la carte (débordement ADC, DMA)
+	uint64_t board_lost;      // Somme des pertes signalées
+	uint64_t stream_frames[4];  // Trames par flux de la carte (FRAME_STREAM : données, télémétrie, journal)
+	uint64_t stream_bytes[4];   // Octets par flux, en-têtes compris
+} AdcStreamStats;
+
+typedef struct AdcStream AdcStream;
+
+typedef void (*AdcBlockFn)(void *user, const AdcBlock *blk);
+typedef void (*AdcTextFn)(void *user, const char *text, size_t length);
+
+struct AdcStream {
+	AdcBlockFn     on_block;
+	AdcTextFn      on_text;   // Lignes / trames de texte qui ne sont pas des échantillons
+	void          *user;
+	AdcStreamStats stats;
+	/* état interne */
+	uint8_t        carry[512];
+	size_t         carry_len;
+	int            have_seq;
+	uint16_t       last_seq;
+	uint8_t        raw_buf[2];
+	uint16_t       unpack[255];           // Échantillons d'une trame compactée
+	uint8_t        unpack_buf[2 * 255];
+};
+
+void adcs_init(AdcStream *s, AdcBlockFn on_block, AdcTextFn on_text, void *user);
+void adcs_feed(AdcStream *s, const uint8_t *data, size_t length);
+
+static inline uint16_t adcs_sample(const AdcBlock *b, unsigned i)
+{
+	return (uint16_t)(b->data[2 * i] | (b->data[2 * i + 1] << 8));
+}
+
+#endif /* ADC_STREAM_H */
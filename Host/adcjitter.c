@@ -0,0 +1,428 @@
+/**
+  * @brief  adcjitter : analyse de la cadence d'échantillonnage d'un flux enregistré
+  *
+  *   Compilation :
+  *      gcc -O2 -o adcjitter adcjitter.c adc_stream.c adc_capture.c ../ADC-UART/Frame.c ../ADC-UART/CRC16.c ../ADC-UART/Pack.c -lm
+  *
+  *   Utilisation :
+  *      adcjitter [options] <capture.adccap | flux (fichier, pty, -)>
+  *         -p <µs>            période nominale (par défaut : médiane des intervalles)
+  *         -s <µs>            intervalle entre les échantillons d'un même bloc (par défaut :
+  *                            écart entre débuts de blocs consécutifs / échantillons du bloc)
+  *         --arrival          utiliser l'heure de réception au lieu de l'horodatage carte
+  *         --json             sortie JSON (sinon texte)
+  *         --max-jitter <µs>  seuil sur le 99e centile de |intervalle - nominal|
+  *         --min-rate <Hz>    seuil sur la cadence effective
+  *         --max-gaps <n>     seuil sur le nombre de trous
+  *
+  *   Par canal : cadence effective, distribution de la gigue (écart-type, centiles,
+  *   histogramme), trous (intervalle > 1,5 x nominal) et inversions (horodatage ou séquence
+  *   en recul). Les échantillons relus depuis le journal Flash sont exclus. Le code de
+  *   retour vaut 1 si un seuil est dépassé : utilisable pour valider une version du logiciel.
+  *   Une trame ne porte que l'horodatage de son premier échantillon : le i-ème échantillon
+  *   d'un bloc est daté t_us + i x intervalle. L'estimation par défaut convient au flux
+  *   continu (blocs jointifs) ; pour des rafales, donner -s (durée d'une conversion).
+  *   Une période nominale nulle (horodatages identiques) est une erreur.
+  */
+#define _GNU_SOURCE
+#include "adc_stream.h"
+#include "adc_capture.h"
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_CHANNELS 32
+#define HIST_BINS    21   // Gigue de -10 % à +10 % de la période nominale, par pas de 1 %
+
+typedef struct {
+	uint64_t *t_ns;
+	uint32_t *seq;
+	uint16_t *count;      // Échantillons du bloc daté par t_ns (développés par expand())
+	size_t    n, cap;
+	int       has_seq;
+	uint64_t  wrap;       // Déroulage de l'horodatage carte (u32 en µs)
+	uint32_t  last_t_us;
+} Series;
+
+typedef struct {
+	size_t   samples;
+	double   duration_s;
+	double   rate_hz;
+	double   nominal_us;
+	double   mean_us, min_us, max_us, std_us;
+	double   p50_us, p90_us, p99_us, p999_us;  // Centiles de |intervalle - nominal|
+	uint64_t gaps, missing, reorders;
+	uint64_t hist[HIST_BINS + 2];              // + débordements bas et haut
+} Report;
+
+static Series series[MAX_CHANNELS];
+static int use_arrival;
+static uint64_t arrival_ns;
+
+static void reserve (Series *s, size_t n)
+{
+	if (n <= s->cap)
+		return;
+	s->cap = s->cap ? s->cap : 4096;
+	while (s->cap < n)
+		s->cap *= 2;
+	s->t_ns = realloc(s->t_ns, s->cap * sizeof(*s->t_ns));
+	s->seq = realloc(s->seq, s->cap * sizeof(*s->seq));
+	s->count = realloc(s->count, s->cap * sizeof(*s->count));
+	if (!s->t_ns || !s->seq || !s->count) {
+		fprintf(stderr, "adcjitter: mémoire insuffisante\n");
+		exit(2);
+	}
+}
+
+static void push (Series *s, uint64_t t_ns, uint32_t seq, uint16_t count)
+{
+	reserve(s, s->n + 1);
+	s->t_ns[s->n] = t_ns;
+	s->seq[s->n] = seq;
+	s->count[s->n] = count;
+	s->n++;
+}
+
+static void add_block (uint8_t channel, uint8_t flags, uint32_t seq, uint32_t t_us, uint64_t arr_ns,
+                       uint16_t count)
+{
+	Series *s;
+	uint64_t t;
+
+	if (flags & ADCS_F_REPLAY || channel >= MAX_CHANNELS)
+		return;
+	s = &series[channel];
+
+	if (!use_arrival && (flags & ADCS_F_HAS_TS)) {
+		if (s->n && t_us < s->last_t_us && s->last_t_us - t_us > 0x80000000u)
+			s->wrap += 1ull << 32;              // Rebouclage du compteur µs de la carte
+		s->last_t_us = t_us;
+		t = (s->wrap + t_us) * 1000;
+	} else {
+		t = arr_ns;
+	}
+	s->has_seq |= (flags & ADCS_F_HAS_SEQ) != 0;
+	push(s, t, seq, count);
+}
+
+static void on_block (void *user, const AdcBlock *b)
+{
+	(void)user;
+	if (b->flags & ADCS_F_GAP)
+		return;                                 // Marqueur de perte : le trou est mesuré sur les dates
+	// Un bloc de plusieurs échantillons ne porte que l'horodatage du premier : daté par expand()
+	add_block(b->channel, b->flags, b->seq, b->t_us, arrival_ns, b->count);
+}
+
+static int cmp_double (const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+static double percentile (const double *sorted, size_t n, double q)
+{
+	size_t i = (size_t)(q * (n - 1) + 0.5);
+	return n ? sorted[i] : 0;
+}
+
+/**
+  * @brief Dater chaque échantillon des blocs : t + i x intervalle
+  * @param sample_us : Intervalle dans un bloc (<= 0 : médiane de l'écart entre débuts de
+  *                    blocs consécutifs divisé par les échantillons du premier)
+  * @retval 0 si succès, -1 si l'intervalle est nul alors que des blocs en ont besoin
+  */
+static int expand (Series *s, double sample_us)
+{
+	size_t total = 0, m = 0;
+	double *per = NULL;
+
+	for (size_t i = 0; i < s->n; i++)
+		total += s->count[i];
+	if (total == s->n)
+		return 0;                               // Un échantillon par bloc : rien à dater
+
+	if (sample_us <= 0) {
+		per = malloc(s->n * sizeof(double));
+		for (size_t i = 0; per && i + 1 < s->n; i++) {
+			if (s->count[i] > 1 && s->t_ns[i + 1] > s->t_ns[i])
+				per[m++] = (s->t_ns[i + 1] - s->t_ns[i]) / 1000.0 / s->count[i];
+		}
+		if (m) {
+			qsort(per, m, sizeof(double), cmp_double);
+			sample_us = percentile(per, m, 0.5);
+		}
+		free(per);
+	}
+	if (!(sample_us > 0))
+		return -1;
+
+	// Développement en place, de la fin vers le début
+	size_t j = total;
+	reserve(s, total);
+	for (size_t i = s->n; i-- > 0; ) {
+		uint64_t t = s->t_ns[i];
+		uint32_t seq = s->seq[i];
+		for (uint16_t k = s->count[i]; k-- > 0; ) {
+			j--;
+			s->t_ns[j] = t + (uint64_t)(k * sample_us * 1000.0 + 0.5);
+			s->seq[j] = seq;
+			s->count[j] = 1;
+		}
+	}
+	s->n = total;
+	return 0;
+}
+
+/**
+  * @brief Statistiques d'intervalle d'une série
+  * @retval 0 si succès, -1 si la période nominale est nulle
+  */
+static int analyse (const Series *s, double nominal_us, Report *r)
+{
+	int rc = 0;
+
+	size_t m = 0;
+	double *dt = malloc(s->n * sizeof(double));
+	double *dev = malloc(s->n * sizeof(double));
+	double sum = 0, sum2 = 0;
+
+	memset(r, 0, sizeof(*r));
+	r->samples = s->n;
+	if (s->n < 2 || !dt || !dev)
+		goto out;
+
+	for (size_t i = 1; i < s->n; i++) {
+		if (s->t_ns[i] < s->t_ns[i - 1] ||
+		    (s->has_seq && (int32_t)(s->seq[i] - s->seq[i - 1]) < 0)) {
+			r->reorders++;
+			continue;
+		}
+		dt[m++] = (s->t_ns[i] - s->t_ns[i - 1]) / 1000.0;
+	}
+	if (!m)
+		goto out;
+
+	if (nominal_us <= 0) {
+		memcpy(dev, dt, m * sizeof(double));
+		qsort(dev, m, sizeof(double), cmp_double);
+		nominal_us = percentile(dev, m, 0.5);
+	}
+	r->nominal_us = nominal_us;
+	if (!(nominal_us > 0)) {
+		rc = -1;                                // Horodatages identiques : aucune cadence mesurable
+		goto out;
+	}
+	r->min_us = r->max_us = dt[0];
+
+	for (size_t i = 0; i < m; i++) {
+		double d = dt[i] - nominal_us;
+		sum += dt[i];
+		sum2 += dt[i] * dt[i];
+		if (dt[i] < r->min_us) r->min_us = dt[i];
+		if (dt[i] > r->max_us) r->max_us = dt[i];
+		if (dt[i] > 1.5 * nominal_us) {
+			double lost = floor(dt[i] / nominal_us + 0.5) - 1;
+			r->gaps++;
+			r->missing += (uint64_t)fmin(fmax(lost, 1), 1e15);   // Au moins 1, borné
+		}
+		int bin = (int)floor(d / nominal_us * 100.0 + 0.5) + HIST_BINS / 2;
+		if (bin < 0)
+			r->hist[HIST_BINS]++;
+		else if (bin >= HIST_BINS)
+			r->hist[HIST_BINS + 1]++;
+		else
+			r->hist[bin]++;
+		dev[i] = fabs(d);
+	}
+	qsort(dev, m, sizeof(double), cmp_double);
+
+	r->mean_us = sum / m;
+	r->std_us = sqrt(fmax(0, sum2 / m - r->mean_us * r->mean_us));
+	r->p50_us = percentile(dev, m, 0.50);
+	r->p90_us = percentile(dev, m, 0.90);
+	r->p99_us = percentile(dev, m, 0.99);
+	r->p999_us = percentile(dev, m, 0.999);
+	r->duration_s = (s->t_ns[s->n - 1] - s->t_ns[0]) / 1e9;
+	r->rate_hz = r->duration_s > 0 ? (s->n - 1) / r->duration_s : 0;
+
+out:
+	free(dt);
+	free(dev);
+	return rc;
+}
+
+static void print_text (int ch, const Report *r)
+{
+	printf("canal %d : %zu échantillons sur %.3f s\n", ch, r->samples, r->duration_s);
+	printf("  cadence effective : %.3f Hz (nominal %.1f µs, moyenne %.1f µs)\n",
+	       r->rate_hz, r->nominal_us, r->mean_us);
+	printf("  intervalle min/max : %.1f / %.1f µs, écart-type %.2f µs\n", r->min_us, r->max_us, r->std_us);
+	printf("  |gigue| p50 %.2f  p90 %.2f  p99 %.2f  p99.9 %.2f µs\n",
+	       r->p50_us, r->p90_us, r->p99_us, r->p999_us);
+	printf("  trous %llu (échantillons manquants ~%llu), inversions %llu\n",
+	       (unsigned long long)r->gaps, (unsigned long long)r->missing, (unsigned long long)r->reorders);
+	printf("  histogramme (écart / nominal) :\n");
+	printf("    <-10%% : %llu\n", (unsigned long long)r->hist[HIST_BINS]);
+	for (int i = 0; i < HIST_BINS; i++)
+		if (r->hist[i])
+			printf("    %+3d%% : %llu\n", i - HIST_BINS / 2, (unsigned long long)r->hist[i]);
+	printf("    >+10%% : %llu\n", (unsigned long long)r->hist[HIST_BINS + 1]);
+}
+
+static void print_json (int ch, const Report *r, int first)
+{
+	printf("%s\n    {\"channel\": %d, \"samples\": %zu, \"duration_s\": %.6f, \"rate_hz\": %.6f,"
+	       " \"nominal_us\": %.3f, \"mean_us\": %.3f, \"min_us\": %.3f, \"max_us\": %.3f, \"std_us\": %.3f,"
+	       " \"jitter_p50_us\": %.3f, \"jitter_p90_us\": %.3f, \"jitter_p99_us\": %.3f, \"jitter_p999_us\": %.3f,"
+	       " \"gaps\": %llu, \"missing\": %llu, \"reorders\": %llu, \"histogram\": [",
+	       first ? "" : ",", ch, r->samples, r->duration_s, r->rate_hz, r->nominal_us, r->mean_us,
+	       r->min_us, r->max_us, r->std_us, r->p50_us, r->p90_us, r->p99_us, r->p999_us,
+	       (unsigned long long)r->gaps, (unsigned long long)r->missing, (unsigned long long)r->reorders);
+	for (int i = 0; i < HIST_BINS + 2; i++)
+		printf("%s%llu", i ? ", " : "", (unsigned long long)r->hist[i]);
+	printf("]}");
+}
+
+static int load_capture (const char *path)
+{
+	AdcCapture c;
+	AdcCapColumns col;
+
+	uint32_t seq = 0, t_us = 0;
+	uint64_t arr = 0;
+	uint8_t channel = 0, flags = 0;
+	uint16_t count = 0;
+
+	if (adccap_open(&c, path) != 0)
+		return -1;
+	// Les lignes d'une même trame (même séquence, même horodatage) sont regroupées en bloc
+	for (uint64_t row = 0; row < adccap_rows(&c); row++) {
+		uint64_t i = row % ADCCAP_BLOCK_ROWS;
+		if (i == 0)
+			adccap_block(&c, row / ADCCAP_BLOCK_ROWS, &col);
+		if (count && count < UINT16_MAX && (flags & ADCS_F_HAS_SEQ) && col.flags[i] == flags &&
+		    col.channel[i] == channel && col.seq[i] == seq && col.t_us[i] == t_us && col.arrival_ns[i] == arr) {
+			count++;
+			continue;
+		}
+		if (count)
+			add_block(channel, flags, seq, t_us, arr, count);
+		channel = col.channel[i];
+		flags = col.flags[i];
+		seq = col.seq[i];
+		t_us = col.t_us[i];
+		arr = col.arrival_ns[i];
+		count = 1;
+	}
+	if (count)
+		add_block(channel, flags, seq, t_us, arr, count);
+	adccap_close(&c);
+	return 0;
+}
+
+static int load_stream (const char *path)
+{
+	static uint8_t buf[65536];
+	struct timespec ts;
+	AdcStream s;
+	int fd = strcmp(path, "-") ? open(path, O_RDONLY) : 0;
+	ssize_t r;
+
+	if (fd < 0)
+		return -1;
+	adcs_init(&s, on_block, NULL, NULL);
+	while ((r = read(fd, buf, sizeof(buf))) > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		arrival_ns = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+		adcs_feed(&s, buf, (size_t)r);
+	}
+	if (fd)
+		close(fd);
+	if (s.stats.board_gaps)
+		fprintf(stderr, "adcjitter: %llu pertes signalées par la carte (%llu marqueurs)\n",
+		        (unsigned long long)s.stats.board_lost, (unsigned long long)s.stats.board_gaps);
+	if (s.stats.crc_errors || s.stats.bad_lines)
+		fprintf(stderr, "adcjitter: %llu trames et %llu lignes corrompues ignorées\n",
+		        (unsigned long long)s.stats.crc_errors, (unsigned long long)s.stats.bad_lines);
+	return 0;
+}
+
+int main (int argc, char **argv)
+{
+	double nominal = 0, sample_us = 0, max_jitter = -1, min_rate = -1;
+	long long max_gaps = -1;
+	int json = 0, fail = 0, first = 1;
+	const char *path = NULL;
+	char magic[8] = { 0 };
+	FILE *f;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-p") && i + 1 < argc)
+			nominal = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+			sample_us = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--arrival"))
+			use_arrival = 1;
+		else if (!strcmp(argv[i], "--json"))
+			json = 1;
+		else if (!strcmp(argv[i], "--max-jitter") && i + 1 < argc)
+			max_jitter = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--min-rate") && i + 1 < argc)
+			min_rate = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--max-gaps") && i + 1 < argc)
+			max_gaps = atoll(argv[++i]);
+		else
+			path = argv[i];
+	}
+	if (!path) {
+		fprintf(stderr, "usage: adcjitter [-p µs] [-s µs] [--arrival] [--json] [--max-jitter µs]"
+		                " [--min-rate Hz] [--max-gaps n] <capture|flux>\n");
+		return 2;
+	}
+
+	// Capture en colonnes ou flux brut
+	if (strcmp(path, "-") && (f = fopen(path, "rb")) != NULL) {
+		if (fread(magic, 1, sizeof(magic), f) != sizeof(magic))
+			magic[0] = 0;
+		fclose(f);
+	}
+	if ((memcmp(magic, ADCCAP_MAGIC, 8) == 0 ? load_capture(path) : load_stream(path)) != 0) {
+		fprintf(stderr, "adcjitter: lecture de %s impossible\n", path);
+		return 2;
+	}
+
+	if (json)
+		printf("{\n  \"channels\": [");
+	for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+		Report r;
+		if (!series[ch].n)
+			continue;
+		if (expand(&series[ch], sample_us) != 0 || analyse(&series[ch], nominal, &r) != 0) {
+			fprintf(stderr, "adcjitter: canal %d : période nulle (horodatages identiques), préciser -s ou -p\n", ch);
+			fail = 1;
+			continue;
+		}
+		if (json)
+			print_json(ch, &r, first);
+		else
+			print_text(ch, &r);
+		first = 0;
+
+		if ((max_jitter >= 0 && r.p99_us > max_jitter) ||
+		    (min_rate >= 0 && r.rate_hz < min_rate) ||
+		    (max_gaps >= 0 && (long long)r.gaps > max_gaps))
+			fail = 1;
+	}
+	if (json)
+		printf("\n  ],\n  \"pass\": %s\n}\n", fail ? "false" : "true");
+	else
+		printf("%s\n", fail ? "ÉCHEC : seuil dépassé" : "OK");
+
+	return fail;
+}
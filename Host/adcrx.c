@@ -0,0 +1,403 @@
+/**
+  * @brief  adcrx : réception et capture du flux de la carte ADC-UART
+  *
+  *   Compilation :
+  *      gcc -O2 -o adcrx adcrx.c adc_stream.c adc_capture.c arq_peer.c baud_peer.c ../ADC-UART/Arq.c ../ADC-UART/BaudNeg.c ../ADC-UART/Frame.c ../ADC-UART/CRC16.c ../ADC-UART/Pack.c
+  *
+  *   Utilisation :
+  *      adcrx [-b baud] [-n débit,débit...] [-o capture.adccap] [-q] [-r] [-t secondes] <port série | pty | fichier | ->
+  *      adcrx --bench [Mo]
+  *
+  *   Les échantillons sont affichés en CSV (seq,t_us,arrival_ns,channel,flags,raw) sur la
+  *   sortie standard, sauf avec -q. Sur un port série, un octet est émis chaque seconde pour
+  *   signaler la présence de l'hôte (voir HostLink.c côté carte). Le bilan (débit, pertes,
+  *   erreurs) est écrit sur la sortie d'erreur.
+  *   -r : mode fiable de la carte (APP_RELIABLE) : les trames passent par le pair de
+  *   retransmission (arq_peer.c) qui les remet dans l'ordre et sans doublon ; ses
+  *   acquittements remplacent le battement de coeur.
+  *   -n : négociation du débit avant la réception (APP_BAUDNEG, baud_peer.c) : la carte est au
+  *   débit -b, les candidats sont essayés du plus rapide au plus lent et le premier vérifié
+  *   dans les deux sens est gardé. Les débits que le terminal ne sait pas régler sont écartés.
+  */
+#define _GNU_SOURCE
+#include "adc_stream.h"
+#include "adc_capture.h"
+#include "arq_peer.h"
+#include "baud_peer.h"
+#include "../ADC-UART/Frame.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define READ_CHUNK 65536
+
+typedef struct {
+	AdcCapture cap;
+	int        capture;
+	int        quiet;
+	uint64_t   arrival_ns;  // Heure de réception du tampon en cours d'analyse
+	FILE      *out;
+	AdcStream *stream;      // Mode fiable : destination des trames remises
+	int        fd;          // Mode fiable : port où partent les acquittements
+} RxContext;
+
+static volatile sig_atomic_t stop;
+
+static void on_signal (int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+static uint64_t now_ns (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void on_block (void *user, const AdcBlock *b)
+{
+	RxContext *rx = user;
+
+	for (unsigned i = 0; i < b->count; i++) {
+		uint16_t raw = adcs_sample(b, i);
+		if (rx->capture)
+			adccap_append(&rx->cap, b->seq, b->t_us, rx->arrival_ns, raw, b->channel, b->flags);
+		if (!rx->quiet)
+			fprintf(rx->out, "%u,%u,%llu,%u,%u,%u\n", b->seq, b->t_us,
+			        (unsigned long long)rx->arrival_ns, b->channel, b->flags, raw);
+	}
+}
+
+static void on_text (void *user, const char *text, size_t length)
+{
+	(void)user;
+	fprintf(stderr, "# %.*s\n", (int)length, text);
+}
+
+// Mode fiable : trame remise dans l'ordre par le pair
+static void on_deliver (void *user, const uint8_t *frame, size_t length)
+{
+	RxContext *rx = user;
+	adcs_feed(rx->stream, frame, length);
+}
+
+// Mode fiable : acquittement ou demande de retransmission vers la carte
+static void on_send (void *user, const uint8_t *frame, size_t length)
+{
+	RxContext *rx = user;
+	if (rx->fd >= 0)
+		(void)write(rx->fd, frame, length);
+}
+
+static speed_t baud_constant (long baud)
+{
+	switch (baud) {
+	case 9600:    return B9600;
+	case 19200:   return B19200;
+	case 38400:   return B38400;
+	case 57600:   return B57600;
+	case 115200:  return B115200;
+	case 230400:  return B230400;
+	case 460800:  return B460800;
+	case 921600:  return B921600;
+#ifdef B1000000
+	case 1000000: return B1000000;
+	case 1500000: return B1500000;
+	case 2000000: return B2000000;
+	case 3000000: return B3000000;
+	case 4000000: return B4000000;
+#endif
+	default:      return 0;
+	}
+}
+
+// Configurer un terminal en mode brut au débit demandé
+static int setup_tty (int fd, long baud)
+{
+	struct termios tio;
+	speed_t sp = baud_constant(baud);
+
+	if (tcgetattr(fd, &tio) != 0)
+		return -1;
+	cfmakeraw(&tio);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN] = 1;
+	tio.c_cc[VTIME] = 0;
+	if (sp && (cfsetispeed(&tio, sp) != 0 || cfsetospeed(&tio, sp) != 0))
+		return -1;
+	if (!sp)
+		fprintf(stderr, "adcrx: débit %ld non standard, débit actuel conservé\n", baud);
+	return tcsetattr(fd, TCSANOW, &tio);
+}
+
+/* ---------- négociation du débit (baud_peer.c) sur le terminal ---------- */
+
+static int tty_set_baud (void *user, long baud)
+{
+	int fd = *(int *)user;
+
+	if (!baud_constant(baud))
+		return -1;
+	return setup_tty(fd, baud);
+}
+
+static int tty_write (void *user, const uint8_t *data, size_t length)
+{
+	int fd = *(int *)user;
+
+	while (length) {
+		ssize_t w = write(fd, data, length);
+		if (w < 0 && errno == EINTR)
+			continue;
+		if (w <= 0)
+			return -1;
+		data += w;
+		length -= (size_t)w;
+	}
+	return tcdrain(fd);
+}
+
+static long tty_read (void *user, uint8_t *buf, size_t size, int timeout_ms)
+{
+	int fd = *(int *)user;
+	struct pollfd pfd = { fd, POLLIN, 0 };
+	ssize_t r;
+
+	if (poll(&pfd, 1, timeout_ms) <= 0)
+		return 0;
+	r = read(fd, buf, size);
+	return r < 0 ? (errno == EINTR ? 0 : -1) : (long)r;
+}
+
+static uint64_t tty_now_ms (void *user)
+{
+	(void)user;
+	return now_ns() / 1000000;
+}
+
+// Négocier parmi les débits de la liste "d1,d2,..." ; retourne le débit final
+static long negotiate (int fd, long baud, const char *list)
+{
+	BaudLink link = { tty_set_baud, tty_write, tty_read, tty_now_ms, &fd };
+	BaudOptions o;
+	BaudTrial trials[16];
+	long rates[16];
+	int count = 0, tried;
+	char *end;
+
+	while (*list && count < 16) {
+		long r = strtol(list, &end, 10);
+		if (end == list)
+			break;
+		if (baud_constant(r))
+			rates[count++] = r;
+		else
+			fprintf(stderr, "adcrx: débit %ld non standard, écarté\n", r);
+		list = *end == ',' ? end + 1 : end;
+	}
+	baudp_defaults(&o);
+	baud = baudp_negotiate(&link, &o, baud, rates, count, trials, &tried);
+	for (int i = 0; i < tried; i++)
+		fprintf(stderr, "# débit %ld : %s (carte : réel %lu, %ld ppm, BRR=0x%04X OVER8=%u ; motif %u/%u faux vers la carte, %u/%u vers l'hôte, %u erreurs de ligne)\n",
+		        trials[i].baud, baudp_status(trials[i].status), (unsigned long)trials[i].actual,
+		        (long)trials[i].error_ppm, trials[i].brr, trials[i].over8,
+		        trials[i].board_errors, trials[i].board_received, trials[i].host_errors,
+		        trials[i].host_received, trials[i].line_errors);
+	fprintf(stderr, "# débit retenu : %ld\n", baud);
+	return baud;
+}
+
+static void print_stats (const AdcStreamStats *st, double seconds)
+{
+	fprintf(stderr,
+	        "octets=%llu trames=%llu lignes=%llu échantillons=%llu\n"
+	        "crc=%llu lignes_invalides=%llu trous=%llu trames_perdues=%llu resync=%llu\n",
+	        (unsigned long long)st->bytes, (unsigned long long)st->frames,
+	        (unsigned long long)st->lines, (unsigned long long)st->samples,
+	        (unsigned long long)st->crc_errors, (unsigned long long)st->bad_lines,
+	        (unsigned long long)st->seq_gaps, (unsigned long long)st->lost_frames,
+	        (unsigned long long)st->resync_bytes);
+	if (st->board_gaps)
+		fprintf(stderr, "pertes signalées par la carte : %llu marqueurs, %llu événements\n",
+		        (unsigned long long)st->board_gaps, (unsigned long long)st->board_lost);
+	if (st->stream_frames[1] || st->stream_frames[2] || st->stream_frames[3])
+		fprintf(stderr, "flux : données %llu trames / %llu octets, télémétrie %llu / %llu, journal %llu / %llu\n",
+		        (unsigned long long)st->stream_frames[0], (unsigned long long)st->stream_bytes[0],
+		        (unsigned long long)st->stream_frames[1], (unsigned long long)st->stream_bytes[1],
+		        (unsigned long long)st->stream_frames[2], (unsigned long long)st->stream_bytes[2]);
+	if (seconds > 0)
+		fprintf(stderr, "durée=%.3f s, %.2f Mo/s, %.0f échantillons/s, équivalent %.0f bauds\n",
+		        seconds, st->bytes / seconds / 1e6, st->samples / seconds, st->bytes * 10.0 / seconds);
+}
+
+/**
+  * @brief Mesure de débit de l'analyseur sur un flux synthétique en mémoire
+  *        Flux binaire (trames de 32 échantillons) entrecoupé de lignes texte, découpé en
+  *        morceaux de taille variable pour exercer la reprise en fin de tampon.
+  */
+static int bench (size_t megabytes)
+{
+	size_t size = megabytes * 1000000;
+	uint8_t *buf = malloc(size + FRAME_MAX_SIZE);
+	uint16_t samples[32];
+	size_t n = 0;
+	uint16_t seq = 0;
+	uint32_t unit = 0;
+	AdcStream s;
+	RxContext rx;
+
+	if (!buf)
+		return 1;
+	while (n < size) {
+		if ((++unit & 63) == 0) {
+			n += (size_t)sprintf((char *)buf + n, "ASCII Code: 52 48 57 53, Voltage: 3.30 V\r\n");
+			continue;
+		}
+		for (int i = 0; i < 32; i++)
+			samples[i] = (uint16_t)((seq * 32 + i) & 0xFFF);
+		n += Frame_EncodeSamples(buf + n, seq, seq * 320u, 1, samples, 32);
+		seq++;
+	}
+
+	memset(&rx, 0, sizeof(rx));
+	rx.quiet = 1;
+	adcs_init(&s, on_block, NULL, &rx);
+
+	uint64_t t0 = now_ns();
+	for (size_t off = 0, k = 0; off < n; k++) {
+		size_t chunk = 4096 + (k * 7919) % 60000;   // Morceaux de taille irrégulière
+		if (chunk > n - off)
+			chunk = n - off;
+		adcs_feed(&s, buf + off, chunk);
+		off += chunk;
+	}
+	double dt = (now_ns() - t0) / 1e9;
+
+	print_stats(&s.stats, dt);
+	free(buf);
+	return (s.stats.crc_errors || s.stats.bad_lines) ? 1 : 0;
+}
+
+int main (int argc, char **argv)
+{
+	long baud = 115200;
+	double max_seconds = 0;
+	const char *out_path = NULL, *in_path = NULL, *rates = NULL;
+	static uint8_t buf[READ_CHUNK];
+	static ArqPeer peer;
+	RxContext rx;
+	AdcStream s;
+	int fd, tty, reliable = 0;
+
+	memset(&rx, 0, sizeof(rx));
+	rx.out = stdout;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--bench"))
+			return bench(i + 1 < argc ? (size_t)atol(argv[i + 1]) : 200);
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+			baud = atol(argv[++i]);
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+			rates = argv[++i];
+		else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+			out_path = argv[++i];
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+			max_seconds = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-q"))
+			rx.quiet = 1;
+		else if (!strcmp(argv[i], "-r"))
+			reliable = 1;
+		else
+			in_path = argv[i];
+	}
+	if (!in_path) {
+		fprintf(stderr, "usage: adcrx [-b baud] [-n débit,...] [-o capture.adccap] [-q] [-r] [-t s] <port|fichier|->\n"
+		                "       adcrx --bench [Mo]\n");
+		return 2;
+	}
+
+	fd = strcmp(in_path, "-") ? open(in_path, O_RDWR | O_NOCTTY) : 0;
+	if (fd < 0)
+		fd = open(in_path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "adcrx: %s: %s\n", in_path, strerror(errno));
+		return 1;
+	}
+	tty = isatty(fd);
+	if (tty && setup_tty(fd, baud) != 0) {
+		fprintf(stderr, "adcrx: configuration de %s impossible\n", in_path);
+		return 1;
+	}
+	if (tty && rates)
+		baud = negotiate(fd, baud, rates);
+
+	if (out_path) {
+		if (adccap_create(&rx.cap, out_path) != 0) {
+			fprintf(stderr, "adcrx: %s: %s\n", out_path, strerror(errno));
+			return 1;
+		}
+		rx.capture = 1;
+	}
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	adcs_init(&s, on_block, on_text, &rx);
+	if (reliable) {
+		rx.stream = &s;
+		rx.fd = tty ? fd : -1;      // Fichier : rien à acquitter
+		arqp_init(&peer, on_deliver, on_send, &rx);
+	}
+
+	uint64_t t0 = now_ns(), last_beat = 0;
+	while (!stop) {
+		uint64_t t = now_ns();
+		if (tty && !reliable && t - last_beat >= 1000000000ull) {
+			(void)write(fd, "\n", 1);       // Battement de coeur : hôte présent
+			last_beat = t;
+		}
+		if (max_seconds > 0 && (t - t0) / 1e9 >= max_seconds)
+			break;
+
+		if (tty) {
+			struct pollfd pfd = { fd, POLLIN, 0 };
+			if (poll(&pfd, 1, reliable ? 2 : 200) == 0) {
+				if (reliable)
+					arqp_poll(&peer, now_ns() / 1000000);   // Acquittements différés
+				continue;                   // Rien reçu : continuer à signaler la présence
+			}
+		}
+
+		ssize_t r = read(fd, buf, sizeof(buf));
+		if (r < 0 && errno == EINTR)
+			continue;
+		if (r <= 0)
+			break;
+		rx.arrival_ns = now_ns();
+		if (reliable)
+			arqp_feed(&peer, buf, (size_t)r, rx.arrival_ns / 1000000);
+		else
+			adcs_feed(&s, buf, (size_t)r);
+	}
+
+	print_stats(&s.stats, (now_ns() - t0) / 1e9);
+	if (reliable)
+		fprintf(stderr, "mode fiable : reçues=%llu remises=%llu doublons=%llu perdues=%llu crc=%llu ack=%llu nak=%llu (%llu trames demandées)\n",
+		        (unsigned long long)peer.stats.frames, (unsigned long long)peer.stats.delivered,
+		        (unsigned long long)peer.stats.duplicates, (unsigned long long)peer.stats.lost,
+		        (unsigned long long)peer.rx.crc_errors, (unsigned long long)peer.stats.acks_sent,
+		        (unsigned long long)peer.stats.naks_sent, (unsigned long long)peer.stats.nak_requests);
+	if (rx.capture)
+		adccap_close(&rx.cap);
+	if (fd)
+		close(fd);
+	return 0;
+}
@@ -0,0 +1,178 @@
+#include "arq_peer.h"
+#include <string.h>
+
+#define MASK (ARQ_WINDOW - 1)
+
+/**
+  * @brief Initialiser le pair (réglages par défaut modifiables avant le premier appel)
+  * @param deliver : Trames remises dans l'ordre
+  * @param send : Envoi des acquittements et demandes de retransmission
+  */
+void arqp_init (ArqPeer *p, ArqDeliverFn deliver, ArqSendFn send, void *user)
+{
+	memset(p, 0, sizeof(*p));
+	p->deliver = deliver;
+	p->send = send;
+	p->user = user;
+	p->ack_every = 8;
+	p->ack_delay_ms = 5;
+	p->nak_retry_ms = 50;
+	p->heartbeat_ms = 1000;
+	p->win = ARQ_WINDOW;
+	Frame_RxInit(&p->rx);
+}
+
+// Remettre les trames consécutives à partir de expected
+static void deliver_ready (ArqPeer *p)
+{
+	while (p->have[p->expected & MASK]) {
+		unsigned i = p->expected & MASK;
+		p->deliver(p->user, p->buf[i], p->len[i]);
+		p->stats.delivered++;
+		p->have[i] = 0;
+		p->naked[i] = 0;
+		p->expected++;
+	}
+	if ((uint16_t)(p->top - p->expected) > ARQ_WINDOW)
+		p->top = p->expected;
+}
+
+// Reprendre la réception au numéro to : remettre ce qui attend, compter les trous (estimation
+// après un redémarrage de la carte)
+static void jump (ArqPeer *p, uint16_t to)
+{
+	uint16_t span = (uint16_t)(p->top - p->expected);
+
+	for (uint16_t k = 0; k < span; k++) {
+		unsigned i = p->expected & MASK;
+		if (p->have[i]) {
+			p->deliver(p->user, p->buf[i], p->len[i]);
+			p->stats.delivered++;
+		} else {
+			p->stats.lost++;
+		}
+		p->have[i] = 0;
+		p->naked[i] = 0;
+		p->expected++;
+	}
+	if ((uint16_t)(to - p->expected) < 0x8000)
+		p->stats.lost += (uint16_t)(to - p->expected);   // Jamais reçues
+	memset(p->have, 0, sizeof(p->have));
+	memset(p->naked, 0, sizeof(p->naked));
+	p->expected = p->top = to;
+	p->ack_now = 1;
+}
+
+static void on_frame (ArqPeer *p, const uint8_t *f, size_t n, uint64_t now_ms)
+{
+	uint16_t seq = Frame_GetU16(&f[4]);
+	uint16_t d;
+
+	p->stats.frames++;
+	if (FRAME_TYPE(f[2]) == FRAME_SKIP) {
+		p->stats.skips++;
+		if (p->synced && (uint16_t)(seq - p->expected) < 0x8000 && seq != p->expected)
+			jump(p, seq);
+		else if (!p->synced) {
+			p->synced = 1;
+			p->expected = p->top = seq;
+		}
+		p->ack_now = 1;
+		return;
+	}
+	if (!p->synced) {
+		p->synced = 1;
+		p->expected = p->top = seq;
+	}
+
+	d = (uint16_t)(seq - p->expected);
+	if (d >= ARQ_WINDOW) {
+		if ((uint16_t)(p->expected - seq) <= ARQ_WINDOW) {
+			p->stats.duplicates++;      // Déjà remise : l'acquittement s'est perdu
+			p->ack_now = 1;
+			return;
+		}
+		p->stats.resyncs++;
+		jump(p, seq);
+		d = 0;
+	}
+
+	unsigned i = seq & MASK;
+	if (p->have[i]) {
+		p->stats.duplicates++;
+		p->ack_now = 1;
+		return;
+	}
+	memcpy(p->buf[i], f, n);
+	p->len[i] = (uint16_t)n;
+	p->have[i] = 1;
+	if (d >= (uint16_t)(p->top - p->expected))
+		p->top = (uint16_t)(seq + 1);
+	if (d)
+		p->stats.held++;
+	if (!p->unacked++)
+		p->first_unacked_ms = now_ms;
+	deliver_ready(p);
+}
+
+static void send_ack (ArqPeer *p, uint64_t now_ms)
+{
+	uint8_t pl[FRAME_ACK_SIZE], out[FRAME_HDR_SIZE + FRAME_ACK_SIZE + FRAME_CRC_SIZE];
+	uint32_t sack = 0;
+
+	for (unsigned i = 0; i < 32 && i + 1 < ARQ_WINDOW; i++)
+		if (p->have[(p->expected + 1 + i) & MASK])
+			sack |= 1u << i;
+	Frame_PutU16(&pl[0], p->expected);
+	Frame_PutU32(&pl[2], sack);
+	pl[6] = p->win;
+	p->send(p->user, out, Frame_Encode(out, FRAME_ACK, 0, pl, FRAME_ACK_SIZE));
+	p->stats.acks_sent++;
+	p->unacked = 0;
+	p->ack_now = 0;
+	p->last_ack_ms = now_ms;
+}
+
+/**
+  * @brief Envoyer les acquittements et demandes de retransmission dus
+  *        Appelé par arqp_feed() ; à appeler aussi périodiquement quand rien n'est reçu.
+  */
+void arqp_poll (ArqPeer *p, uint64_t now_ms)
+{
+	uint8_t pl[2 * FRAME_NAK_MAX], out[FRAME_HDR_SIZE + 2 * FRAME_NAK_MAX + FRAME_CRC_SIZE];
+	unsigned n = 0;
+
+	// Trous entre la prochaine trame à remettre et la plus haute reçue
+	for (uint16_t seq = p->expected; seq != p->top && n < FRAME_NAK_MAX; seq++) {
+		unsigned i = seq & MASK;
+		if (p->have[i] || (p->naked[i] && now_ms - p->nak_ms[i] < p->nak_retry_ms))
+			continue;
+		Frame_PutU16(&pl[2 * n++], seq);
+		p->naked[i] = 1;
+		p->nak_ms[i] = now_ms;
+	}
+	if (n) {
+		p->send(p->user, out, Frame_Encode(out, FRAME_NAK, 0, pl, (uint8_t)(2 * n)));
+		p->stats.naks_sent++;
+		p->stats.nak_requests += n;
+	}
+
+	if (p->ack_now || n || p->unacked >= p->ack_every ||
+	    (p->unacked && now_ms - p->first_unacked_ms >= p->ack_delay_ms) ||
+	    now_ms - p->last_ack_ms >= p->heartbeat_ms)
+		send_ack(p, now_ms);
+}
+
+/**
+  * @brief Traiter des octets reçus de la carte
+  * @param now_ms : Heure de réception (ms, base quelconque mais croissante)
+  */
+void arqp_feed (ArqPeer *p, const uint8_t *data, size_t length, uint64_t now_ms)
+{
+	for (size_t k = 0; k < length; k++) {
+		uint32_t n = Frame_RxByte(&p->rx, data[k]);
+		if (n)
+			on_frame(p, p->rx.buf, n, now_ms);
+	}
+	arqp_poll(p, now_ms);
+}
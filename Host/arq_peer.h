@@ -0,0 +1,68 @@
+#ifndef ARQ_PEER_H
+#define ARQ_PEER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../ADC-UART/Arq.h"
+
+/**
+  * @brief Pair de référence du mode fiable de la carte (ADC-UART/Arq.h), côté hôte
+  *        Les trames reçues sont remises dans l'ordre des numéros de séquence, sans doublon ;
+  *        une trame arrivée après un trou attend dans un tampon de ARQ_WINDOW trames. Un trou
+  *        est demandé aussitôt (FRAME_NAK, la liaison série ne déséquence pas) puis de nouveau
+  *        toutes les nak_retry_ms ; les acquittements (FRAME_ACK) partent toutes les ack_every
+  *        trames, ack_delay_ms après une trame non acquittée, et au moins toutes les
+  *        heartbeat_ms (présence de l'hôte, voir HostLink.c).
+  *        FRAME_SKIP ou un numéro hors de toute fenêtre (redémarrage de la carte) : les trames
+  *        en attente sont remises, les trous comptés perdus, et la réception reprend au numéro
+  *        reçu.
+  */
+
+// Trame remise dans l'ordre (trame complète, en-tête et CRC compris)
+typedef void (*ArqDeliverFn)(void *user, const uint8_t *frame, size_t length);
+// Trame de contrôle à envoyer à la carte
+typedef void (*ArqSendFn)(void *user, const uint8_t *frame, size_t length);
+
+typedef struct {
+	uint64_t frames;          // Trames valides reçues, doublons compris
+	uint64_t delivered;       // Trames remises
+	uint64_t duplicates;
+	uint64_t held;            // Trames reçues après un trou (mises en attente)
+	uint64_t lost;            // Trames jamais reçues (abandonnées par la carte, resynchronisation)
+	uint64_t skips;           // Trames FRAME_SKIP reçues
+	uint64_t resyncs;         // Numéros hors fenêtre
+	uint64_t acks_sent;
+	uint64_t naks_sent;       // Trames FRAME_NAK envoyées
+	uint64_t nak_requests;    // Numéros demandés
+} ArqPeerStats;
+
+typedef struct {
+	ArqDeliverFn deliver;
+	ArqSendFn    send;
+	void        *user;
+	unsigned     ack_every;
+	unsigned     ack_delay_ms;
+	unsigned     nak_retry_ms;
+	unsigned     heartbeat_ms;
+	uint8_t      win;             // Fenêtre annoncée (ARQ_WINDOW au plus)
+	ArqPeerStats stats;
+	/* état interne */
+	Frame_Rx     rx;
+	int          synced;
+	uint16_t     expected;        // Prochaine trame à remettre
+	uint16_t     top;             // Un au-delà de la plus haute trame reçue
+	unsigned     unacked;
+	int          ack_now;
+	uint64_t     first_unacked_ms, last_ack_ms;
+	uint8_t      have[ARQ_WINDOW];
+	uint8_t      naked[ARQ_WINDOW];
+	uint64_t     nak_ms[ARQ_WINDOW];
+	uint16_t     len[ARQ_WINDOW];
+	uint8_t      buf[ARQ_WINDOW][FRAME_MAX_SIZE];
+} ArqPeer;
+
+void arqp_init(ArqPeer *p, ArqDeliverFn deliver, ArqSendFn send, void *user);
+void arqp_feed(ArqPeer *p, const uint8_t *data, size_t length, uint64_t now_ms);
+void arqp_poll(ArqPeer *p, uint64_t now_ms);
+
+#endif /* ARQ_PEER_H */
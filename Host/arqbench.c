@@ -0,0 +1,305 @@
+/**
+  * @brief  arqbench : validation du mode fiable de la carte (ADC-UART/Arq.c) face au pair de
+  *         référence (arq_peer.c) sur une liaison série simulée avec pertes
+  *
+  *   Compilation :
+  *      gcc -O2 -o arqbench arqbench.c arq_peer.c ../ADC-UART/Arq.c ../ADC-UART/Frame.c ../ADC-UART/CRC16.c ../ADC-UART/Pack.c -lm
+  *
+  *   Utilisation :
+  *      arqbench [-t secondes] [-v]
+  *
+  *   La liaison est simulée octet par octet dans chaque sens : sérialisation au débit de la
+  *   ligne (10 bits par octet), latence de l'adaptateur USB, erreurs binaires indépendantes
+  *   (un bit inversé dans l'octet touché). La carte émet dès que la ligne est libre : une
+  *   réémission (Arq_Resend) d'abord, sinon une trame nouvelle si la fenêtre le permet
+  *   (Arq_CanSend) ; chaque octet reçu de l'hôte passe par Arq_Input. L'hôte lit ce qui est
+  *   arrivé toutes les millisecondes (arqp_feed, arqp_poll) et renvoie ses acquittements
+  *   sur la voie de retour, elle aussi bruitée.
+  *   Chaque trame porte son rang (32 bits) et un motif qui en dépend : les trames remises
+  *   doivent être intactes, dans l'ordre, sans doublon, et tout saut de rang doit être compté
+  *   perdu par le pair. Sans coupure, aucune perte n'est admise et le débit utile doit
+  *   approcher la limite (1 - taux de trames erronées) x débit de la ligne x données/trame.
+  *   Le cas « hôte muet » coupe l'hôte plusieurs secondes : la carte doit abandonner ses
+  *   trames en attente, continuer sans garantie puis reprendre le mode fiable au retour.
+  *   Le code de retour vaut 1 en cas d'écart.
+  */
+#include "arq_peer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_POLL_NS  1000000ull      // Lecture de l'hôte toutes les millisecondes
+#define PIPE_SIZE     (1u << 20)      // Octets en route dans un sens (puissance de 2)
+
+typedef struct {
+	const char *name;
+	long     baud;
+	double   ber;                  // Taux d'erreurs binaires (les deux sens)
+	unsigned latency_us;           // Latence de l'adaptateur USB (chaque sens)
+	unsigned payload;              // Octets de données par trame
+	double   outage_s;             // Hôte muet pendant outage_s à partir de la 2e seconde
+	double   min_eff;              // Débit utile minimal, en fraction de la limite
+} Case;
+
+static const Case cases[] = {
+	{ "115200, sans erreur",      115200, 0,    1000,  200, 0, 0.97 },
+	{ "115200, BER 1e-5",         115200, 1e-5, 1000,  200, 0, 0.95 },
+	{ "115200, BER 1e-4",         115200, 1e-4, 1000,  200, 0, 0.90 },
+	{ "115200, BER 3e-4",         115200, 3e-4, 1000,  200, 0, 0.85 },
+	{ "921600, BER 1e-5",         921600, 1e-5, 1000,  200, 0, 0.95 },
+	{ "921600, BER 1e-4, 16 ms",  921600, 1e-4, 16000, 200, 0, 0.75 },
+	{ "2 Mbaud, BER 1e-5, 4 ms", 2000000, 1e-5, 4000,  200, 0, 0.90 },
+	{ "2 Mbaud, 16 ms (fenêtre)", 2000000, 1e-5, 16000, 200, 0, 0.40 },
+	{ "921600, petites trames",   921600, 1e-4, 1000,   32, 0, 0.90 },
+	{ "hôte muet 5 s",            921600, 1e-5, 1000,  200, 5, 0    },
+};
+
+static uint32_t rng = 2024;
+
+static double uni (void)
+{
+	rng = rng * 1664525u + 1013904223u;
+	return (rng >> 8) / 16777216.0;
+}
+
+// Un sens de la liaison : octets en route avec leur heure d'arrivée
+typedef struct {
+	uint8_t  *b;
+	uint64_t *t;
+	uint32_t head, tail;
+	uint64_t free_ns;              // Fin de la sérialisation en cours
+} Pipe;
+
+static void pipe_init (Pipe *p)
+{
+	p->b = malloc(PIPE_SIZE);
+	p->t = malloc(PIPE_SIZE * sizeof(uint64_t));
+	p->head = p->tail = 0;
+	p->free_ns = 0;
+	if (!p->b || !p->t) {
+		fprintf(stderr, "mémoire insuffisante\n");
+		exit(2);
+	}
+}
+
+static void pipe_free (Pipe *p)
+{
+	free(p->b);
+	free(p->t);
+}
+
+static double p_byte;              // Probabilité qu'un octet soit touché
+
+// Sérialiser un octet à partir de now_ns ; rend 1 si l'octet a été altéré
+static int pipe_send (Pipe *p, uint8_t c, uint64_t now_ns, uint64_t byte_ns, uint64_t latency_ns)
+{
+	int hit = p_byte > 0 && uni() < p_byte;
+
+	if (hit)
+		c ^= (uint8_t)(1u << (int)(uni() * 8));
+	if (p->free_ns < now_ns)
+		p->free_ns = now_ns;
+	p->free_ns += byte_ns;
+	if (p->head - p->tail == PIPE_SIZE) {
+		fprintf(stderr, "liaison saturée\n");
+		exit(2);
+	}
+	p->b[p->head & (PIPE_SIZE - 1)] = c;
+	p->t[p->head & (PIPE_SIZE - 1)] = p->free_ns + latency_ns;
+	p->head++;
+	return hit;
+}
+
+static int pipe_get (Pipe *p, uint64_t now_ns, uint8_t *c)
+{
+	if (p->head == p->tail || p->t[p->tail & (PIPE_SIZE - 1)] > now_ns)
+		return 0;
+	*c = p->b[p->tail & (PIPE_SIZE - 1)];
+	p->tail++;
+	return 1;
+}
+
+typedef struct {
+	ArqPeer  peer;
+	Pipe     up;                   // Carte -> hôte
+	Pipe     down;                 // Hôte -> carte
+	uint64_t now_ns, byte_ns, latency_ns;
+	unsigned payload;
+	int      started;
+	uint32_t last_rank;
+	uint64_t last_lost;
+	uint64_t bytes;                // Données remises
+	uint64_t bad_payload, out_of_order, miscounted;
+	uint64_t after_outage;         // Trames remises après la coupure
+	int      outage_over;
+} Bench;
+
+static void fill (uint8_t *p, uint32_t rank, unsigned n)
+{
+	Frame_PutU32(p, rank);
+	for (unsigned i = 4; i < n; i++)
+		p[i] = (uint8_t)(rank * 131u + i * 7u);
+}
+
+static void deliver (void *user, const uint8_t *frame, size_t length)
+{
+	Bench *b = user;
+	uint8_t ref[FRAME_MAX_PAYLOAD];
+	uint32_t rank;
+
+	if (FRAME_TYPE(frame[2]) != FRAME_SAMPLES || length != FRAME_HDR_SIZE + b->payload + FRAME_CRC_SIZE) {
+		b->bad_payload++;
+		return;
+	}
+	rank = Frame_GetU32(&frame[FRAME_HDR_SIZE]);
+	fill(ref, rank, b->payload);
+	if (memcmp(ref, &frame[FRAME_HDR_SIZE], b->payload))
+		b->bad_payload++;
+	if (b->started) {
+		if ((int32_t)(rank - b->last_rank) <= 0)
+			b->out_of_order++;
+		else if (rank - b->last_rank - 1 != b->peer.stats.lost - b->last_lost)
+			b->miscounted++;
+	}
+	b->started = 1;
+	b->last_rank = rank;
+	b->last_lost = b->peer.stats.lost;
+	b->bytes += b->payload;
+	b->after_outage += b->outage_over;
+}
+
+static void send_down (void *user, const uint8_t *frame, size_t length)
+{
+	Bench *b = user;
+
+	for (size_t k = 0; k < length; k++)
+		pipe_send(&b->down, frame[k], b->now_ns, b->byte_ns, b->latency_ns);
+}
+
+static int run (const Case *c, double seconds, int verbose)
+{
+	static Bench b;
+	static Arq a;
+	uint8_t tx[FRAME_MAX_SIZE], pl[FRAME_MAX_PAYLOAD], chunk[65536];
+	uint32_t tx_len = 0, tx_pos = 0, rank = 0;
+	uint16_t seq = 0xFFC0;            // Passage par 0 en début d'essai
+	int tx_hit = 0;
+	uint64_t corrupted = 0, end_ns, off_ns, on_ns, next_poll = 0;
+	double frame_bytes, fer, limit, goodput, eff;
+	int ok;
+
+	memset(&b, 0, sizeof(b));
+	pipe_init(&b.up);
+	pipe_init(&b.down);
+	b.byte_ns = (uint64_t)(1e10 / c->baud);
+	b.latency_ns = c->latency_us * 1000ull;
+	b.payload = c->payload;
+	p_byte = 1 - pow(1 - c->ber, 8);
+	arqp_init(&b.peer, deliver, send_down, &b);
+	Arq_Init(&a, seq, 0);
+
+	if (c->outage_s > 0 && seconds < c->outage_s + 8)
+		seconds = c->outage_s + 8;      // Abandon, reprise et régime établi après la coupure
+	end_ns = (uint64_t)(seconds * 1e9);
+	off_ns = c->outage_s > 0 ? 2000000000ull : end_ns;
+	on_ns = off_ns + (uint64_t)(c->outage_s * 1e9);
+
+	for (b.now_ns = 0; b.now_ns < end_ns; b.now_ns += b.byte_ns) {
+		uint32_t now_ms = (uint32_t)(b.now_ns / 1000000);
+		uint8_t ch;
+
+		// Carte : réception puis émission d'un octet (Mux_Poll)
+		while (pipe_get(&b.down, b.now_ns, &ch))
+			Arq_Input(&a, ch, now_ms);
+		if (tx_pos == tx_len) {
+			if (tx_len && tx_hit)
+				corrupted++;
+			tx_pos = tx_len = 0;
+			tx_hit = 0;
+			tx_len = Arq_Resend(&a, now_ms, tx);
+			if (!tx_len && Arq_CanSend(&a, now_ms)) {
+				fill(pl, rank++, c->payload);
+				tx_len = Frame_Encode(tx, FRAME_SAMPLES, seq++, pl, (uint8_t)c->payload);
+				Arq_Sent(&a, tx, tx_len, now_ms);
+			}
+		}
+		if (tx_pos < tx_len)
+			tx_hit |= pipe_send(&b.up, tx[tx_pos++], b.now_ns, b.byte_ns, b.latency_ns);
+
+		// Hôte : lecture par blocs
+		if (b.now_ns >= next_poll) {
+			uint32_t n = 0;
+			int mute = b.now_ns >= off_ns && b.now_ns < on_ns;
+
+			next_poll += HOST_POLL_NS;
+			while (n < sizeof(chunk) && pipe_get(&b.up, b.now_ns, &chunk[n]))
+				n++;
+			if (mute)
+				continue;
+			b.outage_over = c->outage_s > 0 && b.now_ns >= on_ns;
+			if (n)
+				arqp_feed(&b.peer, chunk, n, now_ms);
+			else
+				arqp_poll(&b.peer, now_ms);
+		}
+	}
+
+	frame_bytes = FRAME_HDR_SIZE + c->payload + FRAME_CRC_SIZE;
+	fer = 1 - pow(1 - p_byte, frame_bytes);
+	limit = c->baud / 10.0 * c->payload / frame_bytes * (1 - fer);
+	goodput = b.bytes / seconds;
+	eff = goodput / limit;
+
+	ok = b.bad_payload == 0 && b.out_of_order == 0 && b.miscounted == 0 && eff >= c->min_eff;
+	if (c->outage_s > 0)
+		ok = ok && a.c.abandoned > 0 && b.peer.stats.lost > 0 && a.peer_up && b.after_outage > 0;
+	else
+		ok = ok && b.peer.stats.lost == 0 && a.c.abandoned == 0 && b.peer.stats.resyncs == 0;
+
+	if (verbose) {
+		char line[256];
+		Arq_Format(&a, line, sizeof(line));
+		fputs(line, stdout);
+		printf("  pair : reçues=%llu remises=%llu doublons=%llu attente=%llu perdues=%llu skip=%llu resync=%llu ack=%llu nak=%llu (%llu numéros)\n",
+		       (unsigned long long)b.peer.stats.frames, (unsigned long long)b.peer.stats.delivered,
+		       (unsigned long long)b.peer.stats.duplicates, (unsigned long long)b.peer.stats.held,
+		       (unsigned long long)b.peer.stats.lost, (unsigned long long)b.peer.stats.skips,
+		       (unsigned long long)b.peer.stats.resyncs, (unsigned long long)b.peer.stats.acks_sent,
+		       (unsigned long long)b.peer.stats.naks_sent, (unsigned long long)b.peer.stats.nak_requests);
+	}
+	printf("%-26s %6.1f%% %8lu %8llu %8lu %8lu %8llu %7lu %6.0f %6.0f %5.1f%%  %s\n", c->name,
+	       fer * 100, (unsigned long)a.c.frames, (unsigned long long)corrupted,
+	       (unsigned long)a.c.retransmits, (unsigned long)a.c.timeouts,
+	       (unsigned long long)b.peer.stats.lost, (unsigned long)a.c.stalls,
+	       limit / 1000, goodput / 1000, eff * 100, ok ? "ok" : "ÉCART");
+	pipe_free(&b.up);
+	pipe_free(&b.down);
+	return ok;
+}
+
+int main (int argc, char **argv)
+{
+	double seconds = 12;
+	int verbose = 0, fails = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-t") && i + 1 < argc)
+			seconds = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-v"))
+			verbose = 1;
+		else {
+			fprintf(stderr, "usage: arqbench [-t secondes] [-v]\n");
+			return 2;
+		}
+	}
+	if (seconds < 1)
+		seconds = 1;
+
+	printf("%-26s %7s %8s %8s %8s %8s %8s %7s %6s %6s %6s\n", "cas", "FER", "trames", "altérées",
+	       "réémis.", "délai", "perdues", "pleine", "ko/s*", "ko/s", "effic.");
+	for (unsigned k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+		fails += !run(&cases[k], seconds, verbose);
+	printf("* limite : débit de la ligne x données/trame x (1 - FER)\n");
+	return fails != 0;
+}
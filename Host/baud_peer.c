@@ -0,0 +1,241 @@
+#include "baud_peer.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+	const BaudLink *l;
+	Frame_Rx rx;
+	size_t   pos, len;
+	uint8_t  buf[4096];
+} Reader;
+
+/**
+  * @brief Réglages par défaut
+  */
+void baudp_defaults (BaudOptions *o)
+{
+	o->test_len = BAUDNEG_TEST_LEN;
+	o->settle_ms = 20;
+	o->answer_ms = 300;
+	o->commit_tries = 3;
+}
+
+const char *baudp_status (BaudStatus s)
+{
+	static const char *names[] = {
+		"vérifié", "refusé par la carte", "sans réponse", "refusé par l'adaptateur",
+		"motif de la carte absent", "erreurs", "confirmation sans réponse"
+	};
+	return (unsigned)s < sizeof(names) / sizeof(names[0]) ? names[s] : "?";
+}
+
+// Durée d'émission de n octets (10 bits par octet), arrondie au-dessus
+static unsigned bytes_ms (unsigned n, long baud)
+{
+	return (unsigned)(((uint64_t)n * 10000 + baud - 1) / baud);
+}
+
+// Octet suivant, -1 si rien avant l'échéance
+static int next_byte (Reader *r, uint64_t deadline)
+{
+	while (r->pos == r->len) {
+		uint64_t now = r->l->now_ms(r->l->user);
+		long n;
+
+		if (now >= deadline)
+			return -1;
+		n = r->l->read(r->l->user, r->buf, sizeof(r->buf), (int)(deadline - now));
+		if (n < 0)
+			return -1;
+		r->pos = 0;
+		r->len = (size_t)n;
+	}
+	return r->buf[r->pos++];
+}
+
+// Oublier les octets reçus (changement de débit, nouvelle phase)
+static void reset (Reader *r)
+{
+	r->pos = r->len = 0;
+	Frame_RxInit(&r->rx);
+}
+
+// Laisser passer le temps en ignorant ce qui arrive
+static void pause (Reader *r, unsigned ms)
+{
+	uint64_t deadline = r->l->now_ms(r->l->user) + ms;
+
+	while (next_byte(r, deadline) >= 0)
+		;
+}
+
+static void send_msg (Reader *r, uint8_t op, long baud, uint16_t test_len)
+{
+	uint8_t p[BAUDNEG_PROPOSE_SIZE], out[FRAME_HDR_SIZE + BAUDNEG_PROPOSE_SIZE + FRAME_CRC_SIZE];
+	uint8_t length = op == BAUDNEG_PROPOSE ? BAUDNEG_PROPOSE_SIZE : BAUDNEG_SHORT_SIZE;
+
+	p[0] = op;
+	Frame_PutU32(&p[1], (uint32_t)baud);
+	Frame_PutU16(&p[5], test_len);
+	r->l->write(r->l->user, out, Frame_Encode(out, FRAME_BAUD, 0, p, length));
+}
+
+// Attendre la réponse op (ou BAUDNEG_REJECT pour BAUDNEG_ACCEPT) au sujet de baud
+static const uint8_t *wait_reply (Reader *r, uint8_t op, long baud, unsigned timeout_ms)
+{
+	uint64_t deadline = r->l->now_ms(r->l->user) + timeout_ms;
+	int c;
+
+	while ((c = next_byte(r, deadline)) >= 0) {
+		const uint8_t *p = &r->rx.buf[FRAME_HDR_SIZE];
+		if (Frame_RxByte(&r->rx, (uint8_t)c) && FRAME_TYPE(r->rx.buf[2]) == FRAME_BAUD &&
+		    r->rx.buf[3] >= BAUDNEG_SHORT_SIZE && Frame_GetU32(&p[1]) == (uint32_t)baud &&
+		    (p[0] == op || (op == BAUDNEG_ACCEPT && p[0] == BAUDNEG_REJECT)))
+			return p;
+	}
+	return NULL;
+}
+
+// Motif de la carte (marqueur puis len octets) : octets faux ou manquants
+static void read_pattern (Reader *r, unsigned len, unsigned timeout_ms, BaudTrial *t)
+{
+	uint64_t deadline = r->l->now_ms(r->l->user) + timeout_ms;
+	unsigned mark = 0, i = 0;
+	int c;
+
+	while (i < len && (c = next_byte(r, deadline)) >= 0) {
+		if (mark < 2) {
+			if (c == (mark ? BAUDNEG_MARK1 : BAUDNEG_MARK0))
+				mark++;
+			else
+				mark = (c == BAUDNEG_MARK0);
+			continue;
+		}
+		if ((uint8_t)c != BaudNeg_Pattern(i))
+			t->host_errors++;
+		i++;
+	}
+	t->host_received = i;
+	t->host_errors += len - i;
+	Frame_RxInit(&r->rx);
+}
+
+static BaudStatus trial (Reader *r, const BaudOptions *o, long good, long rate, BaudTrial *t)
+{
+	const BaudLink *l = r->l;
+	unsigned len = o->test_len > BAUDNEG_TEST_MAX ? BAUDNEG_TEST_MAX : o->test_len ? o->test_len : BAUDNEG_TEST_LEN;
+	unsigned pattern_ms = bytes_ms(len + 32, rate);
+	const uint8_t *p = NULL;
+	uint8_t *test;
+	BaudStatus status;
+
+	// 1. Proposition au débit vérifié ; renouvelée après le délai de la carte, au cas où un
+	//    essai précédent serait encore en cours de son côté
+	for (int k = 0; k < 2 && !p; k++) {
+		if (k)
+			pause(r, BAUDNEG_TIMEOUT_MS + pattern_ms);
+		reset(r);
+		send_msg(r, BAUDNEG_PROPOSE, rate, (uint16_t)len);
+		p = wait_reply(r, BAUDNEG_ACCEPT, rate, o->answer_ms + bytes_ms(2 * FRAME_MAX_SIZE, good));
+	}
+	if (!p)
+		return BAUDP_NO_ANSWER;
+	t->actual = Frame_GetU32(&p[5]);
+	t->error_ppm = (int32_t)Frame_GetU32(&p[9]);
+	t->brr = Frame_GetU16(&p[13]);
+	t->over8 = p[15];
+	if (p[0] == BAUDNEG_REJECT)
+		return BAUDP_REJECTED;
+
+	// 2. Passage au débit proposé (la carte y est déjà) et motif de l'hôte
+	if (l->set_baud(l->user, rate) != 0)
+		return BAUDP_HOST_REFUSED;         // La carte revient seule faute de motif
+	pause(r, o->settle_ms);
+	reset(r);
+	test = malloc(len + 2);
+	test[0] = BAUDNEG_MARK0;
+	test[1] = BAUDNEG_MARK1;
+	for (unsigned i = 0; i < len; i++)
+		test[2 + i] = BaudNeg_Pattern(i);
+	l->write(l->user, test, len + 2);
+	free(test);
+
+	// 3. Compte rendu de la carte suivi de son motif
+	p = wait_reply(r, BAUDNEG_RESULT, rate, BAUDNEG_TIMEOUT_MS + pattern_ms);
+	if (!p) {
+		status = BAUDP_NO_RESULT;
+		send_msg(r, BAUDNEG_REVERT, rate, 0);
+		goto revert;
+	}
+	t->board_received = Frame_GetU16(&p[5]);
+	t->board_errors = Frame_GetU16(&p[7]);
+	t->line_errors = Frame_GetU16(&p[9]);
+	read_pattern(r, len, 2 * pattern_ms + o->answer_ms, t);
+	if (t->board_received != len || t->board_errors || t->line_errors || t->host_errors) {
+		status = BAUDP_ERRORS;
+		send_msg(r, BAUDNEG_REVERT, rate, 0);
+		goto revert;
+	}
+
+	// 4. Confirmation ; sans réponse, une dernière fois après le délai de la carte : elle
+	//    répond encore si seule sa réponse s'est perdue
+	for (unsigned k = 0; k < o->commit_tries; k++) {
+		send_msg(r, BAUDNEG_COMMIT, rate, 0);
+		if (wait_reply(r, BAUDNEG_DONE, rate, o->answer_ms))
+			return BAUDP_VERIFIED;
+	}
+	pause(r, BAUDNEG_TIMEOUT_MS + pattern_ms);
+	send_msg(r, BAUDNEG_COMMIT, rate, 0);
+	if (wait_reply(r, BAUDNEG_DONE, rate, o->answer_ms))
+		return BAUDP_VERIFIED;
+	status = BAUDP_NO_DONE;
+
+revert:
+	l->set_baud(l->user, good);
+	pause(r, o->settle_ms);
+	return status;
+}
+
+static int by_rate_desc (const void *a, const void *b)
+{
+	long x = *(const long *)a, y = *(const long *)b;
+	return (x < y) - (x > y);
+}
+
+/**
+  * @brief Négocier le débit le plus élevé vérifié parmi les candidats
+  *        L'adaptateur doit être au débit current, celui de la carte.
+  * @param rates : Candidats (ordre quelconque) ; ceux qui ne dépassent pas current sont ignorés
+  * @param trials : Compte rendu de chaque essai (count places)
+  * @param tried : Nombre d'essais
+  * @retval Débit final, appliqué des deux côtés (current si aucun candidat n'est vérifié)
+  */
+long baudp_negotiate (const BaudLink *l, const BaudOptions *o, long current, const long *rates,
+                      int count, BaudTrial *trials, int *tried)
+{
+	Reader *r = calloc(1, sizeof(*r));
+	long *sorted = malloc(sizeof(long) * (count > 0 ? count : 1));
+	long good = current;
+	int n = 0;
+
+	r->l = l;
+	memcpy(sorted, rates, sizeof(long) * count);
+	qsort(sorted, count, sizeof(long), by_rate_desc);
+	for (int i = 0; i < count && sorted[i] > good; i++) {
+		BaudTrial *t = &trials[n++];
+		uint64_t t0 = l->now_ms(l->user);
+
+		memset(t, 0, sizeof(*t));
+		t->baud = sorted[i];
+		t->status = trial(r, o, good, sorted[i], t);
+		t->seconds = (l->now_ms(l->user) - t0) / 1e3;
+		if (t->status == BAUDP_VERIFIED) {
+			good = sorted[i];
+			break;
+		}
+	}
+	*tried = n;
+	free(sorted);
+	free(r);
+	return good;
+}
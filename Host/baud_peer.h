@@ -0,0 +1,65 @@
+#ifndef BAUD_PEER_H
+#define BAUD_PEER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../ADC-UART/BaudNeg.h"
+
+/**
+  * @brief Négociateur du débit côté hôte (pendant de ADC-UART/BaudNeg.h)
+  *        Les candidats sont proposés du plus rapide au plus lent ; le premier vérifié dans
+  *        les deux sens (motif de test sans erreur, aucune erreur de ligne côté carte) est
+  *        gardé. Un candidat refusé, sans réponse ou avec erreurs ramène les deux côtés au
+  *        dernier débit vérifié avant le suivant. Les trames de données reçues pendant la
+  *        négociation sont ignorées.
+  *        Les accès au port passent par BaudLink : terminal (adcrx -n) ou liaison simulée
+  *        (baudbench).
+  */
+
+typedef struct {
+	int      (*set_baud)(void *user, long baud);                          // 0 si accepté
+	int      (*write)(void *user, const uint8_t *data, size_t length);    // Retour une fois émis
+	long     (*read)(void *user, uint8_t *buf, size_t size, int timeout_ms);  // 0 : délai écoulé
+	uint64_t (*now_ms)(void *user);
+	void      *user;
+} BaudLink;
+
+// Issue d'un essai
+typedef enum {
+	BAUDP_VERIFIED = 0,
+	BAUDP_REJECTED,                // Hors d'atteinte pour la carte
+	BAUDP_NO_ANSWER,               // Pas de réponse à la proposition
+	BAUDP_HOST_REFUSED,            // Débit refusé par l'adaptateur de l'hôte
+	BAUDP_NO_RESULT,               // Motif de la carte jamais reçu
+	BAUDP_ERRORS,                  // Erreurs dans au moins un sens
+	BAUDP_NO_DONE                  // Confirmation sans réponse
+} BaudStatus;
+
+typedef struct {
+	long       baud;
+	BaudStatus status;
+	uint32_t   actual;             // Réglage calculé par la carte
+	int32_t    error_ppm;
+	uint16_t   brr;
+	uint8_t    over8;
+	unsigned   board_received;     // Motif de l'hôte vu par la carte
+	unsigned   board_errors;
+	unsigned   line_errors;        // Bruit, trame, débordement côté carte
+	unsigned   host_received;      // Motif de la carte vu par l'hôte
+	unsigned   host_errors;
+	double     seconds;
+} BaudTrial;
+
+typedef struct {
+	unsigned test_len;             // Octets du motif (BAUDNEG_TEST_MAX au plus)
+	unsigned settle_ms;            // Attente après un changement de débit de l'adaptateur
+	unsigned answer_ms;            // Attente d'une réponse de la carte
+	unsigned commit_tries;
+} BaudOptions;
+
+void baudp_defaults(BaudOptions *o);
+long baudp_negotiate(const BaudLink *l, const BaudOptions *o, long current, const long *rates,
+                     int count, BaudTrial *trials, int *tried);
+const char *baudp_status(BaudStatus s);
+
+#endif /* BAUD_PEER_H */
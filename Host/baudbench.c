@@ -0,0 +1,402 @@
+/**
+  * @brief  baudbench : validation de la négociation du débit de la carte (ADC-UART/BaudNeg.c)
+  *         face au négociateur de l'hôte (baud_peer.c) sur une liaison série simulée
+  *
+  *   Compilation :
+  *      gcc -O2 -o baudbench baudbench.c baud_peer.c ../ADC-UART/BaudNeg.c ../ADC-UART/Frame.c ../ADC-UART/CRC16.c ../ADC-UART/Pack.c
+  *
+  *   Utilisation :
+  *      baudbench [-v]
+  *
+  *   La liaison est simulée octet par octet dans chaque sens : sérialisation au débit de
+  *   l'émetteur (10 bits par octet), latence de l'adaptateur USB. Un octet reçu à un débit
+  *   écarté de plus de 3 % de celui de l'émetteur arrive faux et compte en erreur de ligne
+  *   côté carte ; au-delà du débit propre de l'adaptateur, des bits sont inversés au hasard.
+  *   La carte calcule BRR et OVER8 comme UART_ComputeBaud() pour l'USART2 (PCLK1 = 42 MHz,
+  *   5,25 Mbauds au plus) et émet des trames de texte toutes les 5 ms, comme le flux réel.
+  *   Chaque cas vérifie le débit final des deux côtés ; ceux qui perdent des confirmations,
+  *   coupent l'hôte ou renégocient vérifient le retour au dernier débit vérifié.
+  *   Le code de retour vaut 1 en cas d'écart.
+  */
+#include "baud_peer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PIPE_SIZE     (1u << 20)      // Octets en route dans un sens (puissance de 2)
+#define LATENCY_NS    1000000ull      // Adaptateur USB, chaque sens
+#define PCLK1         42000000u
+#define BASE_BAUD     115200
+#define MAX_CANDIDATES 8
+
+typedef struct {
+	uint64_t t;                    // Arrivée
+	uint32_t baud;                 // Débit de l'émetteur
+	uint8_t  c;
+} Byte;
+
+typedef struct {
+	Byte    *q;
+	uint32_t head, tail;
+	uint64_t line_free;
+} Pipe;
+
+typedef enum { AFTER_NONE, AFTER_SILENCE, AFTER_HEARTBEAT, AFTER_RENEGOTIATE } After;
+
+typedef struct {
+	const char *name;
+	long     rates[MAX_CANDIDATES];
+	long     clean_max;            // Débit propre de l'adaptateur
+	double   ber;                  // Au-delà
+	int      any_rate;             // Adaptateur à débit quelconque (sinon débits standard)
+	unsigned test_len;
+	unsigned drop_commits;         // Confirmations de l'hôte perdues
+	unsigned drop_dones;           // Réponses BAUDNEG_DONE perdues
+	long     expect;
+	After    after;                // Suite du cas (AFTER_NONE : aucune)
+	long     after_rates[MAX_CANDIDATES];
+	long     expect_after;
+} Case;
+
+typedef struct {
+	const Case *cs;
+	uint64_t now;                  // ns
+	uint64_t next_tick;
+	uint64_t rng;
+	Pipe     to_board, to_host;
+	long     host_baud;
+	uint32_t dev_baud;
+	uint32_t dev_line_errors;
+	unsigned commits_dropped, dones_dropped;
+	uint8_t *host_rx;
+	uint32_t rx_head, rx_tail;
+	BaudNeg  dev;
+	uint16_t text_seq;
+} Sim;
+
+static Sim sim;
+static int verbose;
+
+static uint32_t rnd32 (void)
+{
+	sim.rng ^= sim.rng << 13;
+	sim.rng ^= sim.rng >> 7;
+	sim.rng ^= sim.rng << 17;
+	return (uint32_t)(sim.rng >> 11);
+}
+
+static double rnd01 (void)
+{
+	return rnd32() / 2097152.0 / 2048.0;
+}
+
+static void pipe_put (Pipe *p, const uint8_t *data, size_t length, uint32_t baud)
+{
+	uint64_t byte_ns = 10000000000ull / baud;
+
+	for (size_t i = 0; i < length; i++) {
+		uint64_t start = p->line_free > sim.now ? p->line_free : sim.now;
+		Byte *b = &p->q[p->tail++ & (PIPE_SIZE - 1)];
+		p->line_free = start + byte_ns;
+		b->t = p->line_free + LATENCY_NS;
+		b->baud = baud;
+		b->c = data[i];
+	}
+}
+
+// Octet reçu au débit rx : faux si les débits diffèrent, bits inversés au-delà du débit propre
+static uint8_t line_effect (const Byte *b, uint32_t rx, int *error)
+{
+	double d = (double)b->baud / rx - 1;
+	long rate = b->baud < rx ? b->baud : rx;
+
+	*error = 0;
+	if (d > 0.03 || d < -0.03) {
+		*error = 1;
+		return (uint8_t)rnd32();
+	}
+	if (rate > sim.cs->clean_max && rnd01() < 10 * sim.cs->ber) {
+		*error = rnd32() & 1;            // Le bruit n'est pas toujours détecté (NF)
+		return (uint8_t)(b->c ^ (1u << (rnd32() & 7)));
+	}
+	return b->c;
+}
+
+/* ---------- carte ---------- */
+
+static int dev_check (uint32_t baud, BaudNeg_Rate *rate)
+{
+	uint32_t over8 = baud > PCLK1 / 16, brr, div;
+
+	if (!over8)
+		brr = (PCLK1 + baud / 2) / baud;
+	else {
+		uint32_t div8 = (PCLK1 + baud / 2) / baud;
+		brr = ((div8 >> 3) << 4) | (div8 & 0x7);
+	}
+	div = over8 ? (((brr >> 4) << 3) | (brr & 0x7)) : brr;
+	rate->actual = div ? (PCLK1 + div / 2) / div : 0;
+	rate->error_ppm = (int32_t)(((int64_t)rate->actual - baud) * 1000000 / baud);
+	rate->brr = (uint16_t)brr;
+	rate->over8 = (uint8_t)over8;
+	return (baud > PCLK1 / 8 || rate->error_ppm > 20000 || rate->error_ppm < -20000) ? -1 : 0;
+}
+
+static void dev_apply (uint32_t baud)
+{
+	sim.dev_baud = baud;
+}
+
+static void dev_send (const uint8_t *data, uint32_t length)
+{
+	if (length > FRAME_HDR_SIZE && data[0] == FRAME_SYNC0 && data[2] == FRAME_BAUD &&
+	    data[FRAME_HDR_SIZE] == BAUDNEG_DONE && sim.dones_dropped < sim.cs->drop_dones) {
+		sim.dones_dropped++;
+		return;
+	}
+	pipe_put(&sim.to_host, data, length, sim.dev_baud);
+}
+
+static uint32_t dev_line_errors (void)
+{
+	return sim.dev_line_errors;
+}
+
+static const BaudNeg_Driver dev_driver = { dev_check, dev_apply, dev_send, dev_line_errors };
+
+// Flux de la carte : une ligne de texte toutes les 5 ms
+static void dev_stream (void)
+{
+	uint8_t out[FRAME_MAX_SIZE];
+	char text[48];
+	int n = snprintf(text, sizeof(text), "ASCII Code: 50 48 52 56, Voltage: %u\r\n", sim.text_seq);
+
+	pipe_put(&sim.to_host, out, Frame_Encode(out, FRAME_TEXT, sim.text_seq++, (uint8_t *)text, (uint8_t)n), sim.dev_baud);
+}
+
+/* ---------- simulation ---------- */
+
+static void advance (uint64_t to)
+{
+	for (;;) {
+		Pipe *b = &sim.to_board, *h = &sim.to_host;
+		uint64_t tb = b->head != b->tail ? b->q[b->head & (PIPE_SIZE - 1)].t : UINT64_MAX;
+		uint64_t th = h->head != h->tail ? h->q[h->head & (PIPE_SIZE - 1)].t : UINT64_MAX;
+		uint64_t t = sim.next_tick;
+		int err;
+
+		if (tb < t)
+			t = tb;
+		if (th < t)
+			t = th;
+		if (t > to)
+			break;
+		sim.now = t;
+		if (t == tb) {
+			const Byte *x = &b->q[b->head++ & (PIPE_SIZE - 1)];
+			uint8_t c = line_effect(x, sim.dev_baud, &err);
+			sim.dev_line_errors += err;
+			BaudNeg_Input(&sim.dev, c, (uint32_t)(t / 1000000));
+		} else if (t == th) {
+			const Byte *x = &h->q[h->head++ & (PIPE_SIZE - 1)];
+			sim.host_rx[sim.rx_tail++ & (PIPE_SIZE - 1)] = line_effect(x, (uint32_t)sim.host_baud, &err);
+		} else {
+			uint32_t ms = (uint32_t)(t / 1000000);
+			BaudNeg_Poll(&sim.dev, ms);
+			if (ms % 5 == 0 && sim.to_host.line_free <= t)
+				dev_stream();
+			sim.next_tick += 1000000;
+		}
+	}
+	sim.now = to;
+}
+
+/* ---------- hôte ---------- */
+
+static int std_rate (long baud)
+{
+	static const long std[] = { 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600,
+	                            1000000, 1500000, 2000000, 3000000, 4000000 };
+	for (unsigned i = 0; i < sizeof(std) / sizeof(std[0]); i++)
+		if (std[i] == baud)
+			return 1;
+	return 0;
+}
+
+static int host_set_baud (void *user, long baud)
+{
+	(void)user;
+	if (!sim.cs->any_rate && !std_rate(baud))
+		return -1;
+	sim.host_baud = baud;
+	return 0;
+}
+
+static int host_write (void *user, const uint8_t *data, size_t length)
+{
+	(void)user;
+	if (length > FRAME_HDR_SIZE && data[0] == FRAME_SYNC0 && data[2] == FRAME_BAUD &&
+	    data[FRAME_HDR_SIZE] == BAUDNEG_COMMIT && sim.commits_dropped < sim.cs->drop_commits) {
+		sim.commits_dropped++;
+		return 0;
+	}
+	pipe_put(&sim.to_board, data, length, (uint32_t)sim.host_baud);
+	advance(sim.to_board.line_free);      // Retour une fois émis (tcdrain)
+	return 0;
+}
+
+static long host_read (void *user, uint8_t *buf, size_t size, int timeout_ms)
+{
+	uint64_t deadline = sim.now + (uint64_t)timeout_ms * 1000000;
+	size_t n = 0;
+
+	(void)user;
+	while (sim.rx_head == sim.rx_tail && sim.now < deadline)
+		advance(sim.now + 1000000 < deadline ? sim.now + 1000000 : deadline);
+	while (n < size && sim.rx_head != sim.rx_tail)
+		buf[n++] = sim.host_rx[sim.rx_head++ & (PIPE_SIZE - 1)];
+	return (long)n;
+}
+
+static uint64_t host_now_ms (void *user)
+{
+	(void)user;
+	return sim.now / 1000000;
+}
+
+static const BaudLink host_link = { host_set_baud, host_write, host_read, host_now_ms, NULL };
+
+static long negotiate (const long *list, long current, char *summary, size_t size)
+{
+	BaudOptions o;
+	BaudTrial trials[MAX_CANDIDATES];
+	int count = 0, tried;
+	size_t k = 0;
+	long r;
+
+	while (count < MAX_CANDIDATES && list[count])
+		count++;
+	baudp_defaults(&o);
+	if (sim.cs->test_len)
+		o.test_len = sim.cs->test_len;
+	r = baudp_negotiate(&host_link, &o, current, list, count, trials, &tried);
+	for (int i = 0; i < tried && k < size; i++) {
+		const BaudTrial *t = &trials[i];
+		k += (size_t)snprintf(summary + k, size - k, "%s%ld:%s", i ? " " : "", t->baud, baudp_status(t->status));
+		if (verbose)
+			fprintf(stderr, "  %ld : %s, réel %lu (%ld ppm), BRR=0x%04X OVER8=%u, carte %u/%u faux, ligne %u, hôte %u/%u faux, %.3f s\n",
+			        t->baud, baudp_status(t->status), (unsigned long)t->actual, (long)t->error_ppm,
+			        t->brr, t->over8, t->board_errors, t->board_received, t->line_errors,
+			        t->host_errors, t->host_received, t->seconds);
+	}
+	return r;
+}
+
+static int run (const Case *cs)
+{
+	char summary[256] = "", after[160] = "";
+	long final, final2 = 0;
+	int ok;
+
+	memset(&sim.to_board, 0, sizeof(Pipe));
+	memset(&sim.to_host, 0, sizeof(Pipe));
+	sim.to_board.q = realloc(sim.to_board.q, PIPE_SIZE * sizeof(Byte));
+	sim.to_host.q = realloc(sim.to_host.q, PIPE_SIZE * sizeof(Byte));
+	sim.host_rx = realloc(sim.host_rx, PIPE_SIZE);
+	sim.cs = cs;
+	sim.now = 0;
+	sim.next_tick = 1000000;
+	sim.rng = 0x9E3779B97F4A7C15ull;
+	sim.host_baud = BASE_BAUD;
+	sim.dev_baud = BASE_BAUD;
+	sim.dev_line_errors = 0;
+	sim.commits_dropped = sim.dones_dropped = 0;
+	sim.rx_head = sim.rx_tail = 0;
+	sim.text_seq = 0;
+	BaudNeg_Init(&sim.dev, &dev_driver, BASE_BAUD, 0);
+	advance(50000000);                    // Flux de la carte déjà en cours
+
+	if (verbose)
+		fprintf(stderr, "%s\n", cs->name);
+	final = negotiate(cs->rates, BASE_BAUD, summary, sizeof(summary));
+	ok = final == cs->expect && sim.host_baud == cs->expect && BaudNeg_Current(&sim.dev) == (uint32_t)cs->expect;
+
+	switch (cs->after) {
+	case AFTER_SILENCE:
+		// Hôte muet : la carte revient au débit de démarrage, un hôte relancé y renégocie
+		advance(sim.now + (BAUDNEG_SILENCE_MS + 1000) * 1000000ull);
+		ok &= BaudNeg_Current(&sim.dev) == BASE_BAUD && sim.dev.c.silences == 1;
+		sim.host_baud = BASE_BAUD;
+		final2 = negotiate(cs->after_rates, BASE_BAUD, after, sizeof(after));
+		break;
+	case AFTER_HEARTBEAT:
+		// Battement de coeur de l'hôte : le débit négocié est gardé
+		for (int s = 0; s < 10; s++) {
+			host_write(NULL, (const uint8_t *)"\n", 1);
+			advance(sim.now + 1000000000ull);
+		}
+		final2 = BaudNeg_Current(&sim.dev);
+		snprintf(after, sizeof(after), "10 s de battements");
+		break;
+	case AFTER_RENEGOTIATE:
+		// Échec au-dessus du débit négocié : retour à celui-ci, pas au débit de démarrage
+		final2 = negotiate(cs->after_rates, final, after, sizeof(after));
+		break;
+	default:
+		break;
+	}
+	if (cs->after != AFTER_NONE)
+		ok &= final2 == cs->expect_after && sim.host_baud == cs->expect_after &&
+		      BaudNeg_Current(&sim.dev) == (uint32_t)cs->expect_after;
+
+	printf("%-28s %9ld %9ld  vérifiés=%lu replis=%lu refus=%lu muets=%lu  %6.2f s  %s\n", cs->name,
+	       cs->after != AFTER_NONE ? final2 : final, (long)BaudNeg_Current(&sim.dev),
+	       (unsigned long)sim.dev.c.verified, (unsigned long)sim.dev.c.fallbacks,
+	       (unsigned long)sim.dev.c.rejected, (unsigned long)sim.dev.c.silences, sim.now / 1e9,
+	       ok ? "ok" : "ÉCART");
+	printf("    %s\n", summary);
+	if (after[0])
+		printf("    puis : %s\n", after);
+	return ok;
+}
+
+static const Case cases[] = {
+	{ "adaptateur propre à 2M", { 4000000, 3000000, 2000000, 1000000 }, 2000000, 1e-3, 0, 0, 0, 0, 2000000,
+	  AFTER_NONE, { 0 }, 0 },
+	{ "maximum de l'USART2", { 8000000, 6000000, 5250000 }, 6000000, 1e-3, 1, 0, 0, 0, 5250000,
+	  AFTER_NONE, { 0 }, 0 },
+	{ "débit refusé par l'hôte", { 3500000, 2000000 }, 4000000, 0, 0, 0, 0, 0, 2000000,
+	  AFTER_NONE, { 0 }, 0 },
+	{ "bruit marginal (1e-4)", { 2000000, 1000000 }, 1000000, 1e-4, 0, 4096, 0, 0, 1000000,
+	  AFTER_NONE, { 0 }, 0 },
+	{ "confirmation perdue", { 3000000 }, 3000000, 0, 0, 0, 1, 0, 3000000,
+	  AFTER_NONE, { 0 }, 0 },
+	{ "confirmations perdues", { 3000000, 2000000 }, 3000000, 0, 0, 0, 4, 0, 2000000,
+	  AFTER_NONE, { 0 }, 0 },
+	{ "réponses DONE perdues", { 3000000 }, 3000000, 0, 0, 0, 0, 3, 3000000,
+	  AFTER_NONE, { 0 }, 0 },
+	{ "hôte muet", { 3000000 }, 3000000, 0, 0, 0, 0, 0, 3000000,
+	  AFTER_SILENCE, { 3000000 }, 3000000 },
+	{ "battement de coeur", { 3000000 }, 3000000, 0, 0, 0, 0, 0, 3000000,
+	  AFTER_HEARTBEAT, { 0 }, 3000000 },
+	{ "renégociation en échec", { 2000000 }, 2000000, 1e-3, 0, 0, 0, 0, 2000000,
+	  AFTER_RENEGOTIATE, { 4000000, 3000000 }, 2000000 },
+};
+
+int main (int argc, char **argv)
+{
+	int fails = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-v"))
+			verbose = 1;
+		else {
+			fprintf(stderr, "usage: baudbench [-v]\n");
+			return 2;
+		}
+	}
+	printf("%-28s %9s %9s\n", "cas", "hôte", "carte");
+	for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+		fails += !run(&cases[i]);
+	return fails != 0;
+}
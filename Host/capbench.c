@@ -0,0 +1,699 @@
+/**
+  * @brief  capbench : matrice de capacité de la boucle d'acquisition sur une cible simulée
+  *
+  *   Compilation :
+  *      gcc -O2 -Wno-pointer-to-int-cast -Iregsim -Wl,--wrap=SysClock_GetTree,--wrap=UART_TxBusy \
+  *          -Wl,--wrap=UART_WriteDMA,--wrap=Dsp_OffsetGain,--wrap=Dsp_Mean,--wrap=Filter_Process \
+  *          -Wl,--wrap=Deadband_Check,--wrap=Frame_PutPacked,--wrap=shift_digits \
+  *          -o capbench capbench.c regsim/regsim.c ../ADC-UART/Output.c ../ADC-UART/UART_Config.c \
+  *          ../ADC-UART/Spsc.c ../ADC-UART/SystemClock.c ../ADC-UART/Mux.c ../ADC-UART/Arq.c ../ADC-UART/Frame.c \
+  *          ../ADC-UART/CRC16.c ../ADC-UART/Pack.c ../ADC-UART/Dsp.c ../ADC-UART/Filter.c \
+  *          ../ADC-UART/Deadband.c ../ADC-UART/ASCII_Config.c ../ADC-UART/Trace.c -lm
+  *
+  *   Utilisation :
+  *      capbench [-f formats] [-b débits] [-c canaux] [-s étages] [-p ms] [-d s]
+  *               [-k nom=cycles]... [-v étiquette] [-j] [-l]
+  *         -f   formats : text, bin6, bin8, bin10, bin12 (text,bin12,bin8)
+  *         -b   débits de USART2 (115200,460800,921600,2000000)
+  *         -c   canaux acquis à chaque période, 1 à 4 (1,2,4)
+  *         -s   étages : none, cal, filter, deadband, cumulés dans l'ordre de la carte
+  *              (none,cal,filter,deadband)
+  *         -p   période de la boucle (10)            -d   durée simulée d'un essai (1)
+  *         -k   coût d'une opération du modèle       -l   liste des coûts
+  *         -v   étiquette ajoutée à chaque ligne (version du logiciel de la carte)
+  *         -j   JSON au lieu de CSV
+  *
+  *   Les modules de la carte s'exécutent tels quels : traitement et envoi des rafales de la
+  *   boucle principale (Output.c : étalonnage, filtre, bande morte, trame compactée ou lignes
+  *   texte), multiplexeur (Mux.c) avec ses files et son ordonnancement, trames (Frame.c,
+  *   Pack.c, CRC16.c) et choix du débit (UART_CheckBaud de UART_Config.c, sur l'arbre
+  *   d'horloge du profil performance). Le banc ne fait que cadencer les périodes, pour 1 à 4
+  *   canaux : rafale de B conversions par canal, Output_Process(), Output_SendBlock(), puis
+  *   attente de l'échéance en faisant avancer le multiplexeur.
+  *   Seuls le temps et les périphériques sont simulés, en cycles du coeur à 168 MHz :
+  *     - ADC1 : ADCCLK 21 MHz (PCLK2 / 4), conversion de 3 cycles d'échantillonnage plus la
+  *       résolution ; ADC_ReadBlock() scrute EOC, le processeur est occupé ;
+  *     - USART2 : débit réel de UART_CheckBaud(), 10 bits par octet ; émission DMA
+  *       asynchrone (UART_WriteDMA), chaque UART_TxBusy() coûte une scrutation ;
+  *     - processeur : coût de chaque opération en cycles (-l), imputé à l'appel des fonctions
+  *       de la carte (--wrap à l'édition de liens). Ce sont des estimations : les remplacer
+  *       avec -k par les mesures de la carte (compteur de cycles, ligne "Filter:", trace
+  *       convertie par tracedump).
+  *   Étage filter : passe-bas (0,1 fs), réjecteur (0,05 fs) en Q31 DF1 et moyenne de 8 points ;
+  *   deadband : moyenne de la rafale, bande de 8 LSB.
+  *
+  *   Pour chaque point de la matrice, le débit offert (échantillons/s, tous canaux) monte par
+  *   la taille de rafale B, de 1 à la capacité d'une trame, à la période -p ; en dessous, par
+  *   allongement de la période jusqu'à 1 s avec B = 1 ; au-dessus, par raccourcissement jusqu'à
+  *   1 ms avec des trames pleines. Deux dichotomies donnent :
+  *     sustainable_sps   débit le plus élevé sans période manquée (chaque rafale commence
+  *                       moins d'une période après son échéance), avec period_ms et burst ;
+  *     headroom_pct      temps libre à ce débit (attente de l'échéance), et la répartition :
+  *                       adc_pct, cpu_pct (calcul), blocked_pct (file pleine), link_pct
+  *                       (occupation de la ligne) ;
+  *     drop_onset_sps    premier débit où des rafales manquent en fin d'essai (la boucle ne
+  *                       rattrape plus son retard) et lost_pct, part des échantillons perdus ;
+  *     bound             limite au premier débit non soutenable : link, adc ou cpu ; burst si
+  *                       tout passe jusqu'à une trame pleine par canal et par milliseconde ;
+  *                       baud si USART2 n'atteint pas le débit.
+  *   Le code de retour vaut 1 si un point atteignable n'a aucun débit soutenable.
+  */
+#include "regsim/stm32f4xx.h"
+#include "../ADC-UART/Output.h"
+#include "../ADC-UART/SystemClock.h"
+#include "../ADC-UART/UART_Config.h"
+#include "../ADC-UART/Mux.h"
+#include "../ADC-UART/Frame.h"
+#include "../ADC-UART/Pack.h"
+#include "../ADC-UART/Dsp.h"
+#include "../ADC-UART/Filter.h"
+#include "../ADC-UART/Deadband.h"
+#include "../ADC-UART/ASCII_Config.h"
+#include "../ADC-UART/HostLink.h"
+#include "../ADC-UART/Timer_Config.h"
+#include "../ADC-UART/Trace.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CPU_HZ       168000000.0
+#define ADCCLK_HZ    21000000.0
+#define ADC_SMP      3             // ADC_SMP_3 (APP_SAMPLE_TIME)
+#define CHANNELS     4
+#define BURST_MAX    255           // Compteur d'une trame compactée
+#define PERIOD_MAX   1000
+#define MIN_PERIODS  20            // Durée minimale d'un essai, en périodes
+#define SPIN_POLLS   4             // Scrutations sans travail : Mux_Reserve() attend une place
+#define CAL_OFFSET   (-12)
+#define CAL_GAIN     16500
+
+enum { STAGE_NONE, STAGE_CAL, STAGE_FILTER, STAGE_DEADBAND, STAGE_COUNT };
+static const char *const stage_names[STAGE_COUNT] = { "none", "cal", "filter", "deadband" };
+
+// Coûts du modèle de processeur (cycles)
+enum {
+	K_LOOP, K_ADC_BLOCK, K_ADC_SAMPLE, K_CAL, K_BIQUAD, K_FIR_TAP, K_FILTER_BLOCK, K_MEAN,
+	K_DEADBAND, K_TEXT_LINE, K_PACK, K_FRAME, K_CRC_BYTE, K_COPY_BYTE, K_MUX_FRAME,
+	K_DMA_START, K_POLL, K_COUNT
+};
+
+typedef struct {
+	const char *name;
+	double      cycles;
+	const char *what;
+} Cost;
+
+static Cost cost[K_COUNT] = {
+	{ "loop",         400, "par période : horodatage, échéance, appels" },
+	{ "adc_block",    120, "par rafale : ADC_ReadBlock, choix du canal" },
+	{ "adc_sample",    24, "par conversion, en plus de sa durée : lancement, lecture de DR" },
+	{ "cal",            4, "par échantillon : Dsp_OffsetGain (deux à la fois en SIMD)" },
+	{ "biquad",        30, "par échantillon et cellule biquad Q31 DF1" },
+	{ "fir_tap",        3, "par échantillon et coefficient FIR" },
+	{ "filter_block",  80, "par rafale : Filter_Process, conversions et bornes" },
+	{ "mean",           1, "par échantillon : Dsp_Mean" },
+	{ "deadband",      60, "par rafale : Deadband_Check" },
+	{ "text_line",   5000, "par échantillon en texte : shift_digits, sprintf avec %.2f, strlen" },
+	{ "pack",           6, "par échantillon en binaire : Frame_PutPacked" },
+	{ "frame",        150, "par trame binaire : Frame_Encode, en-tête" },
+	{ "crc_byte",       9, "par octet de trame binaire : Frame_Encode, CRC et copie" },
+	{ "copy_byte",      1, "par octet en texte : copie dans la file" },
+	{ "mux_frame",    350, "par trame : Mux_Reserve, Mux_Commit, choix du flux" },
+	{ "dma_start",     80, "par trame : UART_WriteDMA" },
+	{ "poll",          40, "par appel : UART_TxBusy" },
+};
+
+// Point de la matrice
+typedef struct {
+	int      binary;
+	uint32_t bits;
+	uint32_t baud, actual;
+	int      channels;
+	int      stage;
+} Point;
+
+// Échelon du débit offert
+typedef struct {
+	uint32_t period_ms;
+	uint32_t burst;
+	double   sps;              // Tous canaux
+} Step;
+
+// Résultat d'un essai
+typedef struct {
+	int      done;
+	uint32_t missed;           // Rafales commencées une période ou plus après leur échéance
+	uint64_t offered;          // Rafales dues pendant l'essai (par canal)
+	uint64_t acquired;
+	double   adc, work, blocked, idle, link;   // Parts du temps
+} Trial;
+
+// Cible simulée
+static struct {
+	uint64_t now;              // Cycles depuis le début de l'essai
+	uint64_t tx_end;           // Fin de l'émission DMA en cours
+	double   byte_cycles;      // Durée d'un octet sur la ligne
+	uint64_t t_adc, t_work, t_blocked, t_idle;
+	uint64_t tx_bytes;
+	int      body;             // 1 : corps de la période ; 0 : attente de l'échéance
+	int      polls;            // UART_TxBusy() consécutifs sans travail
+	int      framed;
+	uint32_t noise;
+} sim;
+
+static ClockTree tree;         // Profil performance : PCLK1 42 MHz pour USART2
+
+static void charge (double cycles)
+{
+	uint64_t c = (uint64_t)(cycles + 0.5);
+
+	sim.now += c;
+	sim.t_work += c;
+	sim.polls = 0;
+}
+
+uint32_t Tick_GetMs (void)
+{
+	return (uint32_t)(sim.now / (uint64_t)(CPU_HZ / 1000));
+}
+
+uint32_t Tick_GetUs (void)
+{
+	return (uint32_t)(sim.now / (uint64_t)(CPU_HZ / 1000000));
+}
+
+uint32_t Trace_Clock (void)
+{
+	return (uint32_t)sim.now;
+}
+
+int MemPlan_VectorsInRam (void)
+{
+	return 0;
+}
+
+// Arbre publié au pilote USART à la place de l'arbre actif de SystemClock.c
+const ClockTree *__wrap_SysClock_GetTree (void)
+{
+	return &tree;
+}
+
+void HostLink_Poll (void)
+{
+}
+
+void HostLink_SetSink (void (*sink)(uint8_t c))
+{
+	(void)sink;
+}
+
+// Pilote USART2 simulé : occupation de la ligne
+int __wrap_UART_TxBusy (const UART_Handle *h)
+{
+	uint64_t c = (uint64_t)(cost[K_POLL].cycles + 0.5);
+
+	(void)h;
+	sim.now += c;
+	if (sim.body)
+		sim.t_work += c;
+	else
+		sim.t_idle += c;
+	if (sim.now >= sim.tx_end)
+		return 0;
+
+	// Mux_Reserve() tourne sur une file pleine : aller directement à la fin de l'émission
+	if (sim.body && ++sim.polls > SPIN_POLLS) {
+		sim.t_blocked += sim.tx_end - sim.now;
+		sim.now = sim.tx_end;
+		sim.polls = 0;
+		return 0;
+	}
+	return 1;
+}
+
+int __wrap_UART_WriteDMA (UART_Handle *h, const uint8_t *data, uint32_t length)
+{
+	(void)data;
+	if (sim.now < sim.tx_end)
+		return -1;
+	if (sim.framed)
+		charge(cost[K_FRAME].cycles + length * cost[K_CRC_BYTE].cycles);
+	else
+		charge(length * cost[K_COPY_BYTE].cycles);
+	charge(cost[K_MUX_FRAME].cycles + cost[K_DMA_START].cycles);
+	sim.tx_end = sim.now + (uint64_t)(length * sim.byte_cycles + 0.5);
+	sim.tx_bytes += length;
+	h->tx_bytes += length;
+	TRACE(TRACE_UART_DMA, length);
+	return 0;
+}
+
+// Rafale de conversions : sinusoïde de 0,1 Hz x (canal + 1) au temps simulé, bruit de +/- 2 LSB
+static void adc_block (uint8_t ch, uint16_t *raw, uint32_t count, uint32_t bits)
+{
+	double conv = (ADC_SMP + bits) * (CPU_HZ / ADCCLK_HZ) + cost[K_ADC_SAMPLE].cycles;
+	double full = (double)((1u << bits) - 1);
+	uint64_t c = (uint64_t)(cost[K_ADC_BLOCK].cycles + count * conv + 0.5);
+
+	TRACE(TRACE_ADC_BEGIN, ch);
+	for (uint32_t i = 0; i < count; i++) {
+		double t = (sim.now + cost[K_ADC_BLOCK].cycles + (i + 1) * conv) / CPU_HZ, v;
+		sim.noise = sim.noise * 1664525u + 1013904223u;
+		v = full * (0.5 + 0.4 * sin(2 * M_PI * 0.1 * (ch + 1) * t)) + (double)(sim.noise >> 30) - 1.5;
+		raw[i] = (uint16_t)(v < 0 ? 0 : v > full ? full : v + 0.5);
+	}
+	sim.now += c;
+	sim.t_adc += c;
+	sim.polls = 0;
+	TRACE(TRACE_ADC_END, ch);
+}
+
+// Coût des étages et de l'envoi, imputé à l'appel des fonctions de la carte par Output.c
+void __real_Dsp_OffsetGain(const uint16_t *in, uint16_t *out, uint32_t count, int16_t offset, int16_t gain, uint32_t bits);
+uint16_t __real_Dsp_Mean(const uint16_t *x, uint32_t count);
+void __real_Filter_Process(Filter_Chan *f, uint32_t bits, const uint16_t *in, uint16_t *out, uint32_t count);
+int __real_Deadband_Check(Deadband_Chan *d, uint16_t value, uint32_t now_ms);
+uint32_t __real_Frame_PutPacked(uint8_t *p, uint32_t t_us, uint8_t channel, uint8_t bits,
+                                const uint16_t *raw, uint8_t count);
+char *__real_shift_digits(int input_integer, char *result_str);
+
+void __wrap_Dsp_OffsetGain (const uint16_t *in, uint16_t *out, uint32_t count, int16_t offset, int16_t gain, uint32_t bits)
+{
+	__real_Dsp_OffsetGain(in, out, count, offset, gain, bits);
+	charge(count * cost[K_CAL].cycles);
+}
+
+uint16_t __wrap_Dsp_Mean (const uint16_t *x, uint32_t count)
+{
+	charge(count * cost[K_MEAN].cycles);
+	return __real_Dsp_Mean(x, count);
+}
+
+void __wrap_Filter_Process (Filter_Chan *f, uint32_t bits, const uint16_t *in, uint16_t *out, uint32_t count)
+{
+	__real_Filter_Process(f, bits, in, out, count);
+	charge(cost[K_FILTER_BLOCK].cycles +
+	       count * (f->sections * cost[K_BIQUAD].cycles + f->taps * cost[K_FIR_TAP].cycles));
+}
+
+int __wrap_Deadband_Check (Deadband_Chan *d, uint16_t value, uint32_t now_ms)
+{
+	charge(cost[K_DEADBAND].cycles);
+	return __real_Deadband_Check(d, value, now_ms);
+}
+
+uint32_t __wrap_Frame_PutPacked (uint8_t *p, uint32_t t_us, uint8_t channel, uint8_t bits,
+                                 const uint16_t *raw, uint8_t count)
+{
+	charge(count * cost[K_PACK].cycles);
+	return __real_Frame_PutPacked(p, t_us, channel, bits, raw, count);
+}
+
+// Ligne texte : shift_digits() puis sprintf() dans Output_FormatSample()
+char *__wrap_shift_digits (int input_integer, char *result_str)
+{
+	charge(cost[K_TEXT_LINE].cycles);
+	return __real_shift_digits(input_integer, result_str);
+}
+
+// Attente de l'échéance : le multiplexeur avance, le temps saute d'émission en émission
+static void wait_until (uint64_t due)
+{
+	while (sim.now < due) {
+		uint64_t next;
+
+		Mux_Poll();
+		next = sim.tx_end > sim.now && sim.tx_end < due ? sim.tx_end : due;
+		if (next > sim.now) {
+			sim.t_idle += next - sim.now;
+			sim.now = next;
+		}
+	}
+}
+
+// Un essai à débit offert fixe
+static void run_trial (const Point *pt, const Step *st, double duration_s, Trial *r)
+{
+	uint64_t period = (uint64_t)st->period_ms * (uint64_t)(CPU_HZ / 1000);
+	uint64_t end = (uint64_t)(duration_s * CPU_HZ);
+	uint16_t raw[BURST_MAX];
+	Output_Chain chain = { 0, 16384, 0, 0, 0, 0 };
+	uint64_t k;
+	double total;
+
+	if (end < MIN_PERIODS * period)
+		end = MIN_PERIODS * period;
+	memset(&sim, 0, sizeof(sim));
+	sim.byte_cycles = 10 * CPU_HZ / pt->actual;
+	sim.framed = pt->binary;
+	Mux_Init(&huart2, pt->binary);
+	for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+		Filter_Reset(Filter_Channel(ch));
+		Deadband_Config(Deadband_Channel(ch), DEADBAND_ABS, 8, 30000);
+	}
+	if (pt->stage >= STAGE_CAL) {
+		chain.cal_offset = CAL_OFFSET;
+		chain.cal_gain = CAL_GAIN;
+	}
+	chain.filter = pt->stage >= STAGE_FILTER;
+	chain.deadband = pt->stage >= STAGE_DEADBAND;
+	memset(r, 0, sizeof(*r));
+
+	for (k = 0; sim.now < end; k++) {
+		if (sim.now >= k * period + period)
+			r->missed++;
+
+		sim.body = 1;
+		charge(cost[K_LOOP].cycles);
+		TRACE(TRACE_LOOP, 0);
+		for (uint8_t ch = 0; ch < pt->channels; ch++) {
+			uint32_t count = st->burst, t_us = Tick_GetUs();
+
+			adc_block(ch, raw, count, pt->bits);
+			count = Output_Process(&chain, raw, count, ch, pt->bits, Tick_GetMs());
+			if (count)
+				Output_SendBlock(raw, count, t_us, ch, pt->bits, pt->binary);
+		}
+		sim.body = 0;
+		wait_until((k + 1) * period);
+	}
+
+	r->done = 1;
+	r->offered = (end + period - 1) / period;
+	r->acquired = k;
+	total = (double)sim.now;
+	r->adc = sim.t_adc / total;
+	r->work = sim.t_work / total;
+	r->blocked = sim.t_blocked / total;
+	r->idle = sim.t_idle / total;
+	r->link = sim.tx_bytes * sim.byte_cycles / total;
+	if (r->link > 1)
+		r->link = 1;
+}
+
+// Le débit est tenu : aucune période manquée, aucune rafale perdue
+static int sustained (const Trial *r)
+{
+	return !r->missed && r->acquired >= r->offered;
+}
+
+// Des rafales manquent en fin d'essai (une seule : retard passager d'une période)
+static int dropping (const Trial *r)
+{
+	return r->acquired + 1 < r->offered;
+}
+
+static const Trial *trial_at (const Point *pt, const Step *ladder, Trial *memo, int i, double duration_s)
+{
+	if (!memo[i].done)
+		run_trial(pt, &ladder[i], duration_s, &memo[i]);
+	return &memo[i];
+}
+
+// Échelle des débits offerts, croissante : période allongée sous B = 1, rafales à la période
+// demandée, puis période raccourcie avec des rafales pleines
+static int build_ladder (Step *s, uint32_t period_ms, uint32_t burst_max, int channels)
+{
+	int n = 0;
+
+	for (uint32_t p = PERIOD_MAX; p > period_ms; p--, n++) {
+		s[n].period_ms = p;
+		s[n].burst = 1;
+		s[n].sps = channels * 1000.0 / p;
+	}
+	for (uint32_t b = 1; b <= burst_max; b++, n++) {
+		s[n].period_ms = period_ms;
+		s[n].burst = b;
+		s[n].sps = channels * b * 1000.0 / period_ms;
+	}
+	for (uint32_t p = period_ms - 1; p >= 1; p--, n++) {
+		s[n].period_ms = p;
+		s[n].burst = burst_max;
+		s[n].sps = channels * burst_max * 1000.0 / p;
+	}
+	return n;
+}
+
+// Résultat d'un point de la matrice
+typedef struct {
+	const Step  *sus;          // Débit soutenable (NULL : aucun)
+	Trial        sus_trial;
+	const Step  *drop;         // Début des pertes (NULL : aucune sur l'échelle)
+	Trial        drop_trial;
+	const char  *bound;
+} Capacity;
+
+static void measure (const Point *pt, uint32_t period_ms, double duration_s, Capacity *cap)
+{
+	static Step ladder[2 * PERIOD_MAX + BURST_MAX];
+	static Trial memo[2 * PERIOD_MAX + BURST_MAX];
+	uint32_t burst_max = pt->binary ? FRAME_PACKED_MAX(pt->bits) : BURST_MAX;
+	int n, lo, hi;
+	const Trial *fail;
+
+	memset(cap, 0, sizeof(*cap));
+	if (!pt->actual) {
+		cap->bound = "baud";
+		return;
+	}
+	if (burst_max > BURST_MAX)
+		burst_max = BURST_MAX;
+	n = build_ladder(ladder, period_ms, burst_max, pt->channels);
+	memset(memo, 0, sizeof(Trial) * n);
+
+	// Débit soutenable : dernier échelon tenu
+	if (!sustained(trial_at(pt, ladder, memo, 0, duration_s)))
+		hi = 0;
+	else if (sustained(trial_at(pt, ladder, memo, n - 1, duration_s)))
+		hi = n;
+	else {
+		lo = 0;
+		hi = n - 1;
+		while (hi - lo > 1) {
+			int mid = (lo + hi) / 2;
+			if (sustained(trial_at(pt, ladder, memo, mid, duration_s)))
+				lo = mid;
+			else
+				hi = mid;
+		}
+	}
+	if (hi > 0) {
+		cap->sus = &ladder[hi - 1];
+		cap->sus_trial = memo[hi - 1];
+	}
+
+	// Limite au premier échelon non tenu
+	if (hi == n)
+		cap->bound = "burst";
+	else {
+		fail = &memo[hi];
+		if (fail->link >= 0.95 || (fail->blocked >= fail->adc && fail->blocked >= fail->work))
+			cap->bound = "link";
+		else
+			cap->bound = fail->adc > fail->work ? "adc" : "cpu";
+	}
+
+	// Début des pertes : premier échelon qui perd, au-delà du débit soutenable
+	lo = hi - 1;
+	hi = n;
+	while (hi - lo > 1) {
+		int mid = (lo + hi) / 2;
+		if (dropping(trial_at(pt, ladder, memo, mid, duration_s)))
+			hi = mid;
+		else
+			lo = mid;
+	}
+	if (hi < n) {
+		cap->drop = &ladder[hi];
+		cap->drop_trial = memo[hi];
+	}
+}
+
+// Listes d'options séparées par des virgules
+static int parse_list (const char *arg, char items[][16], int max)
+{
+	char buf[256], *t;
+	int n = 0;
+
+	snprintf(buf, sizeof(buf), "%s", arg);
+	for (t = strtok(buf, ","); t && n < max; t = strtok(NULL, ","))
+		snprintf(items[n++], 16, "%s", t);
+	return n;
+}
+
+static int parse_format (const char *s, int *binary, uint32_t *bits)
+{
+	if (!strcmp(s, "text")) {
+		*binary = 0;
+		*bits = 12;
+		return 0;
+	}
+	if (strncmp(s, "bin", 3))
+		return -1;
+	*binary = 1;
+	*bits = (uint32_t)atoi(s + 3);
+	return *bits >= 6 && *bits <= 12 && !(*bits & 1) ? 0 : -1;
+}
+
+static int parse_stage (const char *s)
+{
+	for (int i = 0; i < STAGE_COUNT; i++)
+		if (!strcmp(s, stage_names[i]))
+			return i;
+	return -1;
+}
+
+static int set_cost (const char *arg)
+{
+	const char *eq = strchr(arg, '=');
+
+	if (!eq)
+		return -1;
+	for (int i = 0; i < K_COUNT; i++)
+		if (strlen(cost[i].name) == (size_t)(eq - arg) && !strncmp(arg, cost[i].name, eq - arg)) {
+			cost[i].cycles = atof(eq + 1);
+			return 0;
+		}
+	return -1;
+}
+
+// Filtre de l'étage filter, sur tous les canaux
+static void setup_filters (void)
+{
+	float c[10], h[8];
+
+	Filter_DesignLowpass(0.1f, 0.7071f, &c[0]);
+	Filter_DesignNotch(0.05f, 5.0f, &c[5]);
+	for (int i = 0; i < 8; i++)
+		h[i] = 1.0f / 8;
+	for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+		Filter_SetBiquads(Filter_Channel(ch), FILTER_DF1, FILTER_Q31, c, 2);
+		Filter_SetFir(Filter_Channel(ch), h, 8);
+	}
+}
+
+static void print_row (int json, int first, const char *label, const char *format, const Point *pt,
+                       uint32_t period_ms, const Capacity *cap)
+{
+	const Trial *s = &cap->sus_trial, *d = &cap->drop_trial;
+	double lost = cap->drop ? 100.0 * (double)(d->offered - d->acquired) / d->offered : 0;
+
+	if (json) {
+		printf("%s\n  {", first ? "" : ",");
+		if (label)
+			printf("\"version\": \"%s\", ", label);
+		printf("\"format\": \"%s\", \"baud\": %lu, \"actual_baud\": %lu, \"channels\": %d, "
+		       "\"stages\": \"%s\", \"period_ms\": %lu, \"burst\": %lu, \"sustainable_sps\": %.1f, "
+		       "\"headroom_pct\": %.1f, \"adc_pct\": %.1f, \"cpu_pct\": %.1f, \"blocked_pct\": %.1f, "
+		       "\"link_pct\": %.1f, ",
+		       format, (unsigned long)pt->baud, (unsigned long)pt->actual, pt->channels,
+		       stage_names[pt->stage], (unsigned long)(cap->sus ? cap->sus->period_ms : period_ms),
+		       (unsigned long)(cap->sus ? cap->sus->burst : 0), cap->sus ? cap->sus->sps : 0,
+		       100 * s->idle, 100 * s->adc, 100 * s->work, 100 * s->blocked, 100 * s->link);
+		if (cap->drop)
+			printf("\"drop_onset_sps\": %.1f, \"lost_pct\": %.1f, ", cap->drop->sps, lost);
+		else
+			printf("\"drop_onset_sps\": null, \"lost_pct\": null, ");
+		printf("\"bound\": \"%s\"}", cap->bound);
+		return;
+	}
+	if (first)
+		printf("%sformat,baud,actual_baud,channels,stages,period_ms,burst,sustainable_sps,headroom_pct,"
+		       "adc_pct,cpu_pct,blocked_pct,link_pct,drop_onset_sps,lost_pct,bound\n", label ? "version," : "");
+	if (label)
+		printf("%s,", label);
+	printf("%s,%lu,%lu,%d,%s,%lu,%lu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,",
+	       format, (unsigned long)pt->baud, (unsigned long)pt->actual, pt->channels,
+	       stage_names[pt->stage], (unsigned long)(cap->sus ? cap->sus->period_ms : period_ms),
+	       (unsigned long)(cap->sus ? cap->sus->burst : 0), cap->sus ? cap->sus->sps : 0,
+	       100 * s->idle, 100 * s->adc, 100 * s->work, 100 * s->blocked, 100 * s->link);
+	if (cap->drop)
+		printf("%.1f,%.1f,", cap->drop->sps, lost);
+	else
+		printf(",,");
+	printf("%s\n", cap->bound);
+}
+
+int main (int argc, char **argv)
+{
+	char formats[8][16], bauds[16][16], channels[8][16], stages[8][16];
+	int nf, nb, nc, ns, json = 0, first = 1, fail = 0;
+	uint32_t period_ms = 10;
+	double duration_s = 1;
+	const char *label = NULL;
+
+	nf = parse_list("text,bin12,bin8", formats, 8);
+	nb = parse_list("115200,460800,921600,2000000", bauds, 16);
+	nc = parse_list("1,2,4", channels, 8);
+	ns = parse_list("none,cal,filter,deadband", stages, 8);
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-f") && i + 1 < argc)
+			nf = parse_list(argv[++i], formats, 8);
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+			nb = parse_list(argv[++i], bauds, 16);
+		else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+			nc = parse_list(argv[++i], channels, 8);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+			ns = parse_list(argv[++i], stages, 8);
+		else if (!strcmp(argv[i], "-p") && i + 1 < argc)
+			period_ms = strtoul(argv[++i], 0, 10);
+		else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+			duration_s = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-k") && i + 1 < argc) {
+			if (set_cost(argv[++i]) != 0) {
+				fprintf(stderr, "capbench: coût inconnu : %s (liste : -l)\n", argv[i]);
+				return 2;
+			}
+		} else if (!strcmp(argv[i], "-v") && i + 1 < argc)
+			label = argv[++i];
+		else if (!strcmp(argv[i], "-j"))
+			json = 1;
+		else if (!strcmp(argv[i], "-l")) {
+			for (int k = 0; k < K_COUNT; k++)
+				printf("%-13s %6.0f  %s\n", cost[k].name, cost[k].cycles, cost[k].what);
+			return 0;
+		} else {
+			fprintf(stderr, "usage: capbench [-f formats] [-b débits] [-c canaux] [-s étages] [-p ms] [-d s]\n"
+			                "                [-k nom=cycles]... [-v étiquette] [-j] [-l]\n");
+			return 2;
+		}
+	}
+	if (period_ms < 1 || period_ms > PERIOD_MAX || duration_s <= 0) {
+		fprintf(stderr, "capbench: période de 1 à %u ms, durée positive\n", PERIOD_MAX);
+		return 2;
+	}
+
+	SysClock_ComputeTree(CLOCK_PROFILE_PERF, &tree);
+	setup_filters();
+	if (json)
+		printf("[");
+	for (int f = 0; f < nf; f++)
+		for (int b = 0; b < nb; b++)
+			for (int c = 0; c < nc; c++)
+				for (int s = 0; s < ns; s++) {
+					Point pt;
+					Capacity cap;
+					UART_BaudInfo info;
+
+					pt.baud = strtoul(bauds[b], 0, 10);
+					pt.actual = UART_CheckBaud(&huart2, pt.baud, &info) == 0 ? info.actual : 0;
+					pt.channels = atoi(channels[c]);
+					pt.stage = parse_stage(stages[s]);
+					if (parse_format(formats[f], &pt.binary, &pt.bits) != 0 || pt.stage < 0 ||
+					    pt.channels < 1 || pt.channels > CHANNELS) {
+						fprintf(stderr, "capbench: point invalide : %s, %s canaux, %s\n",
+						        formats[f], channels[c], stages[s]);
+						return 2;
+					}
+					measure(&pt, period_ms, duration_s, &cap);
+					print_row(json, first, label, formats[f], &pt, period_ms, &cap);
+					first = 0;
+					if (pt.actual && !cap.sus)
+						fail = 1;
+				}
+	if (json)
+		printf("\n]\n");
+	return fail;
+}
@@ -0,0 +1,181 @@
+/**
+  * @brief  clockbench : vérification des réglages dérivés de l'arbre d'horloge de la carte
+  *         (SystemClock.c, Timer_Config.c, UART_Config.c, ADC_Config.c) face aux valeurs du
+  *         manuel de référence (RM0090) pour chaque profil
+  *
+  *   Compilation :
+  *      gcc -O2 -Wno-pointer-to-int-cast -Iregsim -Wl,--wrap=SysClock_GetTree -o clockbench clockbench.c regsim/regsim.c ../ADC-UART/SystemClock.c ../ADC-UART/Timer_Config.c ../ADC-UART/UART_Config.c ../ADC-UART/ADC_Config.c ../ADC-UART/Trigger.c ../ADC-UART/DWT_Config.c ../ADC-UART/IsrTime.c ../ADC-UART/Spsc.c ../ADC-UART/Trace.c
+  *
+  *   Utilisation :
+  *      clockbench
+  *
+  *   Les fonctions pures (SysClock_ComputeTree, TIM_ComputePrescaler, ADC_ComputePrescaler,
+  *   UART_ComputeBRR / UART_ComputeBaud) sont comparées à une table de référence calculée à la
+  *   main. Puis, pour chaque profil, l'arbre calculé est publié à la place de SysClock_GetTree()
+  *   (la séquence de SysClockConfigProfile() attend des drapeaux RCC que le modèle de registres
+  *   ne fait pas évoluer) et les vrais pilotes TIM6Config() et UART_Init() sont exécutés sur le
+  *   modèle : PSC, BRR et OVER8 écrits doivent être ceux de la table, et UART_CheckBaud() doit
+  *   accepter exactement PCLK / 8 et refuser au-delà.
+  *   Le code de retour vaut 1 en cas d'écart.
+  */
+#include "regsim/stm32f4xx.h"
+#include "../ADC-UART/SystemClock.h"
+#include "../ADC-UART/Timer_Config.h"
+#include "../ADC-UART/UART_Config.h"
+#include "../ADC-UART/ADC_Config.h"
+#include <stdio.h>
+
+// Valeurs de référence d'un profil (RM0090 §6, HSE = 8 MHz)
+typedef struct {
+	ClockProfileId id;
+	uint32_t sysclk, hclk, pclk1, pclk2, tim_apb1, tim_apb2, flash_ws, vos_scale1;
+	uint32_t pll48;          // Sortie PLLQ (0 sans PLL)
+	uint32_t tim6_psc;       // TIM6 à 1 MHz
+	uint32_t adcpre;         // ADCCLK <= 36 MHz
+	uint32_t usart2_brr;     // 115200 bauds sur PCLK1
+} ProfileRef;
+
+static const ProfileRef profile_refs[] = {
+	{ CLOCK_PROFILE_PERF,     168000000, 168000000, 42000000, 84000000, 84000000, 168000000, 5, 1,
+	  48000000, 83, 1, 0x16D },
+	{ CLOCK_PROFILE_LOWPOWER,   8000000,   8000000,  8000000,  8000000,  8000000,   8000000, 0, 0,
+	         0,  7, 0, 0x45 },
+	{ CLOCK_PROFILE_HSI,       16000000,  16000000, 16000000, 16000000, 16000000,  16000000, 0, 0,
+	         0, 15, 0, 0x8B },
+};
+
+// Réglages de débit (RM0090 §30.3.4, tableaux 136 à 139)
+typedef struct {
+	uint32_t pclk, baud;
+	uint32_t over8, brr, actual;
+} BaudRef;
+
+static const BaudRef baud_refs[] = {
+	{ 42000000,   115200, 0, 0x16D,   115068 },
+	{ 84000000,   115200, 0, 0x2D9,   115226 },
+	{ 42000000,   921600, 0, 0x02E,   913043 },
+	{ 42000000,  3000000, 1, 0x016,  3000000 },
+	{ 42000000,  5250000, 1, 0x010,  5250000 },
+	{ 84000000, 10500000, 1, 0x010, 10500000 },
+	{ 16000000,   115200, 0, 0x08B,   115108 },
+	{ 16000000,  1000000, 0, 0x010,  1000000 },
+	{ 16000000,  2000000, 1, 0x010,  2000000 },
+	{  8000000,   115200, 0, 0x045,   115942 },
+};
+
+static ClockTree tree;
+static int fails;
+
+// Arbre publié aux pilotes à la place de l'arbre actif de SystemClock.c
+const ClockTree *__wrap_SysClock_GetTree (void)
+{
+	return &tree;
+}
+
+// Horloge de Trace (DWT->CYCCNT sur la carte) et table des vecteurs, hors sujet ici
+uint32_t Trace_Clock (void)
+{
+	return 0;
+}
+
+int MemPlan_VectorsInRam (void)
+{
+	return 0;
+}
+
+static void check (const char *what, uint32_t got, uint32_t want)
+{
+	if (got != want) {
+		printf("    %-26s %10lu  attendu %10lu  ÉCART\n", what, (unsigned long)got, (unsigned long)want);
+		fails++;
+	}
+}
+
+static void check_profile (const ProfileRef *r)
+{
+	const ClockProfile *p = SysClock_GetProfile(r->id);
+	UART_BaudInfo info;
+	uint32_t brr;
+	int before = fails;
+
+	SysClock_ComputeTree(r->id, &tree);
+	check("SYSCLK", tree.sysclk, r->sysclk);
+	check("HCLK", tree.hclk, r->hclk);
+	check("PCLK1", tree.pclk1, r->pclk1);
+	check("PCLK2", tree.pclk2, r->pclk2);
+	check("horloge timers APB1", tree.tim_apb1, r->tim_apb1);
+	check("horloge timers APB2", tree.tim_apb2, r->tim_apb2);
+	check("attentes Flash", tree.flash_ws, r->flash_ws);
+	check("régulateur Scale 1", tree.vos_scale1, r->vos_scale1);
+
+	// Limites du circuit : HCLK 168 MHz, PCLK1 42 MHz, PCLK2 84 MHz, VCO 1..2 MHz en entrée
+	// et 100..432 MHz en sortie
+	check("HCLK <= 168 MHz", tree.hclk <= 168000000, 1);
+	check("PCLK1 <= 42 MHz", tree.pclk1 <= 42000000, 1);
+	check("PCLK2 <= 84 MHz", tree.pclk2 <= 84000000, 1);
+	if (p->source == CLOCK_SRC_PLL_HSE) {
+		uint32_t vco_in = HSE_HZ / p->pll_m, vco = vco_in * p->pll_n;
+		check("entrée VCO 1..2 MHz", vco_in >= 1000000 && vco_in <= 2000000, 1);
+		check("VCO 100..432 MHz", vco >= 100000000 && vco <= 432000000, 1);
+		check("PLL48", vco / p->pll_q, r->pll48);
+	}
+
+	check("TIM_ComputePrescaler", TIM_ComputePrescaler(tree.tim_apb1, 1000000), r->tim6_psc);
+	check("ADC_ComputePrescaler", ADC_ComputePrescaler(tree.pclk2), r->adcpre);
+	check("ADCCLK <= 36 MHz", tree.pclk2 / (2 * (r->adcpre + 1)) <= ADC_CLK_MAX_HZ, 1);
+
+	// Pilotes réels sur le modèle de registres
+	Regsim_Reset();
+	TIM6Config();
+	check("TIM6->PSC", TIM6->PSC, r->tim6_psc);
+	check("TIM6 en marche", TIM6->CR1 & 1u, 1);
+
+	check("UART_Init(115200)", UART_Init(&huart2, 115200), 0);
+	brr = USART2->BRR;
+	check("USART2->BRR", brr, r->usart2_brr);
+	check("USART2 OVER8", USART2->CR1 >> 15 & 1u, 0);
+	check("UART_CheckBaud(PCLK1 / 8)", UART_CheckBaud(&huart2, tree.pclk1 / 8, &info), 0);
+	check("UART_CheckBaud(> PCLK1 / 8)", UART_CheckBaud(&huart2, tree.pclk1 / 8 + tree.pclk1 / 80, &info),
+	      (uint32_t)-1);
+	check("UART_Init(PCLK1 / 8)", UART_Init(&huart2, tree.pclk1 / 8), 0);
+	check("USART2->BRR (PCLK1 / 8)", USART2->BRR, 0x10);
+	check("USART2 OVER8 (PCLK1 / 8)", USART2->CR1 >> 15 & 1u, 1);
+
+	printf("%-10s %4lu MHz  PCLK1 %2lu MHz  PCLK2 %2lu MHz  PSC %2lu  ADCPRE %lu  BRR 0x%03lX  %s\n",
+	       p->name, (unsigned long)(tree.sysclk / 1000000), (unsigned long)(tree.pclk1 / 1000000),
+	       (unsigned long)(tree.pclk2 / 1000000), (unsigned long)TIM6->PSC, (unsigned long)r->adcpre,
+	       (unsigned long)brr, fails == before ? "ok" : "ÉCART");
+}
+
+static void check_baud (const BaudRef *r)
+{
+	UART_BaudInfo info;
+	int before = fails;
+
+	check("UART_NeedsOver8", UART_NeedsOver8(r->pclk, r->baud), r->over8);
+	check("UART_ComputeBRR", UART_ComputeBRR(r->pclk, r->baud, r->over8), r->brr);
+	UART_ComputeBaud(r->pclk, r->baud, &info);
+	check("UART_ComputeBaud brr", info.brr, r->brr);
+	check("UART_ComputeBaud actual", info.actual, r->actual);
+	check("BRR bit 3 nul en OVER8", r->over8 ? info.brr & 0x8u : 0, 0);
+
+	printf("%2lu MHz %9lu bauds  OVER8 %lu  BRR 0x%03lX  %9lu bauds  %+7.2f %%  %s\n",
+	       (unsigned long)(r->pclk / 1000000), (unsigned long)r->baud, (unsigned long)info.over8,
+	       (unsigned long)info.brr, (unsigned long)info.actual, info.error_ppm / 10000.0,
+	       fails == before ? "ok" : "ÉCART");
+}
+
+int main (int argc, char **argv)
+{
+	(void)argv;
+	if (argc > 1) {
+		fprintf(stderr, "usage: clockbench\n");
+		return 2;
+	}
+	for (unsigned i = 0; i < sizeof(profile_refs) / sizeof(profile_refs[0]); i++)
+		check_profile(&profile_refs[i]);
+	printf("\n");
+	for (unsigned i = 0; i < sizeof(baud_refs) / sizeof(baud_refs[0]); i++)
+		check_baud(&baud_refs[i]);
+	return fails != 0;
+}
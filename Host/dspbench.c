@@ -0,0 +1,258 @@
+/**
+  * @brief  dspbench : vérification et coût des noyaux SIMD de la carte (ADC-UART/Dsp.c)
+  *
+  *   Compilation :
+  *      gcc -O2 -o dspbench dspbench.c ../ADC-UART/Dsp.c
+  *
+  *   Utilisation :
+  *      dspbench [-n échantillons] [-r répétitions]
+  *
+  *   Sur PC, Dsp.c s'exécute avec l'émulation portable des instructions SIMD : chaque noyau est
+  *   comparé bit à bit à sa version de référence sur des blocs aléatoires (longueurs et
+  *   alignements variés, bornes 0 et 4095), puis les deux versions sont chronométrées. Sur PC
+  *   le rapport de vitesse ne reflète que la structure des boucles ; le gain réel se mesure
+  *   sur la carte. Avant cela, chaque noyau (SIMD et référence) est confronté à des vecteurs
+  *   aux sorties calculées à la main à partir de la définition (Dsp.c) : saturation de
+  *   l'addition, gain négatif, écrêtage à 6, 8 et 12 bits, arrondi de la moyenne, accumulation
+  *   au-delà de 32 bits, à chaque alignement des tampons. Code de retour 1 si un écart est
+  *   trouvé, 2 sur erreur d'usage.
+  */
+#define _GNU_SOURCE
+#include "../ADC-UART/Dsp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint32_t rng = 1;
+
+static uint32_t rnd (void)
+{
+	rng = rng * 1664525u + 1013904223u;
+	return rng >> 8;
+}
+
+static double now_ns (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Bloc aléatoire 12 bits avec quelques valeurs aux bornes
+static void fill (uint16_t *x, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t r = rnd();
+		x[i] = (uint16_t)((r & 15) == 0 ? 0 : (r & 15) == 1 ? 4095 : (r >> 4) & 4095);
+	}
+}
+
+// Vecteurs de Dsp_OffsetGain : out = sat((sat16(in + offset) * gain) >> 14, 0, 2^bits - 1)
+static const uint16_t og_in[9] = { 0, 1, 100, 2048, 4000, 4095, 3000, 10, 4094 };
+static const struct {
+	int16_t  offset, gain;
+	uint32_t bits;
+	uint16_t out[9];
+} og_vec[] = {
+	{ 0,      16384, 12, { 0, 1, 100, 2048, 4000, 4095, 3000, 10, 4094 } },     // Identité
+	{ -100,   16384, 12, { 0, 0, 0, 1948, 3900, 3995, 2900, 0, 3994 } },        // Décalage, plancher 0
+	{ 0,      32767, 12, { 0, 1, 199, 4095, 4095, 4095, 4095, 19, 4095 } },     // Gain ~2, troncature
+	{ 0,     -32768, 12, { 0, 0, 0, 0, 0, 0, 0, 0, 0 } },                       // Gain -2 : négatif écrêté
+	{ -5000, -16384, 12, { 4095, 4095, 4095, 2952, 1000, 905, 2000, 4095, 906 } },
+	{ 30000,  16384, 12, { 4095, 4095, 4095, 4095, 4095, 4095, 4095, 4095, 4095 } }, // QADD16 saturé
+	{ 0,       8192, 8,  { 0, 0, 50, 255, 255, 255, 255, 5, 255 } },
+	{ 3,      16384, 6,  { 3, 4, 63, 63, 63, 63, 63, 13, 63 } },
+};
+
+// Écart sur un vecteur de référence
+static int vec_fail (const char *kernel, const char *ref, int a, long long want, long long got)
+{
+	if (want == got)
+		return 0;
+	fprintf(stderr, "%s%s: vecteur, alignement %d : attendu %lld, obtenu %lld\n", kernel, ref, a, want, got);
+	return 1;
+}
+
+/**
+  * @brief Confronter les noyaux et leurs références aux vecteurs calculés à la main
+  *        Chaque vecteur est posé à l'alignement 0 puis 1 (demi-mot) : boucle SIMD, échantillon
+  *        d'alignement et reste impair sont tous parcourus.
+  * @retval Nombre d'écarts
+  */
+static int vectors (void)
+{
+	static _Alignas(4) uint16_t x[1024 + 2], o[16];
+	static _Alignas(4) int16_t w[1024 + 2];
+	static const uint16_t mean_in[4][2] = { { 1, 2 }, { 0, 1 }, { 4095, 4094 }, { 7, 7 } };
+	static const uint16_t mean_out[4] = { 2, 1, 4095, 7 };
+	static const uint16_t mm_in[5] = { 7, 3, 4095, 0, 12 };
+	static const int16_t dot_w[5] = { -1, 2, -3, 4, 32767 };
+	int errors = 0;
+
+	for (int ref = 0; ref < 2; ref++) {
+		const char *r = ref ? "_Ref" : "";
+		for (int a = 0; a < 2; a++) {
+			uint16_t mn, mx;
+
+			// Ajustement : tous les cas de la table, en place et hors place
+			for (unsigned v = 0; v < sizeof(og_vec) / sizeof(og_vec[0]); v++) {
+				memcpy(x + a, og_in, sizeof(og_in));
+				(ref ? Dsp_OffsetGain_Ref : Dsp_OffsetGain)(x + a, o + a, 9, og_vec[v].offset, og_vec[v].gain, og_vec[v].bits);
+				(ref ? Dsp_OffsetGain_Ref : Dsp_OffsetGain)(x + a, x + a, 9, og_vec[v].offset, og_vec[v].gain, og_vec[v].bits);
+				for (int i = 0; i < 9; i++) {
+					errors += vec_fail("OffsetGain", r, a, og_vec[v].out[i], o[a + i]);
+					errors += vec_fail("OffsetGain (en place)", r, a, og_vec[v].out[i], x[a + i]);
+				}
+			}
+
+			// Somme et moyenne : 1000 x 4095 dépasse 16 bits, moyenne arrondie au plus proche
+			for (int i = 0; i < 1000; i++)
+				x[a + i] = 4095;
+			errors += vec_fail("Sum", r, a, 4095000, (ref ? Dsp_Sum_Ref : Dsp_Sum)(x + a, 1000));
+			errors += vec_fail("Sum", r, a, 4095 * 999, (ref ? Dsp_Sum_Ref : Dsp_Sum)(x + a, 999));
+			errors += vec_fail("Mean", r, a, 0, (ref ? Dsp_Mean_Ref : Dsp_Mean)(x + a, 0));
+			for (int v = 0; v < 4; v++) {
+				memcpy(x + a, mean_in[v], sizeof(mean_in[v]));
+				errors += vec_fail("Mean", r, a, mean_out[v], (ref ? Dsp_Mean_Ref : Dsp_Mean)(x + a, 2));
+			}
+
+			// Produit scalaire : poids signés, puis somme au-delà de 32 bits
+			memcpy(x + a, (const uint16_t[]){ 1, 2, 3, 4, 5 }, 5 * sizeof(uint16_t));
+			memcpy(w + a, dot_w, sizeof(dot_w));
+			errors += vec_fail("Dot", r, a, 163845, (ref ? Dsp_Dot_Ref : Dsp_Dot)(x + a, w + a, 5));
+			for (int i = 0; i < 1024; i++) {
+				x[a + i] = 4095;
+				w[a + i] = -32768;
+			}
+			errors += vec_fail("Dot", r, a, -137405399040LL, (ref ? Dsp_Dot_Ref : Dsp_Dot)(x + a, w + a, 1024));
+
+			// Minimum et maximum, y compris bloc d'un échantillon
+			memcpy(x + a, mm_in, sizeof(mm_in));
+			(ref ? Dsp_MinMax_Ref : Dsp_MinMax)(x + a, 5, &mn, &mx);
+			errors += vec_fail("MinMax", r, a, 0, mn) + vec_fail("MinMax", r, a, 4095, mx);
+			(ref ? Dsp_MinMax_Ref : Dsp_MinMax)(x + a + 4, 1, &mn, &mx);
+			errors += vec_fail("MinMax", r, a, 12, mn) + vec_fail("MinMax", r, a, 12, mx);
+		}
+	}
+	return errors;
+}
+
+static int check (void)
+{
+	static uint16_t x[1024 + 2], o1[1024 + 2], o2[1024 + 2];
+	static int16_t w[1024 + 2];
+	static const uint32_t bits[] = { 6, 8, 10, 12 };
+	int errors = 0;
+
+	for (int iter = 0; iter < 20000; iter++) {
+		uint32_t n = rnd() % 1024;
+		uint32_t ax = rnd() & 1, aw = rnd() & 1, ao = rnd() & 1;
+		int16_t offset = (int16_t)((int32_t)(rnd() % 8193) - 4096);
+		int16_t gain = (int16_t)((int32_t)(rnd() % 65536) - 32768);
+		uint32_t b = bits[rnd() & 3];
+		uint16_t mn1, mx1, mn2, mx2;
+
+		fill(x + ax, n);
+		for (uint32_t i = 0; i < n; i++)
+			w[aw + i] = (int16_t)rnd();
+
+		Dsp_OffsetGain(x + ax, o1 + ao, n, offset, gain, b);
+		Dsp_OffsetGain_Ref(x + ax, o2 + ao, n, offset, gain, b);
+		if (memcmp(o1 + ao, o2 + ao, n * sizeof(uint16_t)) != 0) {
+			fprintf(stderr, "OffsetGain: écart (n=%u, offset=%d, gain=%d, bits=%u)\n", n, offset, gain, b);
+			errors++;
+		}
+		if (Dsp_Sum(x + ax, n) != Dsp_Sum_Ref(x + ax, n) || Dsp_Mean(x + ax, n) != Dsp_Mean_Ref(x + ax, n)) {
+			fprintf(stderr, "Sum/Mean: écart (n=%u)\n", n);
+			errors++;
+		}
+		if (Dsp_Dot(x + ax, w + aw, n) != Dsp_Dot_Ref(x + ax, w + aw, n)) {
+			fprintf(stderr, "Dot: écart (n=%u)\n", n);
+			errors++;
+		}
+		Dsp_MinMax(x + ax, n, &mn1, &mx1);
+		Dsp_MinMax_Ref(x + ax, n, &mn2, &mx2);
+		if (mn1 != mn2 || mx1 != mx2) {
+			fprintf(stderr, "MinMax: écart (n=%u)\n", n);
+			errors++;
+		}
+	}
+	return errors;
+}
+
+int main (int argc, char **argv)
+{
+	uint32_t n = 256, reps = 20000;
+	uint16_t *x, *o;
+	int16_t *w;
+	volatile uint64_t sink = 0;
+	double t[2][4];
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc)
+			n = strtoul(argv[++i], 0, 10);
+		else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+			reps = strtoul(argv[++i], 0, 10);
+		else {
+			fprintf(stderr, "usage: dspbench [-n échantillons] [-r répétitions]\n");
+			return 2;
+		}
+	}
+
+	int errors = vectors();
+	printf("vecteurs de référence : %s\n", errors ? "ÉCARTS" : "ok");
+	int diffs = check();
+	printf("bit à bit : %s\n", diffs ? "ÉCARTS" : "identique");
+	errors += diffs;
+
+	x = malloc(n * sizeof(*x));
+	o = malloc(n * sizeof(*o));
+	w = malloc(n * sizeof(*w));
+	if (!x || !o || !w) {
+		perror("malloc");
+		return 2;
+	}
+	fill(x, n);
+	for (uint32_t i = 0; i < n; i++)
+		w[i] = (int16_t)rnd();
+
+	for (int simd = 0; simd < 2; simd++) {
+		double t0;
+		uint16_t mn, mx;
+
+		t0 = now_ns();
+		for (uint32_t r = 0; r < reps; r++)
+			(simd ? Dsp_OffsetGain : Dsp_OffsetGain_Ref)(x, o, n, -100, 17000, 12);
+		t[simd][0] = now_ns() - t0;
+
+		t0 = now_ns();
+		for (uint32_t r = 0; r < reps; r++)
+			sink += (simd ? Dsp_Sum : Dsp_Sum_Ref)(x, n);
+		t[simd][1] = now_ns() - t0;
+
+		t0 = now_ns();
+		for (uint32_t r = 0; r < reps; r++)
+			sink += (uint64_t)(simd ? Dsp_Dot : Dsp_Dot_Ref)(x, w, n);
+		t[simd][2] = now_ns() - t0;
+
+		t0 = now_ns();
+		for (uint32_t r = 0; r < reps; r++) {
+			(simd ? Dsp_MinMax : Dsp_MinMax_Ref)(x, n, &mn, &mx);
+			sink += mn + mx;
+		}
+		t[simd][3] = now_ns() - t0;
+	}
+
+	static const char *names[] = { "OffsetGain", "Sum", "Dot", "MinMax" };
+	printf("%-12s %14s %14s %8s\n", "noyau", "réf. ns/éch.", "SIMD ns/éch.", "rapport");
+	for (int k = 0; k < 4; k++) {
+		double ref = t[0][k] / ((double)n * reps), simd = t[1][k] / ((double)n * reps);
+		printf("%-12s %14.3f %14.3f %8.2f\n", names[k], ref, simd, ref / simd);
+	}
+
+	free(x);
+	free(o);
+	free(w);
+	return errors != 0;
+}
@@ -0,0 +1,365 @@
+/**
+  * @brief  filterbench : précision et coût du moteur de filtrage de la carte (ADC-UART/Filter.c)
+  *
+  *   Compilation :
+  *      gcc -O2 -o filterbench filterbench.c ../ADC-UART/Filter.c -lm
+  *
+  *   Utilisation :
+  *      filterbench [-n échantillons] [-m MHz] [--max-err LSB]
+  *         -n <n>           longueur du signal de test (par défaut 1000000)
+  *         -m <MHz>         convertir le temps mesuré en cycles à cette fréquence (par défaut 3000)
+  *         --max-err <LSB>  seuil sur l'erreur maximale face aux coefficients de conception
+  *
+  *   Chaque étage (cellule DF1/DF2 en Q15/Q31, cascade passe-bas + réjecteur, FIR) filtre un
+  *   signal 12 bits synthétique (deux sinusoïdes, ronflement secteur et bruit) ; la sortie est
+  *   comparée à la même structure calculée en double précision avec les coefficients non
+  *   quantifiés. L'erreur est donnée en LSB de l'ADC, le coût en ns et en cycles par échantillon.
+  *   Le coût sur la carte est envoyé par le logiciel lui-même (rapport "Filter:").
+  *   La colonne "err quant." compare la sortie à la référence calculée avec les coefficients
+  *   tels que quantifiés par le moteur : elle isole l'arithmétique en virgule fixe des effets
+  *   de conception, et chaque étage a sa limite. Suivent des vecteurs de référence aux sorties
+  *   connues exactement (voir vectors()).
+  *   Le code de retour vaut 1 si une limite ou un vecteur est en écart, 2 sur erreur d'usage.
+  */
+#define _GNU_SOURCE
+#include "../ADC-UART/Filter.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BITS   12
+#define BLOCK  255    // Taille maximale d'un bloc sur la carte
+
+typedef struct {
+	const char  *name;
+	FilterForm   form;
+	FilterFormat format;
+	uint32_t     sections;
+	uint32_t     taps;
+	double       limit;        // Erreur maximale admise face aux coefficients quantifiés (LSB)
+	float        c[5 * FILTER_MAX_SECTIONS];
+	float        h[FILTER_MAX_TAPS];
+} Stage;
+
+// Coefficients de la référence double précision
+typedef struct {
+	double c[5 * FILTER_MAX_SECTIONS];
+	double h[FILTER_MAX_TAPS];
+} Coeffs;
+
+typedef struct {
+	double max_err, rms_err;   // Face aux coefficients de conception
+	double max_q;              // Face aux coefficients quantifiés : arithmétique du moteur seule
+	double ns_per_sample;
+} Result;
+
+static double now_ns (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Signal de test : deux composantes utiles, 50 Hz à fs = 1 kHz, bruit uniforme de ±8 LSB
+static void make_signal (uint16_t *x, size_t n)
+{
+	uint32_t rng = 12345;
+
+	for (size_t i = 0; i < n; i++) {
+		double v = 2048 + 900 * sin(2 * M_PI * 0.002 * i) + 300 * sin(2 * M_PI * 0.03 * i)
+		                + 200 * sin(2 * M_PI * 0.05 * i);
+		rng = rng * 1664525u + 1013904223u;
+		v += ((rng >> 8) % 17) - 8.0;
+		x[i] = (uint16_t)(v < 0 ? 0 : v > 4095 ? 4095 : lround(v));
+	}
+}
+
+// Coefficients de conception, non quantifiés
+static void design_coeffs (const Stage *st, Coeffs *k)
+{
+	memset(k, 0, sizeof(*k));
+	for (uint32_t i = 0; i < 5 * st->sections; i++)
+		k->c[i] = st->c[i];
+	for (uint32_t i = 0; i < st->taps; i++)
+		k->h[i] = st->h[i];
+}
+
+// Coefficients tels que quantifiés par le moteur : c = q * 2^(shift - bits fractionnaires)
+static void engine_coeffs (const Stage *st, Coeffs *k)
+{
+	Filter_Chan *f = Filter_Channel(0);
+	int frac = st->format == FILTER_Q31 ? 31 : 15;
+
+	memset(k, 0, sizeof(*k));
+	Filter_SetBiquads(f, st->form, st->format, st->c, st->sections);
+	Filter_SetFir(f, st->h, st->taps);
+	for (uint32_t i = 0; i < 5 * st->sections; i++)
+		k->c[i] = ldexp(f->bq[i / 5].c[i % 5], (int)f->shift - frac);
+	for (uint32_t i = 0; i < st->taps; i++)
+		k->h[i] = ldexp(f->fir_c[i], (int)f->fir_shift - 15);
+}
+
+// Référence double précision : cascade DF1 puis FIR, même conversion d'entrée / sortie
+static void reference (const Stage *st, const Coeffs *kc, const uint16_t *in, double *out, size_t n)
+{
+	double s[FILTER_MAX_SECTIONS][4] = { { 0 } };
+	double dl[FILTER_MAX_TAPS] = { 0 };
+
+	for (size_t i = 0; i < n; i++) {
+		double v = in[i] / 4096.0;
+		for (uint32_t k = 0; k < st->sections; k++) {
+			const double *c = &kc->c[5 * k];
+			double y = c[0] * v + c[1] * s[k][0] + c[2] * s[k][1] - c[3] * s[k][2] - c[4] * s[k][3];
+			s[k][1] = s[k][0]; s[k][0] = v;
+			s[k][3] = s[k][2]; s[k][2] = y;
+			v = y;
+		}
+		if (st->taps) {
+			memmove(&dl[1], &dl[0], (st->taps - 1) * sizeof(double));
+			dl[0] = v;
+			v = 0;
+			for (uint32_t k = 0; k < st->taps; k++)
+				v += kc->h[k] * dl[k];
+		}
+		v *= 4096.0;
+		out[i] = v < 0 ? 0 : v > 4095 ? 4095 : v;
+	}
+}
+
+// Erreur maximale de la sortie face à une référence
+static double max_error (const uint16_t *out, const double *ref, size_t n, double *rms)
+{
+	double m = 0, sq = 0;
+
+	for (size_t i = 0; i < n; i++) {
+		double e = fabs(out[i] - ref[i]);
+		if (e > m)
+			m = e;
+		sq += e * e;
+	}
+	if (rms)
+		*rms = sqrt(sq / n);
+	return m;
+}
+
+// Ligne de résultat d'un vecteur de référence
+static int check (const char *name, int ok, const char *fmt, long want, long got)
+{
+	char d[48];
+
+	snprintf(d, sizeof(d), fmt, want, got);
+	printf("%-30s %-26s %s\n", name, d, ok ? "ok" : "ÉCART");
+	return !ok;
+}
+
+// Sortie d'un échelon constant (état remis à zéro)
+static void step (Filter_Chan *f, uint32_t bits, uint16_t level, uint16_t *y, uint32_t n)
+{
+	uint16_t x[FILTER_CHUNK * 16];
+
+	for (uint32_t i = 0; i < n; i++)
+		x[i] = level;
+	Filter_Reset(f);
+	Filter_Process(f, bits, x, y, n);
+}
+
+/**
+  * @brief Vecteurs de référence : sorties connues exactement, indépendantes de la référence flottante
+  *   - FIR moyenneur de 4 coefficients (0,25, exact en Q15) sur un échelon, en 12 et 8 bits ;
+  *   - gain statique unitaire des passe-bas Q31 (DF1, DF2) ;
+  *   - réjection du réjecteur Q31 sur une sinusoïde à sa fréquence ;
+  *   - saturation sans repliement d'un passe-bas Q15 à dépassement (Q = 2) sur un échelon
+  *     pleine échelle ;
+  *   - indépendance du découpage en blocs : la cascade complète donne la même sortie par blocs
+  *     de 255, de 7 et d'un échantillon.
+  * @retval Nombre d'écarts
+  */
+static int vectors (const uint16_t *sig)
+{
+	enum { N = FILTER_CHUNK * 16 };
+	static const uint16_t ramp12[] = { 250, 500, 750, 1000, 1000, 1000 };
+	static const uint16_t ramp8[] = { 25, 50, 75, 100, 100, 100 };
+	Filter_Chan *f = Filter_Channel(1);
+	float c[5 * FILTER_MAX_SECTIONS], h[8];
+	uint16_t y[N], z[N], x[N];
+	int fails = 0, ok;
+	long got;
+
+	// FIR moyenneur : rampe exacte jusqu'au palier
+	for (int k = 0; k < 4; k++)
+		h[k] = 0.25f;
+	Filter_SetBiquads(f, FILTER_DF1, FILTER_Q15, c, 0);
+	Filter_SetFir(f, h, 4);
+	step(f, 12, 1000, y, 6);
+	fails += check("FIR 4 taps, échelon 12 bits", !memcmp(y, ramp12, sizeof(ramp12)), "250..1000 / %ld..%ld", y[0], y[5]);
+	step(f, 8, 100, y, 6);
+	fails += check("FIR 4 taps, échelon 8 bits", !memcmp(y, ramp8, sizeof(ramp8)), "25..100 / %ld..%ld", y[0], y[5]);
+	Filter_SetFir(f, h, 0);
+
+	// Gain statique : le palier est rendu au LSB près
+	Filter_DesignLowpass(0.05f, 0.7071f, c);
+	Filter_SetBiquads(f, FILTER_DF1, FILTER_Q31, c, 1);
+	step(f, 12, 3000, y, N);
+	fails += check("passe-bas DF1 Q31, palier", y[N - 1] == 3000, "%ld / %ld", 3000, y[N - 1]);
+	Filter_SetBiquads(f, FILTER_DF2, FILTER_Q31, c, 1);
+	step(f, 12, 3000, y, N);
+	fails += check("passe-bas DF2 Q31, palier", y[N - 1] == 3000, "%ld / %ld", 3000, y[N - 1]);
+
+	// Réjecteur : résidu de la sinusoïde à f0 après établissement, composante continue conservée
+	Filter_DesignNotch(0.05f, 5.0f, c);
+	Filter_SetBiquads(f, FILTER_DF1, FILTER_Q31, c, 1);
+	for (uint32_t i = 0; i < N; i++)
+		x[i] = (uint16_t)lround(2048 + 1000 * sin(2 * M_PI * 0.05 * i));
+	Filter_Reset(f);
+	Filter_Process(f, 12, x, y, N);
+	got = 0;
+	for (uint32_t i = N - 100; i < N; i++)
+		if (labs((long)y[i] - 2048) > got)
+			got = labs((long)y[i] - 2048);
+	fails += check("réjecteur Q31, 1000 LSB à f0", got <= 2, "<= %ld / %ld LSB", 2, got);
+
+	// Saturation : le dépassement est écrêté à la pleine échelle, jamais replié vers 0
+	Filter_DesignLowpass(0.1f, 2.0f, c);
+	Filter_SetBiquads(f, FILTER_DF1, FILTER_Q15, c, 1);
+	step(f, 12, 4095, y, N);
+	got = 4095;
+	ok = 0;
+	for (uint32_t i = 3; i < N; i++) {       // Montée en 3 échantillons
+		if (y[i] < got)
+			got = y[i];
+		ok |= y[i] == 4095;
+	}
+	fails += check("passe-bas Q15, échelon 4095", ok && got >= 4090, "min >= %ld / %ld", 4090, got);
+
+	// Découpage : l'état est bien repris d'un appel à l'autre
+	Filter_DesignLowpass(0.1f, 0.7071f, &c[0]);
+	Filter_DesignNotch(0.05f, 5.0f, &c[5]);
+	for (int k = 0; k < 8; k++)
+		h[k] = 0.125f;
+	Filter_SetBiquads(f, FILTER_DF2, FILTER_Q31, c, 2);
+	Filter_SetFir(f, h, 8);
+	Filter_Reset(f);
+	for (uint32_t i = 0; i < N; i += BLOCK)
+		Filter_Process(f, 12, &sig[i], &y[i], N - i < BLOCK ? N - i : BLOCK);
+	Filter_Reset(f);
+	for (uint32_t i = 0; i < N; i += 7)
+		Filter_Process(f, 12, &sig[i], &z[i], N - i < 7 ? N - i : 7);
+	ok = !memcmp(y, z, sizeof(y));
+	Filter_Reset(f);
+	for (uint32_t i = 0; i < N; i++)
+		Filter_Process(f, 12, &sig[i], &z[i], 1);
+	ok &= !memcmp(y, z, sizeof(y));
+	fails += check("cascade, blocs 255 / 7 / 1", ok, "identiques", 0, 0);
+	Filter_SetBiquads(f, FILTER_DF1, FILTER_Q15, c, 0);
+	Filter_SetFir(f, h, 0);
+
+	return fails;
+}
+
+static void run (const Stage *st, const uint16_t *in, uint16_t *out, double *ref, size_t n, Result *r)
+{
+	Filter_Chan *f = Filter_Channel(0);
+	Coeffs k;
+	double t0;
+
+	Filter_SetBiquads(f, st->form, st->format, st->c, st->sections);
+	Filter_SetFir(f, st->h, st->taps);
+
+	t0 = now_ns();
+	for (size_t i = 0; i < n; i += BLOCK)
+		Filter_Process(f, BITS, &in[i], &out[i], n - i < BLOCK ? (uint32_t)(n - i) : BLOCK);
+	r->ns_per_sample = (now_ns() - t0) / n;
+
+	design_coeffs(st, &k);
+	reference(st, &k, in, ref, n);
+	r->max_err = max_error(out, ref, n, &r->rms_err);
+	engine_coeffs(st, &k);
+	reference(st, &k, in, ref, n);
+	r->max_q = max_error(out, ref, n, 0);
+}
+
+int main (int argc, char **argv)
+{
+	size_t n = 1000000;
+	double mhz = 3000, max_err = -1;
+	Stage stages[9];
+	int count = 0, fail = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc)
+			n = strtoul(argv[++i], 0, 10);
+		else if (!strcmp(argv[i], "-m") && i + 1 < argc)
+			mhz = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--max-err") && i + 1 < argc)
+			max_err = atof(argv[++i]);
+		else {
+			fprintf(stderr, "usage: filterbench [-n échantillons] [-m MHz] [--max-err LSB]\n");
+			return 2;
+		}
+	}
+
+	// Étages mesurés : passe-bas fc = 0,01 fs (une cellule), passe-bas + réjecteur 50 Hz, FIR moyenneurs
+	memset(stages, 0, sizeof(stages));
+	// Limites : arrondi de sortie (0,5 LSB) et bruit d'arrondi de l'état, amplifié par la
+	// récursion quand l'état DF1 est en Q15 (pôles proches de 1 à fc = 0,01 fs)
+	static const struct { const char *name; FilterForm form; FilterFormat format; double limit; } cells[] = {
+		{ "biquad DF1 Q15", FILTER_DF1, FILTER_Q15, 8.0 },
+		{ "biquad DF2 Q15", FILTER_DF2, FILTER_Q15, 1.0 },
+		{ "biquad DF1 Q31", FILTER_DF1, FILTER_Q31, 0.75 },
+		{ "biquad DF2 Q31", FILTER_DF2, FILTER_Q31, 0.75 },
+	};
+	for (int k = 0; k < 4; k++, count++) {
+		stages[count].name = cells[k].name;
+		stages[count].form = cells[k].form;
+		stages[count].format = cells[k].format;
+		stages[count].limit = cells[k].limit;
+		stages[count].sections = 1;
+		Filter_DesignLowpass(0.01f, 0.7071f, stages[count].c);
+	}
+	for (int k = 0; k < 2; k++, count++) {
+		stages[count].name = k == 0 ? "LP + notch DF1 Q15" : "LP + notch DF1 Q31";
+		stages[count].form = FILTER_DF1;
+		stages[count].format = k == 0 ? FILTER_Q15 : FILTER_Q31;
+		stages[count].limit = k == 0 ? 3.0 : 0.75;
+		stages[count].sections = 2;
+		Filter_DesignLowpass(0.1f, 0.7071f, &stages[count].c[0]);
+		Filter_DesignNotch(0.05f, 5.0f, &stages[count].c[5]);
+	}
+	for (uint32_t taps = 8; taps <= FILTER_MAX_TAPS; taps *= 4, count++) {
+		stages[count].name = taps == 8 ? "FIR 8 taps" : "FIR 32 taps";
+		stages[count].taps = taps;
+		stages[count].limit = 0.75;
+		for (uint32_t k = 0; k < taps; k++)
+			stages[count].h[k] = 1.0f / taps;
+	}
+
+	uint16_t *in = malloc(n * sizeof(*in));
+	uint16_t *out = malloc(n * sizeof(*out));
+	double *ref = malloc(n * sizeof(*ref));
+	if (!in || !out || !ref) {
+		perror("malloc");
+		return 2;
+	}
+	make_signal(in, n);
+
+	printf("%-20s %10s %10s %10s %12s %14s\n", "étage", "err max", "err rms", "err quant.", "ns/éch.", "cycles/éch.");
+	for (int k = 0; k < count; k++) {
+		Result r;
+		run(&stages[k], in, out, ref, n, &r);
+		int ok = r.max_q <= stages[k].limit && (max_err < 0 || r.max_err <= max_err);
+		printf("%-20s %8.2f L %8.3f L %8.2f L %12.2f %14.1f  %s\n", stages[k].name,
+		       r.max_err, r.rms_err, r.max_q, r.ns_per_sample, r.ns_per_sample * mhz / 1000,
+		       ok ? "ok" : "ÉCART");
+		fail |= !ok;
+	}
+
+	printf("\n%-30s %-26s\n", "vecteur de référence", "attendu / obtenu");
+	fail |= vectors(in) != 0;
+
+	free(in);
+	free(out);
+	free(ref);
+	return fail;
+}
@@ -0,0 +1,334 @@
+/**
+  * @brief  flashbench : journal Flash de la carte (ADC-UART/FlashLog.c) sur une Flash simulée
+  *         avec les durées d'effacement et d'écriture du STM32F407
+  *
+  *   Compilation :
+  *      gcc -O2 -Wno-int-to-pointer-cast -Iregsim -o flashbench flashbench.c regsim/regsim.c ../ADC-UART/FlashLog.c ../ADC-UART/CRC16.c ../ADC-UART/Trace.c
+  *
+  *   Utilisation :
+  *      flashbench [-v]
+  *
+  *   La Flash simulée reprend la zone du journal (4 secteurs de 128 Ko) : un effacement dure
+  *   de 1 à 2 s (DS8626, parallélisme x32), une écriture de demi-mot 16 µs, et une écriture ne
+  *   peut que faire passer des bits de 1 à 0. Banque unique : pendant un effacement ou une
+  *   écriture, le processeur, qui exécute depuis la Flash, est arrêté ; le temps simulé avance
+  *   d'autant.
+  *   Une boucle d'acquisition à période fixe journalise un échantillon par période tant que
+  *   l'hôte est absent, puis relit le journal entre deux échantillons à son retour, comme la
+  *   boucle principale de la carte. Deux politiques d'effacement sont comparées :
+  *      - "après acquisition" : effacement lancé juste après un échantillon (comportement
+  *        d'origine), les arrêts débordent sur les échéances suivantes ;
+  *      - "fenêtre" : effacement seulement dans une fenêtre d'inactivité, les périodes qu'il
+  *        couvre étant sautées à l'avance quand le journal a besoin d'un secteur.
+  *   La version à tâches (APP_RTOS) est simulée à part : la tâche de transport appelle
+  *   driver->idle toutes les 10 ms quand sa file est vide, avec Pipeline_IdleMs() comme fenêtre,
+  *   et réserve les périodes couvrant l'effacement (Pipeline_Reserve) que la tâche d'acquisition
+  *   saute après son acquisition suivante. Le cas "sans réservation" reprend l'ancien appel
+  *   FlashLog_Poll(Pipeline_IdleMs()) seul : sous 2 s de période, rien n'est jamais effacé.
+  *   Chaque cas vérifie la relecture (ordre, contenu, aucun doublon) et le bilan
+  *   journalisés = relus + écrasés + perdus ; avec la fenêtre, aucune échéance ne doit être
+  *   manquée. Un cas coupe l'alimentation au hasard, en écriture comme en effacement.
+  *   Le code de retour vaut 1 en cas d'écart (cas de référence exclus).
+  */
+#include "../ADC-UART/FlashLog.h"
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SECTOR_SIZE   0x20000u
+#define SECTORS       4
+#define ERASE_MIN_US  1000000ull      // Effacement d'un secteur de 128 Ko (x32) : 1 s typique
+#define ERASE_MAX_US  2000000ull      // 2 s au plus
+#define PROG_US       16ull           // Écriture d'un demi-mot (x16)
+#define REPLAY_US     2000ull         // Émission d'un enregistrement relu (trame de ~24 octets)
+#define LATE_US       5000ull         // Retard toléré sur une échéance (relecture en cours)
+#define IDLE_POLL_MS  10u             // Attente de la tâche de transport avant driver->idle (Pipeline.c)
+
+typedef enum {
+	POLICY_AFTER_SAMPLE,         // Effacement après chaque échantillon (référence)
+	POLICY_WINDOW,               // Boucle principale : fenêtre d'inactivité, périodes sautées
+	POLICY_RTOS_IDLE,            // Tâches : fenêtre de Pipeline_IdleMs() seule (référence)
+	POLICY_RTOS                  // Tâches : fenêtre réservée par Pipeline_Reserve()
+} Policy;
+
+typedef struct {
+	const char *name;
+	Policy   policy;
+	uint32_t period_ms;
+	uint32_t up_s;               // Hôte présent au démarrage
+	uint32_t absent_s;           // Puis absent
+	uint32_t back_s;             // Puis de retour
+	uint32_t cuts;               // Coupures d'alimentation pendant l'absence
+	int      expect_overwrite;   // Journal plein attendu
+} Case;
+
+// Échantillon journalisé (même taille que celui de la carte)
+typedef struct {
+	uint32_t t_ms;               // Horodatage (ms : plusieurs heures simulées)
+	uint16_t raw;
+	uint16_t channel;
+} Sample;
+
+static struct {
+	uint8_t  mem[SECTORS * SECTOR_SIZE];
+	uint64_t now;                // Temps simulé (µs)
+	uint64_t stalled;            // Temps processeur arrêté par la Flash
+	uint32_t erases, programs;
+	uint32_t bad_programs;       // Bit remis à 1 sans effacement
+	int64_t  cut_in;             // Opérations Flash avant la prochaine coupure (< 0 : aucune)
+	jmp_buf  power;
+} fl;
+
+static int verbose;
+
+// Horloge de la trace d'événements (TRACE_ERASE_BEGIN / _END)
+uint32_t Trace_Clock (void)
+{
+	return (uint32_t)fl.now;
+}
+
+static void power_check (void)
+{
+	if (fl.cut_in >= 0 && fl.cut_in-- == 0)
+		longjmp(fl.power, 1);
+}
+
+static void sim_erase_start (uint32_t sector)
+{
+	uint64_t us = ERASE_MIN_US + (uint64_t)rand() % (ERASE_MAX_US - ERASE_MIN_US + 1);
+
+	if (fl.cut_in == 0)
+		memset(&fl.mem[sector * SECTOR_SIZE], 0xFF, SECTOR_SIZE / 2);   // Effacement interrompu
+	power_check();
+	memset(&fl.mem[sector * SECTOR_SIZE], 0xFF, SECTOR_SIZE);
+	fl.now += us;                // Processeur arrêté jusqu'à la fin de l'effacement
+	fl.stalled += us;
+	fl.erases++;
+}
+
+static int sim_busy (void)
+{
+	return 0;                    // L'arrêt du processeur couvre déjà toute l'opération
+}
+
+static int sim_program16 (uint32_t offset, uint16_t value)
+{
+	uint16_t old;
+
+	if ((offset & 1) || offset + 2 > sizeof(fl.mem))
+		return -1;
+	power_check();
+	memcpy(&old, &fl.mem[offset], 2);
+	if ((old & value) != value)
+		fl.bad_programs++;
+	old &= value;
+	memcpy(&fl.mem[offset], &old, 2);
+	fl.now += PROG_US;
+	fl.stalled += PROG_US;
+	fl.programs++;
+	return 0;
+}
+
+static const FlashLog_Driver sim_driver = {
+	fl.mem,
+	SECTOR_SIZE,
+	SECTORS,
+	sim_erase_start,
+	sim_busy,
+	sim_program16
+};
+
+// Bilan d'un cas
+typedef struct {
+	uint32_t logged;             // Échantillons confiés au journal
+	uint32_t replayed;
+	uint32_t misses;             // Échéances manquées (arrêts non prévus)
+	uint32_t skipped;            // Périodes sautées pour un effacement
+	uint32_t disorder;           // Relecture hors ordre, doublon ou contenu faux
+	uint32_t lost_cut;           // Enregistrements perdus par coupure
+	uint32_t next_expected;      // Index du prochain échantillon attendu en relecture
+	uint64_t max_late;           // Retard maximal sur une échéance (µs)
+} Result;
+
+static int replay_one (Result *r, const Case *cs)
+{
+	Sample s;
+	uint16_t len;
+	uint32_t seq;
+
+	if (!FlashLog_Peek(&s, &len, &seq))
+		return 0;
+	uint32_t idx = s.t_ms / cs->period_ms;
+	if (len != sizeof(s) || s.raw != (uint16_t)(idx * 7u) || s.channel != 1 || idx < r->next_expected)
+		r->disorder++;
+	r->next_expected = idx + 1;
+	FlashLog_Consume();
+	r->replayed++;
+	fl.now += REPLAY_US;
+	return 1;
+}
+
+static int run (const Case *cs)
+{
+	const uint64_t period = cs->period_ms * 1000ull;
+	const uint64_t absent_from = cs->up_s * 1000000ull;
+	const uint64_t back_at = absent_from + cs->absent_s * 1000000ull;
+	const uint64_t end = back_at + cs->back_s * 1000000ull;
+	// État de la boucle hors pile : il doit survivre au longjmp d'une coupure
+	static uint64_t next;
+	static uint32_t index, cuts_left, reserve_ms;
+	static Result r;
+	const FlashLog_Stats *st;
+	int ok;
+
+	next = 0;
+	index = 0;
+	reserve_ms = 0;
+	cuts_left = cs->cuts;
+	memset(&r, 0, sizeof(r));
+	memset(&fl, 0, sizeof(fl));
+	memset(fl.mem, 0x5A, sizeof(fl.mem));     // Flash jamais préparée : aucun secteur valide
+	fl.cut_in = -1;
+	srand(1);
+	FlashLog_Init(&sim_driver);
+
+	// Coupure d'alimentation : redémarrage, le journal reprend son état depuis la Flash
+	if (setjmp(fl.power)) {
+		FlashLog_Init(&sim_driver);
+		fl.cut_in = -1;
+		// Les échantillons confiés mais absents de la Flash (file d'attente, écriture coupée)
+		r.lost_cut = r.logged - FlashLog_GetStats()->backlog - r.replayed;
+		fl.now = next;                         // Redémarrage immédiat
+	}
+
+	while (next < end) {
+		int host_up = next < absent_from || next >= back_at;
+
+		// Échéance : une acquisition en retard trahit un arrêt non prévu
+		if (fl.now > next + LATE_US) {
+			uint64_t late = fl.now - next;
+			if (late > r.max_late)
+				r.max_late = late;
+			r.misses += (uint32_t)((late + period - 1) / period);
+			next += (late / period) * period;
+			index += (uint32_t)(late / period);
+		}
+		if (fl.now < next)
+			fl.now = next;
+
+		if (!host_up) {
+			Sample s = { index * cs->period_ms, (uint16_t)(index * 7u), 1 };
+			if (FlashLog_Append(&s, sizeof(s)) == 0)
+				r.logged++;
+			if (cuts_left && rand() % 97 == 0) {
+				cuts_left--;
+				fl.cut_in = rand() % 40;       // Pendant l'une des prochaines opérations Flash
+			}
+		}
+		index++;
+		next += period;
+
+		if (cs->policy == POLICY_WINDOW) {
+			uint64_t idle = fl.now < next ? (next - fl.now) / 1000 : 0;
+			uint32_t erase_ms = FlashLog_EraseDue();
+			if (!host_up && erase_ms > idle) {
+				uint32_t skip = (uint32_t)((erase_ms - idle + cs->period_ms - 1) / cs->period_ms);
+				next += skip * period;
+				index += skip;
+				r.skipped += skip;
+			}
+			FlashLog_Poll(fl.now < next ? (uint32_t)((next - fl.now) / 1000) : 0);
+		} else if (cs->policy == POLICY_AFTER_SAMPLE) {
+			FlashLog_Poll(FLASHLOG_ERASE_MAX_MS);
+		} else if (reserve_ms) {
+			// Tâche d'acquisition : sauter les périodes couvrant la fenêtre réservée, traitement
+			// et attente du transport compris (Pipeline.c)
+			uint64_t want = fl.now + (reserve_ms + 2 * IDLE_POLL_MS) * 1000ull;
+			if (want > next) {
+				uint32_t skip = (uint32_t)((want - next + period - 1) / period);
+				next += skip * period;
+				index += skip;
+				r.skipped += skip;
+			}
+			reserve_ms = 0;
+		}
+
+		// Tâche de transport : driver->idle après IDLE_POLL_MS sans bloc à émettre
+		while (cs->policy >= POLICY_RTOS_IDLE && fl.now + IDLE_POLL_MS * 1000ull < next) {
+			uint32_t idle;
+
+			fl.now += IDLE_POLL_MS * 1000ull;
+			idle = (uint32_t)((next - fl.now) / 1000);
+			if (cs->policy == POLICY_RTOS && !host_up && FlashLog_EraseDue() > idle)
+				reserve_ms = FlashLog_EraseDue();
+			FlashLog_Poll(idle);
+			if (host_up)
+				replay_one(&r, cs);
+		}
+
+		// Jusqu'à l'échéance suivante : relecture si l'hôte est là
+		while (cs->policy <= POLICY_WINDOW && fl.now < next) {
+			FlashLog_Poll(cs->policy == POLICY_WINDOW ? (uint32_t)((next - fl.now) / 1000) : FLASHLOG_ERASE_MAX_MS);
+			if (!host_up || !replay_one(&r, cs))
+				break;
+		}
+	}
+
+	st = FlashLog_GetStats();
+	ok = fl.bad_programs == 0 && r.disorder == 0 && st->backlog == 0 && st->dropped == 0;
+	if (!cs->cuts)
+		ok &= r.logged == r.replayed + st->overwritten;
+	else
+		ok &= r.replayed + st->overwritten + r.lost_cut <= r.logged;
+	ok &= (st->overwritten != 0) == cs->expect_overwrite;
+	if (cs->policy == POLICY_WINDOW || cs->policy == POLICY_RTOS)
+		ok &= r.misses == 0;
+
+	printf("%-30s %7lu %7lu %6lu %6lu %5lu %6lu %6lu %7.2f s %7.1f s  %s\n", cs->name,
+	       (unsigned long)r.logged, (unsigned long)r.replayed, (unsigned long)st->overwritten,
+	       (unsigned long)(st->dropped + r.lost_cut), (unsigned long)fl.erases,
+	       (unsigned long)r.misses, (unsigned long)r.skipped, r.max_late / 1e6, fl.stalled / 1e6,
+	       ok ? "ok" : "ÉCART");
+	if (verbose)
+		printf("    écritures %lu (%.0f µs par enregistrement), coupures %lu, en attente %lu, désordre %lu\n",
+		       (unsigned long)fl.programs, r.logged ? fl.programs * (double)PROG_US / r.logged : 0.0,
+		       (unsigned long)cs->cuts, (unsigned long)st->backlog, (unsigned long)r.disorder);
+	return ok;
+}
+
+static const Case cases[] = {
+	{ "après acquisition, 1 s",  POLICY_AFTER_SAMPLE, 1000, 60, 7200, 3600, 0, 0 },
+	{ "fenêtre, 1 s",            POLICY_WINDOW,       1000, 60, 7200, 3600, 0, 0 },
+	{ "fenêtre, 5 s",            POLICY_WINDOW,       5000, 60, 36000, 3600, 0, 0 },
+	{ "fenêtre, journal plein",  POLICY_WINDOW,       1000, 60, 36000, 7200, 0, 1 },
+	{ "fenêtre, coupures",       POLICY_WINDOW,       1000, 60, 7200, 3600, 50, 0 },
+	{ "tâches sans réservation", POLICY_RTOS_IDLE,    1000, 60, 7200, 3600, 0, 0 },
+	{ "tâches, 1 s",             POLICY_RTOS,         1000, 60, 7200, 3600, 0, 0 },
+	{ "tâches, 100 ms",          POLICY_RTOS,         100,  60, 1200, 600, 0, 0 },
+	{ "tâches, journal plein",   POLICY_RTOS,         1000, 60, 36000, 7200, 0, 1 },
+};
+
+int main (int argc, char **argv)
+{
+	int fails = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-v"))
+			verbose = 1;
+		else {
+			fprintf(stderr, "usage: flashbench [-v]\n");
+			return 2;
+		}
+	}
+	printf("%-30s %7s %7s %6s %6s %5s %6s %6s %9s %9s\n", "cas", "journ.", "relus", "écras.",
+	       "perdus", "effac", "manqu.", "sautés", "retard", "arrêt");
+	for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		// Les politiques d'origine manquent des échéances ou perdent le journal par construction :
+		// cas de référence
+		int ok = run(&cases[i]);
+		if (cases[i].policy == POLICY_WINDOW || cases[i].policy == POLICY_RTOS)
+			fails += !ok;
+	}
+	return fails != 0;
+}
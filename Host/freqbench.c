@@ -0,0 +1,177 @@
+/**
+  * @brief  freqbench : validation de la mesure de fréquence de la carte (ADC-UART/Freq.c)
+  *
+  *   Compilation :
+  *      gcc -O2 -o freqbench freqbench.c ../ADC-UART/Freq.c -lm
+  *
+  *   Utilisation :
+  *      freqbench [-w fenêtres] [-v]
+  *
+  *   Des sinusoïdes et des signaux carrés de fréquence et de rapport cyclique connus sont
+  *   échantillonnés comme sur la carte en mode mesure : 42,7 kéch./s (ADC 12 bits, 480 cycles
+  *   d'échantillonnage à 21 MHz), blocs de 255 conversions séparés d'une courte pause, dates
+  *   en cycles d'un compteur 32 bits à 168 MHz qui reboucle pendant l'essai. Les carrés
+  *   passent par un filtre RC (front analogique) ; certains cas ajoutent un bruit gaussien.
+  *   Pour chaque cas : erreur de fréquence (ppm), gigue mesurée et rapport cyclique, comparés
+  *   à des tolérances ; le code de retour vaut 1 si une tolérance est dépassée.
+  *   Gigue résiduelle attendue sans bruit : quantification 12 bits sur les sinus lents (< 1 µs) ;
+  *   sur les carrés, fronts plus courts qu'une période d'échantillonnage, l'interpolation
+  *   linéaire laisse quelques µs selon la position du front, sans biais sur la fréquence.
+  */
+#define _GNU_SOURCE
+#include "../ADC-UART/Freq.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TICK_HZ     168000000u
+#define DT_TICKS    3936u         // 492 cycles ADC à 21 MHz, en cycles CPU
+#define BLOCK       255
+#define GAP_TICKS   504u          // Pause entre blocs (3 µs)
+
+typedef struct {
+	const char *name;
+	int      square;
+	double   freq;               // Hz
+	double   duty;               // Carré : part haute
+	double   noise;              // Écart-type du bruit (LSB)
+	double   tol_ppm;            // Tolérance sur la fréquence
+	double   tol_duty;           // Tolérance absolue sur le rapport cyclique
+} Case;
+
+static const Case cases[] = {
+	{ "sinus",        0,   50.0,   0.5,  0.0,  2.0, 0.001 },
+	{ "sinus",        0,   60.0,   0.5,  0.0,  2.0, 0.001 },
+	{ "sinus",        0,  400.0,   0.5,  0.0,  2.0, 0.001 },
+	{ "sinus",        0, 1234.567, 0.5,  0.0,  2.0, 0.001 },
+	{ "sinus bruité", 0,   50.0,   0.5,  3.0, 50.0, 0.005 },
+	{ "sinus bruité", 0, 1000.0,   0.5,  3.0, 50.0, 0.005 },
+	{ "carré",        1,   50.0,   0.5,  0.0,  2.0, 0.001 },
+	{ "carré",        1,  100.0,   0.25, 0.0,  2.0, 0.001 },
+	{ "carré",        1,  997.0,   0.75, 0.0,  5.0, 0.002 },
+	{ "carré bruité", 1,  250.0,   0.1,  5.0, 20.0, 0.005 },
+};
+
+static uint32_t rng = 12345;
+
+static double gauss (void)
+{
+	double u, v, s;
+	do {
+		rng = rng * 1664525u + 1013904223u;
+		u = (rng >> 8) / 8388608.0 - 1.0;
+		rng = rng * 1664525u + 1013904223u;
+		v = (rng >> 8) / 8388608.0 - 1.0;
+		s = u * u + v * v;
+	} while (s >= 1 || s == 0);
+	return u * sqrt(-2 * log(s) / s);
+}
+
+// Sortie du filtre RC entre t0 et t1 (s), intégrée exactement entre les fronts du carré
+static double rc_advance (const Case *c, double rc, double t0, double t1, double tau)
+{
+	while (t0 < t1) {
+		double ph = t0 * c->freq, cyc = floor(ph);
+		double target, edge, tn;
+
+		if (ph - cyc < c->duty) {
+			target = 3800;
+			edge = (cyc + c->duty) / c->freq;
+		} else {
+			target = 300;
+			edge = (cyc + 1) / c->freq;
+		}
+		tn = edge < t1 ? edge : t1;
+		if (tn <= t0)
+			tn = t0 + 1e-12;
+		rc = target + (rc - target) * exp(-(tn - t0) / tau);
+		t0 = tn;
+	}
+	return rc;
+}
+
+static int run (const Case *c, int windows, int verbose)
+{
+	Freq_Meter m;
+	Freq_Result r;
+	uint16_t x[BLOCK];
+	uint32_t tick = 0xF0000000u;  // Rebouclage du compteur après ~1,6 s
+	uint64_t t = 0;               // Temps absolu en cycles
+	double rc = 300, rc_t = 0;    // État du filtre RC et sa date (s)
+	double tau = 0.5 * DT_TICKS / TICK_HZ;  // Constante de temps : 0,5 échantillon
+	int n = 0, first = 1;
+	double jit = 0, jit_pp = 0, duty = 0, freq = 0;
+
+	Freq_Init(&m, 2048, c->square ? 200 : 40, TICK_HZ, 1000);
+
+	while (n < windows) {
+		for (int i = 0; i < BLOCK; i++) {
+			double ts = (double)(t + (uint64_t)i * DT_TICKS) / TICK_HZ;
+			double ph = fmod(ts * c->freq, 1.0), v;
+
+			if (c->square) {
+				rc = rc_advance(c, rc, rc_t, ts, tau);
+				rc_t = ts;
+				v = rc;
+			} else {
+				v = 2048 + 1500 * sin(2 * M_PI * ph);
+			}
+			v += c->noise * gauss();
+			x[i] = (uint16_t)(v < 0 ? 0 : v > 4095 ? 4095 : lrint(v));
+		}
+		if (Freq_Process(&m, x, BLOCK, tick, DT_TICKS * 256, &r)) {
+			if (first)
+				first = 0;            // Première fenêtre : démarrage, ignorée
+			else {
+				if (verbose) {
+					char line[160];
+					Freq_Format(&r, line, sizeof(line));
+					fputs(line, stdout);
+				}
+				freq += r.freq_hz;
+				jit += r.jitter_rms_us;
+				jit_pp = r.jitter_pp_us > jit_pp ? r.jitter_pp_us : jit_pp;
+				duty += r.duty;
+				n++;
+			}
+		}
+		t += (uint64_t)BLOCK * DT_TICKS + GAP_TICKS;
+		tick += BLOCK * DT_TICKS + GAP_TICKS;
+	}
+
+	freq /= n;
+	duty /= n;
+	jit /= n;
+	double err = (freq - c->freq) / c->freq * 1e6;
+	double derr = fabs(duty - c->duty);
+	int ok = fabs(err) <= c->tol_ppm && derr <= c->tol_duty;
+
+	printf("%-14s %10.3f %12.4f %9.2f %9.3f %9.3f %7.4f %7.4f  %s\n", c->name, c->freq, freq, err,
+	       jit, jit_pp, c->duty, duty, ok ? "ok" : "HORS TOLÉRANCE");
+	return ok;
+}
+
+int main (int argc, char **argv)
+{
+	int windows = 5, verbose = 0, fails = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-w") && i + 1 < argc)
+			windows = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-v"))
+			verbose = 1;
+		else {
+			fprintf(stderr, "usage: freqbench [-w fenêtres] [-v]\n");
+			return 2;
+		}
+	}
+	if (windows < 1)
+		windows = 1;
+
+	printf("%-14s %10s %12s %9s %9s %9s %7s %7s\n", "signal", "f (Hz)", "mesure (Hz)", "err ppm",
+	       "gigue µs", "pp µs", "cycl.", "mesure");
+	for (unsigned k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+		fails += !run(&cases[k], windows, verbose);
+	return fails != 0;
+}
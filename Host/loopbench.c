@@ -0,0 +1,341 @@
+/**
+  * @brief  loopbench : validation de l'analyse de l'autotest DAC -> ADC (ADC-UART/Loopback.c)
+  *
+  *   Compilation :
+  *      gcc -O2 -o loopbench loopbench.c ../ADC-UART/Loopback.c -lm
+  *
+  *   Utilisation :
+  *      loopbench [-k échantillons par code] [-v]
+  *
+  *   Les essais de la carte (paliers continus, rampe code par code, sinus cohérent tiré de
+  *   Loopback_SineTable) sont rejoués sur un modèle d'ADC de 12 bits : décalage et erreur de
+  *   gain injectés, transitions déplacées par une courbure (INL) et au hasard, chacune
+  *   indépendamment (DNL), un code manquant, bruit gaussien à l'entrée. Le DAC est idéal.
+  *   Les erreurs de transition sont rendues orthogonales à une droite sur la plage de
+  *   l'essai, qui reste proche de la droite injectée.
+  *   Les résultats sont comparés à la vérité du modèle : droite des sorties moyennes attendues
+  *   sur les paliers (décalage, gain), extrêmes de l'INL par rapport à elle et de la DNL sur
+  *   les codes évalués, codes manquants. Pour le sinus, la vérité est calculée sur le modèle
+  *   lui-même : pour chaque code de la table, moyenne et variance exactes de la sortie (loi des
+  *   codes de sortie sous le bruit gaussien), puis fondamentale, harmoniques et résidu de ces
+  *   moyennes, le bruit ajoutant sa variance au résidu et 2 s^2 / N à chaque raie harmonique.
+  *   ENOB et THD attendus couvrent ainsi tous les cas, courbure, transitions déplacées et code
+  *   manquant compris ; avec le seul bruit, l'ENOB retrouve 12 - log2(2 + 12 s^2) / 2
+  *   (quantification de la table du DAC, de l'ADC et bruit), et avec la courbure, le THD
+  *   retrouve 20 log(B / 2R). Le code de retour vaut 1 en cas d'écart.
+  */
+#include "../ADC-UART/Loopback.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BITS        12
+#define CODES       (1 << BITS)
+#define LO          256           // Mêmes valeurs par défaut que App_Config.h
+#define HI          3840
+#define DC_STEPS    16
+#define DC_SAMPLES  256
+#define SINE_TABLE  256
+#define SINE_CYCLES 7
+#define SINE_BLOCK  2048
+
+typedef struct {
+	const char *name;
+	double offset;            // LSB
+	double gain_err;          // Relatif
+	double noise;             // Écart-type (LSB)
+	double bow;               // Courbure de l'INL, valeur crête (LSB)
+	double dnl;               // Écart-type du déplacement de chaque transition (LSB)
+	int    missing_code;      // Code rendu absent (0 : aucun)
+} Case;
+
+static const Case cases[] = {
+	{ "idéal, bruit 0,5 LSB",    0.0,  0.0,   0.5, 0.0, 0.0,     0 },
+	{ "décalage et gain",       12.3, -0.008, 1.0, 0.0, 0.0,     0 },
+	{ "courbure INL 2 LSB",     -3.0,  0.002, 0.7, 2.0, 0.0,     0 },
+	{ "transitions 0,2 LSB",     0.0,  0.0,   0.7, 0.0, 0.2,     0 },
+	{ "code manquant",           0.0,  0.0,   0.3, 0.0, 0.05, 2050 },
+	{ "bruit élevé 2 LSB",       5.0,  0.01,  2.0, 0.0, 0.0,     0 },
+};
+
+static uint32_t rng = 4321;
+
+static double uni (void)
+{
+	rng = rng * 1664525u + 1013904223u;
+	return ((rng >> 8) + 0.5) / 16777216.0;
+}
+
+static double gauss (void)
+{
+	double u, v, s;
+	do {
+		u = 2 * uni() - 1;
+		v = 2 * uni() - 1;
+		s = u * u + v * v;
+	} while (s >= 1 || s == 0);
+	return u * sqrt(-2 * log(s) / s);
+}
+
+// Modèle : transition t[c] entre les codes c - 1 et c (c = 1 .. CODES - 1)
+static double t[CODES + 1];
+static const Case *model;
+
+static uint16_t convert (double u)
+{
+	double v = model->offset + (1 + model->gain_err) * u + model->noise * gauss();
+	int c = (int)floor(v + 0.5);
+
+	if (c < 0)
+		c = 0;
+	if (c > CODES - 1)
+		c = CODES - 1;
+	while (c > 0 && v < t[c])
+		c--;
+	while (c < CODES - 1 && v >= t[c + 1])
+		c++;
+	return (uint16_t)c;
+}
+
+// Sortie moyenne attendue pour le code DAC u : nombre moyen de transitions franchies
+static double expected (double u)
+{
+	double v = model->offset + (1 + model->gain_err) * u, sum = 0;
+
+	for (int k = 1; k < CODES; k++) {
+		if (model->noise > 0)
+			sum += 0.5 * erfc((t[k] - v) / (model->noise * sqrt(2)));
+		else
+			sum += v >= t[k];
+	}
+	return sum;
+}
+
+// Moyenne et variance exactes de la sortie pour le code DAC u (loi des codes sous le bruit)
+static void moments (double u, double *mean, double *var)
+{
+	double v = model->offset + (1 + model->gain_err) * u, s1 = 0, s2 = 0;
+	int c0 = (int)floor(v - 12 * model->noise) - 8, c1 = (int)ceil(v + 12 * model->noise) + 8;
+
+	if (c0 < 0)
+		c0 = 0;
+	if (c1 > CODES - 1)
+		c1 = CODES - 1;
+	for (int c = c0; c <= c1; c++) {
+		double lo = c == c0 ? -1e9 : t[c], hi = c == c1 ? 1e9 : t[c + 1], p;
+		if (model->noise > 0)
+			p = 0.5 * (erfc((lo - v) / (model->noise * sqrt(2))) - erfc((hi - v) / (model->noise * sqrt(2))));
+		else
+			p = v >= lo && v < hi;
+		s1 += p * c;
+		s2 += p * (double)c * c;
+	}
+	*mean = s1;
+	*var = s2 - s1 * s1;
+}
+
+/**
+  * @brief ENOB et THD attendus du sinus : raies des sorties moyennes sur une période de la table,
+  *        mêmes harmoniques que Loopback_SineFit ; le bruit ajoute sa variance moyenne au résidu
+  *        et 2 var / N à chaque raie harmonique (N échantillons analysés)
+  * @param h_det : Puissance des harmoniques des sorties moyennes, relative à la fondamentale
+  * @param h_noise : Puissance moyenne du bruit sur les raies harmoniques, relative
+  */
+static void sine_truth (const uint16_t *table, double *enob, double *h_det, double *h_noise)
+{
+	double m[SINE_TABLE], mean = 0, var = 0, p_ac = 0, p1 = 0, ph = 0, pb = 0, pn;
+	uint32_t folds[LOOPBACK_HARMONICS], harmonics = 0;
+
+	for (int i = 0; i < SINE_TABLE; i++) {
+		double v;
+		moments(table[i], &m[i], &v);
+		mean += m[i] / SINE_TABLE;
+		var += v / SINE_TABLE;
+	}
+	for (int i = 0; i < SINE_TABLE; i++)
+		p_ac += (m[i] - mean) * (m[i] - mean) / SINE_TABLE;
+	for (uint32_t k = 1; k <= LOOPBACK_HARMONICS; k++) {
+		uint32_t bin = k * SINE_CYCLES % SINE_TABLE, j;
+		uint32_t fold = bin <= SINE_TABLE / 2 ? bin : SINE_TABLE - bin;
+		double a = 0, b = 0;
+
+		for (j = 0; j < harmonics && folds[j] != fold; j++)
+			;
+		if (fold == 0 || 2 * fold == SINE_TABLE || j < harmonics)
+			continue;
+		folds[harmonics++] = fold;
+		for (int i = 0; i < SINE_TABLE; i++) {
+			a += (m[i] - mean) * cos(2 * M_PI * bin * i / SINE_TABLE) * 2 / SINE_TABLE;
+			b += (m[i] - mean) * sin(2 * M_PI * bin * i / SINE_TABLE) * 2 / SINE_TABLE;
+		}
+		if (k == 1)
+			p1 = (a * a + b * b) / 2;
+		else {
+			ph += (a * a + b * b) / 2;
+			pb += 2 * var / SINE_BLOCK;
+		}
+	}
+	pn = p_ac + var - p1;
+	*h_det = ph / p1;
+	*h_noise = pb / p1;
+	*enob = (10 * log10(p1 / pn) - 1.76 + 20 * log10(CODES / 2 / sqrt(2 * p1))) / 6.02;
+}
+
+static void build_model (const Case *c)
+{
+	double gain = 1 + c->gain_err;
+	int clo = (int)(c->offset + gain * LO), chi = (int)(c->offset + gain * HI);
+	double m = (clo + chi) / 2.0, r = (chi - clo) / 2.0;
+	double e[CODES + 1], sx = 0, sy = 0, sxx = 0, sxy = 0, n = 0, a, b;
+
+	model = c;
+	for (int k = 1; k < CODES; k++) {
+		double w = (k - m) / r;
+		e[k] = c->bow * (w * w - 1.0 / 3) + c->dnl * gauss();
+	}
+	if (c->missing_code) {
+		// Largeur nulle, les autres largeurs inchangées
+		double shift = e[c->missing_code] - 1 - e[c->missing_code + 1];
+		for (int k = c->missing_code + 1; k < CODES; k++)
+			e[k] += shift;
+	}
+	for (int k = clo; k <= chi; k++) {
+		sx += k; sy += e[k]; sxx += (double)k * k; sxy += k * e[k]; n++;
+	}
+	b = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+	a = (sy - b * sx) / n;
+	if (c->bow == 0 && c->dnl == 0 && !c->missing_code)
+		a = b = 0;
+	for (int k = 1; k < CODES; k++)
+		t[k] = k - 0.5 + e[k] - (a + b * k);
+	if (c->missing_code)
+		t[c->missing_code + 1] = t[c->missing_code];
+	for (int k = 2; k < CODES; k++)
+		if (t[k] < t[k - 1])
+			t[k] = t[k - 1];                     // Transitions croissantes : largeur nulle au plus
+	t[0] = -1e9;
+	t[CODES] = 1e9;
+}
+
+static int run (const Case *c, uint32_t per_code, int verbose)
+{
+	static uint16_t buf[SINE_BLOCK], table[SINE_TABLE];
+	double gain = 1 + c->gain_err;
+	Loopback_Dc dc;
+	Loopback_Lin lin;
+	Loopback_Sine sine;
+	double inl_min = 1e9, inl_max = -1e9, dnl_min = 1e9, dnl_max = -1e9;
+	double sx = 0, sy = 0, sxx = 0, sxy = 0, n = DC_STEPS, off_t, gain_t;
+	uint32_t missing = 0, narrow = 0;
+	char line[200];
+	int ok = 1;
+
+	build_model(c);
+
+	Loopback_DcInit(&dc);
+	for (int s = 0; s < DC_STEPS; s++) {
+		uint16_t code = (uint16_t)(LO + (HI - LO) * s / (DC_STEPS - 1));
+		for (int i = 0; i < DC_SAMPLES; i++)
+			buf[i] = convert(code);
+		Loopback_DcAdd(&dc, code, buf, DC_SAMPLES);
+	}
+	Loopback_DcEnd(&dc, 1.0f);
+
+	Loopback_LinInit(&lin, &dc, LO, HI, per_code);
+	for (int code = LO; code <= HI; code++) {
+		for (uint32_t i = 0; i < per_code; i++)
+			buf[i] = convert(code);
+		Loopback_LinAdd(&lin, buf);
+	}
+	Loopback_LinEnd(&lin);
+
+	Loopback_SineTable(table, SINE_TABLE, SINE_CYCLES, LO, HI);
+	for (int i = 0; i < SINE_BLOCK; i++)
+		buf[i] = convert(table[i % SINE_TABLE]);
+	Loopback_SineFit(buf, SINE_BLOCK, SINE_CYCLES * (SINE_BLOCK / SINE_TABLE), BITS, &sine);
+
+	// Vérité : droite des paliers sans bruit d'estimation, puis INL et DNL par rapport à elle
+	// sur les codes que l'analyse évalue (transitions dans la plage utile de la rampe)
+	for (int s = 0; s < DC_STEPS; s++) {
+		double u = LO + (HI - LO) * s / (DC_STEPS - 1), y = expected(u);
+		sx += u; sy += y; sxx += u * u; sxy += u * y;
+	}
+	gain_t = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+	off_t = (sy - gain_t * sx) / n;
+	for (int k = 1; k < CODES - 1; k++) {
+		double u0 = (t[k] - c->offset) / gain, u1 = (t[k + 1] - c->offset) / gain;
+		if (u0 < LO + LOOPBACK_MARGIN || u1 > HI - LOOPBACK_MARGIN)
+			continue;
+		double inl = off_t + gain_t * u0 - (k - 0.5), dnl = gain_t * (u1 - u0) - 1;
+		if (inl < inl_min) inl_min = inl;
+		if (inl > inl_max) inl_max = inl;
+		if (dnl < dnl_min) dnl_min = dnl;
+		if (dnl > dnl_max) dnl_max = dnl;
+		missing += t[k + 1] == t[k];
+		narrow += t[k + 1] > t[k] && t[k + 1] - t[k] < 3.0 / per_code;
+	}
+
+	// Incertitude de comptage : écart-type d'une transition sqrt(0,56 s / per_code) LSB environ,
+	// d'une largeur 1 / sqrt(per_code) au plus ; extrêmes sur quelques milliers de codes. Un
+	// code très étroit (moins de 3 / per_code LSB) peut ne recevoir aucun échantillon.
+	double tol_inl = 0.1 + 4.5 * sqrt((0.6 * c->noise + 0.1) / per_code);
+	double tol_dnl = 0.1 + 4.5 / sqrt(per_code);
+	ok &= fabs(dc.offset - off_t) < 0.2;
+	ok &= fabs(dc.gain_err - (gain_t - 1)) < 1e-4;
+	ok &= fabs(lin.inl_min - inl_min) < tol_inl && fabs(lin.inl_max - inl_max) < tol_inl;
+	ok &= fabs(lin.dnl_min - dnl_min) < tol_dnl && fabs(lin.dnl_max - dnl_max) < tol_dnl;
+	ok &= lin.missing >= missing && lin.missing <= missing + narrow && lin.outliers == 0;
+
+	// THD : le bruit sur les 4 harmoniques suit un chi-deux à 8 degrés de liberté, au plus 3,3 fois
+	// sa moyenne (quantile 99,9 %) ; il s'ajoute en amplitude aux raies déterministes, estimées à
+	// 1 dB près. Sous le bruit, seule la borne haute a un sens.
+	double enob_th, h_det, h_noise;
+	sine_truth(table, &enob_th, &h_det, &h_noise);
+	double thd_th = 10 * log10(h_det + h_noise);
+	double thd_lo = h_det > 10 * h_noise ? 20 * log10(sqrt(0.79 * h_det) - sqrt(3.3 * h_noise)) : -200;
+	double thd_hi = 20 * log10(sqrt(1.26 * h_det) + sqrt(3.3 * h_noise));
+	ok &= fabs(sine.enob - enob_th) < 0.1;
+	ok &= sine.thd >= thd_lo && sine.thd <= thd_hi;
+
+	if (verbose) {
+		Loopback_FormatDc(&dc, line, sizeof(line));
+		fputs(line, stdout);
+		Loopback_FormatLin(&lin, line, sizeof(line));
+		fputs(line, stdout);
+		Loopback_FormatSine(&sine, line, sizeof(line));
+		fputs(line, stdout);
+	}
+	printf("%-24s %+6.2f/%+6.2f %+6.3f/%+6.3f %+5.2f..%+5.2f/%+5.2f..%+5.2f %+5.2f..%+5.2f/%+5.2f..%+5.2f %2lu/%2lu %5.2f/%5.2f %6.1f/%6.1f  %s\n",
+	       c->name, off_t, dc.offset, (gain_t - 1) * 100, dc.gain_err * 100,
+	       inl_min, inl_max, lin.inl_min, lin.inl_max, dnl_min, dnl_max, lin.dnl_min, lin.dnl_max,
+	       (unsigned long)missing, (unsigned long)lin.missing,
+	       enob_th, sine.enob, thd_th, sine.thd,
+	       ok ? "ok" : "ÉCART");
+	return ok;
+}
+
+int main (int argc, char **argv)
+{
+	uint32_t per_code = 64;
+	int verbose = 0, fails = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-k") && i + 1 < argc)
+			per_code = (uint32_t)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-v"))
+			verbose = 1;
+		else {
+			fprintf(stderr, "usage: loopbench [-k échantillons par code] [-v]\n");
+			return 2;
+		}
+	}
+	if (per_code < 1 || per_code > SINE_BLOCK)
+		per_code = 64;
+
+	printf("%-24s %13s %13s %26s %26s %5s %11s %13s\n", "cas (vrai/mesuré)", "décalage",
+	       "gain %", "INL min..max", "DNL min..max", "manq.", "ENOB", "THD dB");
+	for (unsigned k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+		fails += !run(&cases[k], per_code, verbose);
+	return fails != 0;
+}
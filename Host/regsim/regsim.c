@@ -0,0 +1,85 @@
+/**
+  * @brief  regsim : instances en RAM des périphériques du STM32F407 et intrinsèques du coeur,
+  *         pour exécuter sur PC les pilotes de la carte (voir stm32f4xx.h)
+  *
+  *   Les registres partent de leurs valeurs après reset (HSI seule, PLL et périphériques
+  *   arrêtés) ; le banc y place ensuite les drapeaux dont les pilotes attendent le passage.
+  *   Les interruptions ne sont jamais masquées pour de bon : le banc est monotâche et appelle
+  *   lui-même les gestionnaires.
+  */
+#include "stm32f4xx.h"
+#include <stdlib.h>
+#include <string.h>
+
+Regsim regsim;
+uint32_t SystemCoreClock = 16000000u;
+
+static uint32_t primask;
+
+/**
+  * @brief Remettre tous les périphériques dans leur état après reset
+  */
+void Regsim_Reset (void)
+{
+	memset(&regsim, 0, sizeof regsim);
+	regsim.rcc.CR = RCC_CR_HSION | RCC_CR_HSIRDY | (0x10u << 3);   // HSITRIM = 16
+	regsim.rcc.PLLCFGR = 0x24003010u;
+	regsim.rcc.CSR = RCC_CSR_PORRSTF | RCC_CSR_PINRSTF;
+	regsim.flash.CR = FLASH_CR_LOCK;
+	regsim.usart1.SR = regsim.usart2.SR = regsim.usart3.SR = regsim.usart6.SR = 0xC0u;   // TXE, TC
+	SystemCoreClock = 16000000u;
+	primask = 0;
+}
+
+void NVIC_EnableIRQ (IRQn_Type irq)
+{
+	if (irq >= 0)
+		regsim.nvic_enabled[irq >> 5] |= 1u << (irq & 31);
+}
+
+void NVIC_DisableIRQ (IRQn_Type irq)
+{
+	if (irq >= 0)
+		regsim.nvic_enabled[irq >> 5] &= ~(1u << (irq & 31));
+}
+
+/**
+  * @brief  Interruption activée au NVIC (propre au modèle, pour les vérifications du banc)
+  * @retval 1 si activée, 0 sinon
+  */
+int NVIC_IsEnabled (IRQn_Type irq)
+{
+	return irq >= 0 && (regsim.nvic_enabled[irq >> 5] >> (irq & 31) & 1u);
+}
+
+void NVIC_SetPriority (IRQn_Type irq, uint32_t prio) { (void)irq; (void)prio; }
+void NVIC_ClearPendingIRQ (IRQn_Type irq) { (void)irq; }
+
+void NVIC_SystemReset (void)
+{
+	abort();
+}
+
+uint32_t SysTick_Config (uint32_t ticks)
+{
+	if (ticks - 1u > 0xFFFFFFu)
+		return 1;
+	regsim.systick.LOAD = ticks - 1u;
+	regsim.systick.VAL = 0;
+	regsim.systick.CTRL = 7u;   // CLKSOURCE, TICKINT, ENABLE
+	return 0;
+}
+
+void SystemCoreClockUpdate (void) { }
+
+uint32_t __get_MSP (void) { return 0; }
+uint32_t __get_IPSR (void) { return 0; }
+uint32_t __get_PRIMASK (void) { return primask; }
+void __set_PRIMASK (uint32_t v) { primask = v & 1u; }
+void __disable_irq (void) { primask = 1; }
+void __enable_irq (void) { primask = 0; }
+void __DSB (void) { }
+void __ISB (void) { }
+void __DMB (void) { }
+void __WFI (void) { }
+void __NOP (void) { }
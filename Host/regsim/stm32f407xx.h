@@ -0,0 +1,6 @@
+#ifndef REGSIM_STM32F407XX_H
+#define REGSIM_STM32F407XX_H
+
+#include "stm32f4xx.h"             // Modèle de registres (regsim.c)
+
+#endif /* REGSIM_STM32F407XX_H */
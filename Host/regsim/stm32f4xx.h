@@ -0,0 +1,239 @@
+#ifndef REGSIM_STM32F4XX_H
+#define REGSIM_STM32F4XX_H
+
+#include <stdint.h>
+
+/**
+  * @brief Modèle de registres du STM32F407 pour compiler et exécuter sur PC les pilotes de la
+  *        carte (ADC-UART) dans les bancs de Host/
+  *        Chaque périphérique est une instance en RAM (regsim.c) à la place de son adresse fixe :
+  *        les écritures des pilotes s'y retrouvent telles quelles et le banc peut les relire ou
+  *        y placer les drapeaux attendus. Aucun comportement matériel n'est simulé ; une boucle
+  *        d'attente sur un drapeau que le banc ne positionne pas ne se termine pas.
+  *        Seuls les registres, bits et intrinsèques employés par les pilotes sont décrits.
+  */
+
+#define __IO    volatile
+#define __I     volatile const
+
+typedef struct { __IO uint32_t CR, PLLCFGR, CFGR, CIR, AHB1RSTR, AHB2RSTR, AHB3RSTR, R0, APB1RSTR, APB2RSTR, R1[2],
+                 AHB1ENR, AHB2ENR, AHB3ENR, R2, APB1ENR, APB2ENR, R3[2], AHB1LPENR, AHB2LPENR, AHB3LPENR, R4,
+                 APB1LPENR, APB2LPENR, R5[2], BDCR, CSR, R6[2], SSCGR, PLLI2SCFGR; } RCC_TypeDef;
+typedef struct { __IO uint32_t CR, CSR; } PWR_TypeDef;
+typedef struct { __IO uint32_t ACR, KEYR, OPTKEYR, SR, CR, OPTCR; } FLASH_TypeDef;
+typedef struct { __IO uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2]; } GPIO_TypeDef;
+typedef struct { __IO uint32_t SR, CR1, CR2, SMPR1, SMPR2, JOFR1, JOFR2, JOFR3, JOFR4, HTR, LTR, SQR1, SQR2, SQR3,
+                 JSQR, JDR1, JDR2, JDR3, JDR4, DR; } ADC_TypeDef;
+typedef struct { __IO uint32_t CSR, CCR, CDR; } ADC_Common_TypeDef;
+typedef struct { __IO uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR, CCR1, CCR2,
+                 CCR3, CCR4, BDTR, DCR, DMAR, OR; } TIM_TypeDef;
+typedef struct { __IO uint32_t SR, DR, BRR, CR1, CR2, CR3, GTPR; } USART_TypeDef;
+typedef struct { __IO uint32_t CR, NDTR, PAR, M0AR, M1AR, FCR; } DMA_Stream_TypeDef;
+typedef struct { __IO uint32_t LISR, HISR, LIFCR, HIFCR; } DMA_TypeDef;
+typedef struct { __IO uint32_t CTRL, CYCCNT, CPICNT, EXCCNT, SLEEPCNT, LSUCNT, FOLDCNT, PCSR; } DWT_Type;
+typedef struct { __IO uint32_t DHCSR, DCRSR, DCRDR, DEMCR; } CoreDebug_Type;
+typedef struct { __IO uint32_t CPUID, ICSR, VTOR, AIRCR, SCR, CCR; __IO uint8_t SHP[12];
+                 __IO uint32_t SHCSR, CFSR, HFSR, DFSR, MMFAR, BFAR, AFSR; } SCB_Type;
+typedef struct { __IO uint32_t IMR, EMR, RTSR, FTSR, SWIER, PR; } EXTI_TypeDef;
+typedef struct { __IO uint32_t MEMRMP, PMC, EXTICR[4], R[2], CMPCR; } SYSCFG_TypeDef;
+typedef struct { __IO uint32_t CR, SWTRIGR, DHR12R1, DHR12L1, DHR8R1, DHR12R2, DHR12L2, DHR8R2, DHR12RD, DHR12LD,
+                 DHR8RD, DOR1, DOR2, SR; } DAC_TypeDef;
+typedef struct { __IO uint32_t KR, PR, RLR, SR; } IWDG_TypeDef;
+typedef struct { __IO uint32_t CTRL, LOAD, VAL, CALIB; } SysTick_Type;
+typedef struct { __IO uint32_t TR, DR, CR, ISR, PRER, WUTR, CALIBR, ALRMAR, ALRMBR, WPR, SSR, SHIFTR, TSTR, TSDR,
+                 TSSSR, CALR, TAFCR, ALRMASSR, ALRMBSSR, R, BKP0R; } RTC_TypeDef;
+
+/* Instances (regsim.c) */
+typedef struct {
+	RCC_TypeDef        rcc;
+	PWR_TypeDef        pwr;
+	FLASH_TypeDef      flash;
+	GPIO_TypeDef       gpioa, gpiob, gpioc, gpiod;
+	ADC_TypeDef        adc1;
+	ADC_Common_TypeDef adc;
+	TIM_TypeDef        tim2, tim3, tim4, tim5, tim6, tim7;
+	USART_TypeDef      usart1, usart2, usart3, usart6;
+	DMA_TypeDef        dma1, dma2;
+	DMA_Stream_TypeDef dma1_stream[8], dma2_stream[8];
+	DWT_Type           dwt;
+	CoreDebug_Type     coredebug;
+	SCB_Type           scb;
+	EXTI_TypeDef       exti;
+	SYSCFG_TypeDef     syscfg;
+	DAC_TypeDef        dac;
+	IWDG_TypeDef       iwdg;
+	SysTick_Type       systick;
+	RTC_TypeDef        rtc;
+	uint32_t           bkpsram[1024];         // 4 Ko de RAM sauvegardée
+	uint32_t           nvic_enabled[3];       // Un bit par IRQn activée (NVIC_EnableIRQ)
+} Regsim;
+
+extern Regsim regsim;
+
+void Regsim_Reset(void);
+
+#define RCC             (&regsim.rcc)
+#define PWR             (&regsim.pwr)
+#define FLASH           (&regsim.flash)
+#define GPIOA           (&regsim.gpioa)
+#define GPIOB           (&regsim.gpiob)
+#define GPIOC           (&regsim.gpioc)
+#define GPIOD           (&regsim.gpiod)
+#define ADC1            (&regsim.adc1)
+#define ADC             (&regsim.adc)
+#define TIM2            (&regsim.tim2)
+#define TIM3            (&regsim.tim3)
+#define TIM4            (&regsim.tim4)
+#define TIM5            (&regsim.tim5)
+#define TIM6            (&regsim.tim6)
+#define TIM7            (&regsim.tim7)
+#define USART1          (&regsim.usart1)
+#define USART2          (&regsim.usart2)
+#define USART3          (&regsim.usart3)
+#define USART6          (&regsim.usart6)
+#define DMA1            (&regsim.dma1)
+#define DMA2            (&regsim.dma2)
+#define DMA1_Stream0    (&regsim.dma1_stream[0])
+#define DMA1_Stream1    (&regsim.dma1_stream[1])
+#define DMA1_Stream2    (&regsim.dma1_stream[2])
+#define DMA1_Stream3    (&regsim.dma1_stream[3])
+#define DMA1_Stream4    (&regsim.dma1_stream[4])
+#define DMA1_Stream5    (&regsim.dma1_stream[5])
+#define DMA1_Stream6    (&regsim.dma1_stream[6])
+#define DMA1_Stream7    (&regsim.dma1_stream[7])
+#define DMA2_Stream0    (&regsim.dma2_stream[0])
+#define DMA2_Stream1    (&regsim.dma2_stream[1])
+#define DMA2_Stream2    (&regsim.dma2_stream[2])
+#define DMA2_Stream3    (&regsim.dma2_stream[3])
+#define DMA2_Stream4    (&regsim.dma2_stream[4])
+#define DMA2_Stream5    (&regsim.dma2_stream[5])
+#define DMA2_Stream6    (&regsim.dma2_stream[6])
+#define DMA2_Stream7    (&regsim.dma2_stream[7])
+#define DWT             (&regsim.dwt)
+#define CoreDebug       (&regsim.coredebug)
+#define SCB             (&regsim.scb)
+#define EXTI            (&regsim.exti)
+#define SYSCFG          (&regsim.syscfg)
+#define DAC             (&regsim.dac)
+#define IWDG            (&regsim.iwdg)
+#define SysTick         (&regsim.systick)
+#define RTC             (&regsim.rtc)
+#define BKPSRAM_BASE    ((uintptr_t)regsim.bkpsram)
+
+typedef enum {
+	HardFault_IRQn     = -13,
+	SysTick_IRQn       = -1,
+	EXTI0_IRQn         = 6,
+	DMA1_Stream1_IRQn  = 12,
+	DMA1_Stream5_IRQn  = 16,
+	DMA1_Stream6_IRQn  = 17,
+	ADC_IRQn           = 18,
+	EXTI9_5_IRQn       = 23,
+	TIM2_IRQn          = 28,
+	TIM3_IRQn          = 29,
+	USART1_IRQn        = 37,
+	USART2_IRQn        = 38,
+	EXTI15_10_IRQn     = 40,
+	TIM5_IRQn          = 50,
+	TIM6_DAC_IRQn      = 54,
+	TIM7_IRQn          = 55,
+	DMA2_Stream0_IRQn  = 56,
+	DMA2_Stream1_IRQn  = 57,
+	DMA2_Stream2_IRQn  = 58,
+	DMA2_Stream5_IRQn  = 68,
+	DMA2_Stream6_IRQn  = 69,
+	DMA2_Stream7_IRQn  = 70,
+	USART6_IRQn        = 71
+} IRQn_Type;
+
+void     NVIC_EnableIRQ(IRQn_Type irq);
+void     NVIC_DisableIRQ(IRQn_Type irq);
+int      NVIC_IsEnabled(IRQn_Type irq);
+void     NVIC_SetPriority(IRQn_Type irq, uint32_t prio);
+void     NVIC_ClearPendingIRQ(IRQn_Type irq);
+void     NVIC_SystemReset(void);
+uint32_t SysTick_Config(uint32_t ticks);
+
+uint32_t __get_MSP(void);
+uint32_t __get_IPSR(void);
+uint32_t __get_PRIMASK(void);
+void     __set_PRIMASK(uint32_t primask);
+void     __disable_irq(void);
+void     __enable_irq(void);
+void     __DSB(void);
+void     __ISB(void);
+void     __DMB(void);
+void     __WFI(void);
+void     __NOP(void);
+
+extern uint32_t SystemCoreClock;
+void SystemCoreClockUpdate(void);
+
+/* Bits employés par les pilotes (RM0090) */
+#define RCC_CR_HSION                (1u << 0)
+#define RCC_CR_HSIRDY               (1u << 1)
+#define RCC_CR_HSEON                (1u << 16)
+#define RCC_CR_HSERDY               (1u << 17)
+#define RCC_CR_CSSON                (1u << 19)
+#define RCC_CR_PLLON                (1u << 24)
+#define RCC_CR_PLLRDY               (1u << 25)
+#define RCC_PLLCFGR_PLLSRC_HSI      0u
+#define RCC_PLLCFGR_PLLSRC_HSE      (1u << 22)
+#define RCC_CFGR_SW                 (3u << 0)
+#define RCC_CFGR_SW_HSI             0u
+#define RCC_CFGR_SW_HSE             1u
+#define RCC_CFGR_SW_PLL             2u
+#define RCC_CFGR_SWS                (3u << 2)
+#define RCC_CFGR_SWS_HSI            (0u << 2)
+#define RCC_CFGR_SWS_HSE            (1u << 2)
+#define RCC_CFGR_SWS_PLL            (2u << 2)
+#define RCC_CFGR_HPRE               (0xFu << 4)
+#define RCC_CFGR_HPRE_DIV1          0u
+#define RCC_CFGR_PPRE1              (7u << 10)
+#define RCC_CFGR_PPRE1_DIV4         (5u << 10)
+#define RCC_CFGR_PPRE2              (7u << 13)
+#define RCC_CFGR_PPRE2_DIV2         (4u << 13)
+#define RCC_AHB1ENR_BKPSRAMEN       (1u << 18)
+#define RCC_AHB1ENR_CCMDATARAMEN    (1u << 20)
+#define RCC_APB1ENR_PWREN           (1u << 28)
+#define RCC_CSR_RMVF                (1u << 24)
+#define RCC_CSR_BORRSTF             (1u << 25)
+#define RCC_CSR_PINRSTF             (1u << 26)
+#define RCC_CSR_PORRSTF             (1u << 27)
+#define RCC_CSR_SFTRSTF             (1u << 28)
+#define RCC_CSR_IWDGRSTF            (1u << 29)
+#define RCC_CSR_WWDGRSTF            (1u << 30)
+#define RCC_CSR_LPWRRSTF            (1u << 31)
+#define PWR_CR_DBP                  (1u << 8)
+#define PWR_CR_VOS                  (1u << 14)
+#define PWR_CSR_BRR                 (1u << 3)
+#define PWR_CSR_BRE                 (1u << 9)
+#define FLASH_ACR_LATENCY           (7u << 0)
+#define FLASH_ACR_LATENCY_0WS       0u
+#define FLASH_ACR_LATENCY_5WS       5u
+#define FLASH_ACR_PRFTEN            (1u << 8)
+#define FLASH_ACR_ICEN              (1u << 9)
+#define FLASH_ACR_DCEN              (1u << 10)
+#define FLASH_ACR_DCRST             (1u << 12)
+#define FLASH_SR_EOP                (1u << 0)
+#define FLASH_SR_OPERR              (1u << 1)
+#define FLASH_SR_WRPERR             (1u << 4)
+#define FLASH_SR_PGAERR             (1u << 5)
+#define FLASH_SR_PGPERR             (1u << 6)
+#define FLASH_SR_PGSERR             (1u << 7)
+#define FLASH_SR_BSY                (1u << 16)
+#define FLASH_CR_PG                 (1u << 0)
+#define FLASH_CR_SER                (1u << 1)
+#define FLASH_CR_SNB_Pos            3
+#define FLASH_CR_SNB                (0xFu << 3)
+#define FLASH_CR_PSIZE_0            (1u << 8)
+#define FLASH_CR_PSIZE              (3u << 8)
+#define FLASH_CR_STRT               (1u << 16)
+#define FLASH_CR_EOPIE              (1u << 24)
+#define FLASH_CR_LOCK               (1u << 31)
+#define DWT_CTRL_CYCCNTENA_Msk      1u
+#define CoreDebug_DEMCR_TRCENA_Msk  (1u << 24)
+#define SCB_ICSR_VECTACTIVE_Msk     0x1FFu
+#define SysTick_CTRL_ENABLE_Msk     1u
+
+#endif /* REGSIM_STM32F4XX_H */
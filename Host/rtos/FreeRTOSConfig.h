@@ -0,0 +1,52 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/**
+  * @brief Configuration FreeRTOS du simulateur PC (portage POSIX, pipesim.c)
+  *        Mêmes priorités, même allocation statique et mêmes statistiques que la carte
+  *        (ADC-UART/FreeRTOSConfig.h) ; le temps d'exécution est compté en microsecondes.
+  */
+
+#include <stdint.h>
+#include <assert.h>
+
+uint32_t ulGetRunTimeCounterValue(void);
+
+#define configUSE_PREEMPTION                    1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#define configTICK_RATE_HZ                      ((TickType_t)1000)
+#define configMAX_PRIORITIES                    5
+#define configMINIMAL_STACK_SIZE                ((uint16_t)16384)
+#define configMAX_TASK_NAME_LEN                 8
+#define configSTACK_DEPTH_TYPE                  uint32_t
+#define configUSE_16_BIT_TICKS                  0
+#define configIDLE_SHOULD_YIELD                 1
+#define configUSE_IDLE_HOOK                     0
+#define configUSE_TICK_HOOK                     0
+#define configUSE_MUTEXES                       0
+#define configUSE_COUNTING_SEMAPHORES           0
+#define configUSE_TIMERS                        0
+#define configQUEUE_REGISTRY_SIZE               0
+
+// Mémoire
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        0
+#define configCHECK_FOR_STACK_OVERFLOW          0
+
+// Statistiques par tâche
+#define configUSE_TRACE_FACILITY                1
+#define configGENERATE_RUN_TIME_STATS           1
+#define configRUN_TIME_COUNTER_TYPE             uint32_t
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()        ulGetRunTimeCounterValue()
+
+// Fonctions incluses
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_xTaskDelayUntil                 1
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
+#define INCLUDE_vTaskSuspend                    1
+#define INCLUDE_xTaskGetSchedulerState          1
+
+#define configASSERT(x)                         assert(x)
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,186 @@
+/**
+  * @brief  pipesim : essai de charge du pipeline à tâches (ADC-UART/Pipeline.c) sur PC
+  *
+  *   Compilation (noyau FreeRTOS V10.4 ou plus, portage POSIX, dans $FREERTOS) :
+  *      P=$FREERTOS/portable/ThirdParty/GCC/Posix
+  *      gcc -O2 -DAPP_RTOS=1 -DPIPELINE_STACK_SCALE=64 -I. -I$FREERTOS/include -I$P -I$P/utils \
+  *          -o pipesim pipesim.c ../../ADC-UART/Pipeline.c ../../ADC-UART/Frame.c \
+  *          ../../ADC-UART/CRC16.c ../../ADC-UART/Pack.c ../../ADC-UART/Filter.c ../../ADC-UART/Dsp.c \
+  *          $FREERTOS/tasks.c $FREERTOS/queue.c $FREERTOS/list.c $P/port.c $P/utils/wait_for_event.c \
+  *          -lpthread -lm
+  *
+  *   Sans les sources du noyau, même essai sur le noyau réduit de sim/ (rtosim.c) :
+  *      gcc -O2 -DAPP_RTOS=1 -DPIPELINE_STACK_SCALE=64 -I. -Isim \
+  *          -o pipesim pipesim.c sim/rtosim.c ../../ADC-UART/Pipeline.c ../../ADC-UART/Frame.c \
+  *          ../../ADC-UART/CRC16.c ../../ADC-UART/Pack.c ../../ADC-UART/Filter.c ../../ADC-UART/Dsp.c \
+  *          -lpthread -lm
+  *
+  *   Utilisation :
+  *      pipesim [-p ms] [-n échantillons] [-b baud] [-w µs] [-s ms] [-d s] [-o fichier]
+  *         -p   période d'acquisition (1)            -n   échantillons par bloc (16)
+  *         -b   débit du lien simulé (115200)        -w   coût de traitement ajouté par bloc (0)
+  *         -s   période du rapport des tâches (1000) -d   durée de l'essai (10)
+  *         -o   enregistrer le flux émis (lisible par adcrx et adcjitter)
+  *
+  *   Les tâches de la carte s'exécutent telles quelles ; seul le pilote change : un ADC
+  *   synthétique (sinusoïde 12 bits) et un lien série simulé qui occupe la tâche de transport
+  *   pendant la durée d'émission de chaque trame au débit demandé. En fin d'essai, les
+  *   compteurs du pipeline sont affichés ; le code de retour vaut 1 si des blocs ont été
+  *   perdus ou des périodes manquées. Le tick d'un PC n'est pas temps réel : les quelques
+  *   périodes manquées par seconde dues à l'hôte se mesurent sur un essai à transport inactif
+  *   (-b 100000000). Sur PC, la pile indiquée par tâche est celle du thread et n'a pas de lien
+  *   avec la carte.
+  */
+#define _GNU_SOURCE
+#include "FreeRTOS.h"
+#include "task.h"
+#include "../../ADC-UART/Pipeline.h"
+#include "../../ADC-UART/Frame.h"
+#include "../../ADC-UART/Filter.h"
+#include "../../ADC-UART/Dsp.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint32_t period_ms = 1, burst = 16, baud = 115200, work_us, stats_ms = 1000, duration_s = 10;
+static FILE *out;
+static uint16_t seq;
+static double phase;
+static uint64_t t0_us;
+
+static StaticTask_t sim_tcb;
+static StackType_t sim_stack[configMINIMAL_STACK_SIZE];
+
+static uint64_t now_us (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint32_t ulGetRunTimeCounterValue (void)
+{
+	return (uint32_t)(now_us() - t0_us);   // Compté depuis le lancement, comme le DWT de la carte
+}
+
+// Occupation du processeur pendant us microsecondes (émission bloquante, calcul), comptées sur
+// le temps CPU du thread : une tâche préemptée reprend là où elle en était, comme l'émission
+// scrutée de la carte, qui attend encore chaque octet après une préemption
+static void busy (uint64_t us)
+{
+	struct timespec ts;
+	uint64_t end;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	end = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000 + us;
+	do
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	while ((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000 < end);
+}
+
+static void sim_acquire (Pipeline_Block *b)
+{
+	b->t_us = (uint32_t)now_us();
+	b->channel = 1;
+	b->bits = 12;
+	b->count = (uint16_t)burst;
+	for (uint32_t i = 0; i < burst; i++) {
+		b->samples[i] = (uint16_t)lrint(2048 + 1500 * sin(phase) + (rand() % 9) - 4);
+		phase += 2 * M_PI * 50 * 1e-5;      // 50 Hz, une conversion toutes les 10 µs
+	}
+}
+
+static void sim_process (Pipeline_Block *b)
+{
+	Dsp_OffsetGain(b->samples, b->samples, b->count, -12, 16500, b->bits);
+	Filter_Process(Filter_Channel(b->channel), b->bits, b->samples, b->samples, b->count);
+	if (work_us)
+		busy(work_us);
+}
+
+static void sim_transmit (Pipeline_Block *b)
+{
+	if (b->kind == PIPELINE_TEXT) {
+		fwrite(b->out, 1, b->out_len, stdout);
+		fflush(stdout);
+		if (out) {
+			uint8_t frame[FRAME_MAX_SIZE];
+			uint32_t n = Frame_Encode(frame, FRAME_TEXT, seq++, b->out, (uint8_t)b->out_len);
+			fwrite(frame, 1, n, out);
+		}
+		return;
+	}
+	b->out_len = (uint16_t)Frame_EncodePacked(b->out, seq++, b->t_us, b->channel, b->bits,
+	                                          b->samples, (uint8_t)b->count);
+	if (out)
+		fwrite(b->out, 1, b->out_len, out);
+	busy((uint64_t)b->out_len * 10 * 1000000 / baud);   // 10 bits par octet (8N1)
+}
+
+static const Pipeline_Driver sim_pipeline = { sim_acquire, sim_process, sim_transmit, 0 };
+
+// Fin de l'essai : bilan et sortie du processus. Priorité de l'acquisition, pour terminer
+// aussi un essai où le transport, saturé, ne rend jamais la main.
+static void sim_task (void *arg)
+{
+	static char report[1024];
+	Pipeline_Stats s;
+
+	(void)arg;
+	vTaskDelay(pdMS_TO_TICKS(duration_s * 1000));
+	vTaskSuspendAll();              // Bilan figé ; stdout n'est plus partagé avec la tâche de transport
+	Pipeline_GetStats(&s);
+	Pipeline_FormatTasks(report, sizeof(report));
+	printf("--- %lu s, période %lu ms, %lu échantillons/bloc, %lu baud ---\n%s",
+	       (unsigned long)duration_s, (unsigned long)period_ms, (unsigned long)burst,
+	       (unsigned long)baud, report);
+	printf("Débit utile : %.0f échantillons/s (attendu %.0f)\n",
+	       (double)s.sent * burst / duration_s, 1000.0 * burst / period_ms);
+	if (out)
+		fclose(out);
+	exit(s.dropped || s.late ? 1 : 0);
+}
+
+int main (int argc, char **argv)
+{
+	float c[5];
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-p") && i + 1 < argc)
+			period_ms = strtoul(argv[++i], 0, 10);
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+			burst = strtoul(argv[++i], 0, 10);
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+			baud = strtoul(argv[++i], 0, 10);
+		else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+			work_us = strtoul(argv[++i], 0, 10);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+			stats_ms = strtoul(argv[++i], 0, 10);
+		else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+			duration_s = strtoul(argv[++i], 0, 10);
+		else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+			if (!(out = fopen(argv[++i], "wb"))) {
+				perror(argv[i]);
+				return 2;
+			}
+		} else {
+			fprintf(stderr, "usage: pipesim [-p ms] [-n échantillons] [-b baud] [-w µs] [-s ms] [-d s] [-o fichier]\n");
+			return 2;
+		}
+	}
+	if (!period_ms || !baud || !burst || burst > FRAME_PACKED_MAX(12)) {
+		fprintf(stderr, "pipesim: paramètres invalides (1 <= -n <= %d)\n", FRAME_PACKED_MAX(12));
+		return 2;
+	}
+
+	t0_us = now_us();
+	Filter_DesignLowpass(0.1f, 0.7071f, c);
+	Filter_SetBiquads(Filter_Channel(1), FILTER_DF1, FILTER_Q31, c, 1);
+
+	Pipeline_Start(&sim_pipeline, period_ms, stats_ms);
+	xTaskCreateStatic(sim_task, "sim", configMINIMAL_STACK_SIZE, 0, configMAX_PRIORITIES - 1, sim_stack, &sim_tcb);
+	vTaskStartScheduler();
+	return 0;
+}
@@ -0,0 +1,71 @@
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+/**
+  * @brief  rtosim : sous-ensemble de l'API FreeRTOS V10.4 exécuté sur PC (voir rtosim.c)
+  *         Types, constantes et objets statiques utilisés par ADC-UART/Pipeline.c et pipesim.c.
+  */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t StackType_t;
+
+#include "FreeRTOSConfig.h"
+
+#ifndef configRUN_TIME_COUNTER_TYPE
+#define configRUN_TIME_COUNTER_TYPE  uint32_t
+#endif
+
+#define pdFALSE             ((BaseType_t)0)
+#define pdTRUE              ((BaseType_t)1)
+#define pdPASS              pdTRUE
+#define pdFAIL              pdFALSE
+#define errQUEUE_FULL       ((BaseType_t)0)
+#define errQUEUE_EMPTY      ((BaseType_t)0)
+
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFu)
+#define portTICK_PERIOD_MS  ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000u))
+
+typedef void (*TaskFunction_t)(void *);
+
+// Bloc de contrôle d'une tâche : un thread hôte, qui ne s'exécute que lorsqu'il est la tâche courante
+typedef struct rtosim_tcb {
+	pthread_t thread;
+	pthread_cond_t run;                  // Signalé quand la tâche devient la tâche courante
+	TaskFunction_t code;
+	void *param;
+	char name[configMAX_TASK_NAME_LEN];
+	UBaseType_t prio;
+	UBaseType_t number;                  // Numéro de création, à partir de 1
+	StackType_t *stack;
+	uint32_t depth;
+	int ready;                           // 0 : bloquée (délai ou file)
+	int timed;                           // Réveil par le tick à l'échéance wake
+	int timed_out;
+	TickType_t wake;
+	void *wait_q;                        // File attendue, 0 si aucune
+	int wait_send;                       // 1 : attente de place, 0 : attente d'élément
+	uint32_t run_time;
+	uint32_t switched_in;
+} StaticTask_t;
+
+typedef StaticTask_t *TaskHandle_t;
+
+// File : tampon circulaire d'éléments copiés, dans la mémoire fournie par l'application
+typedef struct rtosim_queue {
+	uint8_t *store;
+	UBaseType_t length;
+	UBaseType_t item_size;
+	UBaseType_t head;
+	UBaseType_t count;
+} StaticQueue_t;
+
+typedef StaticQueue_t *QueueHandle_t;
+
+#endif /* INC_FREERTOS_H */
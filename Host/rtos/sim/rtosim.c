@@ -0,0 +1,433 @@
+/**
+  * @brief  rtosim : noyau FreeRTOS réduit pour exécuter sur PC les tâches de la carte
+  *         (ADC-UART/Pipeline.c), sans les sources du noyau ni leur portage POSIX
+  *
+  *   Même principe que le portage POSIX de FreeRTOS : un thread hôte par tâche, dont un seul
+  *   s'exécute à la fois (la tâche courante, les autres attendent leur condition), et un tick
+  *   SIGALRM (setitimer, configTICK_RATE_HZ) reçu par la seule tâche courante : SIGALRM est
+  *   masqué partout ailleurs, et dans le noyau lui-même. Ordonnancement préemptif à priorités
+  *   fixes, tourniquet au tick entre tâches de même priorité (configUSE_TIME_SLICING), préemption
+  *   immédiate quand une file débloque une tâche plus prioritaire.
+  *
+  *   Sous-ensemble fourni : tâches et files statiques, vTaskDelay, xTaskDelayUntil,
+  *   vTaskSuspendAll, uxTaskGetSystemState (temps d'exécution par portGET_RUN_TIME_COUNTER_VALUE,
+  *   minimum de pile libre mesuré sur la pile fournie, remplie de 0xA5 à la création).
+  *   Pas de mutex, sémaphores, notifications, timers ni suppression de tâche.
+  *
+  *   Comme sous le portage POSIX, une tâche préemptée au milieu d'un appel à la bibliothèque C
+  *   en garde les verrous : deux tâches de priorités différentes ne doivent pas se partager un
+  *   même flux stdio sans vTaskSuspendAll.
+  */
+#define _GNU_SOURCE
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define RTOSIM_MAX_TASKS  16
+#define STACK_FILL        0xA5A5A5A5u
+
+static pthread_mutex_t klock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t never = PTHREAD_COND_INITIALIZER;
+static TaskHandle_t tasks[RTOSIM_MAX_TASKS];
+static UBaseType_t n_tasks;
+static TaskHandle_t current;
+static volatile TickType_t tick;
+static int started, suspended;
+static volatile sig_atomic_t stopped;
+
+// Entrée et sortie du noyau : SIGALRM masqué, verrou pris
+static void enter (void)
+{
+	sigset_t s;
+
+	sigemptyset(&s);
+	sigaddset(&s, SIGALRM);
+	pthread_sigmask(SIG_BLOCK, &s, 0);
+	pthread_mutex_lock(&klock);
+}
+
+static void leave (void)
+{
+	sigset_t s;
+
+	pthread_mutex_unlock(&klock);
+	sigemptyset(&s);
+	sigaddset(&s, SIGALRM);
+	pthread_sigmask(SIG_UNBLOCK, &s, 0);
+}
+
+/**
+  * @brief  Tâche prête la plus prioritaire ; à priorité égale, la première après la tâche courante
+  * @retval Tâche élue (la tâche inactive est toujours prête)
+  */
+static TaskHandle_t pick (void)
+{
+	UBaseType_t from = 0;
+	TaskHandle_t best = 0;
+
+	for (UBaseType_t i = 0; i < n_tasks; i++)
+		if (tasks[i] == current)
+			from = i;
+	for (UBaseType_t i = 1; i <= n_tasks; i++) {
+		TaskHandle_t t = tasks[(from + i) % n_tasks];
+		if (t->ready && (!best || t->prio > best->prio))
+			best = t;
+	}
+	return best;
+}
+
+/**
+  * @brief Passer la main à next et attendre de redevenir la tâche courante (verrou tenu)
+  */
+static void switch_to (TaskHandle_t next)
+{
+	TaskHandle_t self = current;
+	uint32_t now = portGET_RUN_TIME_COUNTER_VALUE();
+
+	if (next == self)
+		return;
+	self->run_time += now - self->switched_in;
+	next->switched_in = now;
+	current = next;
+	pthread_cond_signal(&next->run);
+	while (current != self)
+		pthread_cond_wait(&self->run, &klock);
+}
+
+// Préemption par une tâche plus prioritaire devenue prête
+static void preempt (void)
+{
+	TaskHandle_t next;
+
+	if (!started || suspended)
+		return;
+	next = pick();
+	if (next->prio > current->prio)
+		switch_to(next);
+}
+
+// Bloquer la tâche courante pour ticks (portMAX_DELAY : sans échéance)
+static void block (TickType_t ticks)
+{
+	TaskHandle_t self = current;
+
+	configASSERT(started && !suspended);
+	self->ready = 0;
+	self->timed = ticks != portMAX_DELAY;
+	self->wake = tick + ticks;
+	switch_to(pick());
+}
+
+// Débloquer la tâche la plus prioritaire qui attend de la place (send = 1) ou un élément dans q
+static void wake_waiter (StaticQueue_t *q, int send)
+{
+	TaskHandle_t best = 0;
+
+	for (UBaseType_t i = 0; i < n_tasks; i++) {
+		TaskHandle_t t = tasks[i];
+		if (!t->ready && t->wait_q == q && t->wait_send == send && (!best || t->prio > best->prio))
+			best = t;
+	}
+	if (best) {
+		best->ready = 1;
+		best->timed = 0;
+		best->wait_q = 0;
+		preempt();
+	}
+}
+
+/**
+  * @brief Tick : réveil des tâches échues, puis préemption ou tourniquet (tâche courante seulement)
+  */
+static void tick_isr (int sig)
+{
+	(void)sig;
+	if (stopped)
+		return;
+	pthread_mutex_lock(&klock);
+	tick++;
+	for (UBaseType_t i = 0; i < n_tasks; i++) {
+		TaskHandle_t t = tasks[i];
+		if (!t->ready && t->timed && (int32_t)(tick - t->wake) >= 0) {
+			t->ready = 1;
+			t->timed = 0;
+			t->timed_out = 1;
+			t->wait_q = 0;
+		}
+	}
+	if (!suspended)
+		switch_to(pick());
+	pthread_mutex_unlock(&klock);
+}
+
+// Sortie du processus (exit() depuis une tâche) : plus de tick ni de commutation
+static void stop (void)
+{
+	struct itimerval it;
+	sigset_t s;
+
+	stopped = 1;
+	memset(&it, 0, sizeof it);
+	setitimer(ITIMER_REAL, &it, 0);
+	sigemptyset(&s);
+	sigaddset(&s, SIGALRM);
+	pthread_sigmask(SIG_BLOCK, &s, 0);
+}
+
+static void *task_entry (void *arg)
+{
+	TaskHandle_t self = arg;
+
+	pthread_mutex_lock(&klock);
+	while (current != self)
+		pthread_cond_wait(&self->run, &klock);
+	leave();
+	self->code(self->param);
+	abort();                                 // Une tâche FreeRTOS ne retourne jamais
+}
+
+// Création sous verrou, SIGALRM masqué : le thread en hérite jusqu'à sa première élection
+static TaskHandle_t create (TaskFunction_t code, const char *name, uint32_t depth, void *param,
+                            UBaseType_t prio, StackType_t *stack, StaticTask_t *tcb)
+{
+	pthread_attr_t attr;
+
+	configASSERT(n_tasks < RTOSIM_MAX_TASKS && prio < configMAX_PRIORITIES);
+	memset(tcb, 0, sizeof *tcb);
+	tcb->code = code;
+	tcb->param = param;
+	strncpy(tcb->name, name, configMAX_TASK_NAME_LEN - 1);
+	tcb->prio = prio;
+	tcb->number = n_tasks + 1;
+	tcb->stack = stack;
+	tcb->depth = depth;
+	tcb->ready = 1;
+	pthread_cond_init(&tcb->run, 0);
+	for (uint32_t i = 0; i < depth; i++)
+		stack[i] = STACK_FILL;
+
+	pthread_attr_init(&attr);
+	if (pthread_attr_setstack(&attr, stack, depth * sizeof(StackType_t)))
+		tcb->depth = 0;                      // Pile trop petite pour un thread : pile par défaut
+	if (pthread_create(&tcb->thread, &attr, task_entry, tcb))
+		abort();
+	pthread_attr_destroy(&attr);
+	tasks[n_tasks++] = tcb;
+	return tcb;
+}
+
+TaskHandle_t xTaskCreateStatic (TaskFunction_t code, const char *name, uint32_t depth, void *param,
+                                UBaseType_t prio, StackType_t *stack, StaticTask_t *tcb)
+{
+	TaskHandle_t t;
+
+	enter();
+	t = create(code, name, depth, param, prio, stack, tcb);
+	preempt();
+	leave();
+	return t;
+}
+
+static void idle_task (void *arg)
+{
+	(void)arg;
+	for (;;)
+		pause();
+}
+
+/**
+  * @brief Créer la tâche inactive, lancer le tick et la tâche la plus prioritaire ; ne retourne pas
+  */
+void vTaskStartScheduler (void)
+{
+	StaticTask_t *idle_tcb;
+	StackType_t *idle_stack;
+	uint32_t idle_size;
+	struct sigaction sa;
+	struct itimerval it;
+
+	enter();
+	vApplicationGetIdleTaskMemory(&idle_tcb, &idle_stack, &idle_size);
+	create(idle_task, "IDLE", idle_size, 0, tskIDLE_PRIORITY, idle_stack, idle_tcb);
+	atexit(stop);
+
+	memset(&sa, 0, sizeof sa);
+	sa.sa_handler = tick_isr;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGALRM, &sa, 0);
+
+	started = 1;
+	current = pick();
+	current->switched_in = portGET_RUN_TIME_COUNTER_VALUE();
+	pthread_cond_signal(&current->run);
+
+	it.it_interval.tv_sec = 0;
+	it.it_interval.tv_usec = 1000000 / configTICK_RATE_HZ;
+	it.it_value = it.it_interval;
+	setitimer(ITIMER_REAL, &it, 0);
+	for (;;)
+		pthread_cond_wait(&never, &klock);   // SIGALRM reste masqué dans main
+}
+
+void vTaskDelay (TickType_t ticks)
+{
+	enter();
+	if (ticks)
+		block(ticks);
+	else if (!suspended)
+		switch_to(pick());
+	leave();
+}
+
+/**
+  * @brief  Attendre l'échéance *prev + increment, comme xTaskDelayUntil() de tasks.c
+  * @retval pdFALSE si l'échéance était déjà passée (pas d'attente)
+  */
+BaseType_t xTaskDelayUntil (TickType_t *prev, TickType_t increment)
+{
+	BaseType_t should;
+	TickType_t now, wake;
+
+	enter();
+	now = tick;
+	wake = *prev + increment;
+	if (now < *prev)
+		should = wake < *prev && wake > now;
+	else
+		should = wake < *prev || wake > now;
+	*prev = wake;
+	if (should)
+		block(wake - now);
+	leave();
+	return should;
+}
+
+TickType_t xTaskGetTickCount (void)
+{
+	return tick;
+}
+
+void vTaskSuspendAll (void)
+{
+	enter();
+	suspended++;
+	leave();
+}
+
+BaseType_t xTaskResumeAll (void)
+{
+	enter();
+	suspended--;
+	preempt();
+	leave();
+	return pdFALSE;
+}
+
+/**
+  * @brief  État de toutes les tâches (0 si le tableau est trop petit, comme tasks.c)
+  * @retval Nombre de tâches décrites
+  */
+UBaseType_t uxTaskGetSystemState (TaskStatus_t *status, UBaseType_t size, configRUN_TIME_COUNTER_TYPE *total)
+{
+	uint32_t now;
+	UBaseType_t n = 0;
+
+	enter();
+	now = portGET_RUN_TIME_COUNTER_VALUE();
+	if (size >= n_tasks) {
+		for (n = 0; n < n_tasks; n++) {
+			TaskHandle_t t = tasks[n];
+			uint32_t free_words = 0;
+
+			while (free_words < t->depth && t->stack[free_words] == STACK_FILL)
+				free_words++;
+			status[n].xHandle = t;
+			status[n].pcTaskName = t->name;
+			status[n].xTaskNumber = t->number;
+			status[n].eCurrentState = t == current ? eRunning : t->ready ? eReady : eBlocked;
+			status[n].uxCurrentPriority = t->prio;
+			status[n].uxBasePriority = t->prio;
+			status[n].ulRunTimeCounter = t->run_time + (t == current ? now - t->switched_in : 0);
+			status[n].pxStackBase = t->stack;
+			status[n].usStackHighWaterMark = free_words;
+		}
+	}
+	if (total)
+		*total = now;
+	leave();
+	return n;
+}
+
+QueueHandle_t xQueueCreateStatic (UBaseType_t length, UBaseType_t item_size, uint8_t *store, StaticQueue_t *q)
+{
+	q->store = store;
+	q->length = length;
+	q->item_size = item_size;
+	q->head = 0;
+	q->count = 0;
+	return q;
+}
+
+// Attente d'une place (send = 1) ou d'un élément jusqu'à l'échéance ; 0 si le délai est écoulé
+static int wait_queue (StaticQueue_t *q, int send, TickType_t wait, TickType_t deadline)
+{
+	TaskHandle_t self = current;
+
+	if (!wait || !started || self->timed_out)
+		return 0;
+	if (wait != portMAX_DELAY && (int32_t)(deadline - tick) <= 0)
+		return 0;
+	self->wait_q = q;
+	self->wait_send = send;
+	block(wait == portMAX_DELAY ? portMAX_DELAY : deadline - tick);
+	return 1;
+}
+
+BaseType_t xQueueSend (QueueHandle_t q, const void *item, TickType_t wait)
+{
+	TickType_t deadline;
+
+	enter();
+	deadline = tick + wait;
+	if (started)
+		current->timed_out = 0;
+	while (q->count == q->length) {
+		if (!wait_queue(q, 1, wait, deadline)) {
+			leave();
+			return errQUEUE_FULL;
+		}
+	}
+	memcpy(q->store + (q->head + q->count) % q->length * q->item_size, item, q->item_size);
+	q->count++;
+	wake_waiter(q, 0);
+	leave();
+	return pdPASS;
+}
+
+BaseType_t xQueueReceive (QueueHandle_t q, void *item, TickType_t wait)
+{
+	TickType_t deadline;
+
+	enter();
+	deadline = tick + wait;
+	if (started)
+		current->timed_out = 0;
+	while (!q->count) {
+		if (!wait_queue(q, 0, wait, deadline)) {
+			leave();
+			return errQUEUE_EMPTY;
+		}
+	}
+	memcpy(item, q->store + q->head * q->item_size, q->item_size);
+	q->head = (q->head + 1) % q->length;
+	q->count--;
+	wake_waiter(q, 1);
+	leave();
+	return pdPASS;
+}
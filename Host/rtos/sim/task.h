@@ -0,0 +1,42 @@
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#include "FreeRTOS.h"
+
+#define tskIDLE_PRIORITY  ((UBaseType_t)0)
+
+typedef enum {
+	eRunning = 0,
+	eReady,
+	eBlocked,
+	eSuspended,
+	eDeleted,
+	eInvalid
+} eTaskState;
+
+typedef struct {
+	TaskHandle_t xHandle;
+	const char *pcTaskName;
+	UBaseType_t xTaskNumber;
+	eTaskState eCurrentState;
+	UBaseType_t uxCurrentPriority;
+	UBaseType_t uxBasePriority;
+	configRUN_TIME_COUNTER_TYPE ulRunTimeCounter;
+	StackType_t *pxStackBase;
+	configSTACK_DEPTH_TYPE usStackHighWaterMark;
+} TaskStatus_t;
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t code, const char *name, uint32_t depth, void *param,
+                               UBaseType_t prio, StackType_t *stack, StaticTask_t *tcb);
+void vTaskStartScheduler(void);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskDelayUntil(TickType_t *prev, TickType_t increment);
+TickType_t xTaskGetTickCount(void);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, UBaseType_t size, configRUN_TIME_COUNTER_TYPE *total);
+
+// Fournies par l'application
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *size);
+
+#endif /* INC_TASK_H */
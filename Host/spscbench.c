@@ -0,0 +1,322 @@
+/**
+  * @brief  spscbench : validation et débit de la file sans verrou de la carte (ADC-UART/Spsc.c)
+  *
+  *   Compilation :
+  *      gcc -O2 -pthread -DSPSC_LINE=64 -o spscbench spscbench.c ../ADC-UART/Spsc.c
+  *
+  *   Utilisation :
+  *      spscbench [-n éléments]
+  *
+  *   Essai de charge : un fil producteur et un fil consommateur se partagent une file, chacun
+  *   choisissant au hasard l'accès à une place (Claim/Commit, Peek/Release), par copie
+  *   (Push/Pop) ou par lot (ClaimN/CommitN, PeekN/ReleaseN, lot publié en partie). Chaque
+  *   élément porte son rang et une somme de contrôle : tout élément perdu, dupliqué, déséquencé
+  *   ou lu avant d'être complet est compté. Les files de 1 et 2 places forcent l'alternance
+  *   plein / vide, celle d'octets reproduit la réception UART (UART_RX_SIZE).
+  *   Mesure de débit : éléments par seconde selon la taille des places et du lot, comparés à
+  *   la même file protégée par un verrou (pthread_mutex).
+  *   Sur une machine à un seul coeur, les deux fils alternent par préemption : l'essai reste
+  *   valable, le débit mesure surtout les changements de contexte. -DSPSC_LINE=4 (valeur de
+  *   la carte) mesure le coût du faux partage entre coeurs.
+  *   Le code de retour vaut 1 en cas d'écart.
+  */
+#define _GNU_SOURCE
+#include "../ADC-UART/Spsc.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+	uint32_t rank;
+	uint32_t a, b;
+	uint32_t sum;
+} Item;
+
+typedef struct {
+	Spsc      q;
+	uint32_t  slot_size;           // sizeof(Item) ou 1 (octets)
+	uint64_t  count;
+	uint32_t  seed;
+	/* résultats du consommateur */
+	uint64_t  received, bad;
+	/* mesure de débit */
+	uint32_t  batch;               // 0 : une place à la fois
+	pthread_mutex_t lock;          // File de référence verrouillée
+	int       locked;
+} Test;
+
+static double now_s (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t rnd (uint32_t *s)
+{
+	*s = *s * 1664525u + 1013904223u;
+	return *s >> 8;
+}
+
+static void make (Item *it, uint32_t rank)
+{
+	it->rank = rank;
+	it->a = rank * 2654435761u;
+	it->b = ~rank;
+	it->sum = it->rank ^ it->a ^ it->b ^ 0x5A5A5A5Au;
+}
+
+static int check (const Item *it, uint32_t rank)
+{
+	return it->rank == rank && it->a == rank * 2654435761u && it->b == ~rank &&
+	       it->sum == (it->rank ^ it->a ^ it->b ^ 0x5A5A5A5Au);
+}
+
+static void put (Test *t, uint8_t *p, uint32_t rank)
+{
+	if (t->slot_size == 1)
+		*p = (uint8_t)(rank * 7u);
+	else
+		make((Item *)p, rank);
+}
+
+static int get (Test *t, const uint8_t *p, uint32_t rank)
+{
+	if (t->slot_size == 1)
+		return *p == (uint8_t)(rank * 7u);
+	return check((const Item *)p, rank);
+}
+
+/* ---------- essai de charge ---------- */
+
+static void *stress_producer (void *arg)
+{
+	Test *t = arg;
+	uint32_t s = t->seed, rank = 0;
+	uint8_t tmp[sizeof(Item)];
+
+	while (rank < t->count) {
+		uint32_t mode = rnd(&s) % 3;
+		void *p;
+
+		if (mode == 0 && (p = Spsc_Claim(&t->q)) != 0) {
+			put(t, p, rank++);
+			Spsc_Commit(&t->q);
+		} else if (mode == 1) {
+			put(t, tmp, rank);
+			if (Spsc_Push(&t->q, tmp) == 0)
+				rank++;
+		} else if (mode == 2) {
+			uint32_t n = Spsc_ClaimN(&t->q, &p), k;
+			if (n > t->count - rank)
+				n = (uint32_t)(t->count - rank);
+			if (n)
+				n = 1 + rnd(&s) % n;      // Lot publié en partie
+			for (k = 0; k < n; k++)
+				put(t, (uint8_t *)p + k * t->slot_size, rank + k);
+			Spsc_CommitN(&t->q, n);
+			rank += n;
+		}
+		if (Spsc_Count(&t->q) > t->q.mask)
+			sched_yield();
+	}
+	return 0;
+}
+
+static void *stress_consumer (void *arg)
+{
+	Test *t = arg;
+	uint32_t s = t->seed ^ 0x9E3779B9u, rank = 0;
+	uint8_t tmp[sizeof(Item)];
+
+	while (rank < t->count) {
+		uint32_t mode = rnd(&s) % 3;
+		void *p;
+
+		if (mode == 0 && (p = Spsc_Peek(&t->q)) != 0) {
+			t->bad += !get(t, p, rank++);
+			Spsc_Release(&t->q);
+		} else if (mode == 1) {
+			if (Spsc_Pop(&t->q, tmp) == 0)
+				t->bad += !get(t, tmp, rank++);
+		} else if (mode == 2) {
+			uint32_t n = Spsc_PeekN(&t->q, &p), k;
+			if (n)
+				n = 1 + rnd(&s) % n;      // Lot rendu en partie
+			for (k = 0; k < n; k++)
+				t->bad += !get(t, (uint8_t *)p + k * t->slot_size, rank + k);
+			Spsc_ReleaseN(&t->q, n);
+			rank += n;
+		}
+		if (!Spsc_Count(&t->q))
+			sched_yield();
+	}
+	t->received = rank;
+	return 0;
+}
+
+static int stress (const char *name, uint32_t slot_size, uint32_t slots, uint64_t count, uint32_t seed)
+{
+	static Test t;
+	pthread_t prod, cons;
+	void *storage = aligned_alloc(64, ((size_t)slots * slot_size + 63) / 64 * 64);
+	double t0;
+	int ok;
+
+	memset(&t, 0, sizeof(t));
+	if (!storage || Spsc_Init(&t.q, storage, slot_size, slots) != 0) {
+		fprintf(stderr, "%s : initialisation impossible\n", name);
+		return 0;
+	}
+	t.slot_size = slot_size;
+	t.count = count;
+	t.seed = seed;
+	t0 = now_s();
+	pthread_create(&cons, 0, stress_consumer, &t);
+	pthread_create(&prod, 0, stress_producer, &t);
+	pthread_join(prod, 0);
+	pthread_join(cons, 0);
+
+	ok = t.bad == 0 && t.received == count && Spsc_Count(&t.q) == 0;
+	printf("%-24s %6u %10llu %10llu %8llu %10u %8.2f  %s\n", name, slots,
+	       (unsigned long long)count, (unsigned long long)t.received, (unsigned long long)t.bad,
+	       t.q.full, now_s() - t0, ok ? "ok" : "ÉCART");
+	free(storage);
+	return ok;
+}
+
+/* ---------- mesure de débit ---------- */
+
+static void *bench_producer (void *arg)
+{
+	Test *t = arg;
+	uint64_t rank = 0;
+
+	while (rank < t->count) {
+		void *p;
+		uint32_t n = 0;
+
+		if (t->locked)
+			pthread_mutex_lock(&t->lock);
+		if (t->batch) {
+			n = Spsc_ClaimN(&t->q, &p);
+			if (n > t->batch)
+				n = t->batch;
+			if (n > t->count - rank)
+				n = (uint32_t)(t->count - rank);
+			for (uint32_t k = 0; k < n; k++)
+				*(uint32_t *)((uint8_t *)p + k * t->slot_size) = (uint32_t)(rank + k);
+			Spsc_CommitN(&t->q, n);
+		} else if ((p = Spsc_Claim(&t->q)) != 0) {
+			*(uint32_t *)p = (uint32_t)rank;
+			Spsc_Commit(&t->q);
+			n = 1;
+		}
+		if (t->locked)
+			pthread_mutex_unlock(&t->lock);
+		rank += n;
+		if (!n)
+			sched_yield();
+	}
+	return 0;
+}
+
+static void *bench_consumer (void *arg)
+{
+	Test *t = arg;
+	uint64_t rank = 0;
+
+	while (rank < t->count) {
+		void *p;
+		uint32_t n = 0;
+
+		if (t->locked)
+			pthread_mutex_lock(&t->lock);
+		if (t->batch) {
+			n = Spsc_PeekN(&t->q, &p);
+			if (n > t->batch)
+				n = t->batch;
+			for (uint32_t k = 0; k < n; k++)
+				t->bad += *(uint32_t *)((uint8_t *)p + k * t->slot_size) != (uint32_t)(rank + k);
+			Spsc_ReleaseN(&t->q, n);
+		} else if ((p = Spsc_Peek(&t->q)) != 0) {
+			t->bad += *(uint32_t *)p != (uint32_t)rank;
+			Spsc_Release(&t->q);
+			n = 1;
+		}
+		if (t->locked)
+			pthread_mutex_unlock(&t->lock);
+		rank += n;
+		if (!n)
+			sched_yield();
+	}
+	return 0;
+}
+
+static int bench (uint32_t slot_size, uint32_t batch, int locked, uint64_t count)
+{
+	static Test t;
+	pthread_t prod, cons;
+	uint32_t slots = 1024;
+	void *storage = aligned_alloc(64, (size_t)slots * slot_size);
+	double t0, dt;
+
+	memset(&t, 0, sizeof(t));
+	Spsc_Init(&t.q, storage, slot_size, slots);
+	t.slot_size = slot_size;
+	t.count = count;
+	t.batch = batch;
+	t.locked = locked;
+	pthread_mutex_init(&t.lock, 0);
+	t0 = now_s();
+	pthread_create(&cons, 0, bench_consumer, &t);
+	pthread_create(&prod, 0, bench_producer, &t);
+	pthread_join(prod, 0);
+	pthread_join(cons, 0);
+	dt = now_s() - t0;
+
+	printf("%-24s %6u %6u %10.2f %10.1f %8.1f  %s\n", locked ? "verrou (mutex)" : "sans verrou",
+	       slot_size, batch ? batch : 1, count / dt / 1e6, count * slot_size / dt / 1e6,
+	       dt * 1e9 / count, t.bad ? "ÉCART" : "ok");
+	pthread_mutex_destroy(&t.lock);
+	free(storage);
+	return t.bad == 0;
+}
+
+int main (int argc, char **argv)
+{
+	uint64_t count = 5000000;
+	int fails = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc)
+			count = strtoull(argv[++i], 0, 10);
+		else {
+			fprintf(stderr, "usage: spscbench [-n éléments]\n");
+			return 2;
+		}
+	}
+	if (count < 1000)
+		count = 1000;
+
+	printf("Essai de charge (SPSC_LINE=%d)\n", SPSC_LINE);
+	printf("%-24s %6s %10s %10s %8s %10s %8s\n", "file", "places", "envoyés", "reçus", "écarts",
+	       "pleine", "durée s");
+	fails += !stress("1 place", sizeof(Item), 1, count / 10, 1);
+	fails += !stress("2 places", sizeof(Item), 2, count / 10, 2);
+	fails += !stress("16 places", sizeof(Item), 16, count, 3);
+	fails += !stress("1024 places", sizeof(Item), 1024, count, 4);
+	fails += !stress("octets (UART, 64)", 1, 64, count, 5);
+
+	printf("\nDébit (file de 1024 places)\n");
+	printf("%-24s %6s %6s %10s %10s %8s\n", "accès", "octets", "lot", "Méléments/s", "Mo/s", "ns/élém.");
+	for (uint32_t size = 4; size <= 64; size *= 4) {
+		fails += !bench(size, 0, 0, count * 4);
+		fails += !bench(size, 64, 0, count * 4);
+		fails += !bench(size, 0, 1, count);
+	}
+	return fails != 0;
+}
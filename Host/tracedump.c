@@ -0,0 +1,385 @@
+/**
+  * @brief  tracedump : vidage de la trace d'événements de la carte (ADC-UART/Trace.h) et
+  *         conversion en chronologie lisible par les visionneuses de traces
+  *
+  *   Compilation :
+  *      gcc -O2 -o tracedump tracedump.c ../ADC-UART/Frame.c ../ADC-UART/CRC16.c ../ADC-UART/Pack.c
+  *
+  *   Utilisation :
+  *      tracedump [-b baud] [-o trace.json] [-p] [-t secondes] <port série | fichier | ->
+  *
+  *   Sur un port série, une trame FRAME_TRACE_CMD demande le vidage de l'anneau ; avec -p,
+  *   rien n'est demandé et l'outil attend le vidage envoyé par la carte au démarrage (anneau
+  *   préservé à travers un reset ou gelé par une faute). Un fichier (enregistrement brut du
+  *   port, texte ou binaire) est lu en entier et tous les vidages qu'il contient sont
+  *   convertis. La sortie (trace.json par défaut, - : sortie standard) est au format Trace
+  *   Event JSON : ouvrir dans https://ui.perfetto.dev ou chrome://tracing. Un processus par
+  *   vidage ; une piste par gestionnaire d'interruption, puis ADC, UART, multiplexeur et
+  *   boucle principale. Les paires _BEGIN / _END deviennent des tranches, les autres
+  *   événements des instants. Le bilan de chaque vidage (cause, adresse fautive) est écrit
+  *   sur la sortie d'erreur ; le code de retour vaut 1 si aucun vidage complet n'est reçu.
+  */
+#define _GNU_SOURCE
+#include "../ADC-UART/Frame.h"
+#include "../ADC-UART/Trace.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// Pistes (tid) ; les gestionnaires d'interruption suivent TRACK_ISR
+enum { TRACK_MAIN = 1, TRACK_ADC, TRACK_UART, TRACK_MUX, TRACK_ISR };
+
+static const char *const isr_names[] = { "SysTick", "ADC", "ADC DMA", "TIM2 edge" };
+static const char *const track_names[] = { "", "main", "ADC", "UART", "Mux" };
+static const char *const cause_names[] = { "?", "command", "reset", "fault" };
+
+typedef struct {
+	const char *name;
+	int         track;
+	char        ph;                // 'B', 'E' ou 'i'
+} EventInfo;
+
+static const EventInfo events[TRACE_ID_COUNT] = {
+	[TRACE_NONE]           = { "none", TRACK_MAIN, 'i' },
+	[TRACE_ISR_BEGIN]      = { "ISR", TRACK_ISR, 'B' },
+	[TRACE_ISR_END]        = { "ISR", TRACK_ISR, 'E' },
+	[TRACE_ADC_BEGIN]      = { "ADC_ReadBlock", TRACK_ADC, 'B' },
+	[TRACE_ADC_END]        = { "ADC_ReadBlock", TRACK_ADC, 'E' },
+	[TRACE_TXE_BEGIN]      = { "TXE wait", TRACK_UART, 'B' },
+	[TRACE_TXE_END]        = { "TXE wait", TRACK_UART, 'E' },
+	[TRACE_WRITE_BEGIN]    = { "UART_Write", TRACK_UART, 'B' },
+	[TRACE_WRITE_END]      = { "UART_Write", TRACK_UART, 'E' },
+	[TRACE_FLUSH_BEGIN]    = { "UART_Flush", TRACK_UART, 'B' },
+	[TRACE_FLUSH_END]      = { "UART_Flush", TRACK_UART, 'E' },
+	[TRACE_MUX_WAIT_BEGIN] = { "queue full", TRACK_MUX, 'B' },
+	[TRACE_MUX_WAIT_END]   = { "queue full", TRACK_MUX, 'E' },
+	[TRACE_ERASE_BEGIN]    = { "flash erase", TRACK_MAIN, 'B' },
+	[TRACE_ERASE_END]      = { "flash erase", TRACK_MAIN, 'E' },
+	[TRACE_ADC_OVR]        = { "ADC overrun", TRACK_ADC, 'i' },
+	[TRACE_UART_DMA]       = { "DMA TX", TRACK_UART, 'i' },
+	[TRACE_MUX_DROP]       = { "drop", TRACK_MUX, 'i' },
+	[TRACE_BAUD]           = { "baud", TRACK_UART, 'i' },
+	[TRACE_HOST]           = { "host", TRACK_MAIN, 'i' },
+	[TRACE_LOOP]           = { "period", TRACK_MAIN, 'i' },
+	[TRACE_FAULT]          = { "FAULT", TRACK_MAIN, 'i' },
+	[TRACE_MARK]           = { "mark", TRACK_MAIN, 'i' },
+};
+
+#define TRACKS  (TRACK_ISR + 8)
+
+typedef struct {
+	int       started;             // Partie TRACE_PART_INFO reçue
+	uint8_t   cause;
+	uint16_t  count;
+	uint32_t  got;
+	uint32_t  total, clock_hz;
+	uint32_t  fault_pc, fault_lr, cfsr, hfsr;
+	Trace_Record rec[TRACE_RECORDS];
+} Dump;
+
+typedef struct {
+	FILE *out;
+	int   dumps;                   // Vidages complets écrits
+	int   first;                   // Aucun événement JSON écrit
+	Dump  d;
+} Converter;
+
+static uint64_t now_ms (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Ajouter un événement au tableau traceEvents
+static void json_event (Converter *c, const char *fmt, ...)
+{
+	va_list ap;
+
+	fputs(c->first ? "\n" : ",\n", c->out);
+	c->first = 0;
+	va_start(ap, fmt);
+	vfprintf(c->out, fmt, ap);
+	va_end(ap);
+}
+
+static int track_of (const Trace_Record *r)
+{
+	const EventInfo *e = &events[r->id];
+	return e->track == TRACK_ISR ? TRACK_ISR + (r->arg & 7) : e->track;
+}
+
+static const char *track_name (int track, char *buf, size_t size)
+{
+	if (track < TRACK_ISR)
+		return track_names[track];
+	snprintf(buf, size, "ISR %s", track - TRACK_ISR < 4 ? isr_names[track - TRACK_ISR] : "?");
+	return buf;
+}
+
+// Écrire un vidage complet : horodatage déroulé sur 64 bits, tranches et instants
+static void write_dump (Converter *c)
+{
+	const Dump *d = &c->d;
+	int pid = c->dumps + 1, depth[TRACKS] = { 0 }, used[TRACKS] = { 0 };
+	double us_per_cycle = 1e6 / (d->clock_hz ? d->clock_hz : 168000000);
+	uint64_t t = 0;
+	double ts = 0;
+	char name[64];
+
+	json_event(c, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"dump %d (%s, %lu records)\"}}",
+	           pid, pid, cause_names[d->cause <= TRACE_CAUSE_FAULT ? d->cause : 0], (unsigned long)d->count);
+	for (uint32_t i = 0; i < d->count; i++) {
+		const Trace_Record *r = &d->rec[i];
+		const EventInfo *e;
+		int track;
+
+		if (i)
+			t += (uint32_t)(r->cycles - d->rec[i - 1].cycles);
+		ts = t * us_per_cycle;
+		if (r->id >= TRACE_ID_COUNT || !events[r->id].name) {
+			json_event(c, "{\"name\":\"id %u\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"arg\":%u}}",
+			           r->id, ts, pid, TRACK_MAIN, r->arg);
+			used[TRACK_MAIN] = 1;
+			continue;
+		}
+		e = &events[r->id];
+		track = track_of(r);
+		used[track] = 1;
+		if (e->ph == 'E') {
+			if (depth[track] == 0)
+				continue;              // Début perdu dans l'anneau
+			depth[track]--;
+			json_event(c, "{\"ph\":\"E\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}", ts, pid, track);
+		} else if (e->ph == 'B') {
+			depth[track]++;
+			json_event(c, "{\"name\":\"%s\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"arg\":%u}}",
+			           e->name, ts, pid, track, r->arg);
+		} else if (r->id == TRACE_FAULT) {
+			json_event(c, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+			              "\"args\":{\"exception\":%u,\"pc\":\"0x%08lX\",\"lr\":\"0x%08lX\",\"cfsr\":\"0x%08lX\",\"hfsr\":\"0x%08lX\"}}",
+			           e->name, ts, pid, track, r->arg, (unsigned long)d->fault_pc, (unsigned long)d->fault_lr,
+			           (unsigned long)d->cfsr, (unsigned long)d->hfsr);
+		} else if (r->id == TRACE_BAUD) {
+			json_event(c, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"baud\":%lu}}",
+			           e->name, ts, pid, track, (unsigned long)r->arg * 100);
+		} else {
+			json_event(c, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"arg\":%u}}",
+			           e->name, ts, pid, track, r->arg);
+		}
+	}
+
+	// Tranches ouvertes à la fin de l'anneau (faute, gel) : fermées au dernier événement
+	for (int k = 0; k < TRACKS; k++) {
+		while (depth[k]-- > 0)
+			json_event(c, "{\"ph\":\"E\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}", ts, pid, k);
+		if (used[k])
+			json_event(c, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+			           pid, k, track_name(k, name, sizeof(name)));
+	}
+
+	fprintf(stderr, "tracedump: vidage %d : %s, %u enregistrements (%lu écrits depuis le départ), %.3f ms, horloge %lu Hz\n",
+	        pid, cause_names[d->cause <= TRACE_CAUSE_FAULT ? d->cause : 0], d->count, (unsigned long)d->total,
+	        ts / 1000, (unsigned long)d->clock_hz);
+	if (d->cause == TRACE_CAUSE_FAULT)
+		fprintf(stderr, "tracedump: faute : pc=0x%08lX lr=0x%08lX cfsr=0x%08lX hfsr=0x%08lX\n",
+		        (unsigned long)d->fault_pc, (unsigned long)d->fault_lr, (unsigned long)d->cfsr, (unsigned long)d->hfsr);
+	c->dumps++;
+}
+
+// Trame FRAME_TRACE reçue
+static void on_part (Converter *c, const uint8_t *p, uint32_t length)
+{
+	Dump *d = &c->d;
+	uint32_t index, n;
+
+	if (length < 1)
+		return;
+	switch (p[0]) {
+	case TRACE_PART_INFO:
+		if (length < TRACE_INFO_SIZE)
+			return;
+		memset(d, 0, sizeof(*d) - sizeof(d->rec));
+		d->started = 1;
+		d->cause = p[1];
+		d->count = Frame_GetU16(&p[2]);
+		if (d->count > TRACE_RECORDS)
+			d->count = TRACE_RECORDS;
+		d->total = Frame_GetU32(&p[4]);
+		d->clock_hz = Frame_GetU32(&p[8]);
+		d->fault_pc = Frame_GetU32(&p[12]);
+		d->fault_lr = Frame_GetU32(&p[16]);
+		d->cfsr = Frame_GetU32(&p[20]);
+		d->hfsr = Frame_GetU32(&p[24]);
+		break;
+	case TRACE_PART_RECORDS:
+		if (!d->started || length < TRACE_RECORDS_HDR)
+			return;
+		index = Frame_GetU16(&p[1]);
+		n = p[3];
+		if (length < TRACE_RECORDS_HDR + n * TRACE_RECORD_SIZE || index != d->got || index + n > d->count) {
+			d->started = 0;            // Trame perdue : vidage incomplet, ignoré
+			fprintf(stderr, "tracedump: vidage incomplet (enregistrement %lu attendu, %lu reçu)\n",
+			        (unsigned long)d->got, (unsigned long)index);
+			return;
+		}
+		for (uint32_t i = 0; i < n; i++) {
+			const uint8_t *q = &p[TRACE_RECORDS_HDR + i * TRACE_RECORD_SIZE];
+			Trace_Record *r = &d->rec[index + i];
+			r->cycles = Frame_GetU32(q);
+			r->id = Frame_GetU16(&q[4]);
+			r->arg = Frame_GetU16(&q[6]);
+		}
+		d->got = index + n;
+		break;
+	default:
+		if (d->started && d->got == d->count)
+			write_dump(c);
+		d->started = 0;
+		break;
+	}
+}
+
+static int feed (Converter *c, Frame_Rx *rx, const uint8_t *buf, size_t n)
+{
+	int before = c->dumps;
+
+	for (size_t i = 0; i < n; i++)
+		if (Frame_RxByte(rx, buf[i]) && FRAME_TYPE(rx->buf[2]) == FRAME_TRACE)
+			on_part(c, &rx->buf[FRAME_HDR_SIZE], rx->buf[3]);
+	return c->dumps - before;
+}
+
+static speed_t baud_constant (long baud)
+{
+	switch (baud) {
+	case 9600:    return B9600;
+	case 19200:   return B19200;
+	case 38400:   return B38400;
+	case 57600:   return B57600;
+	case 115200:  return B115200;
+	case 230400:  return B230400;
+	case 460800:  return B460800;
+	case 921600:  return B921600;
+#ifdef B1000000
+	case 1000000: return B1000000;
+	case 1500000: return B1500000;
+	case 2000000: return B2000000;
+	case 3000000: return B3000000;
+	case 4000000: return B4000000;
+#endif
+	default:      return 0;
+	}
+}
+
+// Configurer un terminal en mode brut au débit demandé
+static int setup_tty (int fd, long baud)
+{
+	struct termios tio;
+	speed_t sp = baud_constant(baud);
+
+	if (tcgetattr(fd, &tio) != 0)
+		return -1;
+	cfmakeraw(&tio);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN] = 1;
+	tio.c_cc[VTIME] = 0;
+	if (sp && (cfsetispeed(&tio, sp) != 0 || cfsetospeed(&tio, sp) != 0))
+		return -1;
+	if (!sp)
+		fprintf(stderr, "tracedump: débit %ld non standard, débit actuel conservé\n", baud);
+	return tcsetattr(fd, TCSANOW, &tio);
+}
+
+int main (int argc, char **argv)
+{
+	long baud = 115200;
+	double max_seconds = 10;
+	const char *out_path = "trace.json", *in_path = NULL;
+	static Converter conv;
+	static Frame_Rx rx;
+	static uint8_t buf[65536];
+	int fd, tty, passive = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-b") && i + 1 < argc)
+			baud = atol(argv[++i]);
+		else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+			out_path = argv[++i];
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+			max_seconds = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-p"))
+			passive = 1;
+		else
+			in_path = argv[i];
+	}
+	if (!in_path) {
+		fprintf(stderr, "usage: tracedump [-b baud] [-o trace.json] [-p] [-t s] <port|fichier|->\n");
+		return 2;
+	}
+
+	fd = strcmp(in_path, "-") ? open(in_path, O_RDWR | O_NOCTTY) : 0;
+	if (fd < 0)
+		fd = open(in_path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "tracedump: %s: %s\n", in_path, strerror(errno));
+		return 1;
+	}
+	tty = isatty(fd);
+	if (tty && setup_tty(fd, baud) != 0) {
+		fprintf(stderr, "tracedump: configuration de %s impossible\n", in_path);
+		return 1;
+	}
+	conv.out = strcmp(out_path, "-") ? fopen(out_path, "w") : stdout;
+	if (!conv.out) {
+		fprintf(stderr, "tracedump: %s: %s\n", out_path, strerror(errno));
+		return 1;
+	}
+	conv.first = 1;
+	fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", conv.out);
+	Frame_RxInit(&rx);
+
+	if (tty) {
+		// Demande de vidage, puis réception jusqu'au premier vidage complet
+		uint64_t deadline = now_ms() + (uint64_t)(max_seconds * 1000);
+		if (!passive) {
+			uint8_t cmd[FRAME_HDR_SIZE + FRAME_CRC_SIZE];
+			if (write(fd, cmd, Frame_Encode(cmd, FRAME_TRACE_CMD, 0, NULL, 0)) < 0)
+				fprintf(stderr, "tracedump: %s: %s\n", in_path, strerror(errno));
+		}
+		while (!conv.dumps && now_ms() < deadline) {
+			struct pollfd pfd = { fd, POLLIN, 0 };
+			ssize_t r;
+			if (poll(&pfd, 1, 100) <= 0)
+				continue;
+			r = read(fd, buf, sizeof(buf));
+			if (r < 0 && errno == EINTR)
+				continue;
+			if (r <= 0)
+				break;
+			feed(&conv, &rx, buf, (size_t)r);
+		}
+	} else {
+		ssize_t r;
+		while ((r = read(fd, buf, sizeof(buf))) > 0)
+			feed(&conv, &rx, buf, (size_t)r);
+	}
+
+	fputs("\n]}\n", conv.out);
+	if (conv.out != stdout)
+		fclose(conv.out);
+	if (fd)
+		close(fd);
+	if (!conv.dumps) {
+		fprintf(stderr, "tracedump: aucun vidage complet reçu\n");
+		return 1;
+	}
+	return 0;
+}
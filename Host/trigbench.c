@@ -0,0 +1,238 @@
+/**
+  * @brief  trigbench : validation de l'acquisition déclenchée de la carte (ADC-UART/Trigger.c)
+  *
+  *   Compilation :
+  *      gcc -O2 -o trigbench trigbench.c ../ADC-UART/Trigger.c ../ADC-UART/Spsc.c -lm
+  *
+  *   Utilisation :
+  *      trigbench [-n fronts] [-v]
+  *
+  *   Une source de fronts simulée (strobe périodique avec gigue, doubles fronts, cadence
+  *   supérieure à celle de l'ADC) attaque un modèle de la carte : TIM2 à 84 MHz date chaque
+  *   front (capture, avec écrasement si l'interruption de capture n'a pas encore lu la
+  *   précédente), l'ADC ignore un front pendant une conversion (12 bits, 3 cycles
+  *   d'échantillonnage à 21 MHz, synchronisation variable), l'interruption EOC lit le
+  *   résultat après une latence variable, parfois retardée par une autre interruption
+  *   (débordement OVR si la conversion suivante se termine avant la lecture). Les
+  *   interruptions sont servies dans l'ordre de leurs priorités (capture avant EOC).
+  *   Les compteurs de Trigger.c (fronts, échantillons, manqués) doivent être exacts ; les
+  *   latences sont comparées à la vérité du modèle (capture écrasée : l'échantillon est daté
+  *   par le dernier front capturé, latence sous-estimée, seul cas d'appariement approché).
+  *   Le code de retour vaut 1 en cas d'écart.
+  */
+#include "../ADC-UART/Trigger.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TICK_HZ     84000000.0
+#define CONV_TICKS  72            // (15 + 3) cycles ADC à 21 MHz
+#define CONV_MIN    60            // Conversion effective : 60 à 72 ticks selon la synchronisation
+
+typedef struct {
+	const char *name;
+	double period_us;            // Période du strobe
+	double jitter_us;            // Gigue gaussienne (écart-type)
+	double double_prob;          // Probabilité d'un second front rapproché
+	double double_min_us;        // Écart du second front (tirage uniforme)
+	double double_max_us;
+	double hog_prob;             // Probabilité que l'interruption EOC soit retardée
+	double hog_us;
+	int    approx_latency;       // Capture écrasée : daté par le front le plus récent, admis
+} Case;
+
+static const Case cases[] = {
+	{ "strobe 10 kHz",          100.0, 0.05, 0.0,  0,    0,    0.0,   0, 0 },
+	{ "strobe 100 kHz",          10.0, 0.02, 0.0,  0,    0,    0.0,   0, 0 },
+	{ "doubles < conversion",    50.0, 0.05, 0.2,  0.30, 0.70, 0.0,   0, 0 },
+	{ "capture écrasée",         50.0, 0.05, 0.2,  0.05, 0.20, 0.0,   0, 1 },
+	{ "doubles > conversion",    50.0, 0.05, 0.2,  0.95, 3.0,  0.0,   0, 0 },
+	{ "strobe > cadence ADC",     0.6, 0.01, 0.0,  0,    0,    0.0,   0, 0 },
+	{ "EOC retardée (OVR)",      20.0, 0.02, 0.0,  0,    0,    0.05, 25, 0 },
+};
+
+static uint32_t rng = 2024;
+
+static double uni (void)
+{
+	rng = rng * 1664525u + 1013904223u;
+	return (rng >> 8) / 16777216.0;
+}
+
+static double gauss (void)
+{
+	double u, v, s;
+	do {
+		u = 2 * uni() - 1;
+		v = 2 * uni() - 1;
+		s = u * u + v * v;
+	} while (s >= 1 || s == 0);
+	return u * sqrt(-2 * log(s) / s);
+}
+
+// Latence d'entrée en interruption : 12 à 40 cycles CPU, soit 6 à 20 ticks
+static uint64_t isr_latency (void)
+{
+	return 6 + (uint64_t)(uni() * 15);
+}
+
+typedef struct {
+	uint64_t edges, converted, ignored, overruns, delivered;
+	uint64_t mismatched;
+	double   lat_min, lat_max, lat_sum;
+} Truth;
+
+static int run (const Case *c, long count, int verbose)
+{
+	const uint64_t never = UINT64_MAX;
+	const uint64_t base = 0xFFFFFFFFull - 2000000;   // Rebouclage de TIM2 pendant l'essai
+	Trigger tr;
+	Truth tru;
+	uint64_t *edges = malloc(sizeof(uint64_t) * 2 * (size_t)count);
+	long n = 0;
+	double t = 1000;
+
+	memset(&tru, 0, sizeof(tru));
+	tru.lat_min = 1e30;
+	Trigger_Init(&tr, CONV_TICKS);
+
+	// Fronts (ticks absolus, croissants)
+	for (long i = 0; i < count; i++) {
+		double e = t + c->jitter_us * gauss();
+		edges[n++] = base + (uint64_t)(e * TICK_HZ / 1e6);
+		if (c->double_prob > 0 && uni() < c->double_prob) {
+			double d = c->double_min_us + uni() * (c->double_max_us - c->double_min_us);
+			edges[n++] = base + (uint64_t)((e + d) * TICK_HZ / 1e6);
+		}
+		t += c->period_us;
+	}
+
+	// Simulation événementielle
+	uint64_t cap_time = never, cap_ccr = 0, cap_of = 0;
+	uint64_t conv_end = never, conv_edge = 0;
+	uint64_t eoc_isr = never, dr_edge = 0, ovr = 0, eoc_flag = 0;
+	uint64_t fifo_truth[4096];
+	long ft_rd = 0, ft_wr = 0;
+	long i = 0;
+
+	while (i < n || cap_time != never || conv_end != never || eoc_isr != never) {
+		uint64_t te = i < n ? edges[i] : never;
+		uint64_t next = te;
+		int ev = 0;                              // 0 front, 1 fin de conversion, 2 capture, 3 EOC
+
+		if (conv_end <= next) { next = conv_end; ev = 1; }
+		if (cap_time < next || (cap_time == next && ev == 0 && cap_time != never)) { next = cap_time; ev = 2; }
+		if (eoc_isr < next) { next = eoc_isr; ev = 3; }
+
+		switch (ev) {
+		case 0:
+			tru.edges++;
+			if (cap_time != never)
+				cap_of = 1;                      // Capture précédente pas encore lue : écrasée
+			else
+				cap_time = te + isr_latency();
+			cap_ccr = te;
+			if (conv_end == never) {
+				conv_edge = te;
+				conv_end = te + CONV_MIN + (uint64_t)(uni() * (CONV_TICKS - CONV_MIN + 1));
+				tru.converted++;
+			} else {
+				tru.ignored++;
+			}
+			i++;
+			break;
+		case 1:
+			if (eoc_flag) {
+				ovr = 1;                         // DR pas encore lu : résultat précédent perdu
+				tru.overruns++;
+			} else {
+				eoc_isr = conv_end + isr_latency();
+				if (c->hog_prob > 0 && uni() < c->hog_prob)
+					eoc_isr += (uint64_t)(c->hog_us * TICK_HZ / 1e6);
+			}
+			eoc_flag = 1;
+			dr_edge = conv_edge;
+			conv_end = never;
+			break;
+		case 2:
+			Trigger_Edge(&tr, (uint32_t)cap_ccr, (uint32_t)cap_of);
+			cap_of = 0;
+			cap_time = never;
+			break;
+		case 3: {
+			// Une capture en attente passe d'abord (priorité plus haute)
+			if (cap_time <= eoc_isr) {
+				Trigger_Edge(&tr, (uint32_t)cap_ccr, (uint32_t)cap_of);
+				cap_of = 0;
+				cap_time = never;
+			}
+			double lat = (double)(eoc_isr - dr_edge);
+			if (ovr)
+				Trigger_Drop(&tr);               // Comme ADC_IRQHandler : OVR avant EOC
+			Trigger_Conversion(&tr, (uint32_t)eoc_isr, (uint16_t)(dr_edge & 0xFFF));
+			tru.delivered++;
+			if (lat < tru.lat_min) tru.lat_min = lat;
+			if (lat > tru.lat_max) tru.lat_max = lat;
+			tru.lat_sum += lat;
+			fifo_truth[ft_wr++ & 4095] = dr_edge;
+			ovr = 0;
+			eoc_flag = 0;
+			eoc_isr = never;
+			break;
+		}
+		}
+
+		// Lecture côté application : appariement comparé à la vérité
+		Trigger_Sample s;
+		while (Trigger_Read(&tr, &s, 1)) {
+			if (s.t_edge != (uint32_t)fifo_truth[ft_rd++ & 4095])
+				tru.mismatched++;
+		}
+	}
+
+	const Trigger_Stats *st = &tr.stats;
+	uint64_t truth_missed = tru.ignored + tru.overruns;
+	double ns = 1e9 / TICK_HZ;
+	int ok = st->edges == tru.edges && st->missed == truth_missed && st->samples == tru.delivered &&
+	         st->orphans == 0 && st->overflows == 0 && (c->approx_latency || tru.mismatched == 0);
+
+	if (verbose) {
+		char line[200];
+		Trigger_Format(st, (uint32_t)TICK_HZ, line, sizeof(line));
+		fputs(line, stdout);
+	}
+	printf("%-22s %8llu %8llu %8llu %8llu %7llu %6.0f/%4.0f/%4.0f %6.0f/%4.0f/%4.0f %6llu  %s\n", c->name,
+	       (unsigned long long)tru.edges, (unsigned long long)truth_missed,
+	       (unsigned long long)st->missed, (unsigned long long)st->samples, (unsigned long long)tru.overruns,
+	       tru.lat_min * ns, tru.lat_sum / tru.delivered * ns, tru.lat_max * ns,
+	       st->lat_min * ns, (double)st->lat_sum / st->samples * ns, st->lat_max * ns,
+	       (unsigned long long)tru.mismatched, ok ? "ok" : "ÉCART");
+	free(edges);
+	return ok;
+}
+
+int main (int argc, char **argv)
+{
+	long count = 200000;
+	int verbose = 0, fails = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc)
+			count = atol(argv[++i]);
+		else if (!strcmp(argv[i], "-v"))
+			verbose = 1;
+		else {
+			fprintf(stderr, "usage: trigbench [-n fronts] [-v]\n");
+			return 2;
+		}
+	}
+	if (count < 1)
+		count = 1;
+
+	printf("%-22s %8s %8s %8s %8s %7s %16s %16s %6s\n", "cas", "fronts", "manqués", "mesurés",
+	       "échant.", "OVR", "latence ns réel", "latence mesurée", "apparié");
+	for (unsigned k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+		fails += !run(&cases[k], count, verbose);
+	return fails != 0;
+}